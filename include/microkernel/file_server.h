@@ -0,0 +1,28 @@
+#ifndef MICROKERNEL_FILE_SERVER_H
+#define MICROKERNEL_FILE_SERVER_H
+
+#include "types.h"
+
+/* ── Configuration ────────────────────────────────────────────────── */
+
+typedef struct {
+    uint16_t port;
+    char     root[128];   /* directory served at "/" */
+} file_server_config_t;
+
+/* ── API ──────────────────────────────────────────────────────────── */
+
+/*
+ * Spawn a static file server: GET and HEAD of the files under
+ * config->root on config->port, "dir/" serving "dir/index.html".
+ *
+ * Files go out with actor_http_respond_file (sendfile on plain sockets)
+ * from a small cache of open fds, revalidated with stat() per request.
+ * Every response carries an ETag; If-None-Match answers 304, and a
+ * single "Range: bytes=" range answers 206 (416 if unsatisfiable).
+ *
+ * Returns the actor ID, or ACTOR_ID_INVALID on failure.
+ */
+actor_id_t file_server_init(runtime_t *rt, const file_server_config_t *config);
+
+#endif /* MICROKERNEL_FILE_SERVER_H */
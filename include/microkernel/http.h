@@ -2,12 +2,49 @@
 #define MICROKERNEL_HTTP_H
 
 #include "types.h"
+#include <sys/types.h>
 
 /* ── Connection ID ──────────────────────────────────────────────────── */
 
 typedef uint32_t http_conn_id_t;
 #define HTTP_CONN_ID_INVALID ((http_conn_id_t)0)
 
+/* ── Header index ───────────────────────────────────────────────────── */
+
+/* Request and response payloads end with an index of their packed
+   headers, after the body at a 4-byte aligned offset from the payload
+   start: an http_header_index_t, count entries, then a hash table of
+   mask + 1 slots, each an entry number + 1 (0 = empty).  Headers beyond
+   HTTP_HEADER_INDEX_MAX are in the packed block but not the index. */
+
+typedef struct {
+    uint32_t hash;       /* http_header_hash() of the name */
+    uint32_t offset;     /* of "Key: Value\0" in the packed headers */
+    uint16_t name_len;
+    uint16_t value;      /* offset of Value from the line's start */
+} http_header_entry_t;
+
+typedef struct {
+    uint16_t count;
+    uint16_t mask;
+} http_header_index_t;
+
+#define HTTP_HEADER_INDEX_MAX 0x7FFF
+
+static inline const http_header_index_t *
+http_header_index_at(const void *payload, size_t end) {
+    return (const http_header_index_t *)
+           ((const uint8_t *)payload + ((end + 3) & ~(size_t)3));
+}
+
+/* FNV-1a of name, case-folded */
+uint32_t http_header_hash(const char *name, size_t len);
+
+/* Value of the first header called name (any case), or NULL */
+const char *http_header_get(const char *headers,
+                            const http_header_index_t *index,
+                            const char *name);
+
 /* ── HTTP response payload (MSG_HTTP_RESPONSE) ─────────────────────── */
 
 typedef struct {
@@ -25,6 +62,33 @@ static inline const void *http_response_body(const http_response_payload_t *p) {
     return (const uint8_t *)(p + 1) + p->headers_size;
 }
 
+static inline const http_header_index_t *
+http_response_header_index(const http_response_payload_t *p) {
+    return http_header_index_at(p, sizeof(*p) + p->headers_size +
+                                   p->body_size);
+}
+
+static inline const char *http_response_header(const http_response_payload_t *p,
+                                               const char *name) {
+    return http_header_get(http_response_headers(p),
+                           http_response_header_index(p), name);
+}
+
+/* MSG_HTTP_RESPONSE_HEAD carries an http_response_payload_t with
+   body_size 0; the body follows as MSG_HTTP_BODY_CHUNK messages. */
+
+/* ── Streamed body payload (MSG_HTTP_BODY_CHUNK) ───────────────────── */
+
+typedef struct {
+    http_conn_id_t conn_id;
+    bool           final;     /* last message of the response */
+    size_t         size;      /* body bytes after struct */
+} http_body_chunk_payload_t;
+
+static inline const void *http_body_chunk_data(const http_body_chunk_payload_t *p) {
+    return (const void *)(p + 1);
+}
+
 /* ── HTTP error payload (MSG_HTTP_ERROR) ───────────────────────────── */
 
 typedef struct {
@@ -79,7 +143,8 @@ typedef struct {
     size_t path_size;      /* includes \0 */
     size_t headers_size;   /* packed "Key: Value\0" pairs */
     size_t body_size;
-    /* followed by: [method\0][path\0][packed headers][body] */
+    bool   body_streamed;  /* body follows as MSG_HTTP_BODY_CHUNK */
+    /* followed by: [method\0][path\0][packed headers][body][index] */
 } http_request_payload_t;
 
 static inline const char *http_request_method(const http_request_payload_t *p) {
@@ -99,6 +164,19 @@ static inline const void *http_request_body(const http_request_payload_t *p) {
            p->headers_size;
 }
 
+static inline const http_header_index_t *
+http_request_header_index(const http_request_payload_t *p) {
+    return http_header_index_at(p, sizeof(*p) + p->method_size +
+                                   p->path_size + p->headers_size +
+                                   p->body_size);
+}
+
+static inline const char *http_request_header(const http_request_payload_t *p,
+                                              const char *name) {
+    return http_header_get(http_request_headers(p),
+                           http_request_header_index(p), name);
+}
+
 /* ── Actor-facing APIs ────────────────────────────────────────────── */
 
 http_conn_id_t actor_http_fetch(runtime_t *rt, const char *method,
@@ -107,6 +185,19 @@ http_conn_id_t actor_http_fetch(runtime_t *rt, const char *method,
                                 size_t body_size);
 http_conn_id_t actor_http_get(runtime_t *rt, const char *url);
 
+/* Like actor_http_fetch, but the response arrives as MSG_HTTP_RESPONSE_HEAD
+   and then MSG_HTTP_BODY_CHUNK messages as bytes come in, the last with
+   final set.  At most window bytes (0 = HTTP_STREAM_WINDOW) are delivered
+   and not yet acked; past that the socket isn't read. */
+http_conn_id_t actor_http_fetch_stream(runtime_t *rt, const char *method,
+                                       const char *url,
+                                       const char *const *headers,
+                                       size_t n_headers, const void *body,
+                                       size_t body_size, size_t window);
+
+/* Done with bytes of streamed body: reopen that much of the window */
+bool actor_http_body_ack(runtime_t *rt, http_conn_id_t id, size_t bytes);
+
 http_conn_id_t actor_sse_connect(runtime_t *rt, const char *url);
 
 http_conn_id_t actor_ws_connect(runtime_t *rt, const char *url);
@@ -124,11 +215,39 @@ void actor_http_close(runtime_t *rt, http_conn_id_t id);
 bool actor_http_listen(runtime_t *rt, uint16_t port);
 bool actor_http_unlisten(runtime_t *rt, uint16_t port);
 
+/* Like actor_http_listen, but a request with a body is delivered as soon
+   as its headers are in, with body_streamed set; the body follows as
+   MSG_HTTP_BODY_CHUNK messages, acked with actor_http_body_ack against
+   window (0 = HTTP_STREAM_WINDOW).  Respond after the final chunk. */
+bool actor_http_listen_stream(runtime_t *rt, uint16_t port, size_t window);
+
 bool actor_http_respond(runtime_t *rt, http_conn_id_t conn_id,
                         int status_code,
                         const char *const *headers, size_t n_headers,
                         const void *body, size_t body_size);
 
+/* Respond with len bytes of the open file fd from offset, with
+   Content-Length len.  The conn sends from its own dup of fd, so the
+   caller may close fd at once; on a plain socket the bytes go from the
+   page cache with sendfile, not through a buffer.  A HEAD request gets
+   the head alone. */
+bool actor_http_respond_file(runtime_t *rt, http_conn_id_t conn_id,
+                             int status_code,
+                             const char *const *headers, size_t n_headers,
+                             int fd, off_t offset, size_t len);
+
+/* Response of unknown length: the head now, then the body in any number
+   of writes, sent with chunked transfer encoding (or delimited by close
+   for an HTTP/1.0 client).  A write that would leave more than
+   HTTP_SEND_BACKLOG_MAX bytes unsent is refused, and MSG_HTTP_WRITE_READY
+   follows once the backlog is out. */
+bool actor_http_respond_start(runtime_t *rt, http_conn_id_t conn_id,
+                              int status_code,
+                              const char *const *headers, size_t n_headers);
+bool actor_http_write_chunk(runtime_t *rt, http_conn_id_t conn_id,
+                            const void *data, size_t size);
+bool actor_http_end(runtime_t *rt, http_conn_id_t conn_id);
+
 bool actor_sse_start(runtime_t *rt, http_conn_id_t conn_id);
 bool actor_sse_push(runtime_t *rt, http_conn_id_t conn_id,
                     const char *event, const char *data, size_t data_size);
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 
 typedef struct mk_socket mk_socket_t;
 
@@ -12,6 +13,11 @@ struct mk_socket {
     ssize_t (*write)(mk_socket_t *self, const uint8_t *buf, size_t len);
     void    (*close)(mk_socket_t *self);
     int     (*get_fd)(mk_socket_t *self);
+    /* Optional: send len bytes of in_fd from *offset without copying
+       through user space, advancing *offset.  NULL where the bytes must
+       pass through the socket layer (TLS) or the OS has no sendfile. */
+    ssize_t (*sendfile)(mk_socket_t *self, int in_fd, off_t *offset,
+                        size_t len);
     void    *ctx;
 };
 
@@ -24,6 +30,12 @@ mk_socket_t *mk_socket_tcp_connect(const char *host, uint16_t port);
    Used by the server accept path. Returns NULL on alloc failure. */
 mk_socket_t *mk_socket_tcp_wrap(int fd);
 
+/* Start a non-blocking connect to a resolved address.  Returns at once;
+   the socket polls writable when the connect completes, and SO_ERROR
+   then says whether it failed.  Returns NULL on immediate failure. */
+mk_socket_t *mk_socket_tcp_connect_addr(const struct sockaddr *addr,
+                                        socklen_t addr_len);
+
 #if defined(HAVE_OPENSSL) || defined(HAVE_MBEDTLS)
 #define HAVE_TLS 1
 #endif
@@ -36,4 +48,11 @@ mk_socket_t *mk_socket_tcp_wrap(int fd);
 mk_socket_t *mk_socket_tls_connect(const char *host, uint16_t port);
 #endif
 
+#ifdef HAVE_OPENSSL
+/* TLS over an already-connected fd, verified against host; takes the
+   fd, closing it on failure.  The handshake blocks.  (esp-tls only
+   connects by name, so the ESP32 build has no equivalent.) */
+mk_socket_t *mk_socket_tls_wrap(int fd, const char *host);
+#endif
+
 #endif /* MICROKERNEL_MK_SOCKET_H */
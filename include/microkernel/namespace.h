@@ -12,6 +12,9 @@
 #define MSG_NS_UMOUNT     ((msg_type_t)0xFF000018)
 #define MSG_NS_REPLY      ((msg_type_t)0xFF000019)
 #define MSG_NS_NOTIFY     ((msg_type_t)0xFF00001A)
+#define MSG_NS_SUBSCRIBE  ((msg_type_t)0xFF0000A9)
+#define MSG_NS_UNSUBSCRIBE ((msg_type_t)0xFF0000AA)
+#define MSG_NS_FLUSH      ((msg_type_t)0xFF0000AB)  /* internal */
 
 #define NS_PATH_MAX 128
 
@@ -39,6 +42,15 @@ typedef struct {
     char mount_point[NS_PATH_MAX];
 } ns_umount_t;
 
+/* MSG_NS_SUBSCRIBE / MSG_NS_UNSUBSCRIBE: the sender is the subscriber.
+   prefix is a plain string prefix ("" = every path and mount). */
+#define NS_SUB_SNAPSHOT 0x01   /* first batch replays what exists now */
+
+typedef struct {
+    char     prefix[NS_PATH_MAX];
+    uint32_t flags;            /* NS_SUB_*; ignored on unsubscribe */
+} ns_subscribe_t;
+
 /* ── Reply payload ─────────────────────────────────────────────────── */
 
 #define NS_OK       0
@@ -56,12 +68,22 @@ typedef struct {
     char       data[NS_REPLY_PAYLOAD_MAX];
 } ns_reply_t;
 
-/* ── Notify payload (future: change notifications) ─────────────────── */
+/* ── Notify payload ────────────────────────────────────────────────── */
+
+/* MSG_NS_NOTIFY carries an array of ns_notify_t (payload_size / sizeof),
+   in the order the changes happened.  Changes made before the namespace
+   actor next runs are batched into one message per subscriber. */
+#define NS_EVENT_REGISTER   1
+#define NS_EVENT_UNREGISTER 2
+#define NS_EVENT_MOUNT      3   /* actor_id is the mount target */
+#define NS_EVENT_UMOUNT     4
+
+#define NS_NOTIFY_BATCH_MAX 32
 
 typedef struct {
     char       path[NS_PATH_MAX];
     actor_id_t actor_id;
-    int32_t    event;      /* register=1, unregister=2 */
+    int32_t    event;      /* NS_EVENT_* */
 } ns_notify_t;
 
 /* ── API ───────────────────────────────────────────────────────────── */
@@ -86,6 +108,14 @@ size_t     ns_reverse_lookup_all_paths(runtime_t *rt, actor_id_t id,
                                        char *buf, size_t buf_size,
                                        size_t *offset);
 
+/* Subscribe the calling actor to changes under prefix at the namespace
+   actor ns (ACTOR_ID_INVALID = this node's).  The result arrives as an
+   MSG_NS_REPLY, then changes as MSG_NS_NOTIFY batches.  Subscriptions
+   end when the subscriber exits. */
+bool ns_subscribe(runtime_t *rt, actor_id_t ns, const char *prefix,
+                  uint32_t flags);
+bool ns_unsubscribe(runtime_t *rt, actor_id_t ns, const char *prefix);
+
 /* Synchronous call to namespace actor (waiter actor pattern).
    Caller provides MSG_NS_* type + payload, gets ns_reply_t back.
    Only safe from outside the scheduler (init code, tests). */
@@ -102,15 +132,21 @@ const char *mk_node_identity(void);
    Returns bytes written. */
 size_t ns_list_paths(runtime_t *rt, const char *prefix, char *buf, size_t buf_size);
 
-/* Stable node ID derived from identity.
-   Linux: MK_NODE_ID env var or hash of identity -> [1,15].
-   ESP32: hash of identity -> [1,15]. */
+/* Stable 32-bit node ID (never 0).
+   Linux: MK_NODE_ID env var, else a hash of MK_NODE_NAME or the hostname.
+   ESP32: hash of the full efuse MAC.
+   Mounts refuse a peer whose ID is already held by a different node. */
 node_id_t mk_node_id(void);
 
 /* Remove a specific path by name (for remote unregister). */
 void ns_remove_path(runtime_t *rt, const char *path);
 
-/* Sync all local names + paths to a single transport. */
+/* Remove every path owned by an actor on node (it became unreachable). */
+void ns_purge_node_paths(runtime_t *rt, node_id_t node);
+
+/* Sync all local names + paths to a single transport, one message per
+   binding.  Mounts use it for peers without MOUNT_FEATURE_REGISTRY_SYNC;
+   the rest exchange digests and only send what differs. */
 struct transport;
 void ns_sync_to_transport(runtime_t *rt, struct transport *tp);
 
@@ -132,12 +168,24 @@ actor_id_t caps_actor_init(runtime_t *rt);
 
 #define MK_MOUNT_PORT 4200
 
-/* Mount hello (exchanged over raw TCP before transport creation) */
+/* Mount hello (exchanged over raw TCP before transport creation).
+   v1 peers send a 32-byte identity and zero-fill the tail; the last four
+   bytes now carry the highest wire version the sender speaks.  Both sides
+   switch to min(local, peer) once the hellos are exchanged.  Feature
+   bits are only honoured once both sides speak v2. */
 #define MOUNT_HELLO_MAGIC 0x4D4B3031  /* "MK01" */
+#define MOUNT_FEATURE_COMPRESS 0x01   /* accepts compressed v2 payloads */
+#define MOUNT_FEATURE_REGISTRY_SYNC 0x02  /* MSG_REGISTRY_DIGEST / _DELTA */
 typedef struct __attribute__((packed)) {
     uint32_t magic;        /* MOUNT_HELLO_MAGIC, network byte order */
     uint32_t node_id;      /* network byte order */
-    char     identity[32]; /* null-terminated */
+    char     identity[28]; /* null-terminated */
+    uint8_t  wire_version; /* WIRE_VERSION_*; 0 from v1 peers */
+    uint8_t  features;     /* MOUNT_FEATURE_* */
+    uint8_t  reserved[2];
 } mount_hello_t;
 
+_Static_assert(sizeof(mount_hello_t) == 40,
+               "mount_hello_t must stay 40 bytes for v1 peers");
+
 #endif /* MICROKERNEL_NAMESPACE_H */
@@ -19,12 +19,48 @@ void       actor_stop(runtime_t *rt, actor_id_t id);
 bool actor_send(runtime_t *rt, actor_id_t dest, msg_type_t type,
                 const void *payload, size_t payload_size);
 
+/* Messages an actor may still send to dest before actor_send refuses
+   for lack of flow-control credit.  UINT32_MAX for local or unlimited
+   destinations; 0 means the caller will get MSG_SEND_READY once the
+   remote actor catches up. */
+uint32_t actor_send_credit(runtime_t *rt, actor_id_t dest);
+
 /* Helpers for use inside behavior functions */
 actor_id_t actor_self(runtime_t *rt);
 void      *actor_state(runtime_t *rt);
 
-/* Transport */
+/* Transport — one per peer node, keyed by transport->peer_node.  Adding
+   a transport for an already attached node replaces (and destroys) the
+   old one.  Remove detaches and destroys it. */
 bool runtime_add_transport(runtime_t *rt, transport_t *transport);
+bool runtime_remove_transport(runtime_t *rt, node_id_t peer_node);
+
+/* Path to a node: direct peers report themselves at metric 1, nodes
+   behind a gateway report the neighbour to send through and the hop
+   count.  False if the node is unreachable. */
+bool runtime_get_route(runtime_t *rt, node_id_t node, node_id_t *next_hop,
+                       uint32_t *metric);
+
+/* Peer failure detection.  Every interval_ms each peer is sent a
+   heartbeat; a peer that has been silent for timeout_ms, or whose link
+   closed, is removed.  Defaults: 1000 / 5000 ms.  interval_ms = 0 turns
+   heartbeats and the silence check off (closed links are still noticed). */
+void runtime_set_heartbeat(runtime_t *rt, uint32_t interval_ms,
+                           uint32_t timeout_ms);
+
+/* Flow control: at most `window` messages sent by this node's actors may
+   be unconsumed at any one remote actor.  Off (0) by default: a full
+   remote mailbox then drops what it cannot hold.  Turn it on only
+   towards peers that return credit, or senders stall until the window
+   is reopened. */
+void runtime_set_flow_window(runtime_t *rt, uint32_t window);
+
+/* Global names, by default replicated to every node, are instead kept by
+   one owner per name, chosen on a consistent-hash ring of the reachable
+   nodes.  Each node then holds its own names, the names it owns and a
+   bounded cache of answers (see actor_resolve_name).  Paths stay
+   replicated.  Set on every node of a cluster, before attaching peers. */
+void runtime_set_registry_partitioned(runtime_t *rt, bool on);
 
 /* Introspection */
 size_t runtime_list_actors(runtime_t *rt, actor_id_t *buf, size_t max_count);
@@ -137,6 +137,37 @@
 #define MSG_SEQ_STATUS         ((msg_type_t)0xFF000092)
 #define MSG_SEQ_POSITION       ((msg_type_t)0xFF000093)
 
+/* Node liveness */
+#define MSG_HEARTBEAT          ((msg_type_t)0xFF0000A0)   /* node-to-node */
+#define MSG_NODE_DOWN          ((msg_type_t)0xFF0000A1)
+#define MSG_NODE_UP            ((msg_type_t)0xFF0000A2)
+
+/* Flow control */
+#define MSG_FLOW_CREDIT        ((msg_type_t)0xFF0000A3)   /* node-to-node */
+#define MSG_SEND_READY         ((msg_type_t)0xFF0000A4)
+#define MSG_FLOW_METER         ((msg_type_t)0xFF0000B4)   /* node-to-node */
+
+/* Monitors (see supervision.h) */
+#define MSG_MONITOR            ((msg_type_t)0xFF0000A5)   /* node-to-node */
+#define MSG_DEMONITOR          ((msg_type_t)0xFF0000A6)   /* node-to-node */
+#define MSG_ACTOR_EXIT         ((msg_type_t)0xFF0000A7)   /* node-to-node */
+#define MSG_DOWN               ((msg_type_t)0xFF0000A8)
+
+/* Registry replication (see src/registry_sync.h) */
+#define MSG_REGISTRY_DELTA     ((msg_type_t)0xFF0000AC)   /* node-to-node */
+#define MSG_REGISTRY_DIGEST    ((msg_type_t)0xFF0000AD)   /* node-to-node */
+#define MSG_NAME_QUERY         ((msg_type_t)0xFF0000AE)   /* node-to-node */
+#define MSG_NAME_RESOLVED      ((msg_type_t)0xFF0000AF)
+
+/* Streamed HTTP bodies (actor_http_fetch_stream, actor_http_listen_stream,
+   actor_http_write_chunk) */
+#define MSG_HTTP_RESPONSE_HEAD ((msg_type_t)0xFF0000B0)
+#define MSG_HTTP_BODY_CHUNK    ((msg_type_t)0xFF0000B1)
+#define MSG_HTTP_WRITE_READY   ((msg_type_t)0xFF0000B2)
+
+/* Multi-hop routing: distance-vector adverts between nodes */
+#define MSG_ROUTE_ADVERT       ((msg_type_t)0xFF0000B3)   /* node-to-node */
+
 /* ── Timer payload ─────────────────────────────────────────────────── */
 
 typedef struct {
@@ -174,6 +205,26 @@ bool       actor_cancel_timer(runtime_t *rt, timer_id_t id);
 bool actor_watch_fd(runtime_t *rt, int fd, uint32_t events);
 bool actor_unwatch_fd(runtime_t *rt, int fd);
 
+/* ── Node liveness ─────────────────────────────────────────────────── */
+
+/* Payload of MSG_NODE_DOWN / MSG_NODE_UP */
+typedef struct {
+    node_id_t node_id;
+} node_event_payload_t;
+
+/* Subscribe the calling actor to MSG_NODE_DOWN / MSG_NODE_UP, sent when a
+   node stops or starts being reachable (directly or through a route). */
+bool actor_watch_nodes(runtime_t *rt);
+bool actor_unwatch_nodes(runtime_t *rt);
+
+/* ── Flow control ──────────────────────────────────────────────────── */
+
+/* Payload of MSG_SEND_READY: the remote actor an earlier actor_send to
+   was refused for lack of credit can take messages again */
+typedef struct {
+    actor_id_t dest;
+} send_ready_payload_t;
+
 /* ── Cross-node registry payloads ──────────────────────────────────── */
 
 typedef struct {
@@ -200,10 +251,37 @@ typedef struct {
 bool       actor_register_name(runtime_t *rt, const char *name, actor_id_t id);
 actor_id_t actor_lookup(runtime_t *rt, const char *name);
 
+/* Ask for a name's binding; the answer arrives as MSG_NAME_RESOLVED
+   (name_register_payload_t, actor_id ACTOR_ID_INVALID if unbound).  With
+   a partitioned registry a name bound elsewhere is fetched from its
+   owner and cached, so actor_lookup() finds it afterwards; otherwise
+   the answer comes from the local registry.  Call from a behavior.
+   False if the owner cannot be reached. */
+bool       actor_resolve_name(runtime_t *rt, const char *name);
+
 /* Send message by name — lookup + send in one call */
 bool actor_send_named(runtime_t *rt, const char *name, msg_type_t type,
                       const void *payload, size_t payload_size);
 
+/* Name handles: a name resolved once and cached until any name, path or
+   mount binding changes (the registry epoch moves on), after which the
+   next use resolves it again.  A send through a valid handle costs one
+   comparison instead of a hash or path walk.  Names that do not resolve
+   are cached too, so the handle can be made before the target exists. */
+typedef struct {
+    char       name[128];   /* NS_PATH_MAX */
+    actor_id_t id;          /* ACTOR_ID_INVALID if it did not resolve */
+    uint64_t   epoch;       /* registry epoch id was resolved at */
+} actor_name_handle_t;
+
+actor_name_handle_t actor_name_resolve(runtime_t *rt, const char *name);
+
+/* Current binding, re-resolved if the handle is stale */
+actor_id_t actor_name_handle_id(runtime_t *rt, actor_name_handle_t *h);
+
+bool actor_send_handle(runtime_t *rt, actor_name_handle_t *h, msg_type_t type,
+                       const void *payload, size_t payload_size);
+
 /* Reverse lookup: find first name for actor ID (flat registry + namespace paths).
    Returns name length (0 if not found). */
 size_t actor_reverse_lookup(runtime_t *rt, actor_id_t id,
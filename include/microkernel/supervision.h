@@ -4,8 +4,10 @@
 #include "types.h"
 
 /* Exit reasons */
-#define EXIT_NORMAL  0   /* behavior returned false */
-#define EXIT_KILLED  1   /* actor_stop() called */
+#define EXIT_NORMAL   0   /* behavior returned false */
+#define EXIT_KILLED   1   /* actor_stop() called */
+#define EXIT_NOPROC   2   /* MSG_DOWN: the actor did not exist */
+#define EXIT_NODEDOWN 3   /* MSG_DOWN: its node became unreachable */
 
 /* Restart types (per-child policy) */
 typedef enum {
@@ -41,6 +43,22 @@ typedef struct {
     uint8_t    exit_reason;
 } child_exit_payload_t;
 
+/* MSG_DOWN payload */
+typedef struct {
+    uint32_t   ref;           /* as returned by actor_monitor */
+    actor_id_t actor;
+    uint8_t    exit_reason;   /* EXIT_* */
+} down_payload_t;
+
+/* Monitor an actor on this or any reachable node.  The calling actor
+   gets one MSG_DOWN when the target exits, does not exist, or its node
+   becomes unreachable.  Returns a reference (0 if not called from an
+   actor or out of memory). */
+uint32_t actor_monitor(runtime_t *rt, actor_id_t target);
+
+/* Cancel a monitor of the calling actor; no MSG_DOWN follows */
+bool actor_demonitor(runtime_t *rt, uint32_t ref);
+
 /* Spawn a supervisor that manages children per the given specs */
 actor_id_t supervisor_start(runtime_t *rt,
                             restart_strategy_t strategy,
@@ -13,6 +13,7 @@ struct transport {
     message_t *(*recv)(transport_t *self);
     bool     (*is_connected)(transport_t *self);
     void     (*destroy)(transport_t *self);
+    bool     (*flush)(transport_t *self);  /* push batched sends; may be NULL */
     void      *impl;            /* transport-specific state */
 };
 
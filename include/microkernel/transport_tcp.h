@@ -16,4 +16,13 @@ transport_t *transport_tcp_connect(const char *host, uint16_t port,
 /* Wrap an already-connected TCP fd as a transport. */
 transport_t *transport_tcp_from_fd(int fd, node_id_t peer_node);
 
+/* Select the wire framing (WIRE_VERSION_1 or WIRE_VERSION_2).
+   New transports default to v1; ns_mount_* switch to the version
+   negotiated in the mount hello. Set before any traffic flows. */
+void transport_tcp_set_wire_version(transport_t *tp, uint8_t version);
+
+/* Compress outgoing payloads of at least min_size bytes (0 disables).
+   Only applies to v2 framing; enable it only if the peer negotiated it. */
+void transport_tcp_set_compression(transport_t *tp, size_t min_size);
+
 #endif /* MICROKERNEL_TRANSPORT_TCP_H */
@@ -3,6 +3,27 @@
 
 #include "transport.h"
 
+/* Largest datagram sent; bigger messages are fragmented to this size */
+#ifndef UDP_FRAG_MTU
+#define UDP_FRAG_MTU 1472
+#endif
+
+/* Datagrams per sendmmsg/recvmmsg call */
+#ifndef UDP_BATCH_MAX
+#define UDP_BATCH_MAX 64
+#endif
+
+/* Largest message accepted for fragmentation/reassembly */
+#ifndef UDP_MAX_MESSAGE
+#define UDP_MAX_MESSAGE (16u * 1024 * 1024)
+#endif
+
+/* Reliable mode: datagrams in flight or queued per transport.  Also caps
+   reliable messages at about UDP_REL_WINDOW * 1.4 KB. */
+#ifndef UDP_REL_WINDOW
+#define UDP_REL_WINDOW 1024
+#endif
+
 /* Create a bound (server-side) UDP transport on host:port.
    Binds immediately. Learns peer from first recvfrom, then connect()s to lock in. */
 transport_t *transport_udp_bind(const char *host, uint16_t port,
@@ -13,4 +34,39 @@ transport_t *transport_udp_bind(const char *host, uint16_t port,
 transport_t *transport_udp_connect(const char *host, uint16_t port,
                                     node_id_t peer_node);
 
+/* Queue up to max_batch datagrams before sending them in one sendmmsg
+   (clamped to UDP_BATCH_MAX). Default 1 sends immediately. Queued
+   datagrams also go out on tp->flush(), which the runtime calls before
+   every poll. */
+void transport_udp_set_batch(transport_t *tp, size_t max_batch);
+
+/* Reliable delivery (opt-in; both ends must use the same setting).
+   Sequence numbers, selective ACKs, retransmission timers and a
+   congestion window.  ORDERED delivers messages in send order;
+   UNORDERED delivers each exactly once as soon as it arrives.  send()
+   returns false when the retransmit window is full.  Timers advance on
+   recv() and flush(), which the runtime drives from its poll loop.
+   Set before traffic flows. */
+typedef enum {
+    UDP_RELIABLE_OFF = 0,
+    UDP_RELIABLE_ORDERED = 1,
+    UDP_RELIABLE_UNORDERED = 2
+} udp_reliable_mode_t;
+
+bool transport_udp_set_reliable(transport_t *tp, udp_reliable_mode_t mode);
+
+typedef struct {
+    uint64_t sent;          /* datagrams transmitted, including resends */
+    uint64_t retransmits;
+    uint64_t acks_sent;
+    uint64_t dup_received;
+    uint32_t in_flight;
+    uint32_t cwnd;          /* congestion window, datagrams */
+    uint32_t srtt_ms;
+    uint32_t rto_ms;
+} udp_rel_stats_t;
+
+/* Reliable-mode counters; false if reliability is off */
+bool transport_udp_get_stats(transport_t *tp, udp_rel_stats_t *out);
+
 #endif /* MICROKERNEL_TRANSPORT_UDP_H */
@@ -45,4 +45,75 @@ message_t *wire_deserialize(const void *buf, size_t buf_size);
 void *wire_serialize_net(const message_t *msg, size_t *out_size);
 message_t *wire_deserialize_net(const void *buf, size_t buf_size);
 
+/* Header-only helpers for transports that frame into their own buffers.
+   wire_header_to_net writes msg's header (reserved = 0) to out;
+   wire_header_from_net decodes a network-order header to host order. */
+void wire_header_to_net(const message_t *msg, void *out);
+void wire_header_from_net(const void *buf, wire_header_t *hdr);
+
+/*
+ * Compact v2 framing (negotiated per peer in the mount hello).
+ * Variable-length header, all integers unsigned LEB128 varints:
+ *
+ * Field          Encoding
+ * flags          1 byte (WIRE_FLAG_*)
+ * payload_size   varint
+ * type           varint (low 24 bits only if WIRE_FLAG_SYS_TYPE)
+ * source         varint node + varint seq
+ * dest           varint node + varint seq
+ * trace_id       varint, present only if WIRE_FLAG_TRACE
+ * raw_size       varint, present only if WIRE_FLAG_COMPRESSED
+ * payload        payload_size bytes (LZ block if WIRE_FLAG_COMPRESSED)
+ *
+ * A typical MIDI event or timer ping costs 7 header bytes instead of 28.
+ */
+
+#define WIRE_VERSION_1   1
+#define WIRE_VERSION_2   2
+#define WIRE_VERSION_MAX WIRE_VERSION_2
+
+#define WIRE_FLAG_COMPRESSED 0x01  /* payload is compressed */
+#define WIRE_FLAG_TRACE      0x02  /* trace_id follows the header */
+#define WIRE_FLAG_SYS_TYPE   0x04  /* type is 0xFFxxxxxx, low 24 bits sent */
+#define WIRE_FLAGS_KNOWN     0x07
+
+#define WIRE_V2_MIN_HEADER 7
+#define WIRE_V2_MAX_HEADER 46
+
+/* Default payload size at which compression is attempted */
+#ifndef WIRE_COMPRESS_THRESHOLD
+#define WIRE_COMPRESS_THRESHOLD 1024
+#endif
+
+typedef struct {
+    uint8_t    flags;         /* WIRE_FLAG_* (SYS_TYPE is set automatically) */
+    actor_id_t source;
+    actor_id_t dest;
+    msg_type_t type;
+    uint32_t   payload_size;
+    uint64_t   trace_id;      /* meaningful only with WIRE_FLAG_TRACE */
+    uint32_t   raw_size;      /* uncompressed size, with WIRE_FLAG_COMPRESSED */
+} wire_v2_header_t;
+
+/* Encode a v2 header into out (at least WIRE_V2_MAX_HEADER bytes).
+   Returns the number of bytes written. */
+size_t wire_v2_encode_header(const wire_v2_header_t *hdr, uint8_t *out);
+
+/* Decode a v2 header from the front of buf.
+   Returns header length on success, 0 if more bytes are needed,
+   -1 if the header is malformed or uses unknown flags. */
+int wire_v2_decode_header(const void *buf, size_t buf_size,
+                          wire_v2_header_t *hdr);
+
+/* Same semantics as wire_serialize_net/wire_deserialize_net, v2 framing.
+   wire_deserialize_v2 transparently inflates WIRE_FLAG_COMPRESSED frames. */
+void *wire_serialize_v2(const message_t *msg, size_t *out_size);
+message_t *wire_deserialize_v2(const void *buf, size_t buf_size);
+
+/* Like wire_serialize_v2, but compresses payloads of at least min_size
+   bytes when that makes the frame smaller.  Only use towards peers that
+   negotiated compression. */
+void *wire_serialize_v2_compressed(const message_t *msg, size_t min_size,
+                                   size_t *out_size);
+
 #endif /* MICROKERNEL_WIRE_H */
@@ -514,6 +514,16 @@ static bool cf_proxy_behavior(runtime_t *rt, actor_t *self,
         schedule_reconnect(s, rt);
         return true;
 
+    case MSG_HTTP_ERROR: {
+        /* The WS never opened: lookup, connect or TLS failed */
+        const http_error_payload_t *p = msg->payload;
+        if (p->conn_id != s->ws_conn) return true;
+        CF_LOG("WS connect failed: %s", p->message);
+        s->ws_conn = HTTP_CONN_ID_INVALID;
+        schedule_reconnect(s, rt);
+        return true;
+    }
+
     case MSG_TIMER:
         /* Reconnect */
         if (!s->connected && s->config.url[0]) {
@@ -29,6 +29,7 @@ typedef struct {
     int params[8];
     int nparam;
     uint16_t palette[16];       /* ANSI 16-color → RGB565 */
+    actor_name_handle_t display; /* /node/hardware/display, one send per row */
 } console_state_t;
 
 /* File-static pointer for test helpers (Linux only) */
@@ -299,8 +300,8 @@ static void flush_dirty(runtime_t *rt, console_state_t *cs) {
             p->cells[c].bg = CELL(cs, row, c).bg;
         }
 
-        actor_send_named(rt, "/node/hardware/display",
-                         MSG_DISPLAY_TEXT_ATTR, buf, payload_size);
+        actor_send_handle(rt, &cs->display,
+                          MSG_DISPLAY_TEXT_ATTR, buf, payload_size);
     }
 
     cs->dirty = 0;
@@ -374,6 +375,7 @@ actor_id_t mk_console_actor_init(runtime_t *rt) {
         return ACTOR_ID_INVALID;
     }
 
+    cs->display = actor_name_resolve(rt, "/node/hardware/display");
     init_palette(cs->palette);
     cs->cur_fg = cs->palette[DEFAULT_FG_IDX];
     cs->cur_bg = cs->palette[DEFAULT_BG_IDX];
@@ -0,0 +1,287 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "dns_resolver.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <netdb.h>
+#ifdef ESP_PLATFORM
+#include <esp_vfs_eventfd.h>    /* registered at boot for timers */
+#else
+#include <sys/eventfd.h>
+#endif
+
+#define ENTRY_EMPTY   0
+#define ENTRY_PENDING 1         /* queued or in getaddrinfo() */
+#define ENTRY_OK      2
+#define ENTRY_FAILED  3
+
+typedef struct {
+    char         host[DNS_HOST_MAX];
+    uint8_t      state;         /* ENTRY_* */
+    uint64_t     expires_ms;
+    uint64_t     used_ms;       /* least recently used goes first */
+    dns_result_t result;        /* ports unset */
+} dns_entry_t;
+
+typedef struct dns_job {
+    struct dns_job *next;
+    char            host[DNS_HOST_MAX];
+    bool            ok;
+    dns_result_t    result;
+} dns_job_t;
+
+struct dns_resolver {
+    dns_entry_t    *cache;
+    size_t          cache_size;
+    uint32_t        ttl_ms;
+    uint32_t        negative_ttl_ms;
+    size_t          inflight;   /* queued, not yet collected */
+    int             wake_fd;    /* eventfd, written per finished job */
+
+    /* Shared with the thread */
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    pthread_t       thread;
+    bool            started;
+    bool            stop;
+    dns_job_t      *queue;      /* FIFO: head, tail */
+    dns_job_t      *queue_tail;
+    dns_job_t      *done;
+};
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* Up to DNS_MAX_ADDRS stream addresses of host; false if none */
+static bool resolve(const char *host, int flags, dns_result_t *out) {
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+
+    out->count = 0;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0) return false;
+    for (struct addrinfo *ai = res; ai && out->count < DNS_MAX_ADDRS;
+         ai = ai->ai_next) {
+        if (ai->ai_addrlen > sizeof(out->addrs[0].addr)) continue;
+        dns_addr_t *a = &out->addrs[out->count++];
+        memcpy(&a->addr, ai->ai_addr, ai->ai_addrlen);
+        a->len = ai->ai_addrlen;
+    }
+    freeaddrinfo(res);
+    return out->count > 0;
+}
+
+static void set_port(dns_result_t *r, uint16_t port) {
+    for (size_t i = 0; i < r->count; i++) {
+        if (r->addrs[i].addr.sa.sa_family == AF_INET6)
+            r->addrs[i].addr.in6.sin6_port = htons(port);
+        else
+            r->addrs[i].addr.in.sin_port = htons(port);
+    }
+}
+
+/* ── Resolver thread ───────────────────────────────────────────────── */
+
+static void *resolver_main(void *arg) {
+    dns_resolver_t *r = arg;
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        while (!r->queue && !r->stop)
+            pthread_cond_wait(&r->cond, &r->lock);
+        if (r->stop) break;
+        dns_job_t *job = r->queue;
+        r->queue = job->next;
+        if (!r->queue) r->queue_tail = NULL;
+        pthread_mutex_unlock(&r->lock);
+
+        job->ok = resolve(job->host, 0, &job->result);
+
+        pthread_mutex_lock(&r->lock);
+        job->next = r->done;
+        r->done = job;
+        uint64_t one = 1;
+        (void)write(r->wake_fd, &one, sizeof(one));
+    }
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+static bool start_thread(dns_resolver_t *r) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+#ifdef ESP_PLATFORM
+    pthread_attr_setstacksize(&attr, 4096);
+#endif
+    r->started = pthread_create(&r->thread, &attr, resolver_main, r) == 0;
+    pthread_attr_destroy(&attr);
+    return r->started;
+}
+
+/* ── Public API ────────────────────────────────────────────────────── */
+
+dns_resolver_t *dns_resolver_create(size_t cache_size, uint32_t ttl_ms,
+                                    uint32_t negative_ttl_ms) {
+    dns_resolver_t *r = calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    r->cache = calloc(cache_size ? cache_size : 1, sizeof(dns_entry_t));
+#ifdef ESP_PLATFORM
+    /* ESP-IDF's eventfd takes no flags */
+    r->wake_fd = eventfd(0, 0);
+    if (r->wake_fd >= 0) {
+        int flags = fcntl(r->wake_fd, F_GETFL, 0);
+        if (flags >= 0) fcntl(r->wake_fd, F_SETFL, flags | O_NONBLOCK);
+    }
+#else
+    r->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    if (!r->cache || r->wake_fd < 0) {
+        if (r->wake_fd >= 0) close(r->wake_fd);
+        free(r->cache);
+        free(r);
+        return NULL;
+    }
+    r->cache_size = cache_size ? cache_size : 1;
+    r->ttl_ms = ttl_ms;
+    r->negative_ttl_ms = negative_ttl_ms;
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->cond, NULL);
+    return r;
+}
+
+static void free_jobs(dns_job_t *job) {
+    while (job) {
+        dns_job_t *next = job->next;
+        free(job);
+        job = next;
+    }
+}
+
+void dns_resolver_destroy(dns_resolver_t *r) {
+    if (!r) return;
+    if (r->started) {
+        pthread_mutex_lock(&r->lock);
+        r->stop = true;
+        pthread_cond_signal(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+        pthread_join(r->thread, NULL);
+    }
+    free_jobs(r->queue);
+    free_jobs(r->done);
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+    close(r->wake_fd);
+    free(r->cache);
+    free(r);
+}
+
+static dns_entry_t *find_entry(dns_resolver_t *r, const char *host) {
+    for (size_t i = 0; i < r->cache_size; i++) {
+        dns_entry_t *e = &r->cache[i];
+        if (e->state != ENTRY_EMPTY && strcmp(e->host, host) == 0) return e;
+    }
+    return NULL;
+}
+
+/* A free slot, else the least recently used answer; never a lookup in
+   flight */
+static dns_entry_t *evict_entry(dns_resolver_t *r) {
+    dns_entry_t *victim = NULL;
+    for (size_t i = 0; i < r->cache_size; i++) {
+        dns_entry_t *e = &r->cache[i];
+        if (e->state == ENTRY_EMPTY) return e;
+        if (e->state != ENTRY_PENDING &&
+            (!victim || e->used_ms < victim->used_ms))
+            victim = e;
+    }
+    return victim;
+}
+
+dns_status_t dns_lookup(dns_resolver_t *r, const char *host, uint16_t port,
+                        dns_result_t *out) {
+    if (!r || !host[0] || strlen(host) >= DNS_HOST_MAX) return DNS_FAILED;
+
+    /* An address literal needs no lookup */
+    if (resolve(host, AI_NUMERICHOST, out)) {
+        set_port(out, port);
+        return DNS_DONE;
+    }
+
+    uint64_t now = now_ms();
+    dns_entry_t *e = find_entry(r, host);
+    if (e && e->state == ENTRY_PENDING) return DNS_PENDING;
+    if (e && now < e->expires_ms) {
+        e->used_ms = now;
+        if (e->state == ENTRY_FAILED) return DNS_FAILED;
+        *out = e->result;
+        set_port(out, port);
+        return DNS_DONE;
+    }
+
+    /* Missing or expired: ask the thread */
+    if (!e) e = evict_entry(r);
+    /* Every slot has a lookup in flight.  One of them frees a slot when
+       it's collected, and the caller asks again then. */
+    if (!e) return DNS_PENDING;
+    dns_job_t *job = calloc(1, sizeof(*job));
+    if (!job) return DNS_FAILED;
+    snprintf(job->host, sizeof(job->host), "%s", host);
+
+    pthread_mutex_lock(&r->lock);
+    if (!r->started && !start_thread(r)) {
+        pthread_mutex_unlock(&r->lock);
+        free(job);
+        return DNS_FAILED;
+    }
+    if (r->queue_tail) r->queue_tail->next = job;
+    else r->queue = job;
+    r->queue_tail = job;
+    pthread_cond_signal(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+
+    snprintf(e->host, sizeof(e->host), "%s", host);
+    e->state = ENTRY_PENDING;
+    e->used_ms = now;
+    r->inflight++;
+    return DNS_PENDING;
+}
+
+int dns_resolver_fd(const dns_resolver_t *r) {
+    return r && r->inflight > 0 ? r->wake_fd : -1;
+}
+
+bool dns_collect(dns_resolver_t *r) {
+    uint64_t count;
+    (void)read(r->wake_fd, &count, sizeof(count));
+
+    pthread_mutex_lock(&r->lock);
+    dns_job_t *done = r->done;
+    r->done = NULL;
+    pthread_mutex_unlock(&r->lock);
+
+    bool any = done != NULL;
+    uint64_t now = now_ms();
+    while (done) {
+        dns_job_t *job = done;
+        done = job->next;
+        r->inflight--;
+        dns_entry_t *e = find_entry(r, job->host);
+        if (e && e->state == ENTRY_PENDING) {
+            e->state = job->ok ? ENTRY_OK : ENTRY_FAILED;
+            e->result = job->result;
+            e->expires_ms = now + (job->ok ? r->ttl_ms : r->negative_ttl_ms);
+        }
+        free(job);
+    }
+    return any;
+}
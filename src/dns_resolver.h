@@ -0,0 +1,65 @@
+#ifndef DNS_RESOLVER_H
+#define DNS_RESOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+/* Host name lookups off the event loop: getaddrinfo() runs on a resolver
+   thread, and answers are cached per host.  getaddrinfo() reports no
+   record TTLs, so an answer lives for a fixed ttl_ms and a failure for
+   negative_ttl_ms. */
+
+#ifndef DNS_MAX_ADDRS
+#define DNS_MAX_ADDRS 4              /* addresses kept per host */
+#endif
+#define DNS_HOST_MAX 256
+
+typedef struct {
+    union {
+        struct sockaddr     sa;
+        struct sockaddr_in  in;
+        struct sockaddr_in6 in6;
+    } addr;
+    socklen_t len;
+} dns_addr_t;
+
+/* Addresses in getaddrinfo() order, each with the port asked for */
+typedef struct {
+    dns_addr_t addrs[DNS_MAX_ADDRS];
+    size_t     count;
+} dns_result_t;
+
+typedef enum {
+    DNS_DONE,       /* *out filled */
+    DNS_PENDING,    /* ask again once dns_collect() reports progress */
+    DNS_FAILED      /* no such host (or it failed within negative_ttl_ms) */
+} dns_status_t;
+
+typedef struct dns_resolver dns_resolver_t;
+
+/* The thread starts on the first lookup that misses the cache.
+   Returns NULL on allocation failure. */
+dns_resolver_t *dns_resolver_create(size_t cache_size, uint32_t ttl_ms,
+                                    uint32_t negative_ttl_ms);
+
+/* Waits for a lookup still in getaddrinfo() to return */
+void dns_resolver_destroy(dns_resolver_t *r);
+
+/* Numeric hosts and fresh cache entries answer at once; anything else
+   is queued for the thread (one lookup per host however many ask).
+   While every cache slot has a lookup in flight a new host isn't queued,
+   just reported DNS_PENDING until a dns_collect() frees a slot. */
+dns_status_t dns_lookup(dns_resolver_t *r, const char *host, uint16_t port,
+                        dns_result_t *out);
+
+/* Polls readable when a queued lookup has finished; -1 while none is
+   queued */
+int dns_resolver_fd(const dns_resolver_t *r);
+
+/* Move finished lookups into the cache.  Returns true if any did. */
+bool dns_collect(dns_resolver_t *r);
+
+#endif /* DNS_RESOLVER_H */
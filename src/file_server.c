@@ -0,0 +1,339 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "microkernel/file_server.h"
+#include "microkernel/runtime.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/http.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* ── Constants ────────────────────────────────────────────────────── */
+
+#ifndef FILE_SERVER_FD_CACHE
+#define FILE_SERVER_FD_CACHE 16      /* open files kept between requests */
+#endif
+#define FS_MAX_PATH 256
+#define FS_ETAG_MAX 48
+
+/* ── Actor state ──────────────────────────────────────────────────── */
+
+/* An open file, valid while stat() still shows the same inode, size and
+   mtime at its path */
+typedef struct {
+    char     path[FS_MAX_PATH];   /* "" = free */
+    int      fd;
+    ino_t    ino;
+    off_t    size;
+    time_t   mtime;
+    char     etag[FS_ETAG_MAX];
+    uint64_t used;                /* LRU tick */
+} fd_entry_t;
+
+typedef struct {
+    uint16_t   port;
+    char       root[128];
+    fd_entry_t cache[FILE_SERVER_FD_CACHE];
+    uint64_t   tick;
+} file_server_state_t;
+
+static void file_server_state_free(void *state) {
+    file_server_state_t *s = state;
+    for (size_t i = 0; i < FILE_SERVER_FD_CACHE; i++)
+        if (s->cache[i].path[0]) close(s->cache[i].fd);
+    free(s);
+}
+
+/* ── fd cache ─────────────────────────────────────────────────────── */
+
+static bool entry_current(const fd_entry_t *e, const struct stat *st) {
+    return e->ino == st->st_ino && e->size == st->st_size &&
+           e->mtime == st->st_mtime;
+}
+
+/* Open file for path, reusing the cached fd if the file is unchanged;
+   NULL if it can't be opened */
+static fd_entry_t *fd_cache_open(file_server_state_t *s, const char *path,
+                                 const struct stat *st) {
+    fd_entry_t *slot = NULL;
+    for (size_t i = 0; i < FILE_SERVER_FD_CACHE; i++) {
+        fd_entry_t *e = &s->cache[i];
+        if (e->path[0] && strcmp(e->path, path) == 0) {
+            if (entry_current(e, st)) {
+                e->used = ++s->tick;
+                return e;
+            }
+            slot = e;   /* replaced or modified: reopen in place */
+            break;
+        }
+        if (!slot || !e->path[0] || (slot->path[0] && e->used < slot->used))
+            slot = e;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    if (slot->path[0]) close(slot->fd);
+
+    snprintf(slot->path, sizeof(slot->path), "%s", path);
+    slot->fd = fd;
+    slot->ino = st->st_ino;
+    slot->size = st->st_size;
+    slot->mtime = st->st_mtime;
+    snprintf(slot->etag, sizeof(slot->etag), "\"%llx-%llx\"",
+             (unsigned long long)st->st_mtime,
+             (unsigned long long)st->st_size);
+    slot->used = ++s->tick;
+    return slot;
+}
+
+/* ── Request helpers ──────────────────────────────────────────────── */
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* Request path to a file under root: the query dropped, %XX decoded, "/"
+   ending in index.html.  A NUL, "." or ".." segment is refused, so
+   nothing outside root can be named. */
+static bool resolve_path(const char *root, const char *req,
+                         char *out, size_t cap) {
+    char path[FS_MAX_PATH];
+    size_t len = 0;
+    if (*req != '/') return false;
+    for (; *req && *req != '?' && *req != '#'; req++) {
+        char c = *req;
+        if (c == '%') {
+            int hi = hex_digit(req[1]);
+            int lo = hi < 0 ? -1 : hex_digit(req[2]);
+            if (lo < 0) return false;
+            c = (char)(hi << 4 | lo);
+            if (c == '\0') return false;
+            req += 2;
+        }
+        if (len + 1 >= sizeof(path)) return false;
+        path[len++] = c;
+    }
+    path[len] = '\0';
+
+    for (const char *seg = path; seg; ) {
+        seg++;   /* past the '/' */
+        const char *next = strchr(seg, '/');
+        size_t n = next ? (size_t)(next - seg) : strlen(seg);
+        if ((n == 1 && seg[0] == '.') ||
+            (n == 2 && seg[0] == '.' && seg[1] == '.'))
+            return false;
+        seg = next;
+    }
+
+    int r = snprintf(out, cap, "%s%s%s", root, path,
+                     path[len - 1] == '/' ? "index.html" : "");
+    return r > 0 && (size_t)r < cap;
+}
+
+static const char *content_type(const char *path) {
+    static const struct { const char *ext, *type; } types[] = {
+        { "html", "text/html; charset=utf-8" },
+        { "htm",  "text/html; charset=utf-8" },
+        { "css",  "text/css" },
+        { "js",   "text/javascript" },
+        { "json", "application/json" },
+        { "txt",  "text/plain; charset=utf-8" },
+        { "svg",  "image/svg+xml" },
+        { "png",  "image/png" },
+        { "jpg",  "image/jpeg" },
+        { "jpeg", "image/jpeg" },
+        { "gif",  "image/gif" },
+        { "ico",  "image/x-icon" },
+        { "wasm", "application/wasm" },
+    };
+    const char *dot = strrchr(path, '.');
+    if (dot && !strchr(dot, '/')) {
+        for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+            if (strcasecmp(dot + 1, types[i].ext) == 0) return types[i].type;
+    }
+    return "application/octet-stream";
+}
+
+/* If-None-Match lists this ETag (or is "*") */
+static bool etag_matches(const char *list, const char *etag) {
+    if (strcmp(list, "*") == 0) return true;
+    size_t n = strlen(etag);
+    for (const char *p = list; (p = strstr(p, etag)) != NULL; p += n)
+        if (p[n] == '\0' || p[n] == ',' || p[n] == ' ') return true;
+    return false;
+}
+
+static bool parse_u64(const char **s, uint64_t *out) {
+    if (!isdigit((unsigned char)**s)) return false;
+    uint64_t v = 0;
+    for (; isdigit((unsigned char)**s); (*s)++) {
+        if (v > (UINT64_MAX - 9) / 10) return false;
+        v = v * 10 + (uint64_t)(**s - '0');
+    }
+    *out = v;
+    return true;
+}
+
+/* A "bytes=first-last" range, either end open, against a file of size
+   bytes: 1 with the span if satisfiable, 0 if not (416), -1 to ignore
+   the header and send it all (malformed, or more than one range) */
+static int parse_range(const char *v, uint64_t size,
+                       uint64_t *first, uint64_t *last) {
+    if (strncasecmp(v, "bytes=", 6) != 0) return -1;
+    v += 6;
+    uint64_t a, b = size - 1;
+    if (*v == '-') {
+        v++;
+        if (!parse_u64(&v, &a) || (*v && *v != ' ')) return -1;
+        if (a == 0 || size == 0) return 0;
+        *first = a >= size ? 0 : size - a;
+        *last = size - 1;
+        return 1;
+    }
+    if (!parse_u64(&v, &a) || *v++ != '-') return -1;
+    if (*v && *v != ' ') {
+        if (!parse_u64(&v, &b) || (*v && *v != ' ') || b < a) return -1;
+        if (b >= size) b = size - 1;
+    }
+    if (a >= size) return 0;
+    *first = a;
+    *last = b;
+    return 1;
+}
+
+/* ── Request handling ─────────────────────────────────────────────── */
+
+static void respond_error(runtime_t *rt, http_conn_id_t conn_id, int code) {
+    static const char *const headers[] = { "Content-Type: text/plain" };
+    char body[32];
+    int n = snprintf(body, sizeof(body), "%d\n", code);
+    actor_http_respond(rt, conn_id, code, headers, 1, body, (size_t)n);
+}
+
+static void handle_request(runtime_t *rt, file_server_state_t *s,
+                           const http_request_payload_t *p) {
+    const char *method = http_request_method(p);
+    if (strcmp(method, "GET") != 0 && strcmp(method, "HEAD") != 0) {
+        static const char *const allow[] = { "Allow: GET, HEAD" };
+        actor_http_respond(rt, p->conn_id, 405, allow, 1, NULL, 0);
+        return;
+    }
+
+    char path[FS_MAX_PATH];
+    struct stat st;
+    if (!resolve_path(s->root, http_request_path(p), path, sizeof(path))) {
+        respond_error(rt, p->conn_id, 400);
+        return;
+    }
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        size_t len = strlen(path);
+        if (len + sizeof("/index.html") > sizeof(path)) {
+            respond_error(rt, p->conn_id, 404);
+            return;
+        }
+        memcpy(path + len, "/index.html", sizeof("/index.html"));
+    }
+    fd_entry_t *e = NULL;
+    if (stat(path, &st) == 0 && S_ISREG(st.st_mode))
+        e = fd_cache_open(s, path, &st);
+    if (!e) {
+        respond_error(rt, p->conn_id, 404);
+        return;
+    }
+
+    char etag_hdr[16 + FS_ETAG_MAX];
+    char type_hdr[64];
+    char range_hdr[80];
+    snprintf(etag_hdr, sizeof(etag_hdr), "ETag: %s", e->etag);
+    snprintf(type_hdr, sizeof(type_hdr), "Content-Type: %s",
+             content_type(path));
+    const char *headers[4] = { etag_hdr, type_hdr, "Accept-Ranges: bytes" };
+
+    const char *inm = http_request_header(p, "If-None-Match");
+    if (inm && etag_matches(inm, e->etag)) {
+        actor_http_respond(rt, p->conn_id, 304, headers, 1, NULL, 0);
+        return;
+    }
+
+    /* A Range applies only if If-Range, when sent, names this version */
+    uint64_t size = (uint64_t)st.st_size;
+    const char *range = http_request_header(p, "Range");
+    const char *if_range = http_request_header(p, "If-Range");
+    if (range && (!if_range || strcmp(if_range, e->etag) == 0)) {
+        uint64_t first, last;
+        int r = parse_range(range, size, &first, &last);
+        if (r == 0) {
+            snprintf(range_hdr, sizeof(range_hdr),
+                     "Content-Range: bytes */%llu", (unsigned long long)size);
+            headers[1] = range_hdr;
+            actor_http_respond(rt, p->conn_id, 416, headers, 2, NULL, 0);
+            return;
+        }
+        if (r > 0) {
+            snprintf(range_hdr, sizeof(range_hdr),
+                     "Content-Range: bytes %llu-%llu/%llu",
+                     (unsigned long long)first, (unsigned long long)last,
+                     (unsigned long long)size);
+            headers[3] = range_hdr;
+            actor_http_respond_file(rt, p->conn_id, 206, headers, 4, e->fd,
+                                    (off_t)first, (size_t)(last - first + 1));
+            return;
+        }
+    }
+
+    actor_http_respond_file(rt, p->conn_id, 200, headers, 3, e->fd, 0,
+                            (size_t)size);
+}
+
+/* ── Behavior ─────────────────────────────────────────────────────── */
+
+static bool file_server_behavior(runtime_t *rt, actor_t *self,
+                                 message_t *msg, void *state) {
+    (void)self;
+    file_server_state_t *s = state;
+
+    switch (msg->type) {
+    case 1: /* bootstrap */
+        return actor_http_listen(rt, s->port);
+
+    case MSG_HTTP_REQUEST:
+        handle_request(rt, s, msg->payload);
+        return true;
+
+    default:
+        return true;
+    }
+}
+
+/* ── Init ─────────────────────────────────────────────────────────── */
+
+actor_id_t file_server_init(runtime_t *rt, const file_server_config_t *config) {
+    file_server_state_t *s = calloc(1, sizeof(*s));
+    if (!s) return ACTOR_ID_INVALID;
+
+    s->port = config->port;
+    snprintf(s->root, sizeof(s->root), "%s", config->root);
+    size_t len = strlen(s->root);
+    if (len > 0 && s->root[len - 1] == '/') s->root[len - 1] = '\0';
+
+    actor_id_t id = actor_spawn(rt, file_server_behavior, s,
+                                file_server_state_free, 32);
+    if (id == ACTOR_ID_INVALID) {
+        free(s);
+        return ACTOR_ID_INVALID;
+    }
+
+    /* Bootstrap message opens the listener from inside the actor */
+    actor_send(rt, id, 1, NULL, 0);
+    return id;
+}
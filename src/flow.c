@@ -0,0 +1,137 @@
+#include "flow.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Array of elem-sized items grown to hold at least need; NULL (arr
+   untouched) if out of memory */
+static void *reserve(void *arr, size_t *cap, size_t need, size_t elem) {
+    if (need <= *cap) return arr;
+    size_t n = *cap ? *cap * 2 : 8;
+    while (n < need) n *= 2;
+    void *p = realloc(arr, n * elem);
+    if (p) *cap = n;
+    return p;
+}
+
+/* Index of dest, or where it would be inserted */
+static size_t window_find(const flow_table_t *ft, actor_id_t dest) {
+    size_t lo = 0, hi = ft->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ft->windows[mid].dest < dest) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void flow_table_free(flow_table_t *ft) {
+    free(ft->windows);
+    free(ft->waiters);
+    free(ft->owed);
+    free(ft->announced.nodes);
+    free(ft->metering.nodes);
+    *ft = (flow_table_t){0};
+}
+
+bool flow_nodes_has(const flow_nodes_t *set, node_id_t node) {
+    for (size_t i = 0; i < set->count; i++)
+        if (set->nodes[i] == node) return true;
+    return false;
+}
+
+bool flow_nodes_add(flow_nodes_t *set, node_id_t node) {
+    if (flow_nodes_has(set, node)) return true;
+    node_id_t *grown = reserve(set->nodes, &set->cap, set->count + 1,
+                               sizeof(*grown));
+    if (!grown) return false;
+    set->nodes = grown;
+    set->nodes[set->count++] = node;
+    return true;
+}
+
+void flow_nodes_remove(flow_nodes_t *set, node_id_t node) {
+    for (size_t i = 0; i < set->count; i++) {
+        if (set->nodes[i] != node) continue;
+        set->nodes[i] = set->nodes[--set->count];
+        return;
+    }
+}
+
+/* ── Sender side ───────────────────────────────────────────────────── */
+
+flow_window_t *flow_window(const flow_table_t *ft, actor_id_t dest) {
+    size_t i = window_find(ft, dest);
+    return (i < ft->count && ft->windows[i].dest == dest)
+           ? &ft->windows[i] : NULL;
+}
+
+bool flow_charge(flow_table_t *ft, actor_id_t dest, uint64_t now) {
+    flow_window_t *w = flow_window(ft, dest);
+    if (w) {
+        w->in_flight++;
+        return true;
+    }
+    flow_window_t *grown = reserve(ft->windows, &ft->cap, ft->count + 1,
+                                   sizeof(*grown));
+    if (!grown) return false;
+    ft->windows = grown;
+    size_t i = window_find(ft, dest);
+    memmove(&ft->windows[i + 1], &ft->windows[i],
+            (ft->count - i) * sizeof(flow_window_t));
+    ft->windows[i] = (flow_window_t){ dest, 1, now };
+    ft->count++;
+    return true;
+}
+
+void flow_drop(flow_table_t *ft, actor_id_t dest) {
+    size_t i = window_find(ft, dest);
+    if (i == ft->count || ft->windows[i].dest != dest) return;
+    memmove(&ft->windows[i], &ft->windows[i + 1],
+            (ft->count - i - 1) * sizeof(flow_window_t));
+    ft->count--;
+}
+
+void flow_credit(flow_table_t *ft, actor_id_t dest, uint32_t count,
+                 uint64_t now) {
+    flow_window_t *w = flow_window(ft, dest);
+    if (!w) return;
+    w->in_flight = count < w->in_flight ? w->in_flight - count : 0;
+    w->last_credit_ms = now;
+    if (w->in_flight == 0) flow_drop(ft, dest);
+}
+
+bool flow_wait(flow_table_t *ft, actor_id_t dest, actor_id_t waiter) {
+    for (size_t i = 0; i < ft->waiter_count; i++)
+        if (ft->waiters[i].dest == dest && ft->waiters[i].waiter == waiter)
+            return true;
+    flow_waiter_t *grown = reserve(ft->waiters, &ft->waiter_cap,
+                                   ft->waiter_count + 1, sizeof(*grown));
+    if (!grown) return false;
+    ft->waiters = grown;
+    ft->waiters[ft->waiter_count++] = (flow_waiter_t){ dest, waiter };
+    return true;
+}
+
+bool flow_pop_waiter(flow_table_t *ft, actor_id_t dest, actor_id_t *waiter) {
+    for (size_t i = 0; i < ft->waiter_count; i++) {
+        if (ft->waiters[i].dest != dest) continue;
+        *waiter = ft->waiters[i].waiter;
+        ft->waiters[i] = ft->waiters[--ft->waiter_count];
+        return true;
+    }
+    return false;
+}
+
+/* ── Receiver side ─────────────────────────────────────────────────── */
+
+uint32_t flow_owe(flow_table_t *ft, node_id_t node, actor_id_t actor) {
+    for (size_t i = 0; i < ft->owed_count; i++)
+        if (ft->owed[i].node == node && ft->owed[i].actor == actor)
+            return ++ft->owed[i].count;
+    flow_owed_t *grown = reserve(ft->owed, &ft->owed_cap, ft->owed_count + 1,
+                                 sizeof(*grown));
+    if (!grown) return 0;
+    ft->owed = grown;
+    ft->owed[ft->owed_count++] = (flow_owed_t){ node, actor, 1 };
+    return 1;
+}
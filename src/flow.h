@@ -0,0 +1,100 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include "microkernel/types.h"
+
+/* Credit-based flow control for messages between nodes.
+
+   The sending node may have `window` messages in flight to each remote
+   actor.  The receiving node owes the sender one credit for every such
+   message once the destination has consumed it (or it was dropped), and
+   returns them in one MSG_FLOW_CREDIT per node per poll.  A send beyond
+   the window fails and the sending actor is queued for MSG_SEND_READY.
+
+   Credit is owed only to nodes that said they meter: before its first
+   metered send to a node, the sender announces it with MSG_FLOW_METER
+   (payload: uint32_t window, 0 = stopped).  Without an announcement no
+   credit is kept or sent, so unmetered links carry no extra traffic.
+
+   Windows are kept sorted by destination for binary search; waiters and
+   owed credits are short-lived and scanned linearly. */
+
+/* Wire entry of MSG_FLOW_CREDIT (array; host byte order like the other
+   node-to-node payloads) */
+typedef struct {
+    actor_id_t actor;
+    uint32_t   count;
+    uint32_t   reserved;
+} flow_credit_entry_t;
+
+typedef struct {
+    actor_id_t dest;
+    uint32_t   in_flight;
+    uint64_t   last_credit_ms;   /* last grant, or when the window opened */
+} flow_window_t;
+
+typedef struct {
+    actor_id_t dest;
+    actor_id_t waiter;
+} flow_waiter_t;
+
+typedef struct {
+    node_id_t  node;             /* sender to return the credit to */
+    actor_id_t actor;
+    uint32_t   count;
+} flow_owed_t;
+
+/* Small set of node IDs, scanned linearly */
+typedef struct {
+    node_id_t *nodes;
+    size_t     count;
+    size_t     cap;
+} flow_nodes_t;
+
+typedef struct {
+    flow_window_t *windows;
+    size_t         count;
+    size_t         cap;
+    flow_waiter_t *waiters;
+    size_t         waiter_count;
+    size_t         waiter_cap;
+    flow_owed_t   *owed;
+    size_t         owed_count;
+    size_t         owed_cap;
+    flow_nodes_t   announced;    /* nodes told that we meter */
+    flow_nodes_t   metering;     /* nodes that meter their sends to us */
+} flow_table_t;
+
+void flow_table_free(flow_table_t *ft);
+
+bool flow_nodes_has(const flow_nodes_t *set, node_id_t node);
+bool flow_nodes_add(flow_nodes_t *set, node_id_t node);
+void flow_nodes_remove(flow_nodes_t *set, node_id_t node);
+
+/* ── Sender side ── */
+
+flow_window_t *flow_window(const flow_table_t *ft, actor_id_t dest);
+
+/* Count one more message in flight to dest, opening its window if needed */
+bool flow_charge(flow_table_t *ft, actor_id_t dest, uint64_t now);
+
+/* Apply a grant of `count` credits; a fully drained window is closed */
+void flow_credit(flow_table_t *ft, actor_id_t dest, uint32_t count,
+                 uint64_t now);
+
+/* Close dest's window, forgetting whatever is in flight */
+void flow_drop(flow_table_t *ft, actor_id_t dest);
+
+/* Queue `waiter` for MSG_SEND_READY on dest (once per pair) */
+bool flow_wait(flow_table_t *ft, actor_id_t dest, actor_id_t waiter);
+
+/* Remove one waiter for dest; false when there are none left */
+bool flow_pop_waiter(flow_table_t *ft, actor_id_t dest, actor_id_t *waiter);
+
+/* ── Receiver side ── */
+
+/* Record that a message from `node` to `actor` has been consumed.
+   Returns the credits now owed for the pair (0 if out of memory). */
+uint32_t flow_owe(flow_table_t *ft, node_id_t node, actor_id_t actor);
+
+#endif /* FLOW_H */
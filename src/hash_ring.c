@@ -0,0 +1,81 @@
+#include "hash_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* MurmurHash3 finalizer: spreads nearby inputs over the whole ring */
+static uint32_t mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/* FNV-1a, finalized */
+static uint32_t key_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h ^= (uint8_t)*s;
+        h *= 16777619u;
+    }
+    return mix32(h);
+}
+
+static int cmp_node(const void *a, const void *b) {
+    node_id_t x = *(const node_id_t *)a, y = *(const node_id_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int cmp_point(const void *a, const void *b) {
+    const ring_point_t *x = a, *y = b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return cmp_node(&x->node, &y->node);   /* ties broken the same everywhere */
+}
+
+void hash_ring_free(hash_ring_t *r) {
+    free(r->points);
+    free(r->members);
+    *r = (hash_ring_t){0};
+}
+
+bool hash_ring_build(hash_ring_t *r, const node_id_t *members, size_t n) {
+    node_id_t *m = malloc((n ? n : 1) * sizeof(*m));
+    if (!m) return false;
+    memcpy(m, members, n * sizeof(*m));
+    qsort(m, n, sizeof(*m), cmp_node);
+    if (n == r->member_count && memcmp(m, r->members, n * sizeof(*m)) == 0) {
+        free(m);
+        return false;
+    }
+
+    ring_point_t *p = malloc((n ? n : 1) * MK_RING_VNODES * sizeof(*p));
+    if (!p) {
+        free(m);
+        return false;
+    }
+    for (size_t i = 0; i < n; i++)
+        for (uint32_t v = 0; v < MK_RING_VNODES; v++)
+            p[i * MK_RING_VNODES + v] = (ring_point_t){
+                mix32(m[i] ^ mix32(v + 1)), m[i] };
+    qsort(p, n * MK_RING_VNODES, sizeof(*p), cmp_point);
+
+    hash_ring_free(r);
+    r->points = p;
+    r->count = n * MK_RING_VNODES;
+    r->members = m;
+    r->member_count = n;
+    return true;
+}
+
+node_id_t hash_ring_owner(const hash_ring_t *r, const char *key) {
+    if (r->count == 0) return 0;
+    uint32_t h = key_hash(key);
+    size_t lo = 0, hi = r->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->points[mid].hash < h) lo = mid + 1;
+        else hi = mid;
+    }
+    return r->points[lo == r->count ? 0 : lo].node;
+}
@@ -0,0 +1,38 @@
+#ifndef HASH_RING_H
+#define HASH_RING_H
+
+#include "microkernel/types.h"
+
+/* Consistent-hash ring over node IDs, used to pick the node that owns a
+   global name in the partitioned registry.  Each node is placed at
+   MK_RING_VNODES points; a key belongs to the first point at or after
+   its hash, wrapping around.  A node joining or leaving only moves the
+   keys of the arcs next to its own points, about 1/N of them. */
+
+#ifndef MK_RING_VNODES
+#define MK_RING_VNODES 32
+#endif
+
+typedef struct {
+    uint32_t  hash;
+    node_id_t node;
+} ring_point_t;
+
+typedef struct {
+    ring_point_t *points;     /* sorted by hash */
+    size_t        count;
+    node_id_t    *members;    /* sorted */
+    size_t        member_count;
+} hash_ring_t;
+
+void hash_ring_free(hash_ring_t *r);
+
+/* Rebuild for members (any order, no duplicates).  Returns true if the
+   membership changed; false if it is the same, or memory ran out (the
+   old ring is kept). */
+bool hash_ring_build(hash_ring_t *r, const node_id_t *members, size_t n);
+
+/* Owner of key, or 0 if the ring is empty */
+node_id_t hash_ring_owner(const hash_ring_t *r, const char *key);
+
+#endif /* HASH_RING_H */
@@ -5,10 +5,12 @@
 #include "microkernel/mk_socket.h"
 #include "microkernel/message.h"
 #include "runtime_internal.h"
+#include "http_table.h"
 #include "url_parse.h"
 #include "sha1.h"
 #include "base64.h"
 #include "ws_frame.h"
+#include "http_headers.h"
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
@@ -24,24 +26,71 @@
 
 /* ── Buffer helpers ────────────────────────────────────────────────── */
 
+/* Idle conns don't hold a read buffer: return it once all is parsed */
+static void release_read_buf(http_conn_t *conn, runtime_t *rt) {
+    if (conn->read_buf && conn->read_len == 0) {
+        http_table_buf_put(runtime_get_http_table(rt), conn->read_buf);
+        conn->read_buf = NULL;
+    }
+}
+
+/* Unparsed input starts here */
+static inline uint8_t *buf_data(const http_conn_t *conn) {
+    return conn->read_buf + conn->read_pos;
+}
+
+/* Parsed bytes are skipped, not moved: the rest slides to the front only
+   when a read needs the room (buf_compact) */
 static void buf_consume(http_conn_t *conn, size_t n) {
+    conn->crlf_scanned = 0;
     if (n >= conn->read_len) {
         conn->read_len = 0;
+        conn->read_pos = 0;
     } else {
-        memmove(conn->read_buf, conn->read_buf + n, conn->read_len - n);
+        conn->read_pos += n;
         conn->read_len -= n;
     }
 }
 
-/* Find \r\n in buffer. Returns offset or -1. */
+static void buf_compact(http_conn_t *conn) {
+    memmove(conn->read_buf, buf_data(conn), conn->read_len);
+    conn->read_pos = 0;
+}
+
+/* Find \r\n in the unparsed input. Returns offset or -1.  memchr skips
+   to each '\r' a word or vector at a time, and input searched by an
+   earlier call is not searched again. */
 static ssize_t find_crlf(http_conn_t *conn) {
-    for (size_t i = 0; i + 1 < conn->read_len; i++) {
-        if (conn->read_buf[i] == '\r' && conn->read_buf[i + 1] == '\n')
-            return (ssize_t)i;
-    }
+    const uint8_t *data = buf_data(conn);
+    size_t i = conn->crlf_scanned;
+    while (i + 1 < conn->read_len) {
+        const uint8_t *cr = memchr(data + i, '\r', conn->read_len - 1 - i);
+        if (!cr) break;
+        i = (size_t)(cr - data);
+        if (data[i + 1] == '\n') return (ssize_t)i;
+        i++;
+    }
+    /* A '\r' last in the buffer may yet be followed by '\n' */
+    conn->crlf_scanned = conn->read_len > 0 ? conn->read_len - 1 : 0;
     return -1;
 }
 
+/* Case-insensitive match of tok in a comma-separated header value */
+static bool has_token(const char *val, size_t len, const char *tok) {
+    size_t tok_len = strlen(tok);
+    const char *end = val + len;
+    while (val < end) {
+        while (val < end && (*val == ' ' || *val == ',')) val++;
+        const char *t = val;
+        while (val < end && *val != ',') val++;
+        const char *te = val;
+        while (te > t && te[-1] == ' ') te--;
+        if ((size_t)(te - t) == tok_len && strncasecmp(t, tok, tok_len) == 0)
+            return true;
+    }
+    return false;
+}
+
 /* Append to dynamic buffer */
 static bool dyn_append(uint8_t **buf, size_t *size, size_t *cap,
                        const void *data, size_t len) {
@@ -58,29 +107,80 @@ static bool dyn_append(uint8_t **buf, size_t *size, size_t *cap,
     return true;
 }
 
+/* Append a "Name: Value" line to the headers as "Name: Value\0", with
+   its index entry */
+static void add_header(http_conn_t *conn, const char *line, size_t len,
+                       size_t name_len, size_t value) {
+    if (conn->header_index_size / sizeof(http_header_entry_t) <
+        HTTP_HEADER_INDEX_MAX) {
+        http_header_entry_t e = {
+            .hash = http_header_hash(line, name_len),
+            .offset = (uint32_t)conn->headers_size,
+            .name_len = (uint16_t)name_len,
+            .value = (uint16_t)value
+        };
+        dyn_append((uint8_t **)&conn->header_index, &conn->header_index_size,
+                   &conn->header_index_cap, &e, sizeof(e));
+    }
+    dyn_append((uint8_t **)&conn->headers_buf, &conn->headers_size,
+               &conn->headers_cap, line, len);
+    char nul = '\0';
+    dyn_append((uint8_t **)&conn->headers_buf, &conn->headers_size,
+               &conn->headers_cap, &nul, 1);
+}
+
+static void clear_headers(http_conn_t *conn) {
+    conn->headers_size = 0;
+    conn->header_index_size = 0;
+}
+
+/* Index of the headers, after a payload's first end bytes */
+static size_t header_index_end(const http_conn_t *conn, size_t end) {
+    size_t count = conn->header_index_size / sizeof(http_header_entry_t);
+    return ((end + 3) & ~(size_t)3) + http_header_index_size(count);
+}
+
+static void write_header_index(const http_conn_t *conn, uint8_t *payload,
+                               size_t end) {
+    http_header_index_write(
+        (http_header_index_t *)http_header_index_at(payload, end),
+        conn->header_index,
+        conn->header_index_size / sizeof(http_header_entry_t));
+}
+
 /* ── Delivery helpers ──────────────────────────────────────────────── */
 
-static void deliver_http_response(http_conn_t *conn, runtime_t *rt) {
-    /* Build variable-size payload: [header struct][headers_buf][body_buf] */
-    size_t total = sizeof(http_response_payload_t) +
-                   conn->headers_size + conn->body_size;
-    uint8_t *buf = malloc(total);
-    if (!buf) return;
+/* head_only leaves the body out, for MSG_HTTP_RESPONSE_HEAD */
+static bool deliver_http_response(http_conn_t *conn, runtime_t *rt,
+                                  bool head_only) {
+    /* Build variable-size payload:
+       [header struct][headers_buf][body_buf][header index] */
+    size_t body_size = head_only ? 0 : conn->body_size;
+    size_t end = sizeof(http_response_payload_t) +
+                 conn->headers_size + body_size;
+    size_t total = header_index_end(conn, end);
+    uint8_t *buf = calloc(1, total);
+    if (!buf) return false;
 
     http_response_payload_t *p = (http_response_payload_t *)buf;
     p->conn_id = conn->id;
     p->status_code = conn->status_code;
     p->headers_size = conn->headers_size;
-    p->body_size = conn->body_size;
+    p->body_size = body_size;
 
     if (conn->headers_buf && conn->headers_size > 0)
         memcpy(buf + sizeof(*p), conn->headers_buf, conn->headers_size);
-    if (conn->body_buf && conn->body_size > 0)
+    if (conn->body_buf && body_size > 0)
         memcpy(buf + sizeof(*p) + conn->headers_size,
-               conn->body_buf, conn->body_size);
+               conn->body_buf, body_size);
+    write_header_index(conn, buf, end);
 
-    runtime_deliver_msg(rt, conn->owner, MSG_HTTP_RESPONSE, buf, total);
+    bool ok = runtime_deliver_msg(rt, conn->owner,
+                                  head_only ? MSG_HTTP_RESPONSE_HEAD
+                                            : MSG_HTTP_RESPONSE,
+                                  buf, total);
     free(buf);
+    return ok;
 }
 
 static void deliver_http_error(http_conn_t *conn, runtime_t *rt,
@@ -104,7 +204,8 @@ static void deliver_sse_open(http_conn_t *conn, runtime_t *rt) {
 }
 
 static void deliver_sse_event(http_conn_t *conn, runtime_t *rt) {
-    size_t event_len = strlen(conn->sse_event) + 1; /* include null */
+    const char *event = conn->sse_event ? conn->sse_event : "message";
+    size_t event_len = strlen(event) + 1; /* include null */
     size_t data_len = conn->sse_data_size;
     size_t total = sizeof(sse_event_payload_t) + event_len + data_len;
 
@@ -116,7 +217,7 @@ static void deliver_sse_event(http_conn_t *conn, runtime_t *rt) {
     p->event_size = event_len;
     p->data_size = data_len;
 
-    memcpy(buf + sizeof(*p), conn->sse_event, event_len);
+    memcpy(buf + sizeof(*p), event, event_len);
     if (conn->sse_data && data_len > 0)
         memcpy(buf + sizeof(*p) + event_len, conn->sse_data, data_len);
 
@@ -124,7 +225,8 @@ static void deliver_sse_event(http_conn_t *conn, runtime_t *rt) {
     free(buf);
 
     /* Reset SSE accumulator */
-    strcpy(conn->sse_event, "message");
+    free(conn->sse_event);
+    conn->sse_event = NULL;
     conn->sse_data_size = 0;
 }
 
@@ -183,19 +285,321 @@ static void deliver_ws_error(http_conn_t *conn, runtime_t *rt) {
 
 /* ── Transition to error state ─────────────────────────────────────── */
 
+/* Until a WS or SSE stream is open the failure belongs to the request,
+   and MSG_HTTP_ERROR says why (lookup, connect, TLS, handshake) */
 static void conn_error(http_conn_t *conn, runtime_t *rt, const char *msg) {
+    http_state_t was = conn->state;
     conn->state = HTTP_STATE_ERROR;
-    if (conn->conn_type == HTTP_CONN_WS &&
-        conn->state != HTTP_STATE_RECV_STATUS &&
-        conn->state != HTTP_STATE_RECV_HEADERS) {
+    if (conn->conn_type == HTTP_CONN_WS && was == HTTP_STATE_WS_ACTIVE) {
         deliver_ws_error(conn, rt);
-    } else if (conn->conn_type == HTTP_CONN_SSE) {
+    } else if (conn->conn_type == HTTP_CONN_SSE &&
+               was == HTTP_STATE_BODY_STREAM) {
         deliver_sse_closed(conn, rt);
     } else {
         deliver_http_error(conn, rt, msg);
     }
 }
 
+/* ── Streamed bodies ───────────────────────────────────────────────── */
+
+/* A stream delivers nothing its owner can't take: past the window it
+   waits for acks, and a full mailbox leaves the bytes in read_buf and
+   sets stream_blocked until http_conn_resume gets them through.  The
+   head is the response on a client conn, the request on a server one. */
+
+static bool deliver_http_request(http_conn_t *conn, runtime_t *rt,
+                                 bool head_only);
+
+static size_t stream_room(const http_conn_t *conn) {
+    return conn->stream_unacked < conn->stream_window ?
+           conn->stream_window - conn->stream_unacked : 0;
+}
+
+bool http_conn_stream_held(const http_conn_t *conn) {
+    if (!conn->stream) return false;
+    if (conn->stream_blocked) return true;
+    return stream_room(conn) == 0 &&
+           (conn->state == HTTP_STATE_BODY_CONTENT ||
+            conn->state == HTTP_STATE_BODY_CHUNKED ||
+            conn->state == HTTP_STATE_SRV_RECV_BODY);
+}
+
+static bool stream_head(http_conn_t *conn, runtime_t *rt) {
+    if (!conn->stream_head_sent) {
+        conn->stream_head_sent = conn->is_server ?
+            deliver_http_request(conn, rt, true) :
+            deliver_http_response(conn, rt, true);
+        conn->stream_blocked = !conn->stream_head_sent;
+    }
+    return conn->stream_head_sent;
+}
+
+/* The next len bytes of read_buf as a MSG_HTTP_BODY_CHUNK */
+static bool deliver_body_chunk(http_conn_t *conn, runtime_t *rt,
+                               size_t len, bool final) {
+    size_t total = sizeof(http_body_chunk_payload_t) + len;
+    uint8_t *buf = malloc(total);
+    bool ok = buf != NULL;
+    if (ok) {
+        http_body_chunk_payload_t *p = (http_body_chunk_payload_t *)buf;
+        p->conn_id = conn->id;
+        p->final = final;
+        p->size = len;
+        if (len > 0) memcpy(buf + sizeof(*p), buf_data(conn), len);
+        ok = runtime_deliver_msg(rt, conn->owner, MSG_HTTP_BODY_CHUNK,
+                                 buf, total);
+        free(buf);
+    }
+    conn->stream_blocked = !ok;
+    if (ok) {
+        conn->stream_unacked += len;
+        conn->body_size += len;
+    }
+    return ok;
+}
+
+/* Move up to len body bytes off the front of read_buf; returns how many */
+static size_t take_body(http_conn_t *conn, runtime_t *rt, size_t len) {
+    if (conn->stream) {
+        size_t room = stream_room(conn);
+        if (len > room) len = room;
+        if (len == 0 || !stream_head(conn, rt) ||
+            !deliver_body_chunk(conn, rt, len, false))
+            return 0;
+    } else {
+        dyn_append(&conn->body_buf, &conn->body_size, &conn->body_cap,
+                   buf_data(conn), len);
+    }
+    buf_consume(conn, len);
+    return len;
+}
+
+/* Whole body in: one message, or the final chunk of a stream */
+static void deliver_complete(http_conn_t *conn, runtime_t *rt) {
+    if (!conn->stream) {
+        if (conn->is_server)
+            deliver_http_request(conn, rt, false);
+        else
+            deliver_http_response(conn, rt, false);
+        return;
+    }
+    conn->stream_final_pending = true;
+    if (!stream_head(conn, rt) || !deliver_body_chunk(conn, rt, 0, true))
+        return;
+    conn->stream_final_pending = false;
+    if (conn->is_server) conn->state = HTTP_STATE_IDLE;   /* owner responds */
+}
+
+/* ── Client connection pool ────────────────────────────────────────── */
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void make_pool_key(const parsed_url_t *u, char *out) {
+    snprintf(out, HTTP_POOL_KEY_MAX, "%s://%s:%u",
+             u->scheme, u->host, url_effective_port(u));
+}
+
+/* ── Connecting ────────────────────────────────────────────────────── */
+
+/* Nothing here blocks the actor's turn: the host is looked up on the
+   resolver thread (RESOLVING), then each of its addresses tried with a
+   non-blocking connect completed on POLLOUT (CONNECTING). */
+
+static bool conn_target(http_conn_t *conn, const parsed_url_t *u) {
+    conn->remote_host = strdup(u->host);
+    conn->remote_port = url_effective_port(u);
+    conn->remote_tls = url_is_tls(u);
+    return conn->remote_host != NULL;
+}
+
+/* Try the remaining addresses in turn until one starts connecting */
+static bool connect_next(http_conn_t *conn) {
+    while (conn->remote_next < conn->remote_addrs->count) {
+        const dns_addr_t *a = &conn->remote_addrs->addrs[conn->remote_next++];
+        conn->sock = mk_socket_tcp_connect_addr(&a->addr.sa, a->len);
+        if (conn->sock) {
+            conn->state = HTTP_STATE_CONNECTING;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Resolved now, or parked in RESOLVING until http_conn_dns_ready */
+static bool conn_resolve(http_conn_t *conn, runtime_t *rt) {
+    dns_result_t res;
+    switch (dns_lookup(runtime_get_dns(rt), conn->remote_host,
+                       conn->remote_port, &res)) {
+    case DNS_PENDING:
+        conn->state = HTTP_STATE_RESOLVING;
+        return true;
+    case DNS_FAILED:
+        return false;
+    case DNS_DONE:
+        break;
+    }
+    if (!conn->remote_addrs) {
+        conn->remote_addrs = malloc(sizeof(*conn->remote_addrs));
+        if (!conn->remote_addrs) return false;
+    }
+    *conn->remote_addrs = res;
+    conn->remote_next = 0;
+    return connect_next(conn);
+}
+
+/* Open a new socket to the conn's target; false if that failed outright */
+static bool conn_connect(http_conn_t *conn, runtime_t *rt) {
+#ifndef HAVE_TLS
+    if (conn->remote_tls) return false;
+#elif !defined(HAVE_OPENSSL)
+    /* esp-tls resolves and connects by name itself */
+    if (conn->remote_tls) {
+        conn->sock = mk_socket_tls_connect(conn->remote_host,
+                                           conn->remote_port);
+        conn->state = HTTP_STATE_SENDING;
+        return conn->sock != NULL;
+    }
+#endif
+    return conn_resolve(conn, rt);
+}
+
+/* POLLOUT (or an error) on a CONNECTING socket.  Once connected, TLS
+   is started over it and the request goes out; a refused address moves
+   on to the next. */
+static void connect_done(http_conn_t *conn, runtime_t *rt) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    int fd = conn->sock->get_fd(conn->sock);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) err = errno;
+    if (err == 0) {
+#ifdef HAVE_OPENSSL
+        if (conn->remote_tls) {
+            int tls_fd = dup(fd);
+            conn->sock->close(conn->sock);
+            conn->sock = tls_fd >= 0
+                ? mk_socket_tls_wrap(tls_fd, conn->remote_host) : NULL;
+            if (!conn->sock) {
+                conn_error(conn, rt, "tls handshake failed");
+                return;
+            }
+        }
+#endif
+        conn->state = HTTP_STATE_SENDING;
+        return;
+    }
+    conn->sock->close(conn->sock);
+    conn->sock = NULL;
+    if (!connect_next(conn)) conn_error(conn, rt, "connect failed");
+}
+
+void http_conn_dns_ready(runtime_t *rt) {
+    http_table_t *table = runtime_get_http_table(rt);
+    for (size_t i = 0; i < http_table_slots(table); i++) {
+        http_conn_t *conn = http_table_at(table, i);
+        if (conn->id == HTTP_CONN_ID_INVALID ||
+            conn->state != HTTP_STATE_RESOLVING)
+            continue;
+        if (!conn_resolve(conn, rt))
+            conn_error(conn, rt, conn->remote_addrs ? "connect failed"
+                                                    : "host not found");
+    }
+}
+
+/* An idle socket polls readable once the server closes it (or sends
+   anything unasked): either way it can't carry another request */
+static bool pool_sock_alive(mk_socket_t *sock) {
+    struct pollfd pfd = { .fd = sock->get_fd(sock), .events = POLLIN };
+    return poll(&pfd, 1, 0) == 0;
+}
+
+/* Most recently parked live socket for key, or NULL */
+static mk_socket_t *pool_take(runtime_t *rt, const char *key) {
+    http_pool_entry_t *pool = runtime_get_http_pool(rt);
+    for (;;) {
+        http_pool_entry_t *best = NULL;
+        for (size_t i = 0; i < MAX_HTTP_POOL; i++) {
+            if (pool[i].sock && strcmp(pool[i].key, key) == 0 &&
+                (!best || pool[i].idle_since_ms > best->idle_since_ms))
+                best = &pool[i];
+        }
+        if (!best) return NULL;
+        mk_socket_t *sock = best->sock;
+        best->sock = NULL;
+        if (pool_sock_alive(sock)) return sock;
+        sock->close(sock);
+    }
+}
+
+/* Park a socket after a complete response.  It is closed instead if its
+   host already has HTTP_POOL_MAX_PER_HOST parked; a full pool gives up
+   its longest-idle socket. */
+static void pool_put(runtime_t *rt, const char *key, mk_socket_t *sock) {
+    http_pool_entry_t *pool = runtime_get_http_pool(rt);
+    http_pool_entry_t *slot = NULL, *oldest = NULL;
+    size_t same_host = 0;
+    for (size_t i = 0; i < MAX_HTTP_POOL; i++) {
+        if (!pool[i].sock) {
+            if (!slot) slot = &pool[i];
+            continue;
+        }
+        if (strcmp(pool[i].key, key) == 0) same_host++;
+        if (!oldest || pool[i].idle_since_ms < oldest->idle_since_ms)
+            oldest = &pool[i];
+    }
+    if (same_host >= HTTP_POOL_MAX_PER_HOST) {
+        sock->close(sock);
+        return;
+    }
+    if (!slot) {
+        oldest->sock->close(oldest->sock);
+        slot = oldest;
+    }
+    slot->sock = sock;
+    snprintf(slot->key, sizeof(slot->key), "%s", key);
+    slot->idle_since_ms = now_ms();
+}
+
+/* Response fully read: park the socket if the server keeps it open */
+static void finish_response(http_conn_t *conn, runtime_t *rt) {
+    conn->state = HTTP_STATE_DONE;
+    if (conn->pool_key && conn->keep_alive && conn->read_len == 0) {
+        pool_put(rt, conn->pool_key, conn->sock);
+        conn->sock = NULL;
+    }
+    deliver_complete(conn, rt);
+}
+
+/* Body read to its end */
+static void body_done(http_conn_t *conn, runtime_t *rt) {
+    if (conn->is_server)
+        deliver_complete(conn, rt);
+    else
+        finish_response(conn, rt);
+}
+
+/* The server closed a pooled socket before answering: send the request
+   again, once, on a new connection */
+static bool retry_fresh(http_conn_t *conn, runtime_t *rt) {
+    conn->sock->close(conn->sock);
+    conn->sock = NULL;
+    conn->reused = false;
+    conn->send_pos = 0;
+    return conn_connect(conn, rt);
+}
+
+static bool method_idempotent(const char *method) {
+    static const char *const idempotent[] = {
+        "GET", "HEAD", "PUT", "DELETE", "OPTIONS", "TRACE"
+    };
+    for (size_t i = 0; i < sizeof(idempotent) / sizeof(idempotent[0]); i++)
+        if (strcasecmp(method, idempotent[i]) == 0) return true;
+    return false;
+}
+
 /* ── Request building ──────────────────────────────────────────────── */
 
 static uint8_t *build_http_request(const char *method, const parsed_url_t *url,
@@ -320,7 +724,7 @@ static bool parse_status_line(http_conn_t *conn) {
     if (crlf < 0) return false;
 
     /* Parse "HTTP/1.x NNN reason" */
-    char *line = (char *)conn->read_buf;
+    char *line = (char *)buf_data(conn);
     if (crlf < 12 || strncmp(line, "HTTP/1.", 7) != 0) {
         conn->state = HTTP_STATE_ERROR;
         return false;
@@ -336,11 +740,15 @@ static bool parse_status_line(http_conn_t *conn) {
         return false;
     }
 
+    /* HTTP/1.1 responses leave the connection open unless told otherwise */
+    conn->keep_alive = line[7] != '0';
+
     buf_consume(conn, (size_t)crlf + 2);
     conn->state = HTTP_STATE_RECV_HEADERS;
     conn->content_length = -1;
     conn->chunked = false;
     conn->upgrade_ws = false;
+    conn->in_trailer = false;
     return true;
 }
 
@@ -366,7 +774,6 @@ static bool parse_header_line(http_conn_t *conn, runtime_t *rt) {
         } else if (conn->conn_type == HTTP_CONN_SSE) {
             if (conn->status_code >= 200 && conn->status_code < 300) {
                 conn->state = HTTP_STATE_BODY_STREAM;
-                strcpy(conn->sse_event, "message");
                 conn->sse_data_size = 0;
                 deliver_sse_open(conn, rt);
             } else {
@@ -376,7 +783,9 @@ static bool parse_header_line(http_conn_t *conn, runtime_t *rt) {
             }
         } else {
             /* Regular HTTP */
-            if (conn->chunked) {
+            if (conn->head_request) {
+                finish_response(conn, rt);
+            } else if (conn->chunked) {
                 conn->state = HTTP_STATE_BODY_CHUNKED;
                 conn->chunk_remaining = 0;
                 conn->in_chunk_data = false;
@@ -384,20 +793,22 @@ static bool parse_header_line(http_conn_t *conn, runtime_t *rt) {
                 conn->state = HTTP_STATE_BODY_CONTENT;
             } else if (conn->content_length == 0 ||
                        conn->status_code == 204 ||
-                       conn->status_code == 304) {
+                       conn->status_code == 304 ||
+                       conn->head_request) {
                 /* No body */
-                conn->state = HTTP_STATE_DONE;
-                deliver_http_response(conn, rt);
+                finish_response(conn, rt);
             } else {
                 /* Unknown length: read until close */
                 conn->state = HTTP_STATE_BODY_CONTENT;
             }
+            if (conn->stream && conn->state != HTTP_STATE_DONE)
+                stream_head(conn, rt);
         }
         return true;
     }
 
     /* Parse header line */
-    char *line = (char *)conn->read_buf;
+    char *line = (char *)buf_data(conn);
     char *colon = memchr(line, ':', (size_t)crlf);
 
     if (colon) {
@@ -419,6 +830,12 @@ static bool parse_header_line(http_conn_t *conn, runtime_t *rt) {
                    strncasecmp(line, "Upgrade", 7) == 0) {
             if (val_len >= 9 && strncasecmp(val, "websocket", 9) == 0)
                 conn->upgrade_ws = true;
+        } else if (name_len == 10 &&
+                   strncasecmp(line, "Connection", 10) == 0) {
+            if (has_token(val, val_len, "close"))
+                conn->keep_alive = false;
+            else if (has_token(val, val_len, "keep-alive"))
+                conn->keep_alive = true;
         } else if (name_len == 20 &&
                    strncasecmp(line, "Sec-WebSocket-Accept", 20) == 0) {
             /* Validate WS accept key */
@@ -433,15 +850,8 @@ static bool parse_header_line(http_conn_t *conn, runtime_t *rt) {
             }
         }
 
-        /* Accumulate header: "Name: Value\0" */
-        size_t header_line_len = (size_t)crlf + 1; /* include null terminator */
-        dyn_append((uint8_t **)&conn->headers_buf, &conn->headers_size,
-                   &conn->headers_cap, line, (size_t)crlf);
-        /* Null-terminate this header entry */
-        char nul = '\0';
-        dyn_append((uint8_t **)&conn->headers_buf, &conn->headers_size,
-                   &conn->headers_cap, &nul, 1);
-        (void)header_line_len;
+        add_header(conn, line, (size_t)crlf, name_len,
+                   (size_t)(val - line));
     }
 
     buf_consume(conn, (size_t)crlf + 2);
@@ -460,16 +870,11 @@ static bool consume_body_content(http_conn_t *conn, runtime_t *rt) {
         if (avail > remaining) avail = remaining;
     }
 
-    if (avail > 0) {
-        dyn_append(&conn->body_buf, &conn->body_size, &conn->body_cap,
-                   conn->read_buf, avail);
-        buf_consume(conn, avail);
-    }
+    if (avail > 0) avail = take_body(conn, rt, avail);
 
     if (conn->content_length >= 0 &&
         conn->body_size >= (size_t)conn->content_length) {
-        conn->state = HTTP_STATE_DONE;
-        deliver_http_response(conn, rt);
+        finish_response(conn, rt);
     }
 
     return avail > 0;
@@ -480,22 +885,29 @@ static bool consume_body_content(http_conn_t *conn, runtime_t *rt) {
 static bool consume_body_chunked(http_conn_t *conn, runtime_t *rt) {
     if (conn->read_len == 0) return false;
 
+    if (conn->in_trailer) {
+        /* Trailer fields (ignored) up to the blank line */
+        ssize_t crlf = find_crlf(conn);
+        if (crlf < 0) return false;
+        buf_consume(conn, (size_t)crlf + 2);
+        if (crlf == 0) body_done(conn, rt);
+        return true;
+    }
+
     if (conn->in_chunk_data) {
         /* Reading chunk data */
         size_t avail = conn->read_len;
         if (avail > conn->chunk_remaining) avail = conn->chunk_remaining;
 
         if (avail > 0) {
-            dyn_append(&conn->body_buf, &conn->body_size, &conn->body_cap,
-                       conn->read_buf, avail);
-            buf_consume(conn, avail);
+            avail = take_body(conn, rt, avail);
             conn->chunk_remaining -= avail;
         }
 
         if (conn->chunk_remaining == 0) {
             /* Expect trailing \r\n after chunk data */
             if (conn->read_len >= 2 &&
-                conn->read_buf[0] == '\r' && conn->read_buf[1] == '\n') {
+                buf_data(conn)[0] == '\r' && buf_data(conn)[1] == '\n') {
                 buf_consume(conn, 2);
                 conn->in_chunk_data = false;
                 return true;
@@ -514,7 +926,7 @@ static bool consume_body_chunked(http_conn_t *conn, runtime_t *rt) {
     char size_str[32];
     size_t copy = (size_t)crlf < sizeof(size_str) - 1 ?
                   (size_t)crlf : sizeof(size_str) - 1;
-    memcpy(size_str, conn->read_buf, copy);
+    memcpy(size_str, buf_data(conn), copy);
     size_str[copy] = '\0';
 
     /* Ignore chunk extensions (after semicolon) */
@@ -526,9 +938,8 @@ static bool consume_body_chunked(http_conn_t *conn, runtime_t *rt) {
     buf_consume(conn, (size_t)crlf + 2);
 
     if (chunk_size == 0) {
-        /* Last chunk — skip trailing headers/CRLF */
-        conn->state = HTTP_STATE_DONE;
-        deliver_http_response(conn, rt);
+        /* Last chunk: the response ends after the trailer */
+        conn->in_trailer = true;
         return true;
     }
 
@@ -583,10 +994,8 @@ static bool process_sse_line(http_conn_t *conn, runtime_t *rt,
     }
 
     if (field_len == 5 && memcmp(field, "event", 5) == 0) {
-        size_t copy = value_len < sizeof(conn->sse_event) - 1 ?
-                      value_len : sizeof(conn->sse_event) - 1;
-        memcpy(conn->sse_event, value, copy);
-        conn->sse_event[copy] = '\0';
+        free(conn->sse_event);
+        conn->sse_event = strndup(value, value_len < 255 ? value_len : 255);
     } else if (field_len == 4 && memcmp(field, "data", 4) == 0) {
         if (conn->sse_data_size > 0) {
             /* Append newline between data lines */
@@ -603,19 +1012,51 @@ static bool process_sse_line(http_conn_t *conn, runtime_t *rt,
 
 static bool process_sse_data(http_conn_t *conn, runtime_t *rt) {
     /* Look for \n (SSE lines are \n-terminated, may also use \r\n) */
-    for (size_t i = 0; i < conn->read_len; i++) {
-        if (conn->read_buf[i] == '\n') {
-            /* Check for \r\n */
-            size_t line_len = i;
-            if (line_len > 0 && conn->read_buf[line_len - 1] == '\r')
-                line_len--;
-
-            process_sse_line(conn, rt, (char *)conn->read_buf, line_len);
-            buf_consume(conn, i + 1);
-            return true;
-        }
-    }
-    return false;
+    char *line = (char *)buf_data(conn);
+    char *nl = memchr(line, '\n', conn->read_len);
+    if (!nl) return false;
+
+    size_t line_len = (size_t)(nl - line);
+    if (line_len > 0 && line[line_len - 1] == '\r')
+        line_len--;
+    process_sse_line(conn, rt, line, line_len);
+    buf_consume(conn, (size_t)(nl - line) + 1);
+    return true;
+}
+
+/* ── Server-side: keep-alive ───────────────────────────────────────── */
+
+bool http_conn_awaiting_request(const http_conn_t *conn) {
+    return conn->is_server && conn->conn_type == HTTP_CONN_SERVER &&
+           (conn->state == HTTP_STATE_SRV_RECV_REQUEST ||
+            conn->state == HTTP_STATE_SRV_RECV_HEADERS ||
+            conn->state == HTTP_STATE_SRV_RECV_BODY);
+}
+
+/* The owner has the request and is being sent its body */
+static bool srv_body_streaming(const http_conn_t *conn) {
+    return conn->is_server && conn->state == HTTP_STATE_SRV_RECV_BODY &&
+           conn->stream_head_sent;
+}
+
+/* Response written on a persistent conn: reset for the next request,
+   keeping the accumulator buffers for reuse */
+static void srv_next_request(http_conn_t *conn) {
+    free(conn->request_method);
+    conn->request_method = NULL;
+    free(conn->request_path);
+    conn->request_path = NULL;
+    clear_headers(conn);
+    conn->body_size = 0;
+    conn->content_length = -1;
+    conn->chunked = false;
+    conn->upgrade_ws = false;
+    conn->ws_accept_key[0] = '\0';
+    conn->stream_head_sent = false;
+    conn->stream_unacked = 0;
+    conn->want_write_ready = false;
+    conn->state = HTTP_STATE_SRV_RECV_REQUEST;
+    conn->last_active_ms = now_ms();
 }
 
 /* ── Server-side: request line parsing ──────────────────────────────── */
@@ -625,7 +1066,7 @@ static bool parse_request_line(http_conn_t *conn) {
     if (crlf < 0) return false;
 
     /* Parse "METHOD /path HTTP/1.x\r\n" */
-    char *line = (char *)conn->read_buf;
+    char *line = (char *)buf_data(conn);
 
     /* Find method */
     char *sp1 = memchr(line, ' ', (size_t)crlf);
@@ -642,6 +1083,11 @@ static bool parse_request_line(http_conn_t *conn) {
     size_t path_len = (size_t)(sp2 - path_start);
     conn->request_path = strndup(path_start, path_len);
 
+    /* HTTP/1.1 is persistent unless told otherwise; 1.0 must opt in */
+    size_t ver_len = (size_t)(line + crlf - (sp2 + 1));
+    conn->http10 = ver_len == 8 && strncmp(sp2 + 1, "HTTP/1.0", 8) == 0;
+    conn->keep_alive = !conn->http10;
+
     buf_consume(conn, (size_t)crlf + 2);
     conn->state = HTTP_STATE_SRV_RECV_HEADERS;
     conn->content_length = -1;
@@ -652,21 +1098,26 @@ static bool parse_request_line(http_conn_t *conn) {
 
 /* ── Server-side: header parsing ───────────────────────────────────── */
 
-static void deliver_http_request(http_conn_t *conn, runtime_t *rt) {
+/* head_only: the body will follow as a stream */
+static bool deliver_http_request(http_conn_t *conn, runtime_t *rt,
+                                 bool head_only) {
     size_t method_size = strlen(conn->request_method) + 1;
     size_t path_size = strlen(conn->request_path) + 1;
-    size_t total = sizeof(http_request_payload_t) + method_size + path_size +
-                   conn->headers_size + conn->body_size;
+    size_t body_size = head_only ? 0 : conn->body_size;
+    size_t end = sizeof(http_request_payload_t) + method_size + path_size +
+                 conn->headers_size + body_size;
+    size_t total = header_index_end(conn, end);
 
-    uint8_t *buf = malloc(total);
-    if (!buf) return;
+    uint8_t *buf = calloc(1, total);
+    if (!buf) return false;
 
     http_request_payload_t *p = (http_request_payload_t *)buf;
     p->conn_id = conn->id;
     p->method_size = method_size;
     p->path_size = path_size;
     p->headers_size = conn->headers_size;
-    p->body_size = conn->body_size;
+    p->body_size = body_size;
+    p->body_streamed = head_only;
 
     uint8_t *dst = buf + sizeof(*p);
     memcpy(dst, conn->request_method, method_size);
@@ -676,14 +1127,52 @@ static void deliver_http_request(http_conn_t *conn, runtime_t *rt) {
     if (conn->headers_buf && conn->headers_size > 0)
         memcpy(dst, conn->headers_buf, conn->headers_size);
     dst += conn->headers_size;
-    if (conn->body_buf && conn->body_size > 0)
-        memcpy(dst, conn->body_buf, conn->body_size);
+    if (conn->body_buf && body_size > 0)
+        memcpy(dst, conn->body_buf, body_size);
+    write_header_index(conn, buf, end);
 
-    runtime_deliver_msg(rt, conn->owner, MSG_HTTP_REQUEST, buf, total);
+    bool ok = runtime_deliver_msg(rt, conn->owner, MSG_HTTP_REQUEST,
+                                  buf, total);
     free(buf);
 
     /* Park connection — don't free request data yet, actor may need conn_id */
-    conn->state = HTTP_STATE_IDLE;
+    if (!head_only) conn->state = HTTP_STATE_IDLE;
+    return ok;
+}
+
+/* Digits only (trailing blanks allowed), in range; -1 if malformed */
+static int64_t parse_content_length(const char *val, size_t len) {
+    while (len > 0 && (val[len - 1] == ' ' || val[len - 1] == '\t')) len--;
+    if (len == 0) return -1;
+    int64_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (val[i] < '0' || val[i] > '9') return -1;
+        int digit = val[i] - '0';
+        if (n > (INT64_MAX - digit) / 10) return -1;
+        n = n * 10 + digit;
+    }
+    return n;
+}
+
+static bool conn_queue(http_conn_t *conn, const void *data, size_t len,
+                       bool capped);
+
+/* Where the body ends is unknown, so nothing after it can be parsed:
+   answer 400 and close once that is written */
+static void srv_bad_request(http_conn_t *conn) {
+    static const char resp[] = "HTTP/1.1 400 Bad Request\r\n"
+                               "Content-Length: 0\r\n"
+                               "Connection: close\r\n"
+                               "\r\n";
+    buf_consume(conn, conn->read_len);
+    conn->keep_alive = false;
+    if (conn_queue(conn, resp, sizeof(resp) - 1, false) &&
+        http_conn_has_output(conn)) {
+        conn->close_when_sent = true;
+        conn->state = HTTP_STATE_DONE;
+    } else {
+        conn->state = HTTP_STATE_ERROR;   /* written, or lost: close now */
+    }
 }
 
 static bool parse_server_header_line(http_conn_t *conn, runtime_t *rt) {
@@ -696,14 +1185,18 @@ static bool parse_server_header_line(http_conn_t *conn, runtime_t *rt) {
 
         if (conn->content_length > 0 || conn->chunked) {
             conn->state = HTTP_STATE_SRV_RECV_BODY;
+            conn->chunk_remaining = 0;
+            conn->in_chunk_data = false;
+            conn->in_trailer = false;
+            if (conn->stream) stream_head(conn, rt);
         } else {
-            deliver_http_request(conn, rt);
+            deliver_http_request(conn, rt, false);
         }
         return true;
     }
 
     /* Parse header line */
-    char *line = (char *)conn->read_buf;
+    char *line = (char *)buf_data(conn);
     char *colon = memchr(line, ':', (size_t)crlf);
 
     if (colon) {
@@ -714,7 +1207,13 @@ static bool parse_server_header_line(http_conn_t *conn, runtime_t *rt) {
         size_t val_len = (size_t)(line + crlf - val);
 
         if (name_len == 14 && strncasecmp(line, "Content-Length", 14) == 0) {
-            conn->content_length = strtol(val, NULL, 10);
+            int64_t len = parse_content_length(val, val_len);
+            if (len < 0 ||
+                (conn->content_length >= 0 && conn->content_length != len)) {
+                srv_bad_request(conn);
+                return false;
+            }
+            conn->content_length = len;
         } else if (name_len == 17 &&
                    strncasecmp(line, "Transfer-Encoding", 17) == 0) {
             if (val_len >= 7 && strncasecmp(val, "chunked", 7) == 0)
@@ -723,6 +1222,12 @@ static bool parse_server_header_line(http_conn_t *conn, runtime_t *rt) {
                    strncasecmp(line, "Upgrade", 7) == 0) {
             if (val_len >= 9 && strncasecmp(val, "websocket", 9) == 0)
                 conn->upgrade_ws = true;
+        } else if (name_len == 10 &&
+                   strncasecmp(line, "Connection", 10) == 0) {
+            if (has_token(val, val_len, "close"))
+                conn->keep_alive = false;
+            else if (has_token(val, val_len, "keep-alive"))
+                conn->keep_alive = true;
         } else if (name_len == 17 &&
                    strncasecmp(line, "Sec-WebSocket-Key", 17) == 0) {
             /* Compute accept key for server-side WS */
@@ -739,12 +1244,8 @@ static bool parse_server_header_line(http_conn_t *conn, runtime_t *rt) {
             conn->upgrade_ws = true;
         }
 
-        /* Accumulate header */
-        dyn_append((uint8_t **)&conn->headers_buf, &conn->headers_size,
-                   &conn->headers_cap, line, (size_t)crlf);
-        char nul = '\0';
-        dyn_append((uint8_t **)&conn->headers_buf, &conn->headers_size,
-                   &conn->headers_cap, &nul, 1);
+        add_header(conn, line, (size_t)crlf, name_len,
+                   (size_t)(val - line));
     }
 
     buf_consume(conn, (size_t)crlf + 2);
@@ -763,15 +1264,11 @@ static bool consume_server_body(http_conn_t *conn, runtime_t *rt) {
         if (avail > remaining) avail = remaining;
     }
 
-    if (avail > 0) {
-        dyn_append(&conn->body_buf, &conn->body_size, &conn->body_cap,
-                   conn->read_buf, avail);
-        buf_consume(conn, avail);
-    }
+    if (avail > 0) avail = take_body(conn, rt, avail);
 
     if (conn->content_length >= 0 &&
         conn->body_size >= (size_t)conn->content_length) {
-        deliver_http_request(conn, rt);
+        deliver_complete(conn, rt);
     }
 
     return avail > 0;
@@ -788,9 +1285,163 @@ static void deliver_conn_closed(http_conn_t *conn, runtime_t *rt) {
                         &payload, sizeof(payload));
 }
 
+/* A refused actor_http_write_chunk can be retried */
+static void deliver_write_ready(http_conn_t *conn, runtime_t *rt) {
+    conn->want_write_ready = false;
+    ws_status_payload_t payload = {
+        .conn_id = conn->id,
+        .close_code = 0
+    };
+    runtime_deliver_msg(rt, conn->owner, MSG_HTTP_WRITE_READY,
+                        &payload, sizeof(payload));
+}
+
+/* ── Outbound queue ────────────────────────────────────────────────── */
+
+/* Queue bytes for the peer.  What the socket takes at once is written
+   now; the rest waits in send_buf for POLLOUT, so a slow client never
+   stalls the runtime.  Streams (SSE, WebSocket) pass capped and are
+   refused once HTTP_SEND_BACKLOG_MAX bytes are waiting.  False on a
+   write error or a refused stream write. */
+static bool conn_queue(http_conn_t *conn, const void *data, size_t len,
+                       bool capped) {
+    const uint8_t *p = data;
+    if (!http_conn_has_output(conn)) {
+        conn->send_pos = conn->send_size = 0;
+        while (len > 0) {
+            ssize_t n = conn->sock->write(conn->sock, p, len);
+            if (n > 0) {
+                p += n;
+                len -= (size_t)n;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                return false;
+            }
+        }
+        if (len == 0) return true;
+    }
+
+    size_t pending = conn->send_size - conn->send_pos;
+    if (capped && pending + len > HTTP_SEND_BACKLOG_MAX) return false;
+    if (conn->send_pos > 0) {
+        memmove(conn->send_buf, conn->send_buf + conn->send_pos, pending);
+        conn->send_size = pending;
+        conn->send_pos = 0;
+    }
+    return dyn_append(&conn->send_buf, &conn->send_size, &conn->send_cap,
+                      p, len);
+}
+
+static void file_release(http_conn_t *conn) {
+    if (conn->file_left > 0) close(conn->file_fd);
+    conn->file_left = 0;
+}
+
+/* The file segment straight from the page cache to the socket: 1 once
+   sent, 0 if the socket is full, -1 on error */
+static int file_sendfile(http_conn_t *conn) {
+    while (conn->file_left > 0) {
+        ssize_t n = conn->sock->sendfile(conn->sock, conn->file_fd,
+                                          &conn->file_off, conn->file_left);
+        if (n > 0) {
+            conn->file_left -= (size_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1;   /* 0: the file shrank under us */
+        }
+    }
+    close(conn->file_fd);
+    return 1;
+}
+
+/* No sendfile on this socket (TLS): read the next piece of the file
+   into the empty send_buf, for the write loop to send */
+static int file_refill(http_conn_t *conn) {
+    size_t len = conn->file_left < HTTP_FILE_CHUNK
+                 ? conn->file_left : HTTP_FILE_CHUNK;
+    if (conn->send_cap < len) {
+        uint8_t *buf = realloc(conn->send_buf, len);
+        if (!buf) return -1;
+        conn->send_buf = buf;
+        conn->send_cap = len;
+    }
+    ssize_t n = pread(conn->file_fd, conn->send_buf, len, conn->file_off);
+    if (n <= 0) return -1;
+    conn->send_pos = 0;
+    conn->send_size = (size_t)n;
+    conn->file_off += n;
+    conn->file_left -= (size_t)n;
+    if (conn->file_left == 0) close(conn->file_fd);
+    return 1;
+}
+
+/* Write out what's queued, then any file segment: 1 once empty, 0 if
+   the socket is full, -1 on a write error */
+static int conn_flush(http_conn_t *conn) {
+    for (;;) {
+        while (conn->send_pos < conn->send_size) {
+            ssize_t n = conn->sock->write(conn->sock,
+                                           conn->send_buf + conn->send_pos,
+                                           conn->send_size - conn->send_pos);
+            if (n > 0) {
+                conn->send_pos += (size_t)n;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return 0;
+            } else {
+                return -1;
+            }
+        }
+        if (conn->file_left == 0) return 1;
+        int r = conn->sock->sendfile ? file_sendfile(conn)
+                                     : file_refill(conn);
+        if (r <= 0) return r;
+    }
+}
+
+/* A stream whose peer hung up, or fell HTTP_SEND_BACKLOG_MAX behind:
+   close it and tell the owner as for a disconnect */
+static void conn_lost(http_conn_t *conn, runtime_t *rt) {
+    http_state_t was = conn->state;
+    conn->send_pos = conn->send_size = 0;
+    file_release(conn);
+    if (conn->sock) {
+        conn->sock->close(conn->sock);
+        conn->sock = NULL;
+    }
+    conn->state = HTTP_STATE_DONE;
+    if (was == HTTP_STATE_WS_ACTIVE)
+        deliver_ws_closed(conn, rt, 1006);
+    else if (was == HTTP_STATE_SRV_SSE_ACTIVE ||
+             was == HTTP_STATE_SRV_CHUNKED ||
+             (was == HTTP_STATE_SRV_RECV_BODY && conn->stream_head_sent))
+        deliver_conn_closed(conn, rt);
+}
+
+short http_conn_poll_events(const http_conn_t *conn) {
+    if (!conn->sock) return 0;
+    if (conn->state == HTTP_STATE_CONNECTING) return POLLOUT;
+    short events = http_conn_has_output(conn) ? POLLOUT : 0;
+    switch (conn->state) {
+    case HTTP_STATE_IDLE:
+    case HTTP_STATE_SENDING:
+    case HTTP_STATE_SRV_SENDING:
+    case HTTP_STATE_SRV_CHUNKED:
+    case HTTP_STATE_DONE:
+    case HTTP_STATE_ERROR:
+        break;
+    default:
+        /* A stream reads no further than its owner takes */
+        if (!http_conn_stream_held(conn)) events |= POLLIN;
+        break;
+    }
+    return events;
+}
+
 /* ── WebSocket data processing ─────────────────────────────────────── */
 
-static bool send_ws_frame(http_conn_t *conn, uint8_t opcode,
+static bool send_ws_frame(http_conn_t *conn, runtime_t *rt, uint8_t opcode,
                           const uint8_t *payload, size_t len) {
     uint8_t frame[14 + 125]; /* small inline buffer for control frames */
     uint8_t *buf;
@@ -810,24 +1461,10 @@ static bool send_ws_frame(http_conn_t *conn, uint8_t opcode,
     else
         frame_size = ws_frame_build(opcode, true, payload, len, buf);
 
-    /* Blocking write */
-    size_t written = 0;
-    while (written < frame_size) {
-        ssize_t n = conn->sock->write(conn->sock,
-                                       buf + written, frame_size - written);
-        if (n > 0) {
-            written += (size_t)n;
-        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            /* Spin briefly — for small frames this should resolve quickly */
-            continue;
-        } else {
-            if (heap) free(buf);
-            return false;
-        }
-    }
-
+    bool ok = conn_queue(conn, buf, frame_size, true);
     if (heap) free(buf);
-    return true;
+    if (!ok) conn_lost(conn, rt);
+    return ok;
 }
 
 /* Max single WS frame we'll buffer dynamically (64 KB) */
@@ -854,7 +1491,7 @@ static bool process_ws_data(http_conn_t *conn, runtime_t *rt) {
     if (conn->read_len < 2) return false;
 
     ws_frame_info_t info;
-    int hdr_len = ws_frame_parse_header(conn->read_buf, conn->read_len, &info);
+    int hdr_len = ws_frame_parse_header(buf_data(conn), conn->read_len, &info);
     if (hdr_len < 0) {
         conn->state = HTTP_STATE_ERROR;
         deliver_ws_error(conn, rt);
@@ -884,10 +1521,10 @@ static bool process_ws_data(http_conn_t *conn, runtime_t *rt) {
             return false;
         }
         /* Copy what we have so far into the large buffer */
-        memcpy(conn->ws_large_buf, conn->read_buf, conn->read_len);
+        memcpy(conn->ws_large_buf, buf_data(conn), conn->read_len);
         conn->ws_large_size = total_frame;
         conn->ws_large_offset = conn->read_len;
-        conn->read_len = 0;
+        buf_consume(conn, conn->read_len);
 
         /* Drain any TLS-buffered data immediately — poll() won't
          * fire if the remaining bytes are in the TLS decrypt buffer
@@ -919,7 +1556,7 @@ static bool process_ws_data(http_conn_t *conn, runtime_t *rt) {
 
     if (conn->read_len < total_frame) return false;
 
-    process_ws_frame(conn, rt, conn->read_buf, total_frame);
+    process_ws_frame(conn, rt, buf_data(conn), total_frame);
     buf_consume(conn, total_frame);
     return true;
 }
@@ -957,14 +1594,14 @@ static void process_ws_frame(http_conn_t *conn, runtime_t *rt,
             close_len = ws_frame_build_close_unmasked(code, NULL, 0, close_frame);
         else
             close_len = ws_frame_build_close(code, NULL, 0, close_frame);
-        conn->sock->write(conn->sock, close_frame, close_len);
+        conn_queue(conn, close_frame, close_len, false);
         conn->state = HTTP_STATE_DONE;
         deliver_ws_closed(conn, rt, code);
         break;
     }
     case WS_OPCODE_PING:
         /* Auto-respond with pong */
-        send_ws_frame(conn, WS_OPCODE_PONG, payload, plen);
+        send_ws_frame(conn, rt, WS_OPCODE_PONG, payload, plen);
         break;
     case WS_OPCODE_PONG:
         /* Ignore pong */
@@ -976,55 +1613,121 @@ static void process_ws_frame(http_conn_t *conn, runtime_t *rt,
 
 /* ── Main driver ───────────────────────────────────────────────────── */
 
-void http_conn_drive(http_conn_t *conn, short revents, runtime_t *rt) {
-    if (conn->state == HTTP_STATE_DONE || conn->state == HTTP_STATE_ERROR)
+/* Run the state machine over whatever is buffered */
+static void process_buffered(http_conn_t *conn, runtime_t *rt) {
+    bool progress = true;
+    while (progress && conn->read_len > 0 && !conn->stream_blocked) {
+        progress = false;
+        switch (conn->state) {
+        case HTTP_STATE_RECV_STATUS:
+            progress = parse_status_line(conn);
+            break;
+        case HTTP_STATE_RECV_HEADERS:
+            progress = parse_header_line(conn, rt);
+            break;
+        case HTTP_STATE_BODY_CONTENT:
+            progress = consume_body_content(conn, rt);
+            break;
+        case HTTP_STATE_BODY_CHUNKED:
+            progress = consume_body_chunked(conn, rt);
+            break;
+        case HTTP_STATE_BODY_STREAM:
+            progress = process_sse_data(conn, rt);
+            break;
+        case HTTP_STATE_WS_ACTIVE:
+            progress = process_ws_data(conn, rt);
+            break;
+        case HTTP_STATE_SRV_RECV_REQUEST:
+            progress = parse_request_line(conn);
+            break;
+        case HTTP_STATE_SRV_RECV_HEADERS:
+            progress = parse_server_header_line(conn, rt);
+            break;
+        case HTTP_STATE_SRV_RECV_BODY:
+            progress = conn->chunked ? consume_body_chunked(conn, rt)
+                                     : consume_server_body(conn, rt);
+            break;
+        case HTTP_STATE_SRV_SSE_ACTIVE:
+            /* Only here to detect client disconnect; data is irrelevant */
+            buf_consume(conn, conn->read_len);
+            progress = false;
+            break;
+        default:
+            progress = false;
+            break;
+        }
+    }
+}
+
+/* Server response fully written */
+static void srv_response_sent(http_conn_t *conn, runtime_t *rt) {
+    if (!conn->keep_alive) {
+        actor_http_close(rt, conn->id);
         return;
+    }
+    /* Next request: any pipelined behind this one is already buffered */
+    srv_next_request(conn);
+    process_buffered(conn, rt);
+    if (conn->state == HTTP_STATE_ERROR) actor_http_close(rt, conn->id);
+}
 
-    /* Handle POLLOUT for sending (client request or server response) */
-    if ((revents & POLLOUT) &&
-        (conn->state == HTTP_STATE_SENDING ||
-         conn->state == HTTP_STATE_SRV_SENDING)) {
-        while (conn->send_pos < conn->send_size) {
-            ssize_t n = conn->sock->write(conn->sock,
-                                           conn->send_buf + conn->send_pos,
-                                           conn->send_size - conn->send_pos);
-            if (n > 0) {
-                conn->send_pos += (size_t)n;
-            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-                return; /* try again next poll */
-            } else {
-                conn_error(conn, rt, "write error");
-                return;
-            }
+/* Everything queued is out */
+static void output_drained(http_conn_t *conn, runtime_t *rt) {
+    if (conn->close_when_sent) {
+        actor_http_close(rt, conn->id);
+    } else if (conn->state == HTTP_STATE_SENDING) {
+        /* A pooled socket keeps the request until the reply starts, in
+           case it has to be resent */
+        if (!conn->reused) {
+            free(conn->send_buf);
+            conn->send_buf = NULL;
+            conn->send_size = 0;
+            conn->send_pos = 0;
+            conn->send_cap = 0;
         }
-        /* Fully sent */
-        free(conn->send_buf);
-        conn->send_buf = NULL;
-        conn->send_size = 0;
-        conn->send_pos = 0;
+        conn->state = HTTP_STATE_RECV_STATUS;
+    } else if (conn->state == HTTP_STATE_SRV_SENDING) {
+        srv_response_sent(conn, rt);
+    } else if (conn->state == HTTP_STATE_SRV_CHUNKED &&
+               conn->want_write_ready) {
+        deliver_write_ready(conn, rt);
+    }
+}
 
-        if (conn->state == HTTP_STATE_SENDING) {
-            conn->state = HTTP_STATE_RECV_STATUS;
-        } else {
-            /* SRV_SENDING complete — next state depends on conn_type */
-            switch (conn->conn_type) {
-            case HTTP_CONN_SERVER:
-                conn->state = HTTP_STATE_DONE;
-                break;
-            case HTTP_CONN_SERVER_SSE:
-                conn->state = HTTP_STATE_SRV_SSE_ACTIVE;
-                break;
-            case HTTP_CONN_SERVER_WS:
-                conn->state = HTTP_STATE_WS_ACTIVE;
-                deliver_ws_open(conn, rt);
-                break;
-            default:
-                conn->state = HTTP_STATE_DONE;
-                break;
+static void drive_conn(http_conn_t *conn, short revents, runtime_t *rt) {
+    /* Connected (or refused): the request goes out on this same POLLOUT */
+    if (conn->state == HTTP_STATE_CONNECTING) {
+        connect_done(conn, rt);
+        if (conn->state != HTTP_STATE_SENDING) return;
+        revents = POLLOUT;
+    }
+
+    /* Flush queued output: client request, server response, SSE events,
+       WS frames (a closing WS conn may still have its close frame) */
+    if ((revents & POLLOUT) && http_conn_has_output(conn)) {
+        int r = conn_flush(conn);
+        conn->last_active_ms = now_ms();
+        if (r < 0) {
+            if (conn->state == HTTP_STATE_SENDING) {
+                if (!(conn->reused && retry_fresh(conn, rt)))
+                    conn_error(conn, rt, "write error");
+            } else if (conn->state == HTTP_STATE_SRV_SENDING ||
+                       conn->close_when_sent) {
+                actor_http_close(rt, conn->id);
+            } else {
+                conn_lost(conn, rt);
             }
+            return;
+        }
+        if (r > 0) {
+            output_drained(conn, rt);
+            if (conn->id == HTTP_CONN_ID_INVALID) return;
         }
     }
 
+    if (conn->state == HTTP_STATE_DONE || conn->state == HTTP_STATE_ERROR)
+        return;
+
     /* Handle POLLIN for receiving */
     if (revents & (POLLIN | POLLHUP | POLLERR)) {
         /* Large WS frame accumulation — read directly into dynamic buffer.
@@ -1062,20 +1765,36 @@ void http_conn_drive(http_conn_t *conn, short revents, runtime_t *rt) {
         }
 
         /* Read into buffer */
-        size_t space = HTTP_READ_BUF_SIZE - conn->read_len;
+        if (!conn->read_buf) {
+            conn->read_buf = http_table_buf_get(runtime_get_http_table(rt));
+            if (!conn->read_buf) return;   /* retried on the next poll */
+        }
+        if (conn->read_pos > 0 &&
+            conn->read_pos + conn->read_len == HTTP_READ_BUF_SIZE)
+            buf_compact(conn);
+        size_t space = HTTP_READ_BUF_SIZE - conn->read_pos - conn->read_len;
         if (space > 0) {
             ssize_t n = conn->sock->read(conn->sock,
-                                          conn->read_buf + conn->read_len,
+                                          buf_data(conn) + conn->read_len,
                                           space);
             if (n > 0) {
                 conn->read_len += (size_t)n;
+                if (conn->is_server) conn->last_active_ms = now_ms();
+                if (conn->reused) {
+                    conn->reused = false;
+                    free(conn->send_buf);
+                    conn->send_buf = NULL;
+                    conn->send_size = 0;
+                    conn->send_pos = 0;
+                    conn->send_cap = 0;
+                }
             } else if (n == 0) {
                 /* EOF */
                 if (conn->state == HTTP_STATE_BODY_CONTENT &&
                     conn->content_length < 0) {
                     /* Reading until close */
                     conn->state = HTTP_STATE_DONE;
-                    deliver_http_response(conn, rt);
+                    deliver_complete(conn, rt);
                     return;
                 } else if (conn->state == HTTP_STATE_BODY_STREAM) {
                     conn->state = HTTP_STATE_DONE;
@@ -1089,127 +1808,154 @@ void http_conn_drive(http_conn_t *conn, short revents, runtime_t *rt) {
                     conn->state = HTTP_STATE_DONE;
                     deliver_conn_closed(conn, rt);
                     return;
-                } else if (conn->state == HTTP_STATE_SRV_RECV_REQUEST ||
-                           conn->state == HTTP_STATE_SRV_RECV_HEADERS ||
-                           conn->state == HTTP_STATE_SRV_RECV_BODY) {
-                    conn->state = HTTP_STATE_DONE;
+                } else if (srv_body_streaming(conn)) {
+                    conn_lost(conn, rt);
+                    return;
+                } else if (http_conn_awaiting_request(conn) ||
+                           conn->state == HTTP_STATE_SRV_SENDING) {
+                    /* Client done with a persistent conn: free the slot */
+                    actor_http_close(rt, conn->id);
+                    return;
+                } else if (conn->reused && conn->idempotent &&
+                           retry_fresh(conn, rt)) {
                     return;
                 } else {
                     conn_error(conn, rt, "unexpected EOF");
                     return;
                 }
             } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                conn_error(conn, rt, "read error");
+                if (srv_body_streaming(conn))
+                    conn_lost(conn, rt);
+                else if (http_conn_awaiting_request(conn) ||
+                    conn->state == HTTP_STATE_SRV_SENDING)
+                    actor_http_close(rt, conn->id);
+                else if (!(conn->reused && conn->idempotent &&
+                           retry_fresh(conn, rt)))
+                    conn_error(conn, rt, "read error");
                 return;
             }
         }
 
-        /* Process buffered data */
-        bool progress = true;
-        while (progress && conn->read_len > 0) {
-            progress = false;
-            switch (conn->state) {
-            case HTTP_STATE_RECV_STATUS:
-                progress = parse_status_line(conn);
-                break;
-            case HTTP_STATE_RECV_HEADERS:
-                progress = parse_header_line(conn, rt);
-                break;
-            case HTTP_STATE_BODY_CONTENT:
-                progress = consume_body_content(conn, rt);
-                break;
-            case HTTP_STATE_BODY_CHUNKED:
-                progress = consume_body_chunked(conn, rt);
-                break;
-            case HTTP_STATE_BODY_STREAM:
-                progress = process_sse_data(conn, rt);
-                break;
-            case HTTP_STATE_WS_ACTIVE:
-                progress = process_ws_data(conn, rt);
-                break;
-            case HTTP_STATE_SRV_RECV_REQUEST:
-                progress = parse_request_line(conn);
-                break;
-            case HTTP_STATE_SRV_RECV_HEADERS:
-                progress = parse_server_header_line(conn, rt);
-                break;
-            case HTTP_STATE_SRV_RECV_BODY:
-                progress = consume_server_body(conn, rt);
-                break;
-            case HTTP_STATE_SRV_SSE_ACTIVE:
-                /* Only here to detect client disconnect; data is irrelevant */
-                conn->read_len = 0;
-                progress = false;
-                break;
-            default:
-                progress = false;
-                break;
-            }
-        }
+        process_buffered(conn, rt);
+
+        /* Nobody holds a malformed request's conn: drop it */
+        if (conn->is_server && conn->conn_type == HTTP_CONN_SERVER &&
+            conn->state == HTTP_STATE_ERROR)
+            actor_http_close(rt, conn->id);
     }
 }
 
+void http_conn_drive(http_conn_t *conn, short revents, runtime_t *rt) {
+    drive_conn(conn, revents, rt);
+    release_read_buf(conn, rt);
+}
+
+bool http_conn_resume(http_conn_t *conn, runtime_t *rt) {
+    bool head_sent = conn->stream_head_sent;
+    size_t delivered = conn->body_size;
+    conn->stream_blocked = false;   /* set again if the mailbox is still full */
+    if (conn->stream_final_pending)
+        deliver_complete(conn, rt);
+    else if (stream_head(conn, rt))
+        process_buffered(conn, rt);
+    release_read_buf(conn, rt);
+    return conn->stream_head_sent != head_sent ||
+           conn->body_size != delivered || !conn->stream_blocked;
+}
+
 /* ── Connection allocation ─────────────────────────────────────────── */
 
 static http_conn_t *alloc_conn(runtime_t *rt) {
-    http_conn_t *conns = runtime_get_http_conns(rt);
-    size_t max = runtime_get_max_http_conns();
-    for (size_t i = 0; i < max; i++) {
-        if (conns[i].id == HTTP_CONN_ID_INVALID) {
-            memset(&conns[i], 0, sizeof(http_conn_t));
-            conns[i].id = runtime_alloc_http_conn_id(rt);
-            conns[i].owner = runtime_current_actor_id(rt);
-            conns[i].content_length = -1;
-            return &conns[i];
-        }
-    }
-    return NULL;
+    http_conn_t *conn = http_table_alloc(runtime_get_http_table(rt));
+    if (!conn) return NULL;
+    conn->owner = runtime_current_actor_id(rt);
+    conn->content_length = -1;
+    return conn;
+}
+
+static http_conn_t *find_conn(runtime_t *rt, http_conn_id_t id) {
+    return http_table_get(runtime_get_http_table(rt), id);
 }
 
 /* ── Actor APIs ────────────────────────────────────────────────────── */
 
-http_conn_id_t actor_http_fetch(runtime_t *rt, const char *method,
+static http_conn_t *start_fetch(runtime_t *rt, const char *method,
                                 const char *url, const char *const *headers,
                                 size_t n_headers, const void *body,
                                 size_t body_size) {
     parsed_url_t parsed;
-    if (!url_parse(url, &parsed)) return HTTP_CONN_ID_INVALID;
-
-    uint16_t port = url_effective_port(&parsed);
-#ifdef HAVE_TLS
-    mk_socket_t *sock = url_is_tls(&parsed)
-        ? mk_socket_tls_connect(parsed.host, port)
-        : mk_socket_tcp_connect(parsed.host, port);
-#else
-    if (url_is_tls(&parsed)) return HTTP_CONN_ID_INVALID;
-    mk_socket_t *sock = mk_socket_tcp_connect(parsed.host, port);
-#endif
-    if (!sock) return HTTP_CONN_ID_INVALID;
+    if (!url_parse(url, &parsed)) return NULL;
 
     http_conn_t *conn = alloc_conn(rt);
-    if (!conn) {
-        sock->close(sock);
-        return HTTP_CONN_ID_INVALID;
-    }
+    if (!conn) return NULL;
 
-    conn->sock = sock;
     conn->conn_type = HTTP_CONN_HTTP;
+    conn->idempotent = method_idempotent(method);
+    conn->head_request = strcasecmp(method, "HEAD") == 0;
 
     /* Build request */
     conn->send_buf = build_http_request(method, &parsed, headers, n_headers,
                                         body, body_size, false,
                                         &conn->send_size);
-    if (!conn->send_buf) {
-        sock->close(sock);
-        conn->id = HTTP_CONN_ID_INVALID;
-        return HTTP_CONN_ID_INVALID;
+    if (!conn->send_buf || !conn_target(conn, &parsed)) {
+        http_conn_free(rt, conn);
+        return NULL;
     }
+    conn->send_cap = conn->send_size;
     conn->send_pos = 0;
-    conn->state = HTTP_STATE_SENDING;
 
+    /* Reuse an idle connection to the same scheme://host:port if any */
+    char key[HTTP_POOL_KEY_MAX];
+    make_pool_key(&parsed, key);
+    conn->pool_key = strdup(key);    /* not pooled if this fails */
+    conn->sock = pool_take(rt, key);
+    conn->reused = conn->sock != NULL;
+    if (conn->reused) {
+        conn->state = HTTP_STATE_SENDING;
+    } else if (!conn_connect(conn, rt)) {
+        http_conn_free(rt, conn);
+        return NULL;
+    }
+
+    return conn;
+}
+
+http_conn_id_t actor_http_fetch(runtime_t *rt, const char *method,
+                                const char *url, const char *const *headers,
+                                size_t n_headers, const void *body,
+                                size_t body_size) {
+    http_conn_t *conn = start_fetch(rt, method, url, headers, n_headers,
+                                    body, body_size);
+    return conn ? conn->id : HTTP_CONN_ID_INVALID;
+}
+
+http_conn_id_t actor_http_fetch_stream(runtime_t *rt, const char *method,
+                                       const char *url,
+                                       const char *const *headers,
+                                       size_t n_headers, const void *body,
+                                       size_t body_size, size_t window) {
+    http_conn_t *conn = start_fetch(rt, method, url, headers, n_headers,
+                                    body, body_size);
+    if (!conn) return HTTP_CONN_ID_INVALID;
+    conn->stream = true;
+    conn->stream_window = window ? window : HTTP_STREAM_WINDOW;
     return conn->id;
 }
 
+bool actor_http_body_ack(runtime_t *rt, http_conn_id_t id, size_t bytes) {
+    http_conn_t *conn = find_conn(rt, id);
+    if (!conn || !conn->stream) return false;
+    if (bytes > conn->stream_unacked) bytes = conn->stream_unacked;
+    conn->stream_unacked -= bytes;
+    if (conn->is_server) conn->last_active_ms = now_ms();
+    /* Body already read but held back by the window */
+    if (!conn->stream_blocked) {
+        process_buffered(conn, rt);
+        release_read_buf(conn, rt);
+    }
+    return true;
+}
+
 http_conn_id_t actor_http_get(runtime_t *rt, const char *url) {
     return actor_http_fetch(rt, "GET", url, NULL, 0, NULL, 0);
 }
@@ -1218,35 +1964,23 @@ http_conn_id_t actor_sse_connect(runtime_t *rt, const char *url) {
     parsed_url_t parsed;
     if (!url_parse(url, &parsed)) return HTTP_CONN_ID_INVALID;
 
-    uint16_t port = url_effective_port(&parsed);
-#ifdef HAVE_TLS
-    mk_socket_t *sock = url_is_tls(&parsed)
-        ? mk_socket_tls_connect(parsed.host, port)
-        : mk_socket_tcp_connect(parsed.host, port);
-#else
-    if (url_is_tls(&parsed)) return HTTP_CONN_ID_INVALID;
-    mk_socket_t *sock = mk_socket_tcp_connect(parsed.host, port);
-#endif
-    if (!sock) return HTTP_CONN_ID_INVALID;
-
     http_conn_t *conn = alloc_conn(rt);
-    if (!conn) {
-        sock->close(sock);
-        return HTTP_CONN_ID_INVALID;
-    }
+    if (!conn) return HTTP_CONN_ID_INVALID;
 
-    conn->sock = sock;
     conn->conn_type = HTTP_CONN_SSE;
 
     conn->send_buf = build_http_request("GET", &parsed, NULL, 0,
                                         NULL, 0, true, &conn->send_size);
-    if (!conn->send_buf) {
-        sock->close(sock);
-        conn->id = HTTP_CONN_ID_INVALID;
+    if (!conn->send_buf || !conn_target(conn, &parsed)) {
+        http_conn_free(rt, conn);
         return HTTP_CONN_ID_INVALID;
     }
+    conn->send_cap = conn->send_size;
     conn->send_pos = 0;
-    conn->state = HTTP_STATE_SENDING;
+    if (!conn_connect(conn, rt)) {
+        http_conn_free(rt, conn);
+        return HTTP_CONN_ID_INVALID;
+    }
 
     return conn->id;
 }
@@ -1255,35 +1989,23 @@ http_conn_id_t actor_ws_connect(runtime_t *rt, const char *url) {
     parsed_url_t parsed;
     if (!url_parse(url, &parsed)) return HTTP_CONN_ID_INVALID;
 
-    uint16_t port = url_effective_port(&parsed);
-#ifdef HAVE_TLS
-    mk_socket_t *sock = (strcmp(parsed.scheme, "wss") == 0)
-        ? mk_socket_tls_connect(parsed.host, port)
-        : mk_socket_tcp_connect(parsed.host, port);
-#else
-    if (strcmp(parsed.scheme, "wss") == 0) return HTTP_CONN_ID_INVALID;
-    mk_socket_t *sock = mk_socket_tcp_connect(parsed.host, port);
-#endif
-    if (!sock) return HTTP_CONN_ID_INVALID;
-
     http_conn_t *conn = alloc_conn(rt);
-    if (!conn) {
-        sock->close(sock);
-        return HTTP_CONN_ID_INVALID;
-    }
+    if (!conn) return HTTP_CONN_ID_INVALID;
 
-    conn->sock = sock;
     conn->conn_type = HTTP_CONN_WS;
 
     conn->send_buf = build_ws_handshake(&parsed, conn->ws_accept_key,
                                         &conn->send_size);
-    if (!conn->send_buf) {
-        sock->close(sock);
-        conn->id = HTTP_CONN_ID_INVALID;
+    if (!conn->send_buf || !conn_target(conn, &parsed)) {
+        http_conn_free(rt, conn);
         return HTTP_CONN_ID_INVALID;
     }
+    conn->send_cap = conn->send_size;
     conn->send_pos = 0;
-    conn->state = HTTP_STATE_SENDING;
+    if (!conn_connect(conn, rt)) {
+        http_conn_free(rt, conn);
+        return HTTP_CONN_ID_INVALID;
+    }
 
     return conn->id;
 }
@@ -1296,6 +2018,7 @@ static const char *http_status_reason(int code) {
     case 200: return "OK";
     case 201: return "Created";
     case 204: return "No Content";
+    case 206: return "Partial Content";
     case 301: return "Moved Permanently";
     case 302: return "Found";
     case 304: return "Not Modified";
@@ -1303,6 +2026,7 @@ static const char *http_status_reason(int code) {
     case 403: return "Forbidden";
     case 404: return "Not Found";
     case 405: return "Method Not Allowed";
+    case 416: return "Range Not Satisfiable";
     case 500: return "Internal Server Error";
     default:  return "Unknown";
     }
@@ -1310,7 +2034,7 @@ static const char *http_status_reason(int code) {
 
 /* ── Server-side actor APIs ────────────────────────────────────────── */
 
-bool actor_http_listen(runtime_t *rt, uint16_t port) {
+static bool listen_port(runtime_t *rt, uint16_t port, size_t stream_window) {
     actor_id_t owner = runtime_current_actor_id(rt);
     if (owner == ACTOR_ID_INVALID) return false;
 
@@ -1343,7 +2067,7 @@ bool actor_http_listen(runtime_t *rt, uint16_t port) {
         return false;
     }
 
-    if (listen(fd, 16) < 0) {
+    if (listen(fd, SOMAXCONN) < 0) {
         close(fd);
         return false;
     }
@@ -1355,9 +2079,18 @@ bool actor_http_listen(runtime_t *rt, uint16_t port) {
     slot->listen_fd = fd;
     slot->port = port;
     slot->owner = owner;
+    slot->stream_window = stream_window;
     return true;
 }
 
+bool actor_http_listen(runtime_t *rt, uint16_t port) {
+    return listen_port(rt, port, 0);
+}
+
+bool actor_http_listen_stream(runtime_t *rt, uint16_t port, size_t window) {
+    return listen_port(rt, port, window ? window : HTTP_STREAM_WINDOW);
+}
+
 bool actor_http_unlisten(runtime_t *rt, uint16_t port) {
     actor_id_t owner = runtime_current_actor_id(rt);
     if (owner == ACTOR_ID_INVALID) return false;
@@ -1375,73 +2108,213 @@ bool actor_http_unlisten(runtime_t *rt, uint16_t port) {
     return false;
 }
 
-bool actor_http_respond(runtime_t *rt, http_conn_id_t conn_id,
-                        int status_code,
-                        const char *const *headers, size_t n_headers,
-                        const void *body, size_t body_size) {
-    http_conn_t *conns = runtime_get_http_conns(rt);
-    size_t max = runtime_get_max_http_conns();
-    http_conn_t *conn = NULL;
-    for (size_t i = 0; i < max; i++) {
-        if (conns[i].id == conn_id) { conn = &conns[i]; break; }
-    }
-    if (!conn || conn->state != HTTP_STATE_IDLE || !conn->is_server) return false;
-
-    /* Build response: "HTTP/1.1 STATUS Reason\r\n" + headers + body */
-    size_t cap = 256 + body_size;
+/* Room for the status line, headers and framing headers */
+static size_t response_head_cap(const char *const *headers, size_t n_headers) {
+    size_t cap = 256;
     for (size_t i = 0; i < n_headers; i++)
         cap += strlen(headers[i]) + 4;
+    return cap;
+}
 
-    uint8_t *buf = malloc(cap);
-    if (!buf) return false;
-
+/* "HTTP/1.1 STATUS Reason\r\n" + headers + Connection, without the
+   framing header or the blank line; returns the length */
+static int format_response_head(http_conn_t *conn, uint8_t *buf, size_t cap,
+                                int status_code, const char *const *headers,
+                                size_t n_headers) {
     int pos = snprintf((char *)buf, cap, "HTTP/1.1 %d %s\r\n",
                        status_code, http_status_reason(status_code));
 
+    /* The actor may close the conn itself with its own Connection header */
+    bool own_connection = false;
     for (size_t i = 0; i < n_headers; i++) {
         pos += snprintf((char *)buf + pos, cap - (size_t)pos,
                         "%s\r\n", headers[i]);
+        if (strncasecmp(headers[i], "Connection:", 11) == 0) {
+            own_connection = true;
+            const char *val = headers[i] + 11;
+            if (has_token(val, strlen(val), "close"))
+                conn->keep_alive = false;
+        }
+    }
+    if (!own_connection) {
+        pos += snprintf((char *)buf + pos, cap - (size_t)pos,
+                        "Connection: %s\r\n",
+                        conn->keep_alive ? "keep-alive" : "close");
+    }
+    return pos;
+}
+
+/* A response to HEAD carries the head alone; a body would be read as
+   the start of the next response on a persistent conn */
+static bool head_request(const http_conn_t *conn) {
+    return conn->request_method && strcmp(conn->request_method, "HEAD") == 0;
+}
+
+/* Response queued in full: wait for it to drain, or go on to the next
+   request */
+static void srv_response_queued(http_conn_t *conn, runtime_t *rt) {
+    if (http_conn_has_output(conn)) {
+        conn->state = HTTP_STATE_SRV_SENDING;
+        conn->last_active_ms = now_ms();
+        return;
     }
+    srv_response_sent(conn, rt);
+    release_read_buf(conn, rt);   /* no-op if the conn was closed */
+}
+
+bool actor_http_respond(runtime_t *rt, http_conn_id_t conn_id,
+                        int status_code,
+                        const char *const *headers, size_t n_headers,
+                        const void *body, size_t body_size) {
+    http_conn_t *conn = find_conn(rt, conn_id);
+    if (!conn || conn->state != HTTP_STATE_IDLE || !conn->is_server) return false;
 
+    /* Build response: head + Content-Length + body */
+    size_t cap = response_head_cap(headers, n_headers) + body_size;
+    uint8_t *buf = malloc(cap);
+    if (!buf) return false;
+
+    int pos = format_response_head(conn, buf, cap, status_code,
+                                   headers, n_headers);
     pos += snprintf((char *)buf + pos, cap - (size_t)pos,
                     "Content-Length: %zu\r\n"
-                    "Connection: close\r\n"
                     "\r\n", body_size);
 
-    if (body && body_size > 0) {
+    if (body && body_size > 0 && !head_request(conn)) {
         memcpy(buf + pos, body, body_size);
         pos += (int)body_size;
     }
 
-    /* Blocking write — ensures response is sent before actor can stop */
-    size_t total = (size_t)pos;
-    size_t written = 0;
-    while (written < total) {
-        ssize_t n = conn->sock->write(conn->sock,
-                                       buf + written, total - written);
-        if (n > 0) {
-            written += (size_t)n;
-        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            continue;
-        } else {
-            free(buf);
-            conn->state = HTTP_STATE_DONE;
-            return false;
-        }
+    /* Whatever the socket doesn't take now is flushed on POLLOUT */
+    bool ok = conn_queue(conn, buf, (size_t)pos, false);
+    free(buf);
+    if (!ok) {
+        actor_http_close(rt, conn_id);
+        return false;
     }
+    srv_response_queued(conn, rt);
+    return true;
+}
 
+bool actor_http_respond_file(runtime_t *rt, http_conn_id_t conn_id,
+                             int status_code,
+                             const char *const *headers, size_t n_headers,
+                             int fd, off_t offset, size_t len) {
+    http_conn_t *conn = find_conn(rt, conn_id);
+    if (!conn || conn->state != HTTP_STATE_IDLE || !conn->is_server) return false;
+
+    /* HEAD gets the Content-Length of the file but none of it */
+    bool body = len > 0 && !head_request(conn);
+    int file_fd = body ? dup(fd) : -1;
+    if (body && file_fd < 0) return false;
+
+    size_t cap = response_head_cap(headers, n_headers);
+    uint8_t *buf = malloc(cap);
+    if (!buf) {
+        if (file_fd >= 0) close(file_fd);
+        return false;
+    }
+    int pos = format_response_head(conn, buf, cap, status_code,
+                                   headers, n_headers);
+    pos += snprintf((char *)buf + pos, cap - (size_t)pos,
+                    "Content-Length: %zu\r\n"
+                    "\r\n", len);
+
+    bool ok = conn_queue(conn, buf, (size_t)pos, false);
     free(buf);
-    conn->state = HTTP_STATE_DONE;
+    if (ok && body) {
+        conn->file_fd = file_fd;
+        conn->file_off = offset;
+        conn->file_left = len;
+        ok = conn_flush(conn) >= 0;
+    } else if (file_fd >= 0) {
+        close(file_fd);
+    }
+    if (!ok) {
+        actor_http_close(rt, conn_id);
+        return false;
+    }
+    srv_response_queued(conn, rt);
     return true;
 }
 
-bool actor_sse_start(runtime_t *rt, http_conn_id_t conn_id) {
-    http_conn_t *conns = runtime_get_http_conns(rt);
-    size_t max = runtime_get_max_http_conns();
-    http_conn_t *conn = NULL;
-    for (size_t i = 0; i < max; i++) {
-        if (conns[i].id == conn_id) { conn = &conns[i]; break; }
+bool actor_http_respond_start(runtime_t *rt, http_conn_id_t conn_id,
+                              int status_code,
+                              const char *const *headers, size_t n_headers) {
+    http_conn_t *conn = find_conn(rt, conn_id);
+    if (!conn || conn->state != HTTP_STATE_IDLE || !conn->is_server) return false;
+
+    /* An HTTP/1.0 client can't take chunks: the body ends at close */
+    if (conn->http10) conn->keep_alive = false;
+
+    size_t cap = response_head_cap(headers, n_headers);
+    uint8_t *buf = malloc(cap);
+    if (!buf) return false;
+
+    int pos = format_response_head(conn, buf, cap, status_code,
+                                   headers, n_headers);
+    pos += snprintf((char *)buf + pos, cap - (size_t)pos, "%s\r\n",
+                    conn->http10 ? "" : "Transfer-Encoding: chunked\r\n");
+
+    bool ok = conn_queue(conn, buf, (size_t)pos, false);
+    free(buf);
+    if (!ok) {
+        actor_http_close(rt, conn_id);
+        return false;
     }
+    conn->state = HTTP_STATE_SRV_CHUNKED;
+    conn->last_active_ms = now_ms();
+    return true;
+}
+
+bool actor_http_write_chunk(runtime_t *rt, http_conn_id_t conn_id,
+                            const void *data, size_t size) {
+    http_conn_t *conn = find_conn(rt, conn_id);
+    if (!conn || conn->state != HTTP_STATE_SRV_CHUNKED) return false;
+    if (size == 0) return true;   /* a zero-size chunk would end the body */
+    if (head_request(conn)) return true;
+
+    /* Refused whole, so the chunk framing stays intact */
+    size_t frame = conn->http10 ? size : size + 32;
+    size_t pending = conn->send_size - conn->send_pos;
+    if (pending > 0 && pending + frame > HTTP_SEND_BACKLOG_MAX) {
+        conn->want_write_ready = true;
+        return false;
+    }
+
+    uint8_t *buf = malloc(frame);
+    if (!buf) return false;
+    size_t pos = 0;
+    if (!conn->http10)
+        pos = (size_t)snprintf((char *)buf, frame, "%zx\r\n", size);
+    memcpy(buf + pos, data, size);
+    pos += size;
+    if (!conn->http10) {
+        buf[pos++] = '\r';
+        buf[pos++] = '\n';
+    }
+
+    bool ok = conn_queue(conn, buf, pos, false);
+    free(buf);
+    if (!ok) conn_lost(conn, rt);
+    return ok;
+}
+
+bool actor_http_end(runtime_t *rt, http_conn_id_t conn_id) {
+    http_conn_t *conn = find_conn(rt, conn_id);
+    if (!conn || conn->state != HTTP_STATE_SRV_CHUNKED) return false;
+
+    if (!conn->http10 && !head_request(conn) &&
+        !conn_queue(conn, "0\r\n\r\n", 5, false)) {
+        actor_http_close(rt, conn_id);
+        return false;
+    }
+    srv_response_queued(conn, rt);
+    return true;
+}
+
+bool actor_sse_start(runtime_t *rt, http_conn_id_t conn_id) {
+    http_conn_t *conn = find_conn(rt, conn_id);
     if (!conn || conn->state != HTTP_STATE_IDLE || !conn->is_server) return false;
 
     const char *resp = "HTTP/1.1 200 OK\r\n"
@@ -1450,22 +2323,9 @@ bool actor_sse_start(runtime_t *rt, http_conn_id_t conn_id) {
                        "Connection: keep-alive\r\n"
                        "\r\n";
 
-    size_t len = strlen(resp);
-
-    /* Blocking write of SSE headers */
-    size_t written = 0;
-    while (written < len) {
-        ssize_t n = conn->sock->write(conn->sock,
-                                       (const uint8_t *)resp + written,
-                                       len - written);
-        if (n > 0) {
-            written += (size_t)n;
-        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            continue;
-        } else {
-            conn->state = HTTP_STATE_DONE;
-            return false;
-        }
+    if (!conn_queue(conn, resp, strlen(resp), false)) {
+        conn->state = HTTP_STATE_DONE;
+        return false;
     }
 
     conn->conn_type = HTTP_CONN_SERVER_SSE;
@@ -1475,12 +2335,7 @@ bool actor_sse_start(runtime_t *rt, http_conn_id_t conn_id) {
 
 bool actor_sse_push(runtime_t *rt, http_conn_id_t conn_id,
                     const char *event, const char *data, size_t data_size) {
-    http_conn_t *conns = runtime_get_http_conns(rt);
-    size_t max = runtime_get_max_http_conns();
-    http_conn_t *conn = NULL;
-    for (size_t i = 0; i < max; i++) {
-        if (conns[i].id == conn_id) { conn = &conns[i]; break; }
-    }
+    http_conn_t *conn = find_conn(rt, conn_id);
     if (!conn || conn->state != HTTP_STATE_SRV_SSE_ACTIVE || !conn->is_server)
         return false;
 
@@ -1503,34 +2358,15 @@ bool actor_sse_push(runtime_t *rt, http_conn_id_t conn_id,
     buf[pos++] = '\n';
     buf[pos++] = '\n';
 
-    /* Blocking write */
-    size_t written = 0;
-    size_t total = (size_t)pos;
-    while (written < total) {
-        ssize_t n = conn->sock->write(conn->sock,
-                                       (uint8_t *)buf + written,
-                                       total - written);
-        if (n > 0) {
-            written += (size_t)n;
-        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            continue;
-        } else {
-            free(buf);
-            return false;
-        }
-    }
-
+    /* A client too far behind is dropped rather than buffered for */
+    bool ok = conn_queue(conn, buf, (size_t)pos, true);
     free(buf);
-    return true;
+    if (!ok) conn_lost(conn, rt);
+    return ok;
 }
 
 bool actor_ws_accept(runtime_t *rt, http_conn_id_t conn_id) {
-    http_conn_t *conns = runtime_get_http_conns(rt);
-    size_t max = runtime_get_max_http_conns();
-    http_conn_t *conn = NULL;
-    for (size_t i = 0; i < max; i++) {
-        if (conns[i].id == conn_id) { conn = &conns[i]; break; }
-    }
+    http_conn_t *conn = find_conn(rt, conn_id);
     if (!conn || conn->state != HTTP_STATE_IDLE || !conn->is_server) return false;
     if (!conn->upgrade_ws || conn->ws_accept_key[0] == '\0') return false;
 
@@ -1542,21 +2378,9 @@ bool actor_ws_accept(runtime_t *rt, http_conn_id_t conn_id) {
                        "Sec-WebSocket-Accept: %s\r\n"
                        "\r\n", conn->ws_accept_key);
 
-    /* Blocking write of upgrade response */
-    size_t total = (size_t)len;
-    size_t written = 0;
-    while (written < total) {
-        ssize_t n = conn->sock->write(conn->sock,
-                                       (const uint8_t *)resp + written,
-                                       total - written);
-        if (n > 0) {
-            written += (size_t)n;
-        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            continue;
-        } else {
-            conn->state = HTTP_STATE_DONE;
-            return false;
-        }
+    if (!conn_queue(conn, resp, (size_t)len, false)) {
+        conn->state = HTTP_STATE_DONE;
+        return false;
     }
 
     conn->conn_type = HTTP_CONN_SERVER_WS;
@@ -1572,27 +2396,18 @@ bool actor_ws_accept(runtime_t *rt, http_conn_id_t conn_id) {
     return true;
 }
 
-static http_conn_t *find_conn(runtime_t *rt, http_conn_id_t id) {
-    http_conn_t *conns = runtime_get_http_conns(rt);
-    size_t max = runtime_get_max_http_conns();
-    for (size_t i = 0; i < max; i++) {
-        if (conns[i].id == id) return &conns[i];
-    }
-    return NULL;
-}
-
 bool actor_ws_send_text(runtime_t *rt, http_conn_id_t id,
                         const char *text, size_t len) {
     http_conn_t *conn = find_conn(rt, id);
     if (!conn || conn->state != HTTP_STATE_WS_ACTIVE) return false;
-    return send_ws_frame(conn, WS_OPCODE_TEXT, (const uint8_t *)text, len);
+    return send_ws_frame(conn, rt, WS_OPCODE_TEXT, (const uint8_t *)text, len);
 }
 
 bool actor_ws_send_binary(runtime_t *rt, http_conn_id_t id,
                           const void *data, size_t len) {
     http_conn_t *conn = find_conn(rt, id);
     if (!conn || conn->state != HTTP_STATE_WS_ACTIVE) return false;
-    return send_ws_frame(conn, WS_OPCODE_BINARY, data, len);
+    return send_ws_frame(conn, rt, WS_OPCODE_BINARY, data, len);
 }
 
 bool actor_ws_close(runtime_t *rt, http_conn_id_t id,
@@ -1608,15 +2423,8 @@ bool actor_ws_close(runtime_t *rt, http_conn_id_t id,
     else
         frame_size = ws_frame_build_close(code, reason, reason_len, frame);
 
-    /* Blocking write of close frame */
-    size_t written = 0;
-    while (written < frame_size) {
-        ssize_t n = conn->sock->write(conn->sock,
-                                       frame + written, frame_size - written);
-        if (n > 0) written += (size_t)n;
-        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
-        else break;
-    }
+    /* Best effort: flushed on POLLOUT if the socket is full */
+    conn_queue(conn, frame, frame_size, false);
 
     conn->state = HTTP_STATE_DONE;
     return true;
@@ -1624,25 +2432,25 @@ bool actor_ws_close(runtime_t *rt, http_conn_id_t id,
 
 void actor_http_close(runtime_t *rt, http_conn_id_t id) {
     http_conn_t *conn = find_conn(rt, id);
-    if (!conn) return;
+    if (conn) http_conn_free(rt, conn);
+}
 
-    if (conn->sock) {
-        conn->sock->close(conn->sock);
-        conn->sock = NULL;
-    }
+void http_conn_free(runtime_t *rt, http_conn_t *conn) {
+    http_table_t *table = runtime_get_http_table(rt);
+    if (conn->sock) conn->sock->close(conn->sock);
+    if (conn->read_buf) http_table_buf_put(table, conn->read_buf);
     free(conn->send_buf);
-    conn->send_buf = NULL;
+    file_release(conn);
     free(conn->headers_buf);
-    conn->headers_buf = NULL;
+    free(conn->header_index);
     free(conn->body_buf);
-    conn->body_buf = NULL;
+    free(conn->sse_event);
     free(conn->sse_data);
-    conn->sse_data = NULL;
     free(conn->ws_large_buf);
-    conn->ws_large_buf = NULL;
     free(conn->request_method);
-    conn->request_method = NULL;
     free(conn->request_path);
-    conn->request_path = NULL;
-    memset(conn, 0, sizeof(*conn));
+    free(conn->pool_key);
+    free(conn->remote_host);
+    free(conn->remote_addrs);
+    http_table_release(table, conn);   /* zeroes the conn */
 }
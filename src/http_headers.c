@@ -0,0 +1,71 @@
+#include "http_headers.h"
+#include <string.h>
+#include <strings.h>
+
+uint32_t http_header_hash(const char *name, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = (uint8_t)name[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* At least twice as many slots as entries, so probes stay short */
+static size_t index_slots(size_t count) {
+    size_t n = 1;
+    while (n < count * 2) n <<= 1;
+    return n;
+}
+
+static const http_header_entry_t *index_entries(const http_header_index_t *index) {
+    return (const http_header_entry_t *)(index + 1);
+}
+
+static const uint16_t *index_table(const http_header_index_t *index) {
+    return (const uint16_t *)(index_entries(index) + index->count);
+}
+
+size_t http_header_index_size(size_t count) {
+    return sizeof(http_header_index_t) +
+           count * sizeof(http_header_entry_t) +
+           index_slots(count) * sizeof(uint16_t);
+}
+
+void http_header_index_write(http_header_index_t *index,
+                             const http_header_entry_t *entries,
+                             size_t count) {
+    size_t slots = index_slots(count);
+    index->count = (uint16_t)count;
+    index->mask = (uint16_t)(slots - 1);
+    if (count > 0)
+        memcpy(index + 1, entries, count * sizeof(*entries));
+
+    /* Linear probing in arrival order: a repeated name's first line is
+       met first */
+    uint16_t *table = (uint16_t *)index_table(index);
+    memset(table, 0, slots * sizeof(*table));
+    for (size_t i = 0; i < count; i++) {
+        size_t j = entries[i].hash & index->mask;
+        while (table[j]) j = (j + 1) & index->mask;
+        table[j] = (uint16_t)(i + 1);
+    }
+}
+
+const char *http_header_get(const char *headers,
+                            const http_header_index_t *index,
+                            const char *name) {
+    size_t len = strlen(name);
+    uint32_t h = http_header_hash(name, len);
+    const http_header_entry_t *entries = index_entries(index);
+    const uint16_t *table = index_table(index);
+    for (size_t j = h & index->mask; table[j]; j = (j + 1) & index->mask) {
+        const http_header_entry_t *e = &entries[table[j] - 1];
+        if (e->hash == h && e->name_len == len &&
+            strncasecmp(headers + e->offset, name, len) == 0)
+            return headers + e->offset + e->value;
+    }
+    return NULL;
+}
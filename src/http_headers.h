@@ -0,0 +1,17 @@
+#ifndef HTTP_HEADERS_H
+#define HTTP_HEADERS_H
+
+#include "microkernel/http.h"
+
+/* Building the header index delivered after a payload's body (see
+   http.h).  The parser collects one entry per header line as it goes. */
+
+/* Bytes the index of count entries takes */
+size_t http_header_index_size(size_t count);
+
+/* Write the index of count entries, hashing them into its table */
+void http_header_index_write(http_header_index_t *index,
+                             const http_header_entry_t *entries,
+                             size_t count);
+
+#endif /* HTTP_HEADERS_H */
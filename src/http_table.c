@@ -0,0 +1,77 @@
+#include "http_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+void http_table_free(http_table_t *t) {
+    for (size_t i = 0; i * HTTP_CONN_CHUNK < t->slots; i++)
+        free(t->chunks[i]);
+    free(t->chunks);
+    free(t->free_slots);
+    for (size_t i = 0; i < t->spare_count; i++)
+        free(t->spare[i]);
+    *t = (http_table_t){0};
+}
+
+/* Add a chunk of conns, the last one cut short at MAX_HTTP_CONNS */
+static bool grow(http_table_t *t) {
+    if (t->slots >= MAX_HTTP_CONNS) return false;
+    size_t n = MAX_HTTP_CONNS - t->slots;
+    if (n > HTTP_CONN_CHUNK) n = HTTP_CONN_CHUNK;
+    size_t chunk = t->slots / HTTP_CONN_CHUNK;
+
+    http_conn_t **chunks = realloc(t->chunks, (chunk + 1) * sizeof(*chunks));
+    if (!chunks) return false;
+    t->chunks = chunks;
+    uint32_t *free_slots = realloc(t->free_slots,
+                                   (t->slots + n) * sizeof(*free_slots));
+    if (!free_slots) return false;
+    t->free_slots = free_slots;
+    http_conn_t *conns = calloc(n, sizeof(*conns));
+    if (!conns) return false;
+    chunks[chunk] = conns;
+
+    /* Pushed high to low so the lowest slot is handed out first */
+    for (size_t i = n; i-- > 0; )
+        t->free_slots[t->free_count++] = (uint32_t)(t->slots + i);
+    t->slots += n;
+    return true;
+}
+
+http_conn_t *http_table_alloc(http_table_t *t) {
+    if (t->free_count == 0 && !grow(t)) return NULL;
+    uint32_t slot = t->free_slots[--t->free_count];
+    http_conn_t *conn = http_table_at(t, slot);
+    memset(conn, 0, sizeof(*conn));
+
+    uint32_t seq = t->next_seq++ & (UINT32_MAX >> HTTP_CONN_SLOT_BITS);
+    conn->id = (seq << HTTP_CONN_SLOT_BITS) | (slot + 1);
+    t->live++;
+    return conn;
+}
+
+void http_table_release(http_table_t *t, http_conn_t *conn) {
+    if (conn->id == HTTP_CONN_ID_INVALID) return;
+    uint32_t slot = (conn->id & HTTP_CONN_SLOT_MASK) - 1;
+    memset(conn, 0, sizeof(*conn));
+    t->free_slots[t->free_count++] = slot;
+    t->live--;
+}
+
+http_conn_t *http_table_get(const http_table_t *t, http_conn_id_t id) {
+    uint32_t slot = id & HTTP_CONN_SLOT_MASK;
+    if (slot == 0 || slot > t->slots) return NULL;
+    http_conn_t *conn = http_table_at(t, slot - 1);
+    return conn->id == id ? conn : NULL;
+}
+
+uint8_t *http_table_buf_get(http_table_t *t) {
+    if (t->spare_count > 0) return t->spare[--t->spare_count];
+    return malloc(HTTP_READ_BUF_SIZE);
+}
+
+void http_table_buf_put(http_table_t *t, uint8_t *buf) {
+    if (t->spare_count < HTTP_READ_BUF_SPARE)
+        t->spare[t->spare_count++] = buf;
+    else
+        free(buf);
+}
@@ -0,0 +1,68 @@
+#ifndef HTTP_TABLE_H
+#define HTTP_TABLE_H
+
+#include "runtime_internal.h"
+
+/* HTTP connections of one runtime.  Conns live in chunks of
+   HTTP_CONN_CHUNK allocated as the table grows, up to MAX_HTTP_CONNS, so
+   a conn never moves.  An id carries its slot in the low
+   HTTP_CONN_SLOT_BITS bits, for O(1) lookup, and a sequence number
+   above them, so the stale id of a reused slot matches nothing.  Freed
+   slots are reused first.
+
+   Read buffers are lent to conns only while they hold unparsed input;
+   up to HTTP_READ_BUF_SPARE returned buffers are kept for the next. */
+
+#define HTTP_CONN_SLOT_BITS 16
+#define HTTP_CONN_SLOT_MASK ((1u << HTTP_CONN_SLOT_BITS) - 1)
+#if MAX_HTTP_CONNS > HTTP_CONN_SLOT_MASK
+#error "MAX_HTTP_CONNS must fit in HTTP_CONN_SLOT_BITS"
+#endif
+
+#ifndef HTTP_CONN_CHUNK
+#define HTTP_CONN_CHUNK 64
+#endif
+#ifndef HTTP_READ_BUF_SPARE
+#define HTTP_READ_BUF_SPARE 16
+#endif
+
+struct http_table {
+    http_conn_t **chunks;
+    size_t        slots;          /* conns allocated across all chunks */
+    uint32_t     *free_slots;     /* stack of unused slots, one per conn */
+    size_t        free_count;
+    size_t        live;           /* conns in use */
+    uint32_t      next_seq;
+    uint8_t      *spare[HTTP_READ_BUF_SPARE];
+    size_t        spare_count;
+};
+
+void http_table_free(http_table_t *t);
+
+/* Zeroed conn with a fresh id, or NULL at MAX_HTTP_CONNS / out of memory */
+http_conn_t *http_table_alloc(http_table_t *t);
+
+/* Give a conn's slot back; the caller has freed what the conn owns */
+void http_table_release(http_table_t *t, http_conn_t *conn);
+
+/* Conn with this id, or NULL if it was closed */
+http_conn_t *http_table_get(const http_table_t *t, http_conn_id_t id);
+
+/* Read buffer of HTTP_READ_BUF_SIZE bytes, or NULL if out of memory */
+uint8_t *http_table_buf_get(http_table_t *t);
+void     http_table_buf_put(http_table_t *t, uint8_t *buf);
+
+static inline size_t http_table_live(const http_table_t *t) {
+    return t->live;
+}
+
+/* Iteration over every slot; a free one has id HTTP_CONN_ID_INVALID */
+static inline size_t http_table_slots(const http_table_t *t) {
+    return t->slots;
+}
+
+static inline http_conn_t *http_table_at(const http_table_t *t, size_t i) {
+    return &t->chunks[i / HTTP_CONN_CHUNK][i % HTTP_CONN_CHUNK];
+}
+
+#endif /* HTTP_TABLE_H */
@@ -0,0 +1,141 @@
+#include "lz.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define LZ_MIN_MATCH   4
+#define LZ_LAST_LITS   5    /* trailing bytes always emitted as literals */
+#define LZ_MATCH_GUARD 12   /* no match may start this close to the end */
+#define LZ_MAX_OFFSET  65535
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t lz_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Write the 255-run extension of a length nibble that saturated at 15 */
+static uint8_t *put_ext(uint8_t *op, size_t n) {
+    while (n >= 255) { *op++ = 255; n -= 255; }
+    *op++ = (uint8_t)n;
+    return op;
+}
+
+/* Emit one sequence: literals [lit, lit+lit_len), then an optional match.
+   match_len 0 marks the final literal-only sequence. */
+static uint8_t *emit(uint8_t *op, uint8_t *oend, const uint8_t *lit,
+                     size_t lit_len, size_t offset, size_t match_len) {
+    size_t ml = match_len ? match_len - LZ_MIN_MATCH : 0;
+    size_t need = 1 + lit_len + lit_len / 255 + 1
+                + (match_len ? 2 + ml / 255 + 1 : 0);
+    if ((size_t)(oend - op) < need) return NULL;
+
+    uint8_t *token = op++;
+    *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15) op = put_ext(op, lit_len - 15);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (match_len) {
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+        if (ml >= 15) op = put_ext(op, ml - 15);
+    }
+    return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    uint8_t *op = dst;
+    uint8_t *oend = dst + cap;
+    size_t anchor = 0;
+
+    if (len > LZ_MATCH_GUARD) {
+        uint32_t table[1u << LZ_HASH_BITS];
+        memset(table, 0, sizeof(table));
+
+        size_t limit = len - LZ_MATCH_GUARD;
+        size_t ip = 0;
+        while (ip < limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = lz_hash(seq);
+            size_t cand = table[h];
+            table[h] = (uint32_t)ip;
+
+            if (cand >= ip || ip - cand > LZ_MAX_OFFSET ||
+                read32(src + cand) != seq) {
+                /* Skip faster through incompressible runs */
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t mlen = LZ_MIN_MATCH;
+            while (ip + mlen < len - LZ_LAST_LITS &&
+                   src[cand + mlen] == src[ip + mlen])
+                mlen++;
+
+            op = emit(op, oend, src + anchor, ip - anchor, ip - cand, mlen);
+            if (!op) return 0;
+            ip += mlen;
+            anchor = ip;
+        }
+    }
+
+    op = emit(op, oend, src + anchor, len - anchor, 0, 0);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+/* Read a 255-run length extension; returns false on truncation */
+static bool get_ext(const uint8_t **ip, const uint8_t *iend, size_t *n) {
+    uint8_t b;
+    do {
+        if (*ip >= iend) return false;
+        b = *(*ip)++;
+        *n += b;
+    } while (b == 255);
+    return true;
+}
+
+size_t lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + len;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + cap;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        size_t lit = token >> 4;
+        if (lit == 15 && !get_ext(&ip, iend, &lit)) return 0;
+        if (lit > (size_t)(iend - ip) || lit > (size_t)(oend - op)) return 0;
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+
+        if (ip == iend) break;   /* final literal-only sequence */
+
+        if (iend - ip < 2) return 0;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return 0;
+
+        size_t mlen = token & 0x0F;
+        if (mlen == 15 && !get_ext(&ip, iend, &mlen)) return 0;
+        mlen += LZ_MIN_MATCH;
+        if (mlen > (size_t)(oend - op)) return 0;
+
+        const uint8_t *match = op - offset;
+        if (offset >= mlen) {
+            memcpy(op, match, mlen);
+            op += mlen;
+        } else {
+            /* Overlapping copy replicates the run */
+            for (size_t i = 0; i < mlen; i++) *op++ = match[i];
+        }
+    }
+
+    return (size_t)(op - dst);
+}
@@ -0,0 +1,26 @@
+#ifndef LZ_H
+#define LZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Small LZ77 block codec (LZ4 block layout: token, literals, 16-bit
+   offset, length extensions). Favours speed over ratio; used for
+   compressing large inter-node payloads. */
+
+/* Hash table size for the compressor (4 bytes per entry, on the stack) */
+#ifndef LZ_HASH_BITS
+#define LZ_HASH_BITS 12
+#endif
+
+/* Compress len bytes of src into dst (cap bytes).
+   Returns the compressed size, or 0 if the output would not fit in cap.
+   Pass cap < len to only accept output that actually shrinks. */
+size_t lz_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+/* Decompress a block produced by lz_compress into dst (cap bytes).
+   Returns the decompressed size, or 0 if the block is malformed or
+   would overflow cap. */
+size_t lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+#endif /* LZ_H */
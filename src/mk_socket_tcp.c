@@ -10,6 +10,12 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#endif
 
 #ifndef MSG_NOSIGNAL
 #define MSG_NOSIGNAL 0
@@ -32,6 +38,33 @@ static ssize_t tcp_write(mk_socket_t *self, const uint8_t *buf, size_t len) {
     return send(ctx->fd, buf, len, MSG_NOSIGNAL | MSG_DONTWAIT);
 }
 
+#ifdef __linux__
+static ssize_t tcp_sendfile(mk_socket_t *self, int in_fd, off_t *offset,
+                            size_t len) {
+    tcp_socket_ctx_t *ctx = self->ctx;
+
+    /* sendfile() takes no MSG_NOSIGNAL: hold SIGPIPE back for the call
+       and swallow the one a vanished peer raises, so the caller sees
+       EPIPE instead of the process dying */
+    sigset_t pipe_set, old_mask, pending;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_mask);
+    sigpending(&pending);
+    int was_pending = sigismember(&pending, SIGPIPE);
+
+    ssize_t n = sendfile(ctx->fd, in_fd, offset, len);
+    if (n < 0 && errno == EPIPE && !was_pending) {
+        int err = errno;
+        struct timespec none = { 0, 0 };
+        sigtimedwait(&pipe_set, NULL, &none);
+        errno = err;
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    return n;
+}
+#endif
+
 static void tcp_close(mk_socket_t *self) {
     if (!self) return;
     tcp_socket_ctx_t *ctx = self->ctx;
@@ -91,6 +124,9 @@ mk_socket_t *mk_socket_tcp_connect(const char *host, uint16_t port) {
     sock->write = tcp_write;
     sock->close = tcp_close;
     sock->get_fd = tcp_get_fd;
+#ifdef __linux__
+    sock->sendfile = tcp_sendfile;
+#endif
     sock->ctx = ctx;
 
     return sock;
@@ -110,7 +146,26 @@ mk_socket_t *mk_socket_tcp_wrap(int fd) {
     sock->write = tcp_write;
     sock->close = tcp_close;
     sock->get_fd = tcp_get_fd;
+#ifdef __linux__
+    sock->sendfile = tcp_sendfile;
+#endif
     sock->ctx = ctx;
 
     return sock;
 }
+
+mk_socket_t *mk_socket_tcp_connect_addr(const struct sockaddr *addr,
+                                        socklen_t addr_len) {
+    int fd = socket(addr->sa_family, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 ||
+        (connect(fd, addr, addr_len) < 0 && errno != EINPROGRESS)) {
+        close(fd);
+        return NULL;
+    }
+
+    mk_socket_t *sock = mk_socket_tcp_wrap(fd);
+    if (!sock) close(fd);
+    return sock;
+}
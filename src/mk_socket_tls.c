@@ -84,38 +84,18 @@ static int tls_get_fd(mk_socket_t *self) {
 
 /* ── Public API ────────────────────────────────────────────────────── */
 
-mk_socket_t *mk_socket_tls_connect(const char *host, uint16_t port) {
+mk_socket_t *mk_socket_tls_wrap(int fd, const char *host) {
     /* Initialize SSL_CTX once */
     pthread_once(&g_ssl_once, init_ssl_ctx);
-    if (!g_ssl_ctx) return NULL;
-
-    /* DNS + TCP connect (blocking) — same pattern as mk_socket_tcp_connect */
-    char port_str[8];
-    snprintf(port_str, sizeof(port_str), "%u", port);
-
-    struct addrinfo hints, *res;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_flags = AI_NUMERICSERV;
-
-    if (getaddrinfo(host, port_str, &hints, &res) != 0 || !res)
-        return NULL;
-
-    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if (fd < 0) {
-        freeaddrinfo(res);
-        return NULL;
-    }
-
-    int rc = connect(fd, res->ai_addr, res->ai_addrlen);
-    freeaddrinfo(res);
-    if (rc < 0) {
+    if (!g_ssl_ctx) {
         close(fd);
         return NULL;
     }
 
     /* SSL handshake (blocking) */
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+
     SSL *ssl = SSL_new(g_ssl_ctx);
     if (!ssl) {
         close(fd);
@@ -123,6 +103,8 @@ mk_socket_t *mk_socket_tls_connect(const char *host, uint16_t port) {
     }
 
     SSL_set_fd(ssl, fd);
+    /* Queued writes are retried from wherever the pending bytes sit now */
+    SSL_set_mode(ssl, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
     SSL_set_tlsext_host_name(ssl, host);  /* SNI */
     SSL_set1_host(ssl, host);             /* hostname verification */
 
@@ -133,7 +115,7 @@ mk_socket_t *mk_socket_tls_connect(const char *host, uint16_t port) {
     }
 
     /* Set non-blocking after handshake */
-    int flags = fcntl(fd, F_GETFL, 0);
+    flags = fcntl(fd, F_GETFL, 0);
     if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 
     /* Allocate socket + context */
@@ -157,3 +139,33 @@ mk_socket_t *mk_socket_tls_connect(const char *host, uint16_t port) {
 
     return sock;
 }
+
+mk_socket_t *mk_socket_tls_connect(const char *host, uint16_t port) {
+    /* DNS + TCP connect (blocking) — same pattern as mk_socket_tcp_connect */
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+
+    if (getaddrinfo(host, port_str, &hints, &res) != 0 || !res)
+        return NULL;
+
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return NULL;
+    }
+
+    int rc = connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    return mk_socket_tls_wrap(fd, host);
+}
@@ -2,11 +2,20 @@
 #include "microkernel/message.h"
 #include "microkernel/namespace.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-/* Forward declarations for runtime-level broadcast */
-void runtime_broadcast_registry(runtime_t *rt, msg_type_t type,
-                                 const void *payload, size_t payload_size);
+#ifndef NAME_REGISTRY_MIN_SLOTS
+#define NAME_REGISTRY_MIN_SLOTS 16
+#endif
+#define NAME_NONE UINT32_MAX
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
 
 /* FNV-1a hash */
 static uint32_t fnv1a(const char *s) {
@@ -18,52 +27,218 @@ static uint32_t fnv1a(const char *s) {
     return h;
 }
 
-/* Internal: insert into registry without broadcasting (used for remote entries) */
-bool name_registry_insert(runtime_t *rt, const char *name, actor_id_t id) {
-    if (!name || !name[0]) return false;
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    uint32_t h = fnv1a(name) % cap;
-
-    for (size_t i = 0; i < cap; i++) {
-        size_t idx = (h + i) % cap;
-        if (!reg[idx].occupied) {
-            snprintf(reg[idx].name, sizeof(reg[idx].name), "%s", name);
-            reg[idx].actor_id = id;
-            reg[idx].occupied = true;
-            return true;
+static size_t owner_slot_of(const name_registry_t *reg, actor_id_t id) {
+    uint64_t h = id;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h & (reg->cap - 1);
+}
+
+/* ── Actor -> names index ──────────────────────────────────────────── */
+
+/* Owner slot holding id, or the empty slot where it would go */
+static size_t owner_probe(const name_registry_t *reg, actor_id_t id) {
+    size_t mask = reg->cap - 1;
+    size_t i = owner_slot_of(reg, id);
+    while (reg->owner_keys[i] != ACTOR_ID_INVALID && reg->owner_keys[i] != id)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static uint32_t owner_head(const name_registry_t *reg, actor_id_t id) {
+    if (reg->cap == 0) return NAME_NONE;
+    size_t i = owner_probe(reg, id);
+    return reg->owner_keys[i] == id ? reg->owner_head[i] : NAME_NONE;
+}
+
+/* Append slot to its actor's chain (keeps registration order) */
+static void owner_link(name_registry_t *reg, uint32_t slot) {
+    actor_id_t id = reg->slots[slot].actor_id;
+    reg->slots[slot].next_same = NAME_NONE;
+    size_t i = owner_probe(reg, id);
+    if (reg->owner_keys[i] != id) {
+        reg->owner_keys[i] = id;
+        reg->owner_head[i] = slot;
+        return;
+    }
+    uint32_t s = reg->owner_head[i];
+    while (reg->slots[s].next_same != NAME_NONE) s = reg->slots[s].next_same;
+    reg->slots[s].next_same = slot;
+}
+
+static void owner_unlink(name_registry_t *reg, uint32_t slot) {
+    actor_id_t id = reg->slots[slot].actor_id;
+    size_t i = owner_probe(reg, id);
+    if (reg->owner_keys[i] != id) return;
+
+    if (reg->owner_head[i] != slot) {
+        uint32_t s = reg->owner_head[i];
+        while (s != NAME_NONE && reg->slots[s].next_same != slot)
+            s = reg->slots[s].next_same;
+        if (s != NAME_NONE) reg->slots[s].next_same = reg->slots[slot].next_same;
+        return;
+    }
+    reg->owner_head[i] = reg->slots[slot].next_same;
+    if (reg->owner_head[i] != NAME_NONE) return;
+
+    /* Last name of the actor: backward-shift delete its owner slot */
+    size_t mask = reg->cap - 1;
+    size_t gap = i;
+    for (size_t j = (i + 1) & mask; reg->owner_keys[j] != ACTOR_ID_INVALID;
+         j = (j + 1) & mask) {
+        size_t home = owner_slot_of(reg, reg->owner_keys[j]);
+        if (((j - home) & mask) >= ((j - gap) & mask)) {
+            reg->owner_keys[gap] = reg->owner_keys[j];
+            reg->owner_head[gap] = reg->owner_head[j];
+            gap = j;
         }
-        if (strcmp(reg[idx].name, name) == 0) {
-            return false; /* duplicate name */
+    }
+    reg->owner_keys[gap] = ACTOR_ID_INVALID;
+}
+
+/* ── Name table ────────────────────────────────────────────────────── */
+
+void name_registry_free(name_registry_t *reg) {
+    free(reg->slots);
+    free(reg->owner_keys);
+    free(reg->owner_head);
+    *reg = (name_registry_t){0};
+}
+
+/* Slot holding name, or NAME_NONE.  Tombstones keep probe chains intact. */
+static uint32_t name_find(const name_registry_t *reg, const char *name) {
+    if (reg->cap == 0) return NAME_NONE;
+    size_t mask = reg->cap - 1;
+    for (size_t i = fnv1a(name) & mask;; i = (i + 1) & mask) {
+        const name_entry_t *e = &reg->slots[i];
+        if (e->state == NAME_SLOT_EMPTY) return NAME_NONE;
+        if (e->state == NAME_SLOT_LIVE && strcmp(e->name, name) == 0)
+            return (uint32_t)i;
+    }
+}
+
+/* Rebuild into `slots` slots, dropping tombstones.  Every live name is
+   on its actor's chain, so walking the chains moves them all and keeps
+   each actor's names in registration order. */
+static bool rehash(name_registry_t *reg, size_t slots) {
+    name_entry_t *ns = calloc(slots, sizeof(*ns));
+    actor_id_t *keys = calloc(slots, sizeof(*keys));
+    uint32_t *heads = malloc(slots * sizeof(*heads));
+    if (!ns || !keys || !heads) {
+        free(ns);
+        free(keys);
+        free(heads);
+        return false;
+    }
+    name_registry_t old = *reg;
+    reg->slots = ns;
+    reg->owner_keys = keys;
+    reg->owner_head = heads;
+    reg->cap = slots;
+    reg->tombs = 0;
+
+    size_t mask = slots - 1;
+    for (size_t k = 0; k < old.cap; k++) {
+        if (old.owner_keys[k] == ACTOR_ID_INVALID) continue;
+        for (uint32_t i = old.owner_head[k]; i != NAME_NONE;
+             i = old.slots[i].next_same) {
+            size_t j = fnv1a(old.slots[i].name) & mask;
+            while (ns[j].state != NAME_SLOT_EMPTY) j = (j + 1) & mask;
+            ns[j] = old.slots[i];
+            owner_link(reg, (uint32_t)j);
         }
     }
-    return false; /* full */
+    name_registry_free(&old);
+    return true;
+}
+
+/* Keep live + tombstones at or below 3/4; rebuild to at most 1/2 live */
+static bool reserve_slot(name_registry_t *reg) {
+    if ((reg->live + reg->tombs + 1) * 4 <= reg->cap * 3) return true;
+    size_t slots = NAME_REGISTRY_MIN_SLOTS;
+    while (slots < (reg->live + 1) * 2) slots *= 2;
+    return rehash(reg, slots);
+}
+
+static void remove_slot(name_registry_t *reg, uint32_t slot) {
+    if (reg->slots[slot].expires_ms)
+        reg->cached--;
+    else if (!reg->partitioned)
+        registry_digest_toggle(&reg->digest, reg->slots[slot].name,
+                               reg->slots[slot].actor_id);
+    owner_unlink(reg, slot);
+    reg->slots[slot].state = NAME_SLOT_TOMB;
+    reg->slots[slot].name[0] = '\0';
+    reg->slots[slot].actor_id = ACTOR_ID_INVALID;
+    reg->live--;
+    reg->tombs++;
+    reg->epoch++;
+}
+
+const name_entry_t *name_registry_next(runtime_t *rt, size_t *pos) {
+    const name_registry_t *reg = runtime_get_name_registry(rt);
+    for (; *pos < reg->cap; (*pos)++)
+        if (reg->slots[*pos].state == NAME_SLOT_LIVE)
+            return &reg->slots[(*pos)++];
+    return NULL;
+}
+
+const char *name_registry_first_name(runtime_t *rt, actor_id_t id) {
+    const name_registry_t *reg = runtime_get_name_registry(rt);
+    uint32_t s = owner_head(reg, id);
+    return s == NAME_NONE ? NULL : reg->slots[s].name;
+}
+
+/* Slot the new binding went into, or NAME_NONE (duplicate name, out of
+   memory) */
+static uint32_t insert_key(name_registry_t *reg, const char *key,
+                           actor_id_t id) {
+    if (name_find(reg, key) != NAME_NONE) return NAME_NONE;
+    if (!reserve_slot(reg)) return NAME_NONE;
+
+    /* Reuse the first tombstone on the probe path */
+    size_t mask = reg->cap - 1;
+    size_t i = fnv1a(key) & mask;
+    while (reg->slots[i].state == NAME_SLOT_LIVE) i = (i + 1) & mask;
+    if (reg->slots[i].state == NAME_SLOT_TOMB) reg->tombs--;
+
+    name_entry_t *e = &reg->slots[i];
+    snprintf(e->name, sizeof(e->name), "%s", key);
+    e->actor_id = id;
+    e->state = NAME_SLOT_LIVE;
+    e->expires_ms = 0;
+    reg->live++;
+    reg->epoch++;
+    if (!reg->partitioned) registry_digest_toggle(&reg->digest, key, id);
+    owner_link(reg, (uint32_t)i);
+    return (uint32_t)i;
+}
+
+/* Internal: insert into registry without broadcasting (used for remote entries) */
+bool name_registry_insert(runtime_t *rt, const char *name, actor_id_t id) {
+    if (!name || !name[0] || id == ACTOR_ID_INVALID) return false;
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    char key[sizeof(reg->slots[0].name)];
+    snprintf(key, sizeof(key), "%s", name);
+    return insert_key(reg, key, id) != NAME_NONE;
 }
 
-/* Public: register name and broadcast to all connected peers */
+/* Public: register name and announce it to all connected peers */
 bool actor_register_name(runtime_t *rt, const char *name, actor_id_t id) {
     /* Route /-prefixed paths to namespace path table */
     if (name && name[0] == '/') {
         int rc = ns_register_path(rt, name, id);
         if (rc != NS_OK) return false;
-        /* Broadcast path registration to peers */
-        path_register_payload_t payload;
-        memset(&payload, 0, sizeof(payload));
-        snprintf(payload.path, sizeof(payload.path), "%s", name);
-        payload.actor_id = id;
-        runtime_broadcast_registry(rt, MSG_PATH_REGISTER,
-                                    &payload, sizeof(payload));
+        runtime_registry_announce(rt, REGISTRY_PATH_ADD, name, id);
         return true;
     }
 
     if (!name_registry_insert(rt, name, id)) return false;
-
-    /* Broadcast to all peers */
-    name_register_payload_t payload;
-    memset(&payload, 0, sizeof(payload));
-    snprintf(payload.name, sizeof(payload.name), "%s", name);
-    payload.actor_id = id;
-    runtime_broadcast_registry(rt, MSG_NAME_REGISTER, &payload, sizeof(payload));
+    const name_registry_t *reg = runtime_get_name_registry(rt);
+    char key[sizeof(reg->slots[0].name)];
+    snprintf(key, sizeof(key), "%s", name);
+    runtime_registry_announce(rt, REGISTRY_NAME_ADD, key, id);
     return true;
 }
 
@@ -73,46 +248,142 @@ actor_id_t actor_lookup(runtime_t *rt, const char *name) {
     if (name[0] == '/') {
         return ns_lookup_path(rt, name);
     }
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    uint32_t h = fnv1a(name) % cap;
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    char key[sizeof(reg->slots[0].name)];
+    snprintf(key, sizeof(key), "%s", name);
+    uint32_t s = name_find(reg, key);
+    if (s == NAME_NONE) return ACTOR_ID_INVALID;
+    if (reg->slots[s].expires_ms && reg->slots[s].expires_ms <= now_ms()) {
+        remove_slot(reg, s);   /* stale answer: ask the owner again */
+        return ACTOR_ID_INVALID;
+    }
+    return reg->slots[s].actor_id;
+}
+
+void name_registry_touch(runtime_t *rt) {
+    runtime_get_name_registry(rt)->epoch++;
+}
+
+void name_registry_account(runtime_t *rt, const char *path, actor_id_t id) {
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    registry_digest_toggle(&reg->digest, path, id);
+    reg->epoch++;
+}
+
+/* ── Partitioned mode ── */
+
+void name_registry_set_partitioned(runtime_t *rt, bool on) {
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    for (size_t i = 0; i < reg->cap; i++) {
+        name_entry_t *e = &reg->slots[i];
+        if (e->state != NAME_SLOT_LIVE) continue;
+        if (e->expires_ms) remove_slot(reg, (uint32_t)i);
+        else registry_digest_toggle(&reg->digest, e->name, e->actor_id);
+    }
+    reg->partitioned = on;
+}
+
+/* Make room for one more cached answer: the next one round from the hand */
+static void cache_evict(name_registry_t *reg) {
+    for (size_t n = 0; n < reg->cap; n++) {
+        size_t i = reg->cache_hand++ & (reg->cap - 1);
+        if (reg->slots[i].state == NAME_SLOT_LIVE && reg->slots[i].expires_ms) {
+            remove_slot(reg, (uint32_t)i);
+            return;
+        }
+    }
+}
 
-    for (size_t i = 0; i < cap; i++) {
-        size_t idx = (h + i) % cap;
-        if (!reg[idx].occupied) return ACTOR_ID_INVALID;
-        if (strcmp(reg[idx].name, name) == 0) {
-            return reg[idx].actor_id;
+void name_registry_cache(runtime_t *rt, const char *name, actor_id_t id) {
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    if (!reg->partitioned || !name || !name[0] || id == ACTOR_ID_INVALID)
+        return;
+    char key[sizeof(reg->slots[0].name)];
+    snprintf(key, sizeof(key), "%s", name);
+    uint32_t s = name_find(reg, key);
+    if (s != NAME_NONE) {
+        if (!reg->slots[s].expires_ms) return;   /* held here */
+        remove_slot(reg, s);
+    }
+    if (reg->cached >= MK_NAME_CACHE_MAX) cache_evict(reg);
+    s = insert_key(reg, key, id);
+    if (s == NAME_NONE) return;
+    reg->slots[s].expires_ms = now_ms() + MK_NAME_CACHE_TTL_MS;
+    reg->cached++;
+}
+
+void name_registry_rehome(runtime_t *rt) {
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    node_id_t self = runtime_get_node_id(rt);
+    for (size_t i = 0; i < reg->cap; i++) {
+        name_entry_t *e = &reg->slots[i];
+        if (e->state != NAME_SLOT_LIVE) continue;
+        node_id_t owner = runtime_name_owner(rt, e->name);
+        if (e->expires_ms)
+            remove_slot(reg, (uint32_t)i);
+        else if (actor_id_node(e->actor_id) == self) {
+            if (owner != self)
+                runtime_registry_announce(rt, REGISTRY_NAME_ADD, e->name,
+                                          e->actor_id);
+        } else if (owner != self) {
+            remove_slot(reg, (uint32_t)i);   /* its node re-homes it */
         }
     }
-    return ACTOR_ID_INVALID;
+}
+
+/* ── Name handles ── */
+
+actor_name_handle_t actor_name_resolve(runtime_t *rt, const char *name) {
+    actor_name_handle_t h;
+    memset(&h, 0, sizeof(h));
+    snprintf(h.name, sizeof(h.name), "%s", name ? name : "");
+    h.epoch = runtime_get_name_registry(rt)->epoch;
+    h.id = actor_lookup(rt, h.name);
+    return h;
+}
+
+actor_id_t actor_name_handle_id(runtime_t *rt, actor_name_handle_t *h) {
+    uint64_t epoch = runtime_get_name_registry(rt)->epoch;
+    if (h->epoch != epoch) {
+        h->id = actor_lookup(rt, h->name);
+        h->epoch = epoch;
+    }
+    return h->id;
+}
+
+bool actor_send_handle(runtime_t *rt, actor_name_handle_t *h, msg_type_t type,
+                       const void *payload, size_t payload_size) {
+    actor_id_t dest = actor_name_handle_id(rt, h);
+    if (dest == ACTOR_ID_INVALID) return false;
+    return actor_send(rt, dest, type, payload, payload_size);
 }
 
 /* Internal: remove by name without broadcasting (used for incoming MSG_NAME_UNREGISTER) */
 void name_registry_remove_by_name(runtime_t *rt, const char *name) {
     if (!name || !name[0]) return;
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    for (size_t i = 0; i < cap; i++) {
-        if (reg[i].occupied && strcmp(reg[i].name, name) == 0) {
-            memset(&reg[i], 0, sizeof(name_entry_t));
-            return;
-        }
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    char key[sizeof(reg->slots[0].name)];
+    snprintf(key, sizeof(key), "%s", name);
+    uint32_t s = name_find(reg, key);
+    if (s != NAME_NONE) remove_slot(reg, s);
+}
+
+void name_registry_purge_node(runtime_t *rt, node_id_t node) {
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    for (size_t i = 0; i < reg->cap; i++) {
+        if (reg->slots[i].state == NAME_SLOT_LIVE &&
+            actor_id_node(reg->slots[i].actor_id) == node)
+            remove_slot(reg, (uint32_t)i);
     }
 }
 
 void name_registry_deregister_actor(runtime_t *rt, actor_id_t id) {
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    for (size_t i = 0; i < cap; i++) {
-        if (reg[i].occupied && reg[i].actor_id == id) {
-            /* Broadcast unregister to peers before clearing */
-            name_unregister_payload_t payload;
-            memset(&payload, 0, sizeof(payload));
-            snprintf(payload.name, sizeof(payload.name), "%s", reg[i].name);
-            runtime_broadcast_registry(rt, MSG_NAME_UNREGISTER,
-                                        &payload, sizeof(payload));
-            memset(&reg[i], 0, sizeof(name_entry_t));
-        }
+    name_registry_t *reg = runtime_get_name_registry(rt);
+    uint32_t s;
+    while ((s = owner_head(reg, id)) != NAME_NONE) {
+        runtime_registry_announce(rt, REGISTRY_NAME_DEL, reg->slots[s].name,
+                                  ACTOR_ID_INVALID);
+        remove_slot(reg, s);
     }
     /* Also clean up any /-prefixed paths in the namespace actor */
     ns_deregister_actor_paths(rt, id);
@@ -122,17 +393,14 @@ size_t actor_reverse_lookup(runtime_t *rt, actor_id_t id,
                             char *buf, size_t buf_size) {
     if (!buf || buf_size == 0) return 0;
 
-    /* Scan flat name registry */
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    for (size_t i = 0; i < cap; i++) {
-        if (reg[i].occupied && reg[i].actor_id == id) {
-            size_t len = strlen(reg[i].name);
-            if (len >= buf_size) len = buf_size - 1;
-            memcpy(buf, reg[i].name, len);
-            buf[len] = '\0';
-            return len;
-        }
+    /* Flat names first */
+    const char *name = name_registry_first_name(rt, id);
+    if (name) {
+        size_t len = strlen(name);
+        if (len >= buf_size) len = buf_size - 1;
+        memcpy(buf, name, len);
+        buf[len] = '\0';
+        return len;
     }
 
     /* Try namespace path table */
@@ -145,18 +413,16 @@ size_t actor_reverse_lookup_all(runtime_t *rt, actor_id_t id,
 
     size_t off = 0;
 
-    /* Scan flat name registry */
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    for (size_t i = 0; i < cap; i++) {
-        if (reg[i].occupied && reg[i].actor_id == id) {
-            size_t len = strlen(reg[i].name);
-            size_t need = (off > 0 ? 2 : 0) + len;
-            if (off + need >= buf_size) continue;
-            if (off > 0) { buf[off++] = ','; buf[off++] = ' '; }
-            memcpy(buf + off, reg[i].name, len);
-            off += len;
-        }
+    /* Flat names, in registration order */
+    const name_registry_t *reg = runtime_get_name_registry(rt);
+    for (uint32_t s = owner_head(reg, id); s != NAME_NONE;
+         s = reg->slots[s].next_same) {
+        size_t len = strlen(reg->slots[s].name);
+        size_t need = (off > 0 ? 2 : 0) + len;
+        if (off + need >= buf_size) continue;
+        if (off > 0) { buf[off++] = ','; buf[off++] = ' '; }
+        memcpy(buf + off, reg->slots[s].name, len);
+        off += len;
     }
 
     /* Also collect namespace paths */
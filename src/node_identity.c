@@ -52,26 +52,41 @@ const char *mk_node_identity(void) {
 
 /* ── Stable node ID ────────────────────────────────────────────────── */
 
-static node_id_t identity_hash_id(void) {
-    const char *name = mk_node_identity();
+/* 32-bit FNV-1a over the full identity source (not the shortened display
+   name), so IDs only clash by chance: ~1 in 200,000 for 200 nodes.
+   0 is reserved. */
+static node_id_t hash_node_id(const uint8_t *data, size_t len) {
     uint32_t h = 2166136261u;
-    for (const char *p = name; *p; p++) {
-        h ^= (uint8_t)*p;
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
         h *= 16777619u;
     }
-    return (node_id_t)((h % 15) + 1);
+    return h ? (node_id_t)h : 1;
 }
 
 #ifdef ESP_PLATFORM
-node_id_t mk_node_id(void) { return identity_hash_id(); }
+node_id_t mk_node_id(void) {
+    uint8_t mac[6];
+    esp_efuse_mac_get_default(mac);
+    return hash_node_id(mac, sizeof(mac));
+}
 #else
-#include <stdlib.h>
 node_id_t mk_node_id(void) {
     const char *env = getenv("MK_NODE_ID");
     if (env && env[0]) {
-        int id = atoi(env);
-        if (id >= 1 && id < 16) return (node_id_t)id;
+        char *end;
+        unsigned long id = strtoul(env, &end, 10);
+        if (*end == '\0' && id >= 1 && id <= 0xFFFFFFFFul)
+            return (node_id_t)id;
     }
-    return identity_hash_id();
+    const char *name = getenv("MK_NODE_NAME");
+    if (name && name[0])
+        return hash_node_id((const uint8_t *)name, strlen(name));
+    char hostname[256];
+    if (gethostname(hostname, sizeof(hostname)) != 0)
+        return hash_node_id((const uint8_t *)mk_node_identity(),
+                            strlen(mk_node_identity()));
+    hostname[sizeof(hostname) - 1] = '\0';
+    return hash_node_id((const uint8_t *)hostname, strlen(hostname));
 }
 #endif
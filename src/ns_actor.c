@@ -6,7 +6,9 @@
 #include "microkernel/supervision.h"
 #include "microkernel/transport.h"
 #include "microkernel/transport_tcp.h"
+#include "microkernel/wire.h"
 #include "runtime_internal.h"
+#include "ns_trie.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -18,116 +20,246 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/poll.h>
+#include <sys/time.h>
 
-/* ── Path table (hierarchical /paths) ──────────────────────────────── */
-
-#ifndef NS_MAX_PATH_ENTRIES
-#define NS_MAX_PATH_ENTRIES 64
-#endif
+/* ── Mounted peers (node ID -> identity, for collision checks) ─────── */
 
 typedef struct {
-    char       path[NS_PATH_MAX];
-    actor_id_t actor_id;
-    bool       occupied;
-} path_entry_t;
+    node_id_t node_id;
+    char      identity[28];
+} mount_peer_t;
 
-/* ── Mount table ───────────────────────────────────────────────────── */
+/* ── Change subscriptions ──────────────────────────────────────────── */
 
-#ifndef NS_MAX_MOUNTS
-#define NS_MAX_MOUNTS 16
-#endif
+typedef struct {
+    actor_id_t subscriber;
+    uint32_t   monitor;           /* drops the subscription when it exits */
+    char       prefix[NS_PATH_MAX];
+} ns_sub_t;
 
 typedef struct {
-    char       mount_point[NS_PATH_MAX];
-    actor_id_t target;
-    bool       occupied;
-} mount_entry_t;
+    actor_id_t  only;             /* snapshot for one subscriber, else
+                                     ACTOR_ID_INVALID for all */
+    ns_notify_t ev;
+} ns_pending_t;
 
 /* ── Namespace actor state ─────────────────────────────────────────── */
 
 typedef struct {
-    path_entry_t  paths[NS_MAX_PATH_ENTRIES];
-    mount_entry_t mounts[NS_MAX_MOUNTS];
+    ns_trie_t     tree;           /* /paths and mount points */
+    mount_peer_t *peers;          /* grows with the mesh */
+    size_t        peer_count;
+    size_t        peer_cap;
+    actor_id_t    keeper;         /* reconnects ns_mount_connect links */
+    actor_id_t    self;
+    ns_sub_t     *subs;
+    size_t        sub_count;
+    size_t        sub_cap;
+    ns_pending_t *pending;        /* events since the last MSG_NS_FLUSH */
+    size_t        pending_count;
+    size_t        pending_cap;
+    bool          flush_queued;
 } ns_state_t;
 
-/* ── Path table operations ─────────────────────────────────────────── */
+static void ns_state_free(void *state) {
+    ns_state_t *s = state;
+    ns_trie_free(&s->tree);
+    free(s->peers);
+    free(s->subs);
+    free(s->pending);
+    free(s);
+}
 
-static int ns_path_register(ns_state_t *s, const char *path, actor_id_t id) {
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && strcmp(s->paths[i].path, path) == 0)
-            return NS_EEXIST;
+/* ── Change notification ───────────────────────────────────────────── */
+
+static bool has_prefix(const char *path, const char *prefix) {
+    return strncmp(path, prefix, strlen(prefix)) == 0;
+}
+
+static void ns_queue(runtime_t *rt, ns_state_t *s, actor_id_t only,
+                     int32_t event, const char *path, actor_id_t id) {
+    if (s->pending_count == s->pending_cap) {
+        size_t cap = s->pending_cap ? s->pending_cap * 2 : 16;
+        ns_pending_t *p = realloc(s->pending, cap * sizeof(*p));
+        if (!p) return;
+        s->pending = p;
+        s->pending_cap = cap;
     }
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (!s->paths[i].occupied) {
-            snprintf(s->paths[i].path, NS_PATH_MAX, "%s", path);
-            s->paths[i].actor_id = id;
-            s->paths[i].occupied = true;
-            return NS_OK;
+    ns_pending_t *p = &s->pending[s->pending_count++];
+    memset(p, 0, sizeof(*p));
+    p->only = only;
+    snprintf(p->ev.path, NS_PATH_MAX, "%s", path);
+    p->ev.actor_id = id;
+    p->ev.event = event;
+
+    /* Everything that changes before the namespace actor runs again goes
+       out as one batch */
+    if (!s->flush_queued)
+        s->flush_queued = runtime_deliver_msg(rt, s->self, MSG_NS_FLUSH,
+                                              NULL, 0);
+}
+
+/* Record a change for the subscribers whose prefix covers path */
+static void ns_note(runtime_t *rt, ns_state_t *s, int32_t event,
+                    const char *path, actor_id_t id) {
+    for (size_t i = 0; i < s->sub_count; i++) {
+        if (has_prefix(path, s->subs[i].prefix)) {
+            ns_queue(rt, s, ACTOR_ID_INVALID, event, path, id);
+            return;
         }
     }
-    return NS_EFULL;
 }
 
-static actor_id_t ns_path_lookup(ns_state_t *s, const char *path) {
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && strcmp(s->paths[i].path, path) == 0)
-            return s->paths[i].actor_id;
-    }
-    return ACTOR_ID_INVALID;
+static bool sub_covers(const ns_state_t *s, actor_id_t subscriber,
+                       const char *path) {
+    for (size_t i = 0; i < s->sub_count; i++)
+        if (s->subs[i].subscriber == subscriber &&
+            has_prefix(path, s->subs[i].prefix))
+            return true;
+    return false;
 }
 
-static void ns_path_remove_actor(ns_state_t *s, actor_id_t id) {
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && s->paths[i].actor_id == id)
-            memset(&s->paths[i], 0, sizeof(path_entry_t));
+/* One MSG_NS_NOTIFY (or more, NS_NOTIFY_BATCH_MAX events each) per
+   subscriber, however many of its prefixes match */
+static void ns_flush(runtime_t *rt, ns_state_t *s) {
+    s->flush_queued = false;
+    ns_notify_t *batch = malloc(NS_NOTIFY_BATCH_MAX * sizeof(*batch));
+    if (!batch) {
+        s->pending_count = 0;
+        return;
     }
+    for (size_t i = 0; i < s->sub_count; i++) {
+        actor_id_t who = s->subs[i].subscriber;
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++)
+            seen = s->subs[j].subscriber == who;
+        if (seen) continue;
+
+        size_t n = 0;
+        for (size_t k = 0; k < s->pending_count; k++) {
+            const ns_pending_t *p = &s->pending[k];
+            if (p->only != ACTOR_ID_INVALID && p->only != who) continue;
+            if (!sub_covers(s, who, p->ev.path)) continue;
+            batch[n++] = p->ev;
+            if (n == NS_NOTIFY_BATCH_MAX) {
+                actor_send(rt, who, MSG_NS_NOTIFY, batch, n * sizeof(*batch));
+                n = 0;
+            }
+        }
+        if (n > 0)
+            actor_send(rt, who, MSG_NS_NOTIFY, batch, n * sizeof(*batch));
+    }
+    free(batch);
+    s->pending_count = 0;
 }
 
-/* ── Mount table operations ────────────────────────────────────────── */
+typedef struct {
+    runtime_t  *rt;
+    ns_state_t *s;
+    actor_id_t  only;
+    int32_t     event;
+} ns_snapshot_ctx_t;
+
+static bool snapshot_visit(const char *path, actor_id_t id, void *ctx) {
+    ns_snapshot_ctx_t *c = ctx;
+    ns_queue(c->rt, c->s, c->only, c->event, path, id);
+    return true;
+}
 
-static int ns_mount_add(ns_state_t *s, const char *mount_point,
-                         actor_id_t target) {
-    for (size_t i = 0; i < NS_MAX_MOUNTS; i++) {
-        if (s->mounts[i].occupied &&
-            strcmp(s->mounts[i].mount_point, mount_point) == 0)
+static int ns_subscribe_add(runtime_t *rt, ns_state_t *s, actor_id_t who,
+                            const ns_subscribe_t *req) {
+    if (who == ACTOR_ID_INVALID) return NS_EINVAL;
+    char prefix[NS_PATH_MAX];
+    snprintf(prefix, sizeof(prefix), "%.*s", NS_PATH_MAX - 1, req->prefix);
+    for (size_t i = 0; i < s->sub_count; i++)
+        if (s->subs[i].subscriber == who &&
+            strcmp(s->subs[i].prefix, prefix) == 0)
             return NS_EEXIST;
+    if (s->sub_count == s->sub_cap) {
+        size_t cap = s->sub_cap ? s->sub_cap * 2 : 4;
+        ns_sub_t *subs = realloc(s->subs, cap * sizeof(*subs));
+        if (!subs) return NS_EFULL;
+        s->subs = subs;
+        s->sub_cap = cap;
     }
-    for (size_t i = 0; i < NS_MAX_MOUNTS; i++) {
-        if (!s->mounts[i].occupied) {
-            snprintf(s->mounts[i].mount_point, NS_PATH_MAX, "%s", mount_point);
-            s->mounts[i].target = target;
-            s->mounts[i].occupied = true;
-            return NS_OK;
-        }
+    ns_sub_t *sub = &s->subs[s->sub_count++];
+    sub->subscriber = who;
+    sub->monitor = actor_monitor(rt, who);
+    memcpy(sub->prefix, prefix, sizeof(prefix));
+
+    if (req->flags & NS_SUB_SNAPSHOT) {
+        ns_snapshot_ctx_t c = { rt, s, who, NS_EVENT_MOUNT };
+        ns_trie_walk(&s->tree, NS_TRIE_MOUNT, prefix, snapshot_visit, &c);
+        c.event = NS_EVENT_REGISTER;
+        ns_trie_walk(&s->tree, NS_TRIE_PATH, prefix, snapshot_visit, &c);
     }
-    return NS_EFULL;
+    return NS_OK;
+}
+
+static void ns_sub_drop(ns_state_t *s, size_t i) {
+    s->subs[i] = s->subs[--s->sub_count];
 }
 
-static int ns_mount_remove(ns_state_t *s, const char *mount_point) {
-    for (size_t i = 0; i < NS_MAX_MOUNTS; i++) {
-        if (s->mounts[i].occupied &&
-            strcmp(s->mounts[i].mount_point, mount_point) == 0) {
-            memset(&s->mounts[i], 0, sizeof(mount_entry_t));
+static int ns_subscribe_remove(runtime_t *rt, ns_state_t *s, actor_id_t who,
+                               const ns_subscribe_t *req) {
+    char prefix[NS_PATH_MAX];
+    snprintf(prefix, sizeof(prefix), "%.*s", NS_PATH_MAX - 1, req->prefix);
+    for (size_t i = 0; i < s->sub_count; i++) {
+        if (s->subs[i].subscriber == who &&
+            strcmp(s->subs[i].prefix, prefix) == 0) {
+            actor_demonitor(rt, s->subs[i].monitor);
+            ns_sub_drop(s, i);
             return NS_OK;
         }
     }
     return NS_ENOENT;
 }
 
-static mount_entry_t *ns_mount_match(ns_state_t *s, const char *path) {
-    mount_entry_t *best = NULL;
-    size_t best_len = 0;
-    for (size_t i = 0; i < NS_MAX_MOUNTS; i++) {
-        if (!s->mounts[i].occupied) continue;
-        size_t mlen = strlen(s->mounts[i].mount_point);
-        if (mlen > best_len &&
-            strncmp(path, s->mounts[i].mount_point, mlen) == 0 &&
-            (path[mlen] == '/' || path[mlen] == '\0')) {
-            best = &s->mounts[i];
-            best_len = mlen;
-        }
-    }
-    return best;
+/* ── Path table walks ──────────────────────────────────────────────── */
+
+/* "path=id\n" lines into a caller buffer, skipping any that do not fit */
+typedef struct {
+    char   *buf;
+    size_t  size;
+    size_t  off;
+} ns_list_ctx_t;
+
+static bool list_visit(const char *path, actor_id_t id, void *ctx) {
+    ns_list_ctx_t *l = ctx;
+    int n = snprintf(l->buf + l->off, l->size - l->off, "%s=%llu\n",
+                     path, (unsigned long long)id);
+    if (n > 0 && (size_t)n < l->size - l->off) l->off += (size_t)n;
+    return true;
+}
+
+static size_t ns_list_into(ns_state_t *s, const char *prefix,
+                           char *buf, size_t size) {
+    ns_list_ctx_t l = { buf, size, 0 };
+    ns_trie_walk(&s->tree, NS_TRIE_PATH, prefix, list_visit, &l);
+    return l.off;
+}
+
+/* Match for ns_trie_remove_if: paths of one actor or one node, each
+   removal reported to subscribers (and to peers, when asked) */
+typedef struct {
+    runtime_t  *rt;
+    ns_state_t *s;
+    actor_id_t  id;           /* or ACTOR_ID_INVALID to match on node */
+    node_id_t   node;
+    bool        broadcast;
+} ns_purge_ctx_t;
+
+static bool purge_match(const char *path, actor_id_t id, void *ctx) {
+    ns_purge_ctx_t *c = ctx;
+    if (c->id != ACTOR_ID_INVALID ? id != c->id
+                                  : actor_id_node(id) != c->node)
+        return false;
+    if (c->broadcast)
+        runtime_registry_announce(c->rt, REGISTRY_PATH_DEL, path,
+                                  ACTOR_ID_INVALID);
+    name_registry_account(c->rt, path, id);
+    ns_note(c->rt, c->s, NS_EVENT_UNREGISTER, path, id);
+    return true;
 }
 
 /* ── Namespace actor behavior ──────────────────────────────────────── */
@@ -148,7 +280,12 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
         }
         const ns_register_t *req = msg->payload;
         if (req->path[0] == '/') {
-            reply.status = ns_path_register(s, req->path, req->actor_id);
+            reply.status = ns_trie_insert(&s->tree, NS_TRIE_PATH,
+                                          req->path, req->actor_id);
+            if (reply.status == NS_OK) {
+                name_registry_account(rt, req->path, req->actor_id);
+                ns_note(rt, s, NS_EVENT_REGISTER, req->path, req->actor_id);
+            }
         } else {
             bool ok = actor_register_name(rt, req->path, req->actor_id);
             reply.status = ok ? NS_OK : NS_EEXIST;
@@ -165,15 +302,9 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
         }
         const ns_lookup_t *req = msg->payload;
         if (req->path[0] == '/') {
-            mount_entry_t *mount = ns_mount_match(s, req->path);
-            if (mount) {
-                reply.status = NS_OK;
-                reply.actor_id = mount->target;
-                actor_send(rt, msg->source, MSG_NS_REPLY,
-                           &reply, sizeof(reply));
-                return true;
-            }
-            actor_id_t id = ns_path_lookup(s, req->path);
+            actor_id_t id = ns_trie_mount_for(&s->tree, req->path);
+            if (id == ACTOR_ID_INVALID)
+                id = ns_trie_get(&s->tree, NS_TRIE_PATH, req->path);
             if (id != ACTOR_ID_INVALID) {
                 reply.status = NS_OK;
                 reply.actor_id = id;
@@ -199,30 +330,17 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
             break;
         }
         const ns_list_req_t *req = msg->payload;
-        size_t prefix_len = strlen(req->prefix);
-        size_t off = 0;
-
-        for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-            if (!s->paths[i].occupied) continue;
-            if (prefix_len > 0 &&
-                strncmp(s->paths[i].path, req->prefix, prefix_len) != 0)
-                continue;
-            int n = snprintf(reply.data + off, NS_REPLY_PAYLOAD_MAX - off,
-                             "%s=%llu\n", s->paths[i].path,
-                             (unsigned long long)s->paths[i].actor_id);
-            if (n > 0 && (size_t)n < NS_REPLY_PAYLOAD_MAX - off)
-                off += (size_t)n;
-        }
+        size_t off = ns_list_into(s, req->prefix, reply.data,
+                                  NS_REPLY_PAYLOAD_MAX);
 
-        if (prefix_len == 0) {
-            name_entry_t *reg = runtime_get_name_registry(rt);
-            size_t cap = runtime_get_name_registry_size();
-            for (size_t i = 0; i < cap; i++) {
-                if (!reg[i].occupied) continue;
+        if (req->prefix[0] == '\0') {
+            const name_entry_t *e;
+            size_t pos = 0;
+            while ((e = name_registry_next(rt, &pos)) != NULL) {
                 int n = snprintf(reply.data + off,
                                  NS_REPLY_PAYLOAD_MAX - off,
-                                 "%s=%llu\n", reg[i].name,
-                                 (unsigned long long)reg[i].actor_id);
+                                 "%s=%llu\n", e->name,
+                                 (unsigned long long)e->actor_id);
                 if (n > 0 && (size_t)n < NS_REPLY_PAYLOAD_MAX - off)
                     off += (size_t)n;
             }
@@ -240,7 +358,12 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
             break;
         }
         const ns_mount_t *req = msg->payload;
-        reply.status = ns_mount_add(s, req->mount_point, req->target);
+        reply.status = ns_trie_insert(&s->tree, NS_TRIE_MOUNT,
+                                      req->mount_point, req->target);
+        if (reply.status == NS_OK) {
+            name_registry_touch(rt);
+            ns_note(rt, s, NS_EVENT_MOUNT, req->mount_point, req->target);
+        }
         actor_send(rt, msg->source, MSG_NS_REPLY, &reply, sizeof(reply));
         return true;
     }
@@ -251,7 +374,14 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
             break;
         }
         const ns_umount_t *req = msg->payload;
-        reply.status = ns_mount_remove(s, req->mount_point);
+        actor_id_t target = ns_trie_get(&s->tree, NS_TRIE_MOUNT,
+                                        req->mount_point);
+        reply.status = ns_trie_remove(&s->tree, NS_TRIE_MOUNT,
+                                      req->mount_point);
+        if (reply.status == NS_OK) {
+            name_registry_touch(rt);
+            ns_note(rt, s, NS_EVENT_UMOUNT, req->mount_point, target);
+        }
         actor_send(rt, msg->source, MSG_NS_REPLY, &reply, sizeof(reply));
         return true;
     }
@@ -259,7 +389,37 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
     case MSG_CHILD_EXIT: {
         if (msg->payload_size >= sizeof(child_exit_payload_t)) {
             const child_exit_payload_t *p = msg->payload;
-            ns_path_remove_actor(s, p->child_id);
+            ns_purge_ctx_t c = { rt, s, p->child_id, 0, false };
+            ns_trie_remove_if(&s->tree, purge_match, &c);
+        }
+        return true;
+    }
+
+    case MSG_NS_SUBSCRIBE:
+    case MSG_NS_UNSUBSCRIBE: {
+        if (msg->payload_size < sizeof(ns_subscribe_t)) {
+            reply.status = NS_EINVAL;
+            break;
+        }
+        reply.status = msg->type == MSG_NS_SUBSCRIBE
+            ? ns_subscribe_add(rt, s, msg->source, msg->payload)
+            : ns_subscribe_remove(rt, s, msg->source, msg->payload);
+        actor_send(rt, msg->source, MSG_NS_REPLY, &reply, sizeof(reply));
+        return true;
+    }
+
+    case MSG_NS_FLUSH:
+        ns_flush(rt, s);
+        return true;
+
+    case MSG_DOWN: {
+        if (msg->payload_size < sizeof(down_payload_t)) return true;
+        const down_payload_t *d = msg->payload;
+        for (size_t i = 0; i < s->sub_count; i++) {
+            if (s->subs[i].monitor == d->ref) {
+                ns_sub_drop(s, i);
+                break;
+            }
         }
         return true;
     }
@@ -278,55 +438,115 @@ static bool ns_behavior(runtime_t *rt, actor_t *self,
 actor_id_t ns_actor_init(runtime_t *rt) {
     ns_state_t *s = calloc(1, sizeof(ns_state_t));
     if (!s) return ACTOR_ID_INVALID;
+    ns_trie_init(&s->tree);
 
-    actor_id_t id = actor_spawn(rt, ns_behavior, s, free, 64);
+    actor_id_t id = actor_spawn(rt, ns_behavior, s, ns_state_free, 64);
     if (id == ACTOR_ID_INVALID) {
         free(s);
         return ACTOR_ID_INVALID;
     }
 
+    s->self = id;
     runtime_set_ns_state(rt, s);
 
     /* Register node identity paths */
     char node_path[NS_PATH_MAX];
     snprintf(node_path, NS_PATH_MAX, "/node/%s", mk_node_identity());
-    ns_path_register(s, node_path, id);
-    ns_path_register(s, "/sys/ns", id);
+    if (ns_trie_insert(&s->tree, NS_TRIE_PATH, node_path, id) == NS_OK)
+        name_registry_account(rt, node_path, id);
+    if (ns_trie_insert(&s->tree, NS_TRIE_PATH, "/sys/ns", id) == NS_OK)
+        name_registry_account(rt, "/sys/ns", id);
 
     actor_register_name(rt, "ns", id);
     return id;
 }
 
+static bool ns_send_subscription(runtime_t *rt, actor_id_t ns,
+                                 msg_type_t type, const char *prefix,
+                                 uint32_t flags) {
+    if (ns == ACTOR_ID_INVALID) {
+        ns_state_t *s = runtime_get_ns_state(rt);
+        if (!s) return false;
+        ns = s->self;
+    }
+    ns_subscribe_t req;
+    memset(&req, 0, sizeof(req));
+    snprintf(req.prefix, NS_PATH_MAX, "%s", prefix ? prefix : "");
+    req.flags = flags;
+    return actor_send(rt, ns, type, &req, sizeof(req));
+}
+
+bool ns_subscribe(runtime_t *rt, actor_id_t ns, const char *prefix,
+                  uint32_t flags) {
+    return ns_send_subscription(rt, ns, MSG_NS_SUBSCRIBE, prefix, flags);
+}
+
+bool ns_unsubscribe(runtime_t *rt, actor_id_t ns, const char *prefix) {
+    return ns_send_subscription(rt, ns, MSG_NS_UNSUBSCRIBE, prefix, 0);
+}
+
 /* ── Direct-access path operations (bypass message queue) ──────────── */
 
 int ns_register_path(runtime_t *rt, const char *path, actor_id_t id) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s) return NS_EINVAL;
-    return ns_path_register(s, path, id);
+    int rc = ns_trie_insert(&s->tree, NS_TRIE_PATH, path, id);
+    if (rc == NS_OK) {
+        name_registry_account(rt, path, id);
+        ns_note(rt, s, NS_EVENT_REGISTER, path, id);
+    }
+    return rc;
 }
 
 actor_id_t ns_lookup_path(runtime_t *rt, const char *path) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s) return ACTOR_ID_INVALID;
-    mount_entry_t *mount = ns_mount_match(s, path);
-    if (mount) return mount->target;
-    return ns_path_lookup(s, path);
+    actor_id_t mount = ns_trie_mount_for(&s->tree, path);
+    if (mount != ACTOR_ID_INVALID) return mount;
+    return ns_trie_get(&s->tree, NS_TRIE_PATH, path);
+}
+
+/* Reverse lookups walk the whole tree; they serve diagnostics, not sends */
+typedef struct {
+    actor_id_t id;
+    char      *buf;
+    size_t     size;
+    size_t     off;
+    size_t     found;
+} ns_owner_ctx_t;
+
+static bool first_owned_visit(const char *path, actor_id_t id, void *ctx) {
+    ns_owner_ctx_t *o = ctx;
+    if (id != o->id) return true;
+    size_t len = strlen(path);
+    if (len >= o->size) len = o->size - 1;
+    memcpy(o->buf, path, len);
+    o->buf[len] = '\0';
+    o->off = len;
+    return false;
 }
 
 size_t ns_reverse_lookup_path(runtime_t *rt, actor_id_t id,
                               char *buf, size_t buf_size) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s || !buf || buf_size == 0) return 0;
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && s->paths[i].actor_id == id) {
-            size_t len = strlen(s->paths[i].path);
-            if (len >= buf_size) len = buf_size - 1;
-            memcpy(buf, s->paths[i].path, len);
-            buf[len] = '\0';
-            return len;
-        }
-    }
-    return 0;
+    ns_owner_ctx_t o = { id, buf, buf_size, 0, 0 };
+    ns_trie_walk(&s->tree, NS_TRIE_PATH, NULL, first_owned_visit, &o);
+    return o.off;
+}
+
+static bool all_owned_visit(const char *path, actor_id_t id, void *ctx) {
+    ns_owner_ctx_t *o = ctx;
+    if (id != o->id) return true;
+    size_t len = strlen(path);
+    /* Need room for ", " separator + name + NUL */
+    size_t need = (o->off > 0 ? 2 : 0) + len;
+    if (o->off + need >= o->size) return true;  /* skip if no room */
+    if (o->off > 0) { o->buf[o->off++] = ','; o->buf[o->off++] = ' '; }
+    memcpy(o->buf + o->off, path, len);
+    o->off += len;
+    o->found++;
+    return true;
 }
 
 size_t ns_reverse_lookup_all_paths(runtime_t *rt, actor_id_t id,
@@ -334,82 +554,73 @@ size_t ns_reverse_lookup_all_paths(runtime_t *rt, actor_id_t id,
                                    size_t *offset) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s || !buf || buf_size == 0) return 0;
-    size_t found = 0;
-    size_t off = *offset;
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && s->paths[i].actor_id == id) {
-            size_t len = strlen(s->paths[i].path);
-            /* Need room for ", " separator + name + NUL */
-            size_t need = (off > 0 ? 2 : 0) + len;
-            if (off + need >= buf_size) continue;  /* skip if no room */
-            if (off > 0) { buf[off++] = ','; buf[off++] = ' '; }
-            memcpy(buf + off, s->paths[i].path, len);
-            off += len;
-            found++;
-        }
-    }
-    buf[off] = '\0';
-    *offset = off;
-    return found;
+    ns_owner_ctx_t o = { id, buf, buf_size, *offset, 0 };
+    ns_trie_walk(&s->tree, NS_TRIE_PATH, NULL, all_owned_visit, &o);
+    buf[o.off] = '\0';
+    *offset = o.off;
+    return o.found;
 }
 
 void ns_deregister_actor_paths(runtime_t *rt, actor_id_t id) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s) return;
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && s->paths[i].actor_id == id) {
-            /* Broadcast deregistration to peers */
-            path_unregister_payload_t p;
-            memset(&p, 0, sizeof(p));
-            snprintf(p.path, NS_PATH_MAX, "%s", s->paths[i].path);
-            runtime_broadcast_registry(rt, MSG_PATH_UNREGISTER,
-                                        &p, sizeof(p));
-            memset(&s->paths[i], 0, sizeof(path_entry_t));
-        }
-    }
+    ns_purge_ctx_t c = { rt, s, id, 0, true };
+    ns_trie_remove_if(&s->tree, purge_match, &c);
 }
 
 void ns_remove_path(runtime_t *rt, const char *path) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s || !path) return;
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (s->paths[i].occupied && strcmp(s->paths[i].path, path) == 0) {
-            memset(&s->paths[i], 0, sizeof(path_entry_t));
-            return;
-        }
+    actor_id_t id = ns_trie_get(&s->tree, NS_TRIE_PATH, path);
+    if (ns_trie_remove(&s->tree, NS_TRIE_PATH, path) == NS_OK) {
+        name_registry_account(rt, path, id);
+        ns_note(rt, s, NS_EVENT_UNREGISTER, path, id);
     }
 }
 
+void ns_purge_node_paths(runtime_t *rt, node_id_t node) {
+    ns_state_t *s = runtime_get_ns_state(rt);
+    if (!s) return;
+    ns_purge_ctx_t c = { rt, s, ACTOR_ID_INVALID, node, false };
+    ns_trie_remove_if(&s->tree, purge_match, &c);
+}
+
 size_t ns_list_paths(runtime_t *rt, const char *prefix, char *buf, size_t buf_size) {
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s || !buf || buf_size == 0) return 0;
-    size_t prefix_len = prefix ? strlen(prefix) : 0;
-    size_t off = 0;
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (!s->paths[i].occupied) continue;
-        if (prefix_len > 0 &&
-            strncmp(s->paths[i].path, prefix, prefix_len) != 0)
-            continue;
-        int n = snprintf(buf + off, buf_size - off, "%s=%llu\n",
-                         s->paths[i].path,
-                         (unsigned long long)s->paths[i].actor_id);
-        if (n > 0 && (size_t)n < buf_size - off) off += (size_t)n;
-    }
-    return off;
+    return ns_list_into(s, prefix, buf, buf_size);
 }
 
 /* ── Cross-node sync + mount ────────────────────────────────────────── */
 
+static bool sync_path_visit(const char *path, actor_id_t id, void *ctx) {
+    transport_t *tp = ctx;
+    path_register_payload_t p;
+    memset(&p, 0, sizeof(p));
+    snprintf(p.path, NS_PATH_MAX, "%s", path);
+    p.actor_id = id;
+    message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                                     MSG_PATH_REGISTER, &p, sizeof(p));
+    if (msg) { tp->send(tp, msg); message_destroy(msg); }
+    return true;
+}
+
+void ns_walk_paths(runtime_t *rt,
+                   bool (*fn)(const char *path, actor_id_t id, void *ctx),
+                   void *ctx) {
+    ns_state_t *s = runtime_get_ns_state(rt);
+    if (s) ns_trie_walk(&s->tree, NS_TRIE_PATH, NULL, fn, ctx);
+}
+
 void ns_sync_to_transport(runtime_t *rt, transport_t *tp) {
     /* Sync flat names */
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t cap = runtime_get_name_registry_size();
-    for (size_t i = 0; i < cap; i++) {
-        if (!reg[i].occupied) continue;
+    const name_entry_t *e;
+    size_t pos = 0;
+    while ((e = name_registry_next(rt, &pos)) != NULL) {
         name_register_payload_t p;
         memset(&p, 0, sizeof(p));
-        snprintf(p.name, sizeof(p.name), "%s", reg[i].name);
-        p.actor_id = reg[i].actor_id;
+        snprintf(p.name, sizeof(p.name), "%s", e->name);
+        p.actor_id = e->actor_id;
         message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
                                          MSG_NAME_REGISTER, &p, sizeof(p));
         if (msg) { tp->send(tp, msg); message_destroy(msg); }
@@ -418,16 +629,7 @@ void ns_sync_to_transport(runtime_t *rt, transport_t *tp) {
     /* Sync paths */
     ns_state_t *s = runtime_get_ns_state(rt);
     if (!s) return;
-    for (size_t i = 0; i < NS_MAX_PATH_ENTRIES; i++) {
-        if (!s->paths[i].occupied) continue;
-        path_register_payload_t p;
-        memset(&p, 0, sizeof(p));
-        snprintf(p.path, NS_PATH_MAX, "%s", s->paths[i].path);
-        p.actor_id = s->paths[i].actor_id;
-        message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
-                                         MSG_PATH_REGISTER, &p, sizeof(p));
-        if (msg) { tp->send(tp, msg); message_destroy(msg); }
-    }
+    ns_trie_walk(&s->tree, NS_TRIE_PATH, NULL, sync_path_visit, tp);
 }
 
 static ssize_t recv_full(int fd, void *buf, size_t len) {
@@ -445,31 +647,104 @@ static void set_nonblocking_ns(int fd) {
     if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
-int ns_mount_connect(runtime_t *rt, const char *host, uint16_t port,
-                     mount_result_t *result) {
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (fd < 0) return -1;
+static void mount_hello_init(runtime_t *rt, mount_hello_t *hello) {
+    memset(hello, 0, sizeof(*hello));
+    hello->magic = htonl(MOUNT_HELLO_MAGIC);
+    hello->node_id = htonl(runtime_get_node_id(rt));
+    snprintf(hello->identity, sizeof(hello->identity), "%s", mk_node_identity());
+    hello->wire_version = WIRE_VERSION_MAX;
+    hello->features = MOUNT_FEATURE_COMPRESS | MOUNT_FEATURE_REGISTRY_SYNC;
+}
 
-    struct timeval tv = {3, 0};
-    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+/* Wire version both sides agree on.  v1 peers leave the field zero, or
+   (with a 29+ char identity) hold printable text there. */
+static uint8_t mount_hello_wire_version(const mount_hello_t *peer) {
+    uint8_t v = peer->wire_version;
+    if (v < WIRE_VERSION_2 || v >= 0x20) return WIRE_VERSION_1;
+    return v < WIRE_VERSION_MAX ? v : WIRE_VERSION_MAX;
+}
 
-    struct sockaddr_in addr = {0};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
-        close(fd); return -1;
+/* Decide whether a peer's hello may attach under its node ID.  Node IDs
+   are 32-bit hashes, so a clash is unlikely but must not silently
+   hijack another peer's traffic: an ID already held by a connected peer
+   with a different identity is refused.  The same identity reconnecting
+   replaces its old transport.
+
+   A node reached through a gateway holds its ID too, but routes don't
+   carry identities.  One that was once mounted here is checked against
+   the identity it had then; one only ever seen behind a gateway can't
+   be told from a clash, so it is let in and the direct link wins. */
+static bool mount_peer_admit(runtime_t *rt, const mount_hello_t *peer) {
+    node_id_t node = ntohl(peer->node_id);
+    if (node == 0 || node == runtime_get_node_id(rt)) return false;
+
+    char identity[sizeof(peer->identity)];
+    snprintf(identity, sizeof(identity), "%.*s",
+             (int)sizeof(peer->identity), peer->identity);
+
+    ns_state_t *s = runtime_get_ns_state(rt);
+    mount_peer_t *known = NULL;
+    for (size_t i = 0; s && i < s->peer_count; i++)
+        if (s->peers[i].node_id == node) known = &s->peers[i];
+
+    bool same = known && strcmp(known->identity, identity) == 0;
+    transport_t *cur = runtime_get_transport(rt, node);
+    if (cur && cur->is_connected(cur) && !same) return false;
+
+    node_id_t hop;
+    if (known && !same && runtime_get_route(rt, node, &hop, NULL) &&
+        hop != node)
+        return false;
+
+    if (!s) return true;
+    if (!known) {
+        if (s->peer_count == s->peer_cap) {
+            size_t cap = s->peer_cap ? s->peer_cap * 2 : 16;
+            mount_peer_t *p = realloc(s->peers, cap * sizeof(*p));
+            if (!p) return false;
+            s->peers = p;
+            s->peer_cap = cap;
+        }
+        known = &s->peers[s->peer_count++];
+        known->node_id = node;
     }
-    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(fd); return -1;
+    memcpy(known->identity, identity, sizeof(known->identity));
+    return true;
+}
+
+/* Apply what the hellos negotiated to a freshly wrapped mount transport */
+static void mount_configure_transport(transport_t *tp,
+                                      const mount_hello_t *peer) {
+    uint8_t version = mount_hello_wire_version(peer);
+    transport_tcp_set_wire_version(tp, version);
+    if (version >= WIRE_VERSION_2 && (peer->features & MOUNT_FEATURE_COMPRESS))
+        transport_tcp_set_compression(tp, WIRE_COMPRESS_THRESHOLD);
+}
+
+/* Bring a new mount peer up to date: a digest if it speaks registry
+   deltas (it answers with what we lack, and we with what it lacks),
+   else every binding we hold */
+static void mount_sync(runtime_t *rt, transport_t *tp,
+                       const mount_hello_t *peer) {
+    if (mount_hello_wire_version(peer) >= WIRE_VERSION_2 &&
+        (peer->features & MOUNT_FEATURE_REGISTRY_SYNC)) {
+        runtime_send_registry_digest(rt, tp);
+        return;
     }
+    runtime_set_registry_legacy(rt, tp->peer_node);
+    ns_sync_to_transport(rt, tp);
+}
+
+/* Hello exchange on a connected, blocking socket, then attach it as the
+   peer's transport and sync our registrations.  Closes fd on failure. */
+static int mount_handshake(runtime_t *rt, int fd, mount_result_t *result) {
+    struct timeval tv = {3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 
     /* Send our hello */
     mount_hello_t hello;
-    memset(&hello, 0, sizeof(hello));
-    hello.magic = htonl(MOUNT_HELLO_MAGIC);
-    hello.node_id = htonl(runtime_get_node_id(rt));
-    snprintf(hello.identity, sizeof(hello.identity), "%s", mk_node_identity());
+    mount_hello_init(rt, &hello);
     if (send(fd, &hello, sizeof(hello), 0) != sizeof(hello)) {
         close(fd); return -1;
     }
@@ -484,7 +759,7 @@ int ns_mount_connect(runtime_t *rt, const char *host, uint16_t port,
     }
 
     node_id_t peer_node = ntohl(peer.node_id);
-    if (peer_node == 0 || peer_node == runtime_get_node_id(rt)) {
+    if (!mount_peer_admit(rt, &peer)) {
         close(fd); return -1;  /* collision or invalid */
     }
 
@@ -492,21 +767,225 @@ int ns_mount_connect(runtime_t *rt, const char *host, uint16_t port,
     set_nonblocking_ns(fd);
     transport_t *tp = transport_tcp_from_fd(fd, peer_node);
     if (!tp) { close(fd); return -1; }
+    mount_configure_transport(tp, &peer);
     if (!runtime_add_transport(rt, tp)) {
         tp->destroy(tp); return -1;
     }
 
     /* Sync registrations */
-    ns_sync_to_transport(rt, tp);
+    mount_sync(rt, tp, &peer);
 
     if (result) {
         memset(result, 0, sizeof(*result));
-        snprintf(result->identity, sizeof(result->identity), "%s", peer.identity);
+        snprintf(result->identity, sizeof(result->identity), "%.*s",
+                 (int)sizeof(peer.identity), peer.identity);
         result->node_id = peer_node;
     }
     return 0;
 }
 
+/* ── Mount keeper (reconnect with backoff) ─────────────────────────── */
+
+/* Links made by ns_mount_connect are remembered.  When one's peer is
+   lost the keeper redials it, doubling the delay after every failed
+   attempt.  The TCP connect is non-blocking; only the hello exchange
+   blocks (3 s at most), as it does for ns_mount_connect. */
+
+#define MOUNT_RETRY_MIN_MS 250
+#define MOUNT_RETRY_MAX_MS 30000
+#define MOUNT_AUDIT_MS     1000
+
+/* Sent once to a new keeper so it subscribes to node events */
+#define MSG_KEEPER_START ((msg_type_t)0xFF0000FE)
+
+typedef struct {
+    struct sockaddr_in addr;
+    node_id_t          node_id;
+    uint32_t           backoff_ms;
+    timer_id_t         timer;     /* retry pending, 0 = none */
+    int                fd;        /* connect in progress, -1 = none */
+} mount_link_t;
+
+typedef struct {
+    mount_link_t *links;
+    size_t        count;
+    size_t        cap;
+    timer_id_t    audit;
+} mount_keeper_state_t;
+
+static void mount_keeper_free(void *state) {
+    mount_keeper_state_t *mk = state;
+    for (size_t i = 0; i < mk->count; i++)
+        if (mk->links[i].fd >= 0) close(mk->links[i].fd);
+    free(mk->links);
+    free(mk);
+}
+
+static void keeper_schedule(runtime_t *rt, mount_link_t *l) {
+    l->timer = actor_set_timer(rt, l->backoff_ms, false);
+}
+
+static void keeper_failed(runtime_t *rt, mount_link_t *l) {
+    if (l->fd >= 0) {
+        actor_unwatch_fd(rt, l->fd);
+        close(l->fd);
+        l->fd = -1;
+    }
+    l->backoff_ms = l->backoff_ms * 2 > MOUNT_RETRY_MAX_MS
+        ? MOUNT_RETRY_MAX_MS : l->backoff_ms * 2;
+    keeper_schedule(rt, l);
+}
+
+/* Schedule a redial for every idle link whose peer is not attached */
+static void keeper_audit(runtime_t *rt, mount_keeper_state_t *mk) {
+    for (size_t i = 0; i < mk->count; i++) {
+        mount_link_t *l = &mk->links[i];
+        if (l->timer || l->fd >= 0) continue;
+        if (runtime_get_transport(rt, l->node_id)) continue;
+        keeper_schedule(rt, l);
+    }
+}
+
+static void keeper_dial(runtime_t *rt, mount_link_t *l) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { keeper_failed(rt, l); return; }
+    set_nonblocking_ns(fd);
+    if (connect(fd, (struct sockaddr *)&l->addr, sizeof(l->addr)) < 0 &&
+        errno != EINPROGRESS) {
+        close(fd);
+        keeper_failed(rt, l);
+        return;
+    }
+    l->fd = fd;
+    actor_watch_fd(rt, fd, POLLOUT);
+}
+
+static void keeper_connected(runtime_t *rt, mount_link_t *l) {
+    int fd = l->fd;
+    actor_unwatch_fd(rt, fd);
+    l->fd = -1;
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err) {
+        close(fd);
+        keeper_failed(rt, l);
+        return;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+
+    mount_result_t result;
+    if (mount_handshake(rt, fd, &result) != 0) {
+        keeper_failed(rt, l);
+        return;
+    }
+    l->node_id = result.node_id;
+    l->backoff_ms = MOUNT_RETRY_MIN_MS;
+}
+
+static bool mount_keeper_behavior(runtime_t *rt, actor_t *self,
+                                  message_t *msg, void *state) {
+    (void)self;
+    mount_keeper_state_t *mk = state;
+
+    if (msg->type == MSG_KEEPER_START) {
+        actor_watch_nodes(rt);
+        mk->audit = actor_set_timer(rt, MOUNT_AUDIT_MS, true);
+        return true;
+    }
+
+    if (msg->type == MSG_NODE_DOWN) {
+        keeper_audit(rt, mk);
+    } else if (msg->type == MSG_TIMER) {
+        const timer_payload_t *t = msg->payload;
+        if (t->id == mk->audit) {
+            keeper_audit(rt, mk);
+            return true;
+        }
+        for (size_t i = 0; i < mk->count; i++) {
+            mount_link_t *l = &mk->links[i];
+            if (l->timer != t->id) continue;
+            l->timer = 0;
+            /* The peer may have dialled us in the meantime */
+            if (!runtime_get_transport(rt, l->node_id)) keeper_dial(rt, l);
+            break;
+        }
+    } else if (msg->type == MSG_FD_EVENT) {
+        const fd_event_payload_t *ev = msg->payload;
+        for (size_t i = 0; i < mk->count; i++) {
+            if (mk->links[i].fd != ev->fd) continue;
+            keeper_connected(rt, &mk->links[i]);
+            break;
+        }
+    }
+    return true;
+}
+
+/* Remember a link made by ns_mount_connect (needs ns_actor_init) */
+static void mount_keeper_track(runtime_t *rt, const struct sockaddr_in *addr,
+                               node_id_t node) {
+    ns_state_t *s = runtime_get_ns_state(rt);
+    if (!s) return;
+
+    mount_keeper_state_t *mk = s->keeper != ACTOR_ID_INVALID
+        ? runtime_get_actor_state(rt, s->keeper) : NULL;
+    if (!mk) {
+        mk = calloc(1, sizeof(*mk));
+        if (!mk) return;
+        s->keeper = actor_spawn(rt, mount_keeper_behavior, mk,
+                                mount_keeper_free, 16);
+        if (s->keeper == ACTOR_ID_INVALID) { free(mk); return; }
+        runtime_deliver_msg(rt, s->keeper, MSG_KEEPER_START, NULL, 0);
+    }
+
+    for (size_t i = 0; i < mk->count; i++) {
+        mount_link_t *l = &mk->links[i];
+        if (l->addr.sin_addr.s_addr == addr->sin_addr.s_addr &&
+            l->addr.sin_port == addr->sin_port) {
+            l->node_id = node;
+            l->backoff_ms = MOUNT_RETRY_MIN_MS;
+            return;
+        }
+    }
+    if (mk->count == mk->cap) {
+        size_t cap = mk->cap ? mk->cap * 2 : 4;
+        mount_link_t *links = realloc(mk->links, cap * sizeof(*links));
+        if (!links) return;
+        mk->links = links;
+        mk->cap = cap;
+    }
+    mk->links[mk->count++] = (mount_link_t){
+        .addr = *addr, .node_id = node,
+        .backoff_ms = MOUNT_RETRY_MIN_MS, .fd = -1 };
+}
+
+int ns_mount_connect(runtime_t *rt, const char *host, uint16_t port,
+                     mount_result_t *result) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct timeval tv = {3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        close(fd); return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd); return -1;
+    }
+
+    mount_result_t r;
+    if (mount_handshake(rt, fd, &r) != 0) return -1;
+    mount_keeper_track(rt, &addr, r.node_id);
+    if (result) *result = r;
+    return 0;
+}
+
 /* ── Mount listener actor ──────────────────────────────────────────── */
 
 typedef struct {
@@ -553,16 +1032,13 @@ static bool mount_listener_behavior(runtime_t *rt, actor_t *self,
     }
 
     node_id_t peer_node = ntohl(peer.node_id);
-    if (peer_node == 0 || peer_node == runtime_get_node_id(rt)) {
+    if (!mount_peer_admit(rt, &peer)) {
         close(client_fd); return true;
     }
 
     /* Send our hello */
     mount_hello_t hello;
-    memset(&hello, 0, sizeof(hello));
-    hello.magic = htonl(MOUNT_HELLO_MAGIC);
-    hello.node_id = htonl(runtime_get_node_id(rt));
-    snprintf(hello.identity, sizeof(hello.identity), "%s", mk_node_identity());
+    mount_hello_init(rt, &hello);
     if (send(client_fd, &hello, sizeof(hello), 0) != sizeof(hello)) {
         close(client_fd); return true;
     }
@@ -571,11 +1047,12 @@ static bool mount_listener_behavior(runtime_t *rt, actor_t *self,
     set_nonblocking_ns(client_fd);
     transport_t *tp = transport_tcp_from_fd(client_fd, peer_node);
     if (!tp) { close(client_fd); return true; }
+    mount_configure_transport(tp, &peer);
     if (!runtime_add_transport(rt, tp)) {
         tp->destroy(tp); return true;
     }
 
-    ns_sync_to_transport(rt, tp);
+    mount_sync(rt, tp, &peer);
     return true;
 }
 
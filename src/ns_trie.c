@@ -0,0 +1,335 @@
+#include "ns_trie.h"
+#include "microkernel/namespace.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Nodes ─────────────────────────────────────────────────────────── */
+
+static ns_trie_node_t *node_new(const char *label, size_t len) {
+    ns_trie_node_t *n = calloc(1, sizeof(*n));
+    if (!n) return NULL;
+    n->label = malloc(len + 1);
+    if (!n->label) {
+        free(n);
+        return NULL;
+    }
+    memcpy(n->label, label, len);
+    n->label[len] = '\0';
+    n->label_len = len;
+    n->path = ACTOR_ID_INVALID;
+    n->mount = ACTOR_ID_INVALID;
+    return n;
+}
+
+static void node_free_kids(ns_trie_node_t *n) {
+    for (size_t i = 0; i < n->kid_count; i++) {
+        node_free_kids(n->kids[i]);
+        free(n->kids[i]->label);
+        free(n->kids[i]);
+    }
+    free(n->kids);
+    n->kids = NULL;
+    n->kid_count = n->kid_cap = 0;
+}
+
+static bool node_empty(const ns_trie_node_t *n) {
+    return n->path == ACTOR_ID_INVALID && n->mount == ACTOR_ID_INVALID;
+}
+
+static bool kid_insert(ns_trie_node_t *n, size_t at, ns_trie_node_t *kid) {
+    if (n->kid_count == n->kid_cap) {
+        size_t cap = n->kid_cap ? n->kid_cap * 2 : 2;
+        ns_trie_node_t **kids = realloc(n->kids, cap * sizeof(*kids));
+        if (!kids) return false;
+        n->kids = kids;
+        n->kid_cap = cap;
+    }
+    memmove(&n->kids[at + 1], &n->kids[at],
+            (n->kid_count - at) * sizeof(n->kids[0]));
+    n->kids[at] = kid;
+    n->kid_count++;
+    return true;
+}
+
+/* Restore the invariants after n->kids[i] lost a value: drop it if it is
+   now a bare leaf, fold it into its only child if it is a bare branch */
+static void kid_tidy(ns_trie_node_t *n, size_t i) {
+    ns_trie_node_t *k = n->kids[i];
+    if (!node_empty(k) || k->kid_count > 1) return;
+    if (k->kid_count == 0) {
+        memmove(&n->kids[i], &n->kids[i + 1],
+                (n->kid_count - i - 1) * sizeof(n->kids[0]));
+        n->kid_count--;
+    } else {
+        ns_trie_node_t *c = k->kids[0];
+        char *label = malloc(k->label_len + c->label_len + 1);
+        if (!label) return;   /* still correct, just one level deeper */
+        memcpy(label, k->label, k->label_len);
+        memcpy(label + k->label_len, c->label, c->label_len + 1);
+        free(c->label);
+        c->label = label;
+        c->label_len += k->label_len;
+        n->kids[i] = c;
+    }
+    free(k->kids);
+    free(k->label);
+    free(k);
+}
+
+/* ── Components ────────────────────────────────────────────────────── */
+
+/* Length of the first component of s, counting its leading '/' */
+static size_t first_len(const char *s, size_t len) {
+    if (len == 0) return 0;
+    size_t i = 1;
+    while (i < len && s[i] != '/') i++;
+    return i;
+}
+
+static bool at_boundary(char c) {
+    return c == '/' || c == '\0';
+}
+
+/* Index of the kid whose first component is key's, or where it would go */
+static size_t kid_find(const ns_trie_node_t *n, const char *key,
+                       size_t key_first, bool *found) {
+    size_t lo = 0, hi = n->kid_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const ns_trie_node_t *k = n->kids[mid];
+        size_t kl = first_len(k->label, k->label_len);
+        size_t m = kl < key_first ? kl : key_first;
+        int c = memcmp(k->label, key, m);
+        if (c == 0) c = (kl > key_first) - (kl < key_first);
+        if (c == 0) {
+            *found = true;
+            return mid;
+        }
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = false;
+    return lo;
+}
+
+/* The kid whose whole label starts key at a component boundary */
+static ns_trie_node_t *kid_step(const ns_trie_node_t *n, const char *key) {
+    bool found;
+    size_t i = kid_find(n, key, first_len(key, strlen(key)), &found);
+    if (!found) return NULL;
+    ns_trie_node_t *k = n->kids[i];
+    if (strncmp(k->label, key, k->label_len) != 0 ||
+        !at_boundary(key[k->label_len]))
+        return NULL;
+    return k;
+}
+
+/* Longest shared run of whole components of label and key */
+static size_t common_len(const char *label, size_t len, const char *key) {
+    size_t common = 0;
+    for (size_t i = 0;; i++) {
+        char a = i < len ? label[i] : '\0';
+        char b = key[i];
+        if (i > 0 && at_boundary(a) && at_boundary(b)) common = i;
+        if (a == '\0' || b == '\0' || a != b) return common;
+    }
+}
+
+static const ns_trie_node_t *find_node(const ns_trie_t *t, const char *key) {
+    const ns_trie_node_t *n = &t->root;
+    while (n && *key) {
+        n = kid_step(n, key);
+        if (n) key += n->label_len;
+    }
+    return n;
+}
+
+static actor_id_t *slot_of(ns_trie_node_t *n, ns_trie_kind_t kind) {
+    return kind == NS_TRIE_MOUNT ? &n->mount : &n->path;
+}
+
+static actor_id_t value_of(const ns_trie_node_t *n, ns_trie_kind_t kind) {
+    return kind == NS_TRIE_MOUNT ? n->mount : n->path;
+}
+
+/* ── Public ────────────────────────────────────────────────────────── */
+
+void ns_trie_init(ns_trie_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->root.label = "";
+    t->root.path = ACTOR_ID_INVALID;
+    t->root.mount = ACTOR_ID_INVALID;
+}
+
+void ns_trie_free(ns_trie_t *t) {
+    node_free_kids(&t->root);
+    t->paths = t->mounts = 0;
+}
+
+int ns_trie_insert(ns_trie_t *t, ns_trie_kind_t kind, const char *key,
+                   actor_id_t id) {
+    size_t klen = key ? strlen(key) : 0;
+    if (klen == 0 || klen >= NS_PATH_MAX || id == ACTOR_ID_INVALID)
+        return NS_EINVAL;
+
+    ns_trie_node_t *n = &t->root;
+    while (*key) {
+        bool found;
+        size_t i = kid_find(n, key, first_len(key, strlen(key)), &found);
+        if (!found) {
+            ns_trie_node_t *leaf = node_new(key, strlen(key));
+            if (!leaf || !kid_insert(n, i, leaf)) {
+                if (leaf) free(leaf->label);
+                free(leaf);
+                return NS_EFULL;
+            }
+            n = leaf;
+            break;
+        }
+        ns_trie_node_t *k = n->kids[i];
+        size_t common = common_len(k->label, k->label_len, key);
+        if (common < k->label_len) {
+            /* key leaves k's label part way: split k at the boundary */
+            ns_trie_node_t *mid = node_new(k->label, common);
+            if (!mid || !kid_insert(mid, 0, k)) {
+                if (mid) free(mid->label);
+                free(mid);
+                return NS_EFULL;
+            }
+            memmove(k->label, k->label + common, k->label_len - common + 1);
+            k->label_len -= common;
+            n->kids[i] = mid;
+            k = mid;
+        }
+        n = k;
+        key += common;
+    }
+
+    actor_id_t *slot = slot_of(n, kind);
+    if (*slot != ACTOR_ID_INVALID) return NS_EEXIST;
+    *slot = id;
+    if (kind == NS_TRIE_MOUNT) t->mounts++;
+    else t->paths++;
+    return NS_OK;
+}
+
+actor_id_t ns_trie_get(const ns_trie_t *t, ns_trie_kind_t kind,
+                       const char *key) {
+    if (!key || !*key) return ACTOR_ID_INVALID;
+    const ns_trie_node_t *n = find_node(t, key);
+    return n ? value_of(n, kind) : ACTOR_ID_INVALID;
+}
+
+static int remove_below(ns_trie_node_t *n, ns_trie_kind_t kind,
+                        const char *key) {
+    if (!*key) {
+        actor_id_t *slot = slot_of(n, kind);
+        if (*slot == ACTOR_ID_INVALID) return NS_ENOENT;
+        *slot = ACTOR_ID_INVALID;
+        return NS_OK;
+    }
+    bool found;
+    size_t i = kid_find(n, key, first_len(key, strlen(key)), &found);
+    if (!found) return NS_ENOENT;
+    ns_trie_node_t *k = n->kids[i];
+    if (strncmp(k->label, key, k->label_len) != 0 ||
+        !at_boundary(key[k->label_len]))
+        return NS_ENOENT;
+    int rc = remove_below(k, kind, key + k->label_len);
+    if (rc == NS_OK) kid_tidy(n, i);
+    return rc;
+}
+
+int ns_trie_remove(ns_trie_t *t, ns_trie_kind_t kind, const char *key) {
+    if (!key || !*key) return NS_ENOENT;
+    int rc = remove_below(&t->root, kind, key);
+    if (rc == NS_OK) {
+        if (kind == NS_TRIE_MOUNT) t->mounts--;
+        else t->paths--;
+    }
+    return rc;
+}
+
+actor_id_t ns_trie_mount_for(const ns_trie_t *t, const char *path) {
+    if (!path || t->mounts == 0) return ACTOR_ID_INVALID;
+    actor_id_t best = ACTOR_ID_INVALID;
+    const ns_trie_node_t *n = &t->root;
+    while (*path && (n = kid_step(n, path)) != NULL) {
+        path += n->label_len;
+        if (n->mount != ACTOR_ID_INVALID) best = n->mount;
+    }
+    return best;
+}
+
+/* ── Walks ─────────────────────────────────────────────────────────── */
+
+/* buf[0..len) spells the path down to and including n */
+static bool walk_all(const ns_trie_node_t *n, ns_trie_kind_t kind,
+                     char *buf, size_t len, ns_trie_visit_fn fn, void *ctx) {
+    actor_id_t id = value_of(n, kind);
+    if (id != ACTOR_ID_INVALID) {
+        buf[len] = '\0';
+        if (!fn(buf, id, ctx)) return false;
+    }
+    for (size_t i = 0; i < n->kid_count; i++) {
+        const ns_trie_node_t *k = n->kids[i];
+        memcpy(buf + len, k->label, k->label_len);
+        if (!walk_all(k, kind, buf, len + k->label_len, fn, ctx))
+            return false;
+    }
+    return true;
+}
+
+/* As walk_all, for the paths below n that continue with `rest` */
+static bool walk_prefix(const ns_trie_node_t *n, ns_trie_kind_t kind,
+                        char *buf, size_t len,
+                        const char *rest, size_t rest_len,
+                        ns_trie_visit_fn fn, void *ctx) {
+    if (rest_len == 0) return walk_all(n, kind, buf, len, fn, ctx);
+    for (size_t i = 0; i < n->kid_count; i++) {
+        const ns_trie_node_t *k = n->kids[i];
+        size_t m = k->label_len < rest_len ? k->label_len : rest_len;
+        if (memcmp(k->label, rest, m) != 0) continue;
+        memcpy(buf + len, k->label, k->label_len);
+        if (!walk_prefix(k, kind, buf, len + k->label_len,
+                         rest + m, rest_len - m, fn, ctx))
+            return false;
+    }
+    return true;
+}
+
+void ns_trie_walk(const ns_trie_t *t, ns_trie_kind_t kind,
+                  const char *prefix, ns_trie_visit_fn fn, void *ctx) {
+    char buf[NS_PATH_MAX];
+    size_t plen = prefix ? strlen(prefix) : 0;
+    walk_prefix(&t->root, kind, buf, 0, prefix, plen, fn, ctx);
+}
+
+static size_t remove_if_below(ns_trie_node_t *n, char *buf, size_t len,
+                              ns_trie_visit_fn match, void *ctx) {
+    size_t removed = 0;
+    if (n->path != ACTOR_ID_INVALID) {
+        buf[len] = '\0';
+        if (match(buf, n->path, ctx)) {
+            n->path = ACTOR_ID_INVALID;
+            removed++;
+        }
+    }
+    /* Backwards, so tidying kid i leaves the unvisited ones in place */
+    for (size_t i = n->kid_count; i-- > 0;) {
+        ns_trie_node_t *k = n->kids[i];
+        memcpy(buf + len, k->label, k->label_len);
+        size_t r = remove_if_below(k, buf, len + k->label_len, match, ctx);
+        if (r) kid_tidy(n, i);
+        removed += r;
+    }
+    return removed;
+}
+
+size_t ns_trie_remove_if(ns_trie_t *t, ns_trie_visit_fn match, void *ctx) {
+    if (t->paths == 0) return 0;
+    char buf[NS_PATH_MAX];
+    size_t removed = remove_if_below(&t->root, buf, 0, match, ctx);
+    t->paths -= removed;
+    return removed;
+}
@@ -0,0 +1,67 @@
+#ifndef NS_TRIE_H
+#define NS_TRIE_H
+
+#include "microkernel/types.h"
+
+/* Compressed radix trie over /path components, shared by the namespace
+   path table and the mount table.
+
+   Edges are cut only at component boundaries (just before a '/'), so an
+   edge label is one or more whole components, e.g. "/node" or
+   "/sys/ns".  Siblings differ in their first component and are kept
+   sorted by it: lookup is a binary search per level, O(path length)
+   overall, and a walk visits paths in component order.  A node carries a
+   registered path, a mount point, both, or neither (a pure branch);
+   branches with a single child are merged back into it on removal. */
+
+typedef struct ns_trie_node {
+    char                 *label;
+    size_t                label_len;
+    struct ns_trie_node **kids;       /* sorted by first component */
+    size_t                kid_count;
+    size_t                kid_cap;
+    actor_id_t            path;       /* ACTOR_ID_INVALID if none */
+    actor_id_t            mount;      /* ACTOR_ID_INVALID if none */
+} ns_trie_node_t;
+
+typedef struct {
+    ns_trie_node_t root;              /* empty label */
+    size_t         paths;
+    size_t         mounts;
+} ns_trie_t;
+
+typedef enum {
+    NS_TRIE_PATH,
+    NS_TRIE_MOUNT,
+} ns_trie_kind_t;
+
+void ns_trie_init(ns_trie_t *t);
+void ns_trie_free(ns_trie_t *t);
+
+/* NS_OK, NS_EEXIST, NS_EINVAL (empty or >= NS_PATH_MAX) or NS_EFULL
+   (out of memory) */
+int ns_trie_insert(ns_trie_t *t, ns_trie_kind_t kind, const char *key,
+                   actor_id_t id);
+
+actor_id_t ns_trie_get(const ns_trie_t *t, ns_trie_kind_t kind,
+                       const char *key);
+
+/* NS_OK or NS_ENOENT */
+int ns_trie_remove(ns_trie_t *t, ns_trie_kind_t kind, const char *key);
+
+/* Target of the longest mount point that is `path` or a component prefix
+   of it ("/mnt" covers "/mnt" and "/mnt/x", not "/mntx") */
+actor_id_t ns_trie_mount_for(const ns_trie_t *t, const char *path);
+
+/* Visit every path (or mount point) that starts with `prefix` (a plain
+   string prefix; NULL or "" means all), in component order.  The visitor
+   returns false to stop the walk. */
+typedef bool (*ns_trie_visit_fn)(const char *path, actor_id_t id, void *ctx);
+void ns_trie_walk(const ns_trie_t *t, ns_trie_kind_t kind,
+                  const char *prefix, ns_trie_visit_fn fn, void *ctx);
+
+/* Remove every registered path for which `match` returns true (it may
+   look at, but not change, the trie).  Returns the number removed. */
+size_t ns_trie_remove_if(ns_trie_t *t, ns_trie_visit_fn match, void *ctx);
+
+#endif /* NS_TRIE_H */
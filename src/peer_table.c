@@ -0,0 +1,124 @@
+#include "peer_table.h"
+#include <stdlib.h>
+
+#define PEER_TABLE_MIN_SLOTS 16
+
+static size_t slot_of(const peer_table_t *pt, node_id_t node) {
+    /* Mix so that sequential IDs and hashed IDs both spread evenly */
+    uint32_t h = node;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return (size_t)h & pt->mask;
+}
+
+/* Hash slot holding node, or the empty slot where it would go */
+static size_t probe(const peer_table_t *pt, node_id_t node) {
+    size_t i = slot_of(pt, node);
+    while (pt->keys[i] && pt->keys[i] != node) i = (i + 1) & pt->mask;
+    return i;
+}
+
+void peer_table_free(peer_table_t *pt) {
+    free(pt->peers);
+    free(pt->keys);
+    free(pt->index);
+    *pt = (peer_table_t){0};
+}
+
+peer_entry_t *peer_table_entry(const peer_table_t *pt, node_id_t node) {
+    if (!pt->keys || node == 0) return NULL;
+    size_t i = probe(pt, node);
+    return pt->keys[i] ? &pt->peers[pt->index[i]] : NULL;
+}
+
+transport_t *peer_table_get(const peer_table_t *pt, node_id_t node) {
+    peer_entry_t *e = peer_table_entry(pt, node);
+    return e ? e->tp : NULL;
+}
+
+/* Keep the load factor at or below 1/2 */
+static bool rehash(peer_table_t *pt, size_t slots) {
+    uint32_t *keys = calloc(slots, sizeof(*keys));
+    uint32_t *index = malloc(slots * sizeof(*index));
+    if (!keys || !index) {
+        free(keys);
+        free(index);
+        return false;
+    }
+    free(pt->keys);
+    free(pt->index);
+    pt->keys = keys;
+    pt->index = index;
+    pt->mask = slots - 1;
+    for (size_t p = 0; p < pt->count; p++) {
+        size_t i = probe(pt, pt->peers[p].tp->peer_node);
+        pt->keys[i] = pt->peers[p].tp->peer_node;
+        pt->index[i] = (uint32_t)p;
+    }
+    return true;
+}
+
+transport_t *peer_table_put(peer_table_t *pt, transport_t *tp, bool *ok) {
+    node_id_t node = tp->peer_node;
+    *ok = false;
+    if (node == 0) return NULL;
+
+    if (!pt->keys && !rehash(pt, PEER_TABLE_MIN_SLOTS)) return NULL;
+
+    size_t i = probe(pt, node);
+    if (pt->keys[i]) {
+        peer_entry_t *e = &pt->peers[pt->index[i]];
+        transport_t *old = e->tp;
+        *e = (peer_entry_t){ .tp = tp };
+        *ok = true;
+        return old;
+    }
+
+    if (pt->count == pt->peers_cap) {
+        size_t cap = pt->peers_cap ? pt->peers_cap * 2 : 8;
+        peer_entry_t *peers = realloc(pt->peers, cap * sizeof(*peers));
+        if (!peers) return NULL;
+        pt->peers = peers;
+        pt->peers_cap = cap;
+    }
+    if ((pt->count + 1) * 2 > pt->mask + 1) {
+        if (!rehash(pt, (pt->mask + 1) * 2)) return NULL;
+        i = probe(pt, node);
+    }
+
+    pt->keys[i] = node;
+    pt->index[i] = (uint32_t)pt->count;
+    pt->peers[pt->count++] = (peer_entry_t){ .tp = tp };
+    *ok = true;
+    return NULL;
+}
+
+transport_t *peer_table_remove(peer_table_t *pt, node_id_t node) {
+    if (!pt->keys || node == 0) return NULL;
+    size_t i = probe(pt, node);
+    if (!pt->keys[i]) return NULL;
+
+    /* Fill the dense hole with the last peer */
+    uint32_t p = pt->index[i];
+    transport_t *tp = pt->peers[p].tp;
+    pt->count--;
+    if (p != pt->count) {
+        pt->peers[p] = pt->peers[pt->count];
+        pt->index[probe(pt, pt->peers[p].tp->peer_node)] = p;
+    }
+
+    /* Backward-shift deletion: pull later cluster members into the gap */
+    size_t gap = i;
+    for (size_t j = (i + 1) & pt->mask; pt->keys[j]; j = (j + 1) & pt->mask) {
+        size_t home = slot_of(pt, pt->keys[j]);
+        /* Move j into gap unless its home lies cyclically in (gap, j] */
+        if (((j - home) & pt->mask) >= ((j - gap) & pt->mask)) {
+            pt->keys[gap] = pt->keys[j];
+            pt->index[gap] = pt->index[j];
+            gap = j;
+        }
+    }
+    pt->keys[gap] = 0;
+    return tp;
+}
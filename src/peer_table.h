@@ -0,0 +1,56 @@
+#ifndef PEER_TABLE_H
+#define PEER_TABLE_H
+
+#include "microkernel/transport.h"
+
+/* Transports keyed by peer node ID.  An open-addressing hash (linear
+   probing, backward-shift deletion) maps node IDs to slots in a dense
+   array, so lookups are O(1) and iteration only visits attached peers.
+   Both grow on demand.  Node ID 0 is reserved as the empty key.  Each
+   entry also carries the runtime's per-link bookkeeping. */
+
+typedef struct {
+    transport_t *tp;
+    uint64_t     last_rx_ms;       /* last message received, 0 = never */
+    bool         was_connected;    /* seen connected at least once */
+    bool         heard_beat;       /* peer sends MSG_HEARTBEAT */
+    bool         registry_legacy;  /* peer predates MSG_REGISTRY_DELTA */
+} peer_entry_t;
+
+typedef struct {
+    peer_entry_t *peers;     /* dense, peer_table_count() entries */
+    size_t        count;
+    size_t        peers_cap;
+    uint32_t     *keys;      /* hash slots: node ID, 0 = empty */
+    uint32_t     *index;     /* hash slots: position in peers[] */
+    size_t        mask;      /* hash capacity - 1 (power of two) */
+} peer_table_t;
+
+void peer_table_free(peer_table_t *pt);
+
+transport_t *peer_table_get(const peer_table_t *pt, node_id_t node);
+peer_entry_t *peer_table_entry(const peer_table_t *pt, node_id_t node);
+
+/* Attach tp under tp->peer_node with fresh liveness state.  Returns the
+   transport it replaced (the caller owns it), or NULL.  *ok is false if
+   memory ran out. */
+transport_t *peer_table_put(peer_table_t *pt, transport_t *tp, bool *ok);
+
+/* Detach and return the transport for node, or NULL if none. */
+transport_t *peer_table_remove(peer_table_t *pt, node_id_t node);
+
+static inline size_t peer_table_count(const peer_table_t *pt) {
+    return pt->count;
+}
+
+/* Dense iteration; removing the current entry moves the last into i */
+static inline transport_t *peer_table_at(const peer_table_t *pt, size_t i) {
+    return pt->peers[i].tp;
+}
+
+static inline peer_entry_t *peer_table_entry_at(const peer_table_t *pt,
+                                                size_t i) {
+    return &pt->peers[i];
+}
+
+#endif /* PEER_TABLE_H */
@@ -0,0 +1,78 @@
+#include "registry_sync.h"
+#include "microkernel/namespace.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* FNV-1a hash */
+static uint32_t fnv1a(const char *s) {
+    uint32_t h = 2166136261u;
+    for (; *s; s++) {
+        h ^= (uint8_t)*s;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+size_t registry_bucket(const char *key) {
+    return fnv1a(key) % MK_REGISTRY_BUCKETS;
+}
+
+void registry_digest_toggle(registry_digest_t *d, const char *key,
+                            actor_id_t id) {
+    /* Mix key and actor so a rebinding changes the bucket too */
+    uint64_t h = ((uint64_t)fnv1a(key) << 32) ^ id;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    d->bucket[registry_bucket(key)] ^= (uint32_t)h;
+}
+
+/* ── Delta batches ─────────────────────────────────────────────────── */
+
+bool registry_batch_full(const registry_batch_t *b, size_t key_len) {
+    return b->len + sizeof(registry_delta_entry_t) + key_len >
+           MK_REGISTRY_DELTA_MAX;
+}
+
+bool registry_batch_add(registry_batch_t *b, registry_op_t op,
+                        const char *key, actor_id_t id) {
+    size_t len = strlen(key);
+    if (len == 0 || len >= NS_PATH_MAX) return false;
+    size_t need = b->len + sizeof(registry_delta_entry_t) + len;
+    if (need > b->cap) {
+        size_t cap = b->cap ? b->cap * 2 : 512;
+        while (cap < need) cap *= 2;
+        uint8_t *p = realloc(b->buf, cap);
+        if (!p) return false;
+        b->buf = p;
+        b->cap = cap;
+    }
+    registry_delta_entry_t e = { id, (uint8_t)op, (uint8_t)len };
+    memcpy(b->buf + b->len, &e, sizeof(e));
+    memcpy(b->buf + b->len + sizeof(e), key, len);
+    b->len = need;
+    return true;
+}
+
+void registry_batch_free(registry_batch_t *b) {
+    free(b->buf);
+    *b = (registry_batch_t){0};
+}
+
+bool registry_delta_next(const void *payload, size_t size, size_t *pos,
+                         registry_op_t *op, char *key, actor_id_t *id) {
+    const uint8_t *p = payload;
+    registry_delta_entry_t e;
+    if (*pos + sizeof(e) > size) return false;
+    memcpy(&e, p + *pos, sizeof(e));
+    if (e.len == 0 || e.len >= NS_PATH_MAX ||
+        *pos + sizeof(e) + e.len > size ||
+        e.op < REGISTRY_NAME_ADD || e.op > REGISTRY_PATH_DEL)
+        return false;
+    memcpy(key, p + *pos + sizeof(e), e.len);
+    key[e.len] = '\0';
+    *op = (registry_op_t)e.op;
+    *id = e.actor_id;
+    *pos += sizeof(e) + e.len;
+    return true;
+}
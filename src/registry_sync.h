@@ -0,0 +1,76 @@
+#ifndef REGISTRY_SYNC_H
+#define REGISTRY_SYNC_H
+
+#include "microkernel/types.h"
+
+/* Replication of names and paths between nodes.
+
+   Steady state: every local register/unregister is appended to a batch
+   that the runtime sends as one MSG_REGISTRY_DELTA per poll (or sooner,
+   ahead of any message to a peer, so a name is known remotely before
+   anything sent after registering it arrives).
+
+   Reconnect: both ends of a mount send a MSG_REGISTRY_DIGEST, a fixed
+   array of bucket hashes over every (key, actor) binding they hold.  A
+   node answers with its bindings in the buckets whose hash differs from
+   its own, as deltas, so a link between nodes that already agree costs
+   one digest each way.  Bucket hashes XOR one mixed hash per binding,
+   which makes adding and removing the same operation and keeps them
+   O(1) to maintain. */
+
+#ifndef MK_REGISTRY_BUCKETS
+#define MK_REGISTRY_BUCKETS 64
+#endif
+#ifndef MK_REGISTRY_DELTA_MAX
+#define MK_REGISTRY_DELTA_MAX 4096   /* bytes of entries per message */
+#endif
+
+typedef enum {
+    REGISTRY_NAME_ADD = 1,
+    REGISTRY_NAME_DEL = 2,
+    REGISTRY_PATH_ADD = 3,
+    REGISTRY_PATH_DEL = 4,
+} registry_op_t;
+
+/* Wire entry of MSG_REGISTRY_DELTA, followed by len key bytes (no NUL);
+   entries are packed back to back.  Host byte order like the other
+   registry payloads. */
+typedef struct __attribute__((packed)) {
+    actor_id_t actor_id;     /* ACTOR_ID_INVALID for *_DEL */
+    uint8_t    op;           /* registry_op_t */
+    uint8_t    len;
+} registry_delta_entry_t;
+
+/* Payload of MSG_REGISTRY_DIGEST */
+typedef struct {
+    uint32_t bucket[MK_REGISTRY_BUCKETS];
+} registry_digest_t;
+
+size_t registry_bucket(const char *key);
+
+/* Add or remove (the same operation) one binding */
+void registry_digest_toggle(registry_digest_t *d, const char *key,
+                            actor_id_t id);
+
+typedef struct {
+    uint8_t *buf;
+    size_t   len;
+    size_t   cap;
+} registry_batch_t;
+
+/* True if an entry for a key_len-byte key would not fit the batch */
+bool registry_batch_full(const registry_batch_t *b, size_t key_len);
+
+/* Append an entry; false if out of memory or the key is too long */
+bool registry_batch_add(registry_batch_t *b, registry_op_t op,
+                        const char *key, actor_id_t id);
+
+void registry_batch_free(registry_batch_t *b);
+
+/* Decode the entry at *pos of a delta payload and step past it.  key
+   must hold NS_PATH_MAX bytes.  False at the end or on a malformed
+   entry. */
+bool registry_delta_next(const void *payload, size_t size, size_t *pos,
+                         registry_op_t *op, char *key, actor_id_t *id);
+
+#endif /* REGISTRY_SYNC_H */
@@ -0,0 +1,200 @@
+#include "router.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Index of dest, or where it would be inserted */
+static size_t route_find(const route_t *routes, size_t count, node_id_t dest) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (routes[mid].dest < dest) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static route_advert_t *advert_of(const route_table_t *t, node_id_t from) {
+    for (size_t i = 0; i < t->advert_count; i++)
+        if (t->adverts[i].from == from) return &t->adverts[i];
+    return NULL;
+}
+
+void route_table_free(route_table_t *t) {
+    for (size_t i = 0; i < t->advert_count; i++) free(t->adverts[i].entries);
+    free(t->adverts);
+    free(t->changes);
+    free(t->routes);
+    *t = (route_table_t){0};
+}
+
+const route_t *route_lookup(const route_table_t *t, node_id_t dest) {
+    size_t i = route_find(t->routes, t->count, dest);
+    return (i < t->count && t->routes[i].dest == dest) ? &t->routes[i] : NULL;
+}
+
+static bool reserve(route_t **routes, size_t *cap, size_t need) {
+    if (need <= *cap) return true;
+    size_t n = *cap ? *cap : 16;
+    while (n < need) n *= 2;
+    route_t *r = realloc(*routes, n * sizeof(*r));
+    if (!r) return false;
+    *routes = r;
+    *cap = n;
+    return true;
+}
+
+static void note_change(route_table_t *t, node_id_t node, bool reachable) {
+    if (t->change_count == t->change_cap) {
+        size_t cap = t->change_cap ? t->change_cap * 2 : 8;
+        route_change_t *c = realloc(t->changes, cap * sizeof(*c));
+        if (!c) return;
+        t->changes = c;
+        t->change_cap = cap;
+    }
+    t->changes[t->change_count++] = (route_change_t){ node, reachable };
+}
+
+void route_add_hint(route_table_t *t, node_id_t dest, node_id_t next_hop,
+                    uint32_t metric) {
+    if (advert_of(t, next_hop) || route_lookup(t, dest)) return;
+    if (!reserve(&t->routes, &t->cap, t->count + 1)) return;
+    size_t i = route_find(t->routes, t->count, dest);
+    memmove(&t->routes[i + 1], &t->routes[i],
+            (t->count - i) * sizeof(route_t));
+    t->routes[i] = (route_t){ dest, next_hop, metric };
+    t->count++;
+    note_change(t, dest, true);
+}
+
+/* ── Recomputation ─────────────────────────────────────────────────── */
+
+static int cmp_route(const void *a, const void *b) {
+    const route_t *x = a, *y = b;
+    if (x->dest != y->dest) return x->dest < y->dest ? -1 : 1;
+    if (x->metric != y->metric) return x->metric < y->metric ? -1 : 1;
+    if (x->next_hop != y->next_hop) return x->next_hop < y->next_hop ? -1 : 1;
+    return 0;
+}
+
+/* Best route per destination over every stored advert, plus surviving
+   hints.  Marks the table dirty only if the result differs. */
+static void recompute(route_table_t *t, const peer_table_t *peers,
+                      node_id_t self) {
+    size_t n = t->count;
+    for (size_t a = 0; a < t->advert_count; a++) n += t->adverts[a].count;
+
+    route_t *cand = NULL;
+    size_t cap = 0, k = 0;
+    if (n && !reserve(&cand, &cap, n)) return;
+
+    for (size_t a = 0; a < t->advert_count; a++) {
+        const route_advert_t *ad = &t->adverts[a];
+        for (size_t i = 0; i < ad->count; i++) {
+            node_id_t dest = ad->entries[i].node;
+            uint32_t metric = ad->entries[i].metric + 1;
+            if (dest == self || dest == 0 || metric >= ROUTE_METRIC_INFINITY)
+                continue;
+            if (peer_table_get(peers, dest)) continue;   /* direct wins */
+            cand[k++] = (route_t){ dest, ad->from, metric };
+        }
+    }
+    /* Hints live on while their neighbour is attached and silent */
+    for (size_t i = 0; i < t->count; i++) {
+        const route_t *r = &t->routes[i];
+        if (r->metric == ROUTE_METRIC_HINT && !advert_of(t, r->next_hop) &&
+            peer_table_get(peers, r->next_hop) &&
+            !peer_table_get(peers, r->dest))
+            cand[k++] = *r;
+    }
+
+    if (k > 1) qsort(cand, k, sizeof(*cand), cmp_route);
+    size_t out = 0;
+    for (size_t i = 0; i < k; i++)
+        if (out == 0 || cand[out - 1].dest != cand[i].dest)
+            cand[out++] = cand[i];
+
+    if (out != t->count ||
+        (out && memcmp(cand, t->routes, out * sizeof(*cand)) != 0))
+        t->dirty = true;
+
+    /* Both lists are sorted: merge to find destinations gained or lost */
+    size_t i = 0, j = 0;
+    while (i < t->count || j < out) {
+        if (j == out ||
+            (i < t->count && t->routes[i].dest < cand[j].dest)) {
+            note_change(t, t->routes[i++].dest, false);
+        } else if (i == t->count || cand[j].dest < t->routes[i].dest) {
+            note_change(t, cand[j++].dest, true);
+        } else {
+            i++;
+            j++;
+        }
+    }
+    free(t->routes);
+    t->routes = cand;
+    t->count = out;
+    t->cap = cap;
+}
+
+void route_apply_advert(route_table_t *t, const peer_table_t *peers,
+                        node_id_t self, node_id_t from,
+                        const route_advert_entry_t *entries, size_t count) {
+    route_advert_entry_t *copy = NULL;
+    if (count) {
+        copy = malloc(count * sizeof(*copy));
+        if (!copy) return;
+        memcpy(copy, entries, count * sizeof(*copy));
+    }
+
+    route_advert_t *ad = advert_of(t, from);
+    if (!ad) {
+        route_advert_t *grown = realloc(t->adverts,
+                                        (t->advert_count + 1) * sizeof(*grown));
+        if (!grown) {
+            free(copy);
+            return;
+        }
+        t->adverts = grown;
+        ad = &t->adverts[t->advert_count++];
+        ad->from = from;
+        ad->entries = NULL;
+    }
+    free(ad->entries);
+    ad->entries = copy;
+    ad->count = count;
+    recompute(t, peers, self);
+}
+
+void route_peer_changed(route_table_t *t, const peer_table_t *peers,
+                        node_id_t self, node_id_t node) {
+    route_advert_t *ad = advert_of(t, node);
+    if (ad && !peer_table_get(peers, node)) {
+        free(ad->entries);
+        *ad = t->adverts[--t->advert_count];
+    }
+    recompute(t, peers, self);
+}
+
+route_advert_entry_t *route_build_advert(const route_table_t *t,
+                                         const peer_table_t *peers,
+                                         node_id_t to, size_t *count) {
+    size_t n = peer_table_count(peers) + t->count;
+    *count = 0;
+    if (n == 0) return NULL;
+    route_advert_entry_t *e = malloc(n * sizeof(*e));
+    if (!e) return NULL;
+
+    size_t k = 0;
+    for (size_t i = 0; i < peer_table_count(peers); i++) {
+        node_id_t node = peer_table_at(peers, i)->peer_node;
+        if (node != to) e[k++] = (route_advert_entry_t){ node, 1 };
+    }
+    for (size_t i = 0; i < t->count; i++) {
+        const route_t *r = &t->routes[i];
+        if (r->dest == to) continue;
+        e[k++] = (route_advert_entry_t){
+            r->dest, r->next_hop == to ? ROUTE_METRIC_INFINITY : r->metric };
+    }
+    *count = k;
+    return e;
+}
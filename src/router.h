@@ -0,0 +1,85 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "peer_table.h"
+
+/* Distance-vector routes to nodes that are not directly attached.
+   Direct peers live in the peer table and always win; this table only
+   holds nodes reached through a neighbour.  Routes are kept sorted by
+   destination for binary search.
+
+   Every node sends its full table (MSG_ROUTE_ADVERT) to each neighbour
+   whenever it changes.  The latest advert from every neighbour is kept,
+   and the routes are recomputed from all of them, so losing a neighbour
+   falls back to an alternative at once.  Loops are cut with split
+   horizon and poisoned reverse (routes learned from a neighbour go back
+   to it at ROUTE_METRIC_INFINITY); the metric ceiling bounds
+   count-to-infinity. */
+
+#define ROUTE_METRIC_INFINITY 16    /* hops; unreachable */
+#define ROUTE_METRIC_HINT     (ROUTE_METRIC_INFINITY - 1)
+
+typedef struct {
+    node_id_t dest;
+    node_id_t next_hop;
+    uint32_t  metric;      /* hops to dest */
+} route_t;
+
+/* Wire entry of MSG_ROUTE_ADVERT (array; host byte order like the other
+   registry payloads) */
+typedef struct {
+    node_id_t node;
+    uint32_t  metric;
+} route_advert_entry_t;
+
+typedef struct {
+    node_id_t             from;
+    route_advert_entry_t *entries;
+    size_t                count;
+} route_advert_t;
+
+/* A destination that gained or lost its route */
+typedef struct {
+    node_id_t node;
+    bool      reachable;
+} route_change_t;
+
+typedef struct {
+    route_t        *routes;
+    size_t          count;
+    size_t          cap;
+    route_advert_t *adverts;      /* latest advert per neighbour */
+    size_t          advert_count;
+    bool            dirty;        /* routes changed since the last advert */
+    route_change_t *changes;      /* since the runtime last drained them */
+    size_t          change_count;
+    size_t          change_cap;
+} route_table_t;
+
+void route_table_free(route_table_t *t);
+
+const route_t *route_lookup(const route_table_t *t, node_id_t dest);
+
+/* Install a route through a neighbour that does not send adverts (learned
+   from its registry traffic).  Ignored once that neighbour advertises. */
+void route_add_hint(route_table_t *t, node_id_t dest, node_id_t next_hop,
+                    uint32_t metric);
+
+/* Store neighbour `from`'s advert and recompute. */
+void route_apply_advert(route_table_t *t, const peer_table_t *peers,
+                        node_id_t self, node_id_t from,
+                        const route_advert_entry_t *entries, size_t count);
+
+/* Drop what `node` advertised (it was detached) and recompute; also call
+   after attaching a peer so the direct link supersedes routes to it. */
+void route_peer_changed(route_table_t *t, const peer_table_t *peers,
+                        node_id_t self, node_id_t node);
+
+/* Build the advert for neighbour `to`: direct peers at metric 1 plus all
+   routes, poisoned where they lead back through `to`.  Returns a malloc'd
+   array of *count entries, or NULL if empty/out of memory. */
+route_advert_entry_t *route_build_advert(const route_table_t *t,
+                                         const peer_table_t *peers,
+                                         node_id_t to, size_t *count);
+
+#endif /* ROUTER_H */
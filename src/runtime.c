@@ -7,6 +7,11 @@
 #include "microkernel/supervision.h"
 #include "microkernel/namespace.h"
 #include "runtime_internal.h"
+#include "peer_table.h"
+#include "router.h"
+#include "flow.h"
+#include "hash_ring.h"
+#include "http_table.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,19 +19,35 @@
 #include <sys/poll.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 
-#ifndef MAX_TRANSPORTS
-#define MAX_TRANSPORTS 16
-#endif
 #ifndef MAX_TIMERS
 #define MAX_TIMERS      32
 #endif
 #ifndef MAX_FD_WATCHES
 #define MAX_FD_WATCHES  32
 #endif
-#define MAX_POLL_FDS    (MAX_TRANSPORTS + MAX_TIMERS + MAX_FD_WATCHES + MAX_HTTP_CONNS + MAX_HTTP_LISTENERS)
+#ifndef MK_HEARTBEAT_INTERVAL_MS
+#define MK_HEARTBEAT_INTERVAL_MS 1000
+#endif
+#ifndef MK_HEARTBEAT_TIMEOUT_MS
+#define MK_HEARTBEAT_TIMEOUT_MS  5000
+#endif
+#ifndef MK_FLOW_WINDOW
+#define MK_FLOW_WINDOW           0      /* off until runtime_set_flow_window() */
+#endif
+#ifndef MK_FLOW_STALL_MS
+#define MK_FLOW_STALL_MS         2000   /* reopen a window credits never reached */
+#endif
+#ifndef MK_FLOW_CREDIT_BATCH
+#define MK_FLOW_CREDIT_BATCH     8      /* return credit without waiting for poll */
+#endif
+/* Poll entries besides transports and HTTP conns, which are counted at
+   poll time */
+#define MAX_POLL_FIXED  (MAX_TIMERS + MAX_FD_WATCHES + MAX_HTTP_LISTENERS + 1)
 
 /* ── Internal types ────────────────────────────────────────────────── */
 
@@ -35,12 +56,13 @@ typedef enum {
     POLL_SOURCE_TIMER,
     POLL_SOURCE_FD_WATCH,
     POLL_SOURCE_HTTP,
-    POLL_SOURCE_HTTP_LISTEN
+    POLL_SOURCE_HTTP_LISTEN,
+    POLL_SOURCE_DNS
 } poll_source_type_t;
 
 typedef struct {
     poll_source_type_t type;
-    size_t idx;
+    size_t idx;             /* table index, or node ID for transports */
 } poll_source_t;
 
 /* timer_entry_t and name_entry_t are in runtime_internal.h */
@@ -51,10 +73,24 @@ typedef struct {
     actor_id_t  owner;
 } fd_watch_entry_t;
 
-#ifndef NAME_REGISTRY_SIZE
-#define NAME_REGISTRY_SIZE 128
-#endif
-#define NAME_MAX_LEN 64
+/* A monitor held by a local actor; the target may be on any node */
+typedef struct {
+    uint32_t   ref;
+    actor_id_t watcher;
+    actor_id_t target;
+} monitor_t;
+
+/* A local actor monitored from another node */
+typedef struct {
+    actor_id_t target;
+    node_id_t  node;
+} remote_monitor_t;
+
+/* Partitioned registry: changes queued for one ring owner */
+typedef struct {
+    node_id_t        node;
+    registry_batch_t batch;
+} owner_batch_t;
 
 struct runtime {
     node_id_t    node_id;
@@ -65,24 +101,54 @@ struct runtime {
     scheduler_t  scheduler;      /* embedded by value */
     actor_t     *current_actor;  /* set during behavior dispatch */
     bool         running;
-    /* Phase 2: transport table (sparse array indexed by node_id) */
-    transport_t *transports[MAX_TRANSPORTS];
-    size_t       transport_count;
+    /* Phase 2: transports, keyed by peer node ID */
+    peer_table_t peers;
+    route_table_t routes;        /* nodes reached through a peer */
+    /* Node liveness */
+    uint32_t     hb_interval_ms; /* 0 = heartbeats off */
+    uint32_t     hb_timeout_ms;
+    uint64_t     next_hb_ms;
+    actor_id_t  *node_watchers;  /* receive MSG_NODE_DOWN / MSG_NODE_UP */
+    size_t       node_watcher_count;
+    size_t       node_watcher_cap;
+    /* Flow control */
+    flow_table_t flow;
+    uint32_t     flow_window;    /* 0 = off */
+    /* Monitors */
+    monitor_t   *monitors;
+    size_t       monitor_count;
+    size_t       monitor_cap;
+    uint32_t     next_monitor_ref;
+    remote_monitor_t *remote_monitors;
+    size_t       remote_monitor_count;
+    size_t       remote_monitor_cap;
+    struct pollfd *poll_fds;     /* sized for MAX_POLL_FIXED + peers + conns */
+    poll_source_t *poll_sources;
+    size_t         poll_cap;
     /* Phase 2.5: timers */
     timer_entry_t    timers[MAX_TIMERS];
     uint32_t         next_timer_id;       /* monotonic, starts at 1 */
     /* Phase 2.5: FD watches */
     fd_watch_entry_t fd_watches[MAX_FD_WATCHES];
     /* Phase 2.5: name registry */
-    name_entry_t     name_registry[NAME_REGISTRY_SIZE];
+    name_registry_t  names;
+    registry_batch_t registry_out;        /* changes not yet sent to peers */
+    owner_batch_t   *owner_out;           /* partitioned: per ring owner */
+    size_t           owner_out_count;
+    size_t           owner_out_cap;
+    hash_ring_t      ring;                /* partitioned: reachable nodes */
+    bool             ring_dirty;
     /* Phase 2.5: logging */
     actor_id_t       log_actor_id;        /* ACTOR_ID_INVALID until enabled */
     int              min_log_level;
     /* Phase 3.5: HTTP connections */
-    http_conn_t      http_conns[MAX_HTTP_CONNS];
-    uint32_t         next_http_conn_id;   /* monotonic, starts at 1 */
+    http_table_t     http_conns;
     /* Phase 5: HTTP listeners */
     http_listener_t  http_listeners[MAX_HTTP_LISTENERS];
+    /* Idle keep-alive client sockets */
+    http_pool_entry_t http_pool[MAX_HTTP_POOL];
+    /* Client host lookups; NULL until the first connect by name */
+    dns_resolver_t  *dns;
     /* Phase 15: namespace actor state (direct access) */
     void            *ns_state;
     /* Phase 19: state persistence base path */
@@ -113,9 +179,10 @@ runtime_t *runtime_init(node_id_t node_id, size_t max_actors) {
     }
     rt->log_actor_id = ACTOR_ID_INVALID;
     rt->min_log_level = LOG_INFO;
-
-    /* Phase 3.5: HTTP connections */
-    rt->next_http_conn_id = 1;
+    rt->hb_interval_ms = MK_HEARTBEAT_INTERVAL_MS;
+    rt->hb_timeout_ms = MK_HEARTBEAT_TIMEOUT_MS;
+    rt->flow_window = MK_FLOW_WINDOW;
+    rt->next_monitor_ref = 1;
 
     /* Phase 5: HTTP listeners */
     for (size_t i = 0; i < MAX_HTTP_LISTENERS; i++) {
@@ -125,8 +192,11 @@ runtime_t *runtime_init(node_id_t node_id, size_t max_actors) {
     return rt;
 }
 
-/* Forward declaration for HTTP cleanup */
-static void http_conn_free(http_conn_t *conn);
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
 
 void runtime_destroy(runtime_t *rt) {
     if (!rt) return;
@@ -136,11 +206,24 @@ void runtime_destroy(runtime_t *rt) {
         }
     }
     free(rt->actors);
-    for (size_t i = 0; i < MAX_TRANSPORTS; i++) {
-        if (rt->transports[i]) {
-            rt->transports[i]->destroy(rt->transports[i]);
-        }
+    for (size_t i = 0; i < peer_table_count(&rt->peers); i++) {
+        transport_t *tp = peer_table_at(&rt->peers, i);
+        tp->destroy(tp);
     }
+    peer_table_free(&rt->peers);
+    route_table_free(&rt->routes);
+    free(rt->node_watchers);
+    flow_table_free(&rt->flow);
+    name_registry_free(&rt->names);
+    registry_batch_free(&rt->registry_out);
+    for (size_t i = 0; i < rt->owner_out_count; i++)
+        registry_batch_free(&rt->owner_out[i].batch);
+    free(rt->owner_out);
+    hash_ring_free(&rt->ring);
+    free(rt->monitors);
+    free(rt->remote_monitors);
+    free(rt->poll_fds);
+    free(rt->poll_sources);
     /* Close any active timerfds */
     for (size_t i = 0; i < MAX_TIMERS; i++) {
         if (rt->timers[i].id != TIMER_ID_INVALID) {
@@ -148,11 +231,11 @@ void runtime_destroy(runtime_t *rt) {
         }
     }
     /* Clean up HTTP connections */
-    for (size_t i = 0; i < MAX_HTTP_CONNS; i++) {
-        if (rt->http_conns[i].id != HTTP_CONN_ID_INVALID) {
-            http_conn_free(&rt->http_conns[i]);
-        }
+    for (size_t i = 0; i < http_table_slots(&rt->http_conns); i++) {
+        http_conn_t *hc = http_table_at(&rt->http_conns, i);
+        if (hc->id != HTTP_CONN_ID_INVALID) http_conn_free(rt, hc);
     }
+    http_table_free(&rt->http_conns);
     /* Clean up HTTP listeners */
     for (size_t i = 0; i < MAX_HTTP_LISTENERS; i++) {
         if (rt->http_listeners[i].listen_fd >= 0) {
@@ -160,6 +243,11 @@ void runtime_destroy(runtime_t *rt) {
             rt->http_listeners[i].listen_fd = -1;
         }
     }
+    for (size_t i = 0; i < MAX_HTTP_POOL; i++) {
+        if (rt->http_pool[i].sock)
+            rt->http_pool[i].sock->close(rt->http_pool[i].sock);
+    }
+    dns_resolver_destroy(rt->dns);
     free(rt);
 }
 
@@ -236,6 +324,34 @@ bool runtime_deliver_msg(runtime_t *rt, actor_id_t dest, msg_type_t type,
 
 /* ── Messaging ──────────────────────────────────────────────────────── */
 
+static void send_registry_delta(runtime_t *rt);
+static bool send_to_node(runtime_t *rt, node_id_t node, actor_id_t source,
+                         actor_id_t dest, msg_type_t type,
+                         const void *payload, size_t payload_size);
+
+static bool registry_pending(const runtime_t *rt) {
+    return rt->registry_out.len || rt->owner_out_count;
+}
+
+/* Transport towards node: its own if attached, else the route's next hop */
+static transport_t *next_hop_transport(runtime_t *rt, node_id_t node) {
+    transport_t *tp = peer_table_get(&rt->peers, node);
+    if (tp) return tp;
+    const route_t *r = route_lookup(&rt->routes, node);
+    return r ? peer_table_get(&rt->peers, r->next_hop) : NULL;
+}
+
+/* Tell node whether this one meters its sends there (0 = no longer) */
+static bool flow_announce(runtime_t *rt, transport_t *tp, node_id_t node,
+                          uint32_t window) {
+    message_t *msg = message_create(actor_id_make(rt->node_id, 0),
+                                    actor_id_make(node, 0), MSG_FLOW_METER,
+                                    &window, sizeof(window));
+    bool ok = msg && tp->send(tp, msg);
+    message_destroy(msg);
+    return ok;
+}
+
 bool actor_send(runtime_t *rt, actor_id_t dest, msg_type_t type,
                 const void *payload, size_t payload_size) {
     actor_id_t source = rt->current_actor ? rt->current_actor->id
@@ -262,27 +378,99 @@ bool actor_send(runtime_t *rt, actor_id_t dest, msg_type_t type,
         return true;
     }
 
-    /* Remote delivery via transport */
-    if (dest_node >= MAX_TRANSPORTS || !rt->transports[dest_node])
-        return false;
+    /* Remote delivery via transport (direct or through a gateway) */
+    transport_t *tp = next_hop_transport(rt, dest_node);
+    if (!tp) return false;
+
+    /* Out of credit: refuse, and wake the sender once dest catches up */
+    bool metered = rt->flow_window && source != ACTOR_ID_INVALID;
+    if (metered) {
+        const flow_window_t *w = flow_window(&rt->flow, dest);
+        if (w && w->in_flight >= rt->flow_window) {
+            flow_wait(&rt->flow, dest, source);
+            return false;
+        }
+        /* Announced on the same link, so it arrives ahead of the send */
+        if (!flow_nodes_has(&rt->flow.announced, dest_node))
+            metered = flow_announce(rt, tp, dest_node, rt->flow_window) &&
+                      flow_nodes_add(&rt->flow.announced, dest_node);
+    }
+
+    /* Registrations made before this send must arrive before it */
+    if (registry_pending(rt)) send_registry_delta(rt);
 
-    transport_t *tp = rt->transports[dest_node];
     message_t *msg = message_create(source, dest, type,
                                     payload, payload_size);
     if (!msg) return false;
 
     bool ok = tp->send(tp, msg);
     message_destroy(msg);
+    if (ok && metered) flow_charge(&rt->flow, dest, now_ms());
     return ok;
 }
 
+uint32_t actor_send_credit(runtime_t *rt, actor_id_t dest) {
+    if (!rt->flow_window || !rt->current_actor ||
+        actor_id_node(dest) == rt->node_id)
+        return UINT32_MAX;
+    const flow_window_t *w = flow_window(&rt->flow, dest);
+    uint32_t used = w ? w->in_flight : 0;
+    return used < rt->flow_window ? rt->flow_window - used : 0;
+}
+
 /* ── Transport ─────────────────────────────────────────────────────── */
 
+static void settle_routes(runtime_t *rt, node_id_t node, bool was_reachable);
+
 bool runtime_add_transport(runtime_t *rt, transport_t *transport) {
     if (!rt || !transport) return false;
-    if (transport->peer_node >= MAX_TRANSPORTS) return false;
-    rt->transports[transport->peer_node] = transport;
-    rt->transport_count++;
+    node_id_t node = transport->peer_node;
+    if (node == rt->node_id) return false;
+    bool was_reachable = runtime_get_route(rt, node, NULL, NULL);
+    bool ok;
+    transport_t *old = peer_table_put(&rt->peers, transport, &ok);
+    if (old && old != transport) old->destroy(old);   /* reconnect */
+    if (ok) {
+        /* A direct link supersedes any route; tell the neighbours */
+        route_peer_changed(&rt->routes, &rt->peers, rt->node_id, node);
+        rt->routes.dirty = true;
+        settle_routes(rt, node, was_reachable);
+    }
+    return ok;
+}
+
+bool runtime_remove_transport(runtime_t *rt, node_id_t peer_node) {
+    if (!rt) return false;
+    transport_t *tp = peer_table_remove(&rt->peers, peer_node);
+    if (!tp) return false;
+    tp->destroy(tp);
+    route_peer_changed(&rt->routes, &rt->peers, rt->node_id, peer_node);
+    rt->routes.dirty = true;
+    settle_routes(rt, peer_node, true);
+    return true;
+}
+
+void runtime_set_heartbeat(runtime_t *rt, uint32_t interval_ms,
+                           uint32_t timeout_ms) {
+    if (!rt) return;
+    rt->hb_interval_ms = interval_ms;
+    rt->hb_timeout_ms = timeout_ms;
+    rt->next_hb_ms = 0;
+}
+
+bool runtime_get_route(runtime_t *rt, node_id_t node, node_id_t *next_hop,
+                       uint32_t *metric) {
+    if (!rt) return false;
+    node_id_t hop = node;
+    uint32_t hops = 1;
+    if (!peer_table_get(&rt->peers, node)) {
+        const route_t *r = route_lookup(&rt->routes, node);
+        if (!r) return false;
+        hop = r->next_hop;
+        hops = r->metric;
+    }
+    if (next_hop) *next_hop = hop;
+    if (metric) *metric = hops;
     return true;
 }
 
@@ -296,22 +484,6 @@ void *actor_state(runtime_t *rt) {
     return rt->current_actor ? rt->current_actor->state : NULL;
 }
 
-/* ── HTTP connection cleanup ───────────────────────────────────────── */
-
-static void http_conn_free(http_conn_t *conn) {
-    if (conn->sock) {
-        conn->sock->close(conn->sock);
-        conn->sock = NULL;
-    }
-    free(conn->send_buf);
-    free(conn->headers_buf);
-    free(conn->body_buf);
-    free(conn->sse_data);
-    free(conn->request_method);
-    free(conn->request_path);
-    memset(conn, 0, sizeof(*conn));
-}
-
 /* ── Introspection ─────────────────────────────────────────────────── */
 
 size_t runtime_list_actors(runtime_t *rt, actor_id_t *buf, size_t max_count) {
@@ -343,8 +515,26 @@ size_t runtime_actor_info(runtime_t *rt, actor_info_t *buf, size_t max) {
 
 /* ── Execution ──────────────────────────────────────────────────────── */
 
+/* Forward declarations for flow control */
+static void send_flow_credits(runtime_t *rt);
+static void expire_flows(runtime_t *rt);
+static void flow_wake(runtime_t *rt, actor_id_t dest);
+
+/* Node owed a flow credit once msg is consumed, or 0.  Only messages read
+   off a transport carry a remote source, and only a node that announced
+   metering (MSG_FLOW_METER) is kept in credit. */
+static node_id_t credit_owed(const runtime_t *rt, const message_t *msg) {
+    if (msg->source == ACTOR_ID_INVALID || !rt->flow.metering.count) return 0;
+    node_id_t node = actor_id_node(msg->source);
+    if (node == rt->node_id || !flow_nodes_has(&rt->flow.metering, node))
+        return 0;
+    return node;
+}
+
 /* Forward declarations for service cleanup */
 void name_registry_deregister_actor(runtime_t *rt, actor_id_t id);
+static void monitors_actor_exited(runtime_t *rt, actor_id_t id,
+                                  uint8_t reason);
 
 static void cleanup_stopped(runtime_t *rt) {
     for (size_t i = 1; i < rt->max_actors; i++) {
@@ -360,6 +550,8 @@ static void cleanup_stopped(runtime_t *rt) {
                 runtime_deliver_msg(rt, a->parent, MSG_CHILD_EXIT,
                                     &exit_payload, sizeof(exit_payload));
             }
+            /* Notify monitors, here and on other nodes */
+            monitors_actor_exited(rt, id, a->exit_reason);
             /* Clean up timers owned by this actor */
             for (size_t t = 0; t < MAX_TIMERS; t++) {
                 if (rt->timers[t].id != TIMER_ID_INVALID &&
@@ -377,11 +569,19 @@ static void cleanup_stopped(runtime_t *rt) {
                     rt->fd_watches[w].owner = ACTOR_ID_INVALID;
                 }
             }
-            /* Clean up HTTP connections owned by this actor */
-            for (size_t h = 0; h < MAX_HTTP_CONNS; h++) {
-                if (rt->http_conns[h].id != HTTP_CONN_ID_INVALID &&
-                    rt->http_conns[h].owner == id) {
-                    http_conn_free(&rt->http_conns[h]);
+            /* Clean up HTTP connections owned by this actor; a server
+               reply still being written is finished first, then closed */
+            for (size_t h = 0; h < http_table_slots(&rt->http_conns); h++) {
+                http_conn_t *hc = http_table_at(&rt->http_conns, h);
+                if (hc->id == HTTP_CONN_ID_INVALID || hc->owner != id)
+                    continue;
+                if (hc->is_server && hc->sock &&
+                    http_conn_has_output(hc)) {
+                    hc->owner = ACTOR_ID_INVALID;
+                    hc->close_when_sent = true;
+                    hc->state = HTTP_STATE_DONE;
+                } else {
+                    http_conn_free(rt, hc);
                 }
             }
             /* Clean up HTTP listeners owned by this actor */
@@ -417,8 +617,13 @@ void runtime_step(runtime_t *rt) {
     /* Process one message per turn for fairness */
     message_t *msg = mailbox_dequeue(actor->mailbox);
     if (msg) {
+        node_id_t owed = credit_owed(rt, msg);
         bool keep = actor->behavior(rt, actor, msg, actor->state);
         message_destroy(msg);
+        /* A busy consumer may not poll for a while: keep the sender fed */
+        if (owed && flow_owe(&rt->flow, owed, actor->id) >=
+                    MK_FLOW_CREDIT_BATCH)
+            send_flow_credits(rt);
         if (!keep) {
             actor->exit_reason = EXIT_NORMAL;
             actor->status = ACTOR_STOPPED;
@@ -468,36 +673,127 @@ static size_t count_active_listeners(runtime_t *rt) {
 
 static size_t count_active_http_conns(runtime_t *rt) {
     size_t n = 0;
-    for (size_t i = 0; i < MAX_HTTP_CONNS; i++) {
-        if (rt->http_conns[i].id != HTTP_CONN_ID_INVALID &&
-            rt->http_conns[i].state != HTTP_STATE_IDLE &&
-            rt->http_conns[i].state != HTTP_STATE_DONE &&
-            rt->http_conns[i].state != HTTP_STATE_ERROR) {
+    for (size_t i = 0; i < http_table_slots(&rt->http_conns); i++) {
+        http_conn_t *hc = http_table_at(&rt->http_conns, i);
+        if (hc->id == HTTP_CONN_ID_INVALID) continue;
+        /* A stream held back for its owner, or a conn waiting on the
+           resolver, is still live */
+        if (http_conn_poll_events(hc) != 0 || http_conn_stream_held(hc) ||
+            hc->state == HTTP_STATE_RESOLVING)
             n++;
-        }
     }
     return n;
 }
 
+/* Close server conns left waiting for a request or stuck writing to a
+   client that stopped reading, and pooled client sockets, past their
+   idle timeouts */
+static void expire_idle_http(runtime_t *rt) {
+    uint64_t now = now_ms();
+    for (size_t i = 0; i < http_table_slots(&rt->http_conns); i++) {
+        http_conn_t *hc = http_table_at(&rt->http_conns, i);
+        if (hc->id != HTTP_CONN_ID_INVALID &&
+            (http_conn_awaiting_request(hc) ||
+             hc->state == HTTP_STATE_SRV_SENDING || hc->close_when_sent) &&
+            !http_conn_stream_held(hc) &&
+            now - hc->last_active_ms >= HTTP_KEEPALIVE_IDLE_MS)
+            http_conn_free(rt, hc);
+    }
+    for (size_t i = 0; i < MAX_HTTP_POOL; i++) {
+        http_pool_entry_t *pe = &rt->http_pool[i];
+        if (pe->sock && now - pe->idle_since_ms >= HTTP_POOL_IDLE_MS) {
+            pe->sock->close(pe->sock);
+            pe->sock = NULL;
+        }
+    }
+}
+
 /* Forward declaration */
-static bool handle_registry_msg(runtime_t *rt, message_t *msg);
+static bool handle_registry_msg(runtime_t *rt, node_id_t from,
+                                message_t *msg);
+static void send_route_adverts(runtime_t *rt);
+static void ring_update(runtime_t *rt);
+static void forward_msg(runtime_t *rt, node_id_t from, message_t *msg);
+static void check_peers(runtime_t *rt);
+
+/* ── HTTP accept ───────────────────────────────────────────────────── */
+
+/* Take up to HTTP_ACCEPT_BATCH pending connections off a listener, so a
+   burst of clients doesn't wait a poll round each */
+static size_t accept_http(runtime_t *rt, http_listener_t *lis) {
+    size_t accepted = 0;
+    while (accepted < HTTP_ACCEPT_BATCH) {
+        int client_fd = accept(lis->listen_fd, NULL, NULL);
+        if (client_fd < 0) break;
+
+        /* Set non-blocking */
+        int flags = fcntl(client_fd, F_GETFL, 0);
+        if (flags >= 0) fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
+
+        /* Responses are written whole: don't let Nagle hold back the
+           next one on a persistent conn until the client ACKs */
+        int one = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        mk_socket_t *sock = mk_socket_tcp_wrap(client_fd);
+        if (!sock) { close(client_fd); break; }
+
+        http_conn_t *hc = http_table_alloc(&rt->http_conns);
+        if (!hc) {
+            sock->close(sock);
+            break;
+        }
+
+        hc->state = HTTP_STATE_SRV_RECV_REQUEST;
+        hc->conn_type = HTTP_CONN_SERVER;
+        hc->owner = lis->owner;
+        hc->sock = sock;
+        hc->is_server = true;
+        hc->content_length = -1;
+        hc->stream = lis->stream_window > 0;
+        hc->stream_window = lis->stream_window;
+        hc->last_active_ms = now_ms();
+        accepted++;
+    }
+    return accepted;
+}
 
 /* ── Unified poll and dispatch ─────────────────────────────────────── */
 
 static bool poll_and_dispatch(runtime_t *rt, int timeout_ms) {
-    struct pollfd  fds[MAX_POLL_FDS];
-    poll_source_t  sources[MAX_POLL_FDS];
+    size_t need = MAX_POLL_FIXED + peer_table_count(&rt->peers) +
+                  http_table_live(&rt->http_conns);
+    if (need > rt->poll_cap) {
+        struct pollfd *f = realloc(rt->poll_fds, need * sizeof(*f));
+        if (f) rt->poll_fds = f;
+        poll_source_t *src = realloc(rt->poll_sources, need * sizeof(*src));
+        if (src) rt->poll_sources = src;
+        if (!f || !src) return false;
+        rt->poll_cap = need;
+    }
+    struct pollfd *fds = rt->poll_fds;
+    poll_source_t *sources = rt->poll_sources;
     nfds_t nfds = 0;
-
-    /* Add transport FDs */
-    for (size_t i = 0; i < MAX_TRANSPORTS; i++) {
-        transport_t *tp = rt->transports[i];
-        if (!tp || tp->fd < 0) continue;
+    bool resumed = false;
+
+    check_peers(rt);
+    if (rt->routes.dirty) send_route_adverts(rt);
+    if (rt->ring_dirty) ring_update(rt);
+    if (registry_pending(rt)) send_registry_delta(rt);
+    if (rt->flow.owed_count) send_flow_credits(rt);
+    if (rt->flow.waiter_count) expire_flows(rt);
+    expire_idle_http(rt);
+
+    /* Push out sends batched while the scheduler ran, then add FDs */
+    for (size_t i = 0; i < peer_table_count(&rt->peers); i++) {
+        transport_t *tp = peer_table_at(&rt->peers, i);
+        if (tp->flush) tp->flush(tp);
+        if (tp->fd < 0) continue;
         fds[nfds].fd = tp->fd;
         fds[nfds].events = POLLIN;
         fds[nfds].revents = 0;
         sources[nfds].type = POLL_SOURCE_TRANSPORT;
-        sources[nfds].idx = i;
+        sources[nfds].idx = tp->peer_node;
         nfds++;
     }
 
@@ -524,21 +820,14 @@ static bool poll_and_dispatch(runtime_t *rt, int timeout_ms) {
     }
 
     /* Add HTTP connection FDs */
-    for (size_t i = 0; i < MAX_HTTP_CONNS; i++) {
-        http_conn_t *hc = &rt->http_conns[i];
-        if (hc->id == HTTP_CONN_ID_INVALID || !hc->sock) continue;
-        if (hc->state == HTTP_STATE_IDLE || hc->state == HTTP_STATE_DONE ||
-            hc->state == HTTP_STATE_ERROR) continue;
-
-        int sock_fd = hc->sock->get_fd(hc->sock);
-        fds[nfds].fd = sock_fd;
-        short events;
-        if (hc->state == HTTP_STATE_SENDING ||
-            hc->state == HTTP_STATE_SRV_SENDING) {
-            events = POLLOUT;
-        } else {
-            events = POLLIN;
-        }
+    for (size_t i = 0; i < http_table_slots(&rt->http_conns); i++) {
+        http_conn_t *hc = http_table_at(&rt->http_conns, i);
+        if (hc->id == HTTP_CONN_ID_INVALID) continue;
+        if (hc->stream_blocked && http_conn_resume(hc, rt)) resumed = true;
+        short events = http_conn_poll_events(hc);
+        if (events == 0) continue;
+
+        fds[nfds].fd = hc->sock->get_fd(hc->sock);
         fds[nfds].events = events;
         fds[nfds].revents = 0;
         sources[nfds].type = POLL_SOURCE_HTTP;
@@ -557,28 +846,55 @@ static bool poll_and_dispatch(runtime_t *rt, int timeout_ms) {
         nfds++;
     }
 
-    if (nfds == 0) return false;
+    /* Add the resolver's wakeup while lookups are out */
+    int dns_fd = dns_resolver_fd(rt->dns);
+    if (dns_fd >= 0) {
+        fds[nfds].fd = dns_fd;
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        sources[nfds].type = POLL_SOURCE_DNS;
+        sources[nfds].idx = 0;
+        nfds++;
+    }
+
+    /* Don't sleep on messages a resumed stream just delivered */
+    if (nfds == 0) return resumed;
 
-    int ret = poll(fds, nfds, timeout_ms);
-    if (ret <= 0) return false;
+    int ret = poll(fds, nfds, resumed ? 0 : timeout_ms);
+    if (ret <= 0) return resumed;
 
-    bool dispatched = false;
+    bool dispatched = resumed;
 
     for (nfds_t n = 0; n < nfds; n++) {
         if (fds[n].revents == 0) continue;
 
         switch (sources[n].type) {
         case POLL_SOURCE_TRANSPORT: {
-            transport_t *tp = rt->transports[sources[n].idx];
+            transport_t *tp = peer_table_get(&rt->peers,
+                                             (node_id_t)sources[n].idx);
             if (!tp) break;
             message_t *msg;
+            node_id_t from = tp->peer_node;
             while ((msg = tp->recv(tp)) != NULL) {
-                if (handle_registry_msg(rt, msg)) {
+                peer_entry_t *pe = peer_table_entry(&rt->peers, from);
+                if (pe) {
+                    pe->last_rx_ms = now_ms();
+                    if (msg->type == MSG_HEARTBEAT) pe->heard_beat = true;
+                }
+                if (handle_registry_msg(rt, from, msg)) {
                     message_destroy(msg);
                     dispatched = true;
                     continue;
                 }
+                if (msg->dest != ACTOR_ID_INVALID &&
+                    actor_id_node(msg->dest) != rt->node_id) {
+                    forward_msg(rt, from, msg);
+                    dispatched = true;
+                    continue;
+                }
                 if (!deliver_local(rt, msg->dest, msg)) {
+                    node_id_t owed = credit_owed(rt, msg);
+                    if (owed) flow_owe(&rt->flow, owed, msg->dest);
                     message_destroy(msg);
                 }
                 dispatched = true;
@@ -634,7 +950,7 @@ static bool poll_and_dispatch(runtime_t *rt, int timeout_ms) {
             break;
         }
         case POLL_SOURCE_HTTP: {
-            http_conn_t *hc = &rt->http_conns[sources[n].idx];
+            http_conn_t *hc = http_table_at(&rt->http_conns, sources[n].idx);
             if (hc->id == HTTP_CONN_ID_INVALID) break;
             http_conn_drive(hc, fds[n].revents, rt);
             dispatched = true;
@@ -643,42 +959,15 @@ static bool poll_and_dispatch(runtime_t *rt, int timeout_ms) {
         case POLL_SOURCE_HTTP_LISTEN: {
             http_listener_t *lis = &rt->http_listeners[sources[n].idx];
             if (lis->listen_fd < 0) break;
-
-            int client_fd = accept(lis->listen_fd, NULL, NULL);
-            if (client_fd < 0) break;
-
-            /* Set non-blocking */
-            int flags = fcntl(client_fd, F_GETFL, 0);
-            if (flags >= 0) fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
-
-            mk_socket_t *sock = mk_socket_tcp_wrap(client_fd);
-            if (!sock) { close(client_fd); break; }
-
-            /* Allocate connection from shared pool */
-            http_conn_t *hc = NULL;
-            for (size_t ci = 0; ci < MAX_HTTP_CONNS; ci++) {
-                if (rt->http_conns[ci].id == HTTP_CONN_ID_INVALID) {
-                    hc = &rt->http_conns[ci];
-                    break;
-                }
-            }
-            if (!hc) {
-                sock->close(sock);
-                break;
-            }
-
-            memset(hc, 0, sizeof(*hc));
-            hc->id = rt->next_http_conn_id++;
-            hc->state = HTTP_STATE_SRV_RECV_REQUEST;
-            hc->conn_type = HTTP_CONN_SERVER;
-            hc->owner = lis->owner;
-            hc->sock = sock;
-            hc->is_server = true;
-            hc->content_length = -1;
-
-            dispatched = true;
+            if (accept_http(rt, lis) > 0) dispatched = true;
             break;
         }
+        case POLL_SOURCE_DNS:
+            if (dns_collect(rt->dns)) {
+                http_conn_dns_ready(rt);
+                dispatched = true;
+            }
+            break;
         }
     }
 
@@ -696,7 +985,7 @@ void runtime_run(runtime_t *rt) {
 
         if (!rt->running) break;
 
-        bool has_io = (rt->transport_count > 0) ||
+        bool has_io = (peer_table_count(&rt->peers) > 0) ||
                       (count_active_timers(rt) > 0) ||
                       (count_active_watches(rt) > 0) ||
                       (count_active_http_conns(rt) > 0) ||
@@ -806,26 +1095,14 @@ void runtime_set_log_level(runtime_t *rt, int level) {
 
 /* ── Name registry accessors (used by name_registry.c) ─────────────── */
 
-name_entry_t *runtime_get_name_registry(runtime_t *rt) {
-    return rt->name_registry;
-}
-
-size_t runtime_get_name_registry_size(void) {
-    return NAME_REGISTRY_SIZE;
+name_registry_t *runtime_get_name_registry(runtime_t *rt) {
+    return &rt->names;
 }
 
 /* ── HTTP connection accessors (used by http_conn.c) ───────────────── */
 
-http_conn_t *runtime_get_http_conns(runtime_t *rt) {
-    return rt->http_conns;
-}
-
-size_t runtime_get_max_http_conns(void) {
-    return MAX_HTTP_CONNS;
-}
-
-uint32_t runtime_alloc_http_conn_id(runtime_t *rt) {
-    return rt->next_http_conn_id++;
+http_table_t *runtime_get_http_table(runtime_t *rt) {
+    return &rt->http_conns;
 }
 
 /* ── HTTP listener accessors (used by http_conn.c) ─────────────────── */
@@ -834,6 +1111,17 @@ http_listener_t *runtime_get_http_listeners(runtime_t *rt) {
     return rt->http_listeners;
 }
 
+http_pool_entry_t *runtime_get_http_pool(runtime_t *rt) {
+    return rt->http_pool;
+}
+
+dns_resolver_t *runtime_get_dns(runtime_t *rt) {
+    if (!rt->dns)
+        rt->dns = dns_resolver_create(HTTP_DNS_CACHE, HTTP_DNS_TTL_MS,
+                                      HTTP_DNS_NEGATIVE_TTL_MS);
+    return rt->dns;
+}
+
 /* ── Namespace state accessors (used by ns_actor.c, name_registry.c) ── */
 
 void *runtime_get_ns_state(runtime_t *rt) {
@@ -846,58 +1134,802 @@ void runtime_set_ns_state(runtime_t *rt, void *state) {
 
 /* ── Cross-node registry ───────────────────────────────────────────── */
 
-void runtime_broadcast_registry(runtime_t *rt, msg_type_t type,
-                                 const void *payload, size_t payload_size) {
-    for (size_t i = 0; i < MAX_TRANSPORTS; i++) {
-        transport_t *tp = rt->transports[i];
-        if (!tp) continue;
-        message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
-                                         type, payload, payload_size);
-        if (msg) {
-            tp->send(tp, msg);
-            message_destroy(msg);
+static void send_registry_msg(transport_t *tp, msg_type_t type,
+                              const void *payload, size_t payload_size) {
+    message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                                    type, payload, payload_size);
+    if (!msg) return;
+    tp->send(tp, msg);
+    message_destroy(msg);
+}
+
+/* A delta as the per-binding messages older peers understand */
+static void send_registry_legacy(transport_t *tp, const void *delta,
+                                 size_t size) {
+    registry_op_t op;
+    char key[NS_PATH_MAX];
+    actor_id_t id;
+    for (size_t pos = 0; registry_delta_next(delta, size, &pos,
+                                             &op, key, &id);) {
+        switch (op) {
+        case REGISTRY_NAME_ADD: {
+            name_register_payload_t p = { .actor_id = id };
+            snprintf(p.name, sizeof(p.name), "%.*s",
+                     (int)sizeof(p.name) - 1, key);
+            send_registry_msg(tp, MSG_NAME_REGISTER, &p, sizeof(p));
+            break;
+        }
+        case REGISTRY_NAME_DEL: {
+            name_unregister_payload_t p;
+            memset(&p, 0, sizeof(p));
+            snprintf(p.name, sizeof(p.name), "%.*s",
+                     (int)sizeof(p.name) - 1, key);
+            send_registry_msg(tp, MSG_NAME_UNREGISTER, &p, sizeof(p));
+            break;
         }
+        case REGISTRY_PATH_ADD: {
+            path_register_payload_t p = { .actor_id = id };
+            snprintf(p.path, sizeof(p.path), "%s", key);
+            send_registry_msg(tp, MSG_PATH_REGISTER, &p, sizeof(p));
+            break;
+        }
+        case REGISTRY_PATH_DEL: {
+            path_unregister_payload_t p;
+            memset(&p, 0, sizeof(p));
+            snprintf(p.path, sizeof(p.path), "%s", key);
+            send_registry_msg(tp, MSG_PATH_UNREGISTER, &p, sizeof(p));
+            break;
+        }
+        }
+    }
+}
+
+static void send_registry_batch(transport_t *tp, bool legacy,
+                                const registry_batch_t *b) {
+    if (legacy) send_registry_legacy(tp, b->buf, b->len);
+    else send_registry_msg(tp, MSG_REGISTRY_DELTA, b->buf, b->len);
+}
+
+/* Everything announced since the last poll, as one message per peer
+   (and, for partitioned names, one per ring owner) */
+static void send_registry_delta(runtime_t *rt) {
+    for (size_t i = 0; rt->registry_out.len &&
+                       i < peer_table_count(&rt->peers); i++) {
+        peer_entry_t *pe = peer_table_entry_at(&rt->peers, i);
+        send_registry_batch(pe->tp, pe->registry_legacy, &rt->registry_out);
+    }
+    rt->registry_out.len = 0;
+
+    for (size_t i = 0; i < rt->owner_out_count; i++) {
+        owner_batch_t *o = &rt->owner_out[i];
+        /* Addressed to the owner so gateways relay it */
+        send_to_node(rt, o->node, ACTOR_ID_INVALID, actor_id_make(o->node, 0),
+                     MSG_REGISTRY_DELTA, o->batch.buf, o->batch.len);
+        registry_batch_free(&o->batch);
     }
+    rt->owner_out_count = 0;
+}
+
+static registry_batch_t *owner_batch(runtime_t *rt, node_id_t node) {
+    for (size_t i = 0; i < rt->owner_out_count; i++)
+        if (rt->owner_out[i].node == node) return &rt->owner_out[i].batch;
+    if (rt->owner_out_count == rt->owner_out_cap) {
+        size_t cap = rt->owner_out_cap ? rt->owner_out_cap * 2 : 8;
+        owner_batch_t *o = realloc(rt->owner_out, cap * sizeof(*o));
+        if (!o) return NULL;
+        rt->owner_out = o;
+        rt->owner_out_cap = cap;
+    }
+    owner_batch_t *o = &rt->owner_out[rt->owner_out_count++];
+    *o = (owner_batch_t){ .node = node };
+    return &o->batch;
+}
+
+void runtime_registry_announce(runtime_t *rt, registry_op_t op,
+                               const char *key, actor_id_t id) {
+    if (peer_table_count(&rt->peers) == 0) return;
+    registry_batch_t *b = &rt->registry_out;
+    if (rt->names.partitioned &&
+        (op == REGISTRY_NAME_ADD || op == REGISTRY_NAME_DEL)) {
+        /* Only the name's owner hears of it */
+        node_id_t owner = runtime_name_owner(rt, key);
+        if (owner == rt->node_id) return;
+        b = owner_batch(rt, owner);
+        if (!b) return;
+    }
+    if (registry_batch_full(b, strlen(key))) {
+        send_registry_delta(rt);   /* frees b if it was an owner's */
+        runtime_registry_announce(rt, op, key, id);
+        return;
+    }
+    registry_batch_add(b, op, key, id);
+}
+
+/* ── Partitioned names ─────────────────────────────────────────────── */
+
+void runtime_set_registry_partitioned(runtime_t *rt, bool on) {
+    if (!rt || rt->names.partitioned == on) return;
+    name_registry_set_partitioned(rt, on);
+    hash_ring_free(&rt->ring);
+    rt->ring_dirty = true;
+}
+
+/* Rebuild the ring from the nodes reachable now; if its membership
+   changed, names move to their new owners */
+static void ring_update(runtime_t *rt) {
+    rt->ring_dirty = false;
+    if (!rt->names.partitioned) return;
+    node_id_t *nodes = malloc((1 + peer_table_count(&rt->peers) +
+                               rt->routes.count) * sizeof(*nodes));
+    if (!nodes) return;
+    size_t n = 0;
+    nodes[n++] = rt->node_id;
+    for (size_t i = 0; i < peer_table_count(&rt->peers); i++)
+        nodes[n++] = peer_table_at(&rt->peers, i)->peer_node;
+    for (size_t i = 0; i < rt->routes.count; i++) {
+        node_id_t dest = rt->routes.routes[i].dest;
+        if (!peer_table_get(&rt->peers, dest) &&
+            runtime_get_route(rt, dest, NULL, NULL))
+            nodes[n++] = dest;
+    }
+    bool changed = hash_ring_build(&rt->ring, nodes, n);
+    free(nodes);
+    if (changed) name_registry_rehome(rt);
+}
+
+node_id_t runtime_name_owner(runtime_t *rt, const char *name) {
+    if (!rt->names.partitioned) return rt->node_id;
+    if (rt->ring_dirty) ring_update(rt);
+    node_id_t owner = hash_ring_owner(&rt->ring, name);
+    return owner ? owner : rt->node_id;
+}
+
+bool actor_resolve_name(runtime_t *rt, const char *name) {
+    if (!rt->current_actor || !name || !name[0]) return false;
+    actor_id_t self = rt->current_actor->id;
+    name_register_payload_t p;
+    memset(&p, 0, sizeof(p));
+    snprintf(p.name, sizeof(p.name), "%s", name);
+    p.actor_id = actor_lookup(rt, name);
+    /* Paths stay replicated, so only a flat name can live elsewhere */
+    node_id_t owner = name[0] == '/' ? rt->node_id
+                                     : runtime_name_owner(rt, p.name);
+    if (p.actor_id != ACTOR_ID_INVALID || owner == rt->node_id)
+        return runtime_deliver_msg(rt, self, MSG_NAME_RESOLVED, &p, sizeof(p));
+    return send_to_node(rt, owner, self, actor_id_make(owner, 0),
+                        MSG_NAME_QUERY, &p, sizeof(p));
+}
+
+/* MSG_NAME_QUERY at the owner: answer the asking actor directly */
+static void answer_name_query(runtime_t *rt, const message_t *msg) {
+    if (msg->payload_size < sizeof(name_register_payload_t)) return;
+    name_register_payload_t a;
+    memcpy(&a, msg->payload, sizeof(a));
+    a.name[sizeof(a.name) - 1] = '\0';
+    a.actor_id = actor_lookup(rt, a.name);
+    send_to_node(rt, actor_id_node(msg->source), ACTOR_ID_INVALID,
+                 msg->source, MSG_NAME_RESOLVED, &a, sizeof(a));
+}
+
+void runtime_send_registry_digest(runtime_t *rt, transport_t *tp) {
+    send_registry_msg(tp, MSG_REGISTRY_DIGEST, &rt->names.digest,
+                      sizeof(rt->names.digest));
+}
+
+void runtime_set_registry_legacy(runtime_t *rt, node_id_t peer_node) {
+    peer_entry_t *pe = peer_table_entry(&rt->peers, peer_node);
+    if (pe) pe->registry_legacy = true;
+}
+
+/* Our bindings in the buckets where a peer's digest differs from ours,
+   pushed to it as deltas */
+typedef struct {
+    transport_t      *tp;
+    const bool       *differs;
+    registry_batch_t  out;
+} registry_repair_t;
+
+static void registry_repair_add(registry_repair_t *r, registry_op_t op,
+                                const char *key, actor_id_t id) {
+    if (!r->differs[registry_bucket(key)]) return;
+    if (registry_batch_full(&r->out, strlen(key))) {
+        send_registry_batch(r->tp, false, &r->out);
+        r->out.len = 0;
+    }
+    registry_batch_add(&r->out, op, key, id);
+}
+
+static bool repair_path_visit(const char *path, actor_id_t id, void *ctx) {
+    registry_repair_add(ctx, REGISTRY_PATH_ADD, path, id);
+    return true;
+}
+
+static void answer_registry_digest(runtime_t *rt, node_id_t from,
+                                   const message_t *msg) {
+    transport_t *tp = peer_table_get(&rt->peers, from);
+    if (!tp || msg->payload_size < sizeof(registry_digest_t)) return;
+    const registry_digest_t *theirs = msg->payload;
+    bool differs[MK_REGISTRY_BUCKETS];
+    bool any = false;
+    for (size_t b = 0; b < MK_REGISTRY_BUCKETS; b++) {
+        differs[b] = theirs->bucket[b] != rt->names.digest.bucket[b];
+        any |= differs[b];
+    }
+    if (!any) return;
+
+    registry_repair_t r = { tp, differs, {0} };
+    const name_entry_t *e;
+    size_t pos = 0;
+    while (!rt->names.partitioned &&
+           (e = name_registry_next(rt, &pos)) != NULL)
+        registry_repair_add(&r, REGISTRY_NAME_ADD, e->name, e->actor_id);
+    ns_walk_paths(rt, repair_path_visit, &r);
+    if (r.out.len) send_registry_batch(tp, false, &r.out);
+    registry_batch_free(&r.out);
 }
 
 node_id_t runtime_get_node_id(runtime_t *rt) {
     return rt->node_id;
 }
 
+transport_t *runtime_get_transport(runtime_t *rt, node_id_t peer_node) {
+    return rt ? peer_table_get(&rt->peers, peer_node) : NULL;
+}
+
 size_t runtime_get_max_actors(runtime_t *rt) {
     return rt ? rt->max_actors : 0;
 }
 
 size_t runtime_get_transport_count(runtime_t *rt) {
-    return rt ? rt->transport_count : 0;
+    return rt ? peer_table_count(&rt->peers) : 0;
 }
 
 /* Forward declarations for registry internals */
 bool name_registry_insert(runtime_t *rt, const char *name, actor_id_t id);
 void name_registry_remove_by_name(runtime_t *rt, const char *name);
 
-static bool handle_registry_msg(runtime_t *rt, message_t *msg) {
+/* ── Flow control ──────────────────────────────────────────────────── */
+
+void runtime_set_flow_window(runtime_t *rt, uint32_t window) {
+    if (!rt) return;
+    rt->flow_window = window;
+    /* Receivers stop keeping credit for us */
+    if (!window) {
+        flow_nodes_t *set = &rt->flow.announced;
+        for (size_t i = 0; i < set->count; i++) {
+            transport_t *tp = next_hop_transport(rt, set->nodes[i]);
+            if (tp) flow_announce(rt, tp, set->nodes[i], 0);
+        }
+        set->count = 0;
+    }
+    /* Anyone blocked under the old window retries under the new one */
+    while (rt->flow.count > 0) {
+        actor_id_t dest = rt->flow.windows[0].dest;
+        flow_drop(&rt->flow, dest);
+        flow_wake(rt, dest);
+    }
+}
+
+/* Tell the actors refused a send to dest that they may try again */
+static void flow_wake(runtime_t *rt, actor_id_t dest) {
+    send_ready_payload_t p = { .dest = dest };
+    actor_id_t waiter;
+    while (flow_pop_waiter(&rt->flow, dest, &waiter))
+        runtime_deliver_msg(rt, waiter, MSG_SEND_READY, &p, sizeof(p));
+}
+
+static int cmp_owed_node(const void *a, const void *b) {
+    const flow_owed_t *x = a, *y = b;
+    return x->node < y->node ? -1 : x->node > y->node;
+}
+
+/* One MSG_FLOW_CREDIT per sending node for everything consumed since
+   the last poll.  Credits for unreachable nodes are dropped; those whose
+   send failed are kept for the next poll. */
+static void send_flow_credits(runtime_t *rt) {
+    flow_table_t *ft = &rt->flow;
+    flow_credit_entry_t *e = malloc(ft->owed_count * sizeof(*e));
+    if (!e) return;
+    qsort(ft->owed, ft->owed_count, sizeof(*ft->owed), cmp_owed_node);
+
+    size_t kept = 0;
+    for (size_t i = 0, j; i < ft->owed_count; i = j) {
+        node_id_t node = ft->owed[i].node;
+        size_t k = 0;
+        for (j = i; j < ft->owed_count && ft->owed[j].node == node; j++)
+            e[k++] = (flow_credit_entry_t){ ft->owed[j].actor,
+                                            ft->owed[j].count, 0 };
+        transport_t *tp = next_hop_transport(rt, node);
+        if (!tp) continue;
+        /* Addressed to the node itself so gateways relay it */
+        message_t *msg = message_create(ACTOR_ID_INVALID,
+                                        actor_id_make(node, 0),
+                                        MSG_FLOW_CREDIT, e, k * sizeof(*e));
+        bool sent = msg && tp->send(tp, msg);
+        message_destroy(msg);
+        if (!sent) {
+            memmove(&ft->owed[kept], &ft->owed[i], (j - i) * sizeof(*ft->owed));
+            kept += j - i;
+        }
+    }
+    ft->owed_count = kept;
+    free(e);
+}
+
+static void apply_flow_credit(runtime_t *rt, const message_t *msg) {
+    const flow_credit_entry_t *e = msg->payload;
+    size_t n = msg->payload_size / sizeof(*e);
+    uint64_t now = now_ms();
+    for (size_t i = 0; i < n; i++) {
+        flow_credit(&rt->flow, e[i].actor, e[i].count, now);
+        flow_wake(rt, e[i].actor);
+    }
+}
+
+static void apply_flow_meter(runtime_t *rt, const message_t *msg) {
+    uint32_t window;
+    if (msg->payload_size < sizeof(window)) return;
+    memcpy(&window, msg->payload, sizeof(window));
+    node_id_t node = actor_id_node(msg->source);
+    if (window) flow_nodes_add(&rt->flow.metering, node);
+    else flow_nodes_remove(&rt->flow.metering, node);
+}
+
+/* Close the windows to a node that went away; a node that comes back
+   is told again, and must tell us again */
+static void flow_forget_node(runtime_t *rt, node_id_t node) {
+    flow_nodes_remove(&rt->flow.announced, node);
+    flow_nodes_remove(&rt->flow.metering, node);
+    for (size_t i = rt->flow.count; i-- > 0;) {
+        actor_id_t dest = rt->flow.windows[i].dest;
+        if (actor_id_node(dest) != node) continue;
+        flow_drop(&rt->flow, dest);
+        flow_wake(rt, dest);
+    }
+}
+
+/* Credits die with the actor or link they were owed for (or a peer may
+   not send any); a window held shut that long is reopened. */
+static void expire_flows(runtime_t *rt) {
+    uint64_t now = now_ms();
+    for (size_t i = rt->flow.count; i-- > 0;) {
+        const flow_window_t *w = &rt->flow.windows[i];
+        if (w->in_flight < rt->flow_window ||
+            now - w->last_credit_ms <= MK_FLOW_STALL_MS)
+            continue;
+        actor_id_t dest = w->dest;
+        flow_drop(&rt->flow, dest);
+        flow_wake(rt, dest);
+    }
+}
+
+/* ── Monitors ──────────────────────────────────────────────────────── */
+
+/* Runtime-to-runtime message towards node (direct or through a gateway) */
+static bool send_to_node(runtime_t *rt, node_id_t node, actor_id_t source,
+                         actor_id_t dest, msg_type_t type,
+                         const void *payload, size_t payload_size) {
+    transport_t *tp = next_hop_transport(rt, node);
+    if (!tp) return false;
+    message_t *msg = message_create(source, dest, type, payload, payload_size);
+    if (!msg) return false;
+    bool ok = tp->send(tp, msg);
+    message_destroy(msg);
+    return ok;
+}
+
+static void deliver_down(runtime_t *rt, const monitor_t *m, uint8_t reason) {
+    down_payload_t p = { .ref = m->ref, .actor = m->target,
+                         .exit_reason = reason };
+    runtime_deliver_msg(rt, m->watcher, MSG_DOWN, &p, sizeof(p));
+}
+
+static bool target_monitored(runtime_t *rt, actor_id_t target) {
+    for (size_t i = 0; i < rt->monitor_count; i++)
+        if (rt->monitors[i].target == target) return true;
+    return false;
+}
+
+/* Drop monitor i; the target's node is told once nobody here watches it */
+static void monitor_remove(runtime_t *rt, size_t i) {
+    actor_id_t target = rt->monitors[i].target;
+    rt->monitors[i] = rt->monitors[--rt->monitor_count];
+    node_id_t node = actor_id_node(target);
+    if (node != rt->node_id && !target_monitored(rt, target))
+        send_to_node(rt, node, actor_id_make(rt->node_id, 0), target,
+                     MSG_DEMONITOR, NULL, 0);
+}
+
+/* Fire (and drop) every monitor of target */
+static void fire_monitors(runtime_t *rt, actor_id_t target, uint8_t reason) {
+    for (size_t i = 0; i < rt->monitor_count;) {
+        if (rt->monitors[i].target != target) {
+            i++;
+            continue;
+        }
+        monitor_t m = rt->monitors[i];
+        rt->monitors[i] = rt->monitors[--rt->monitor_count];
+        deliver_down(rt, &m, reason);
+    }
+}
+
+uint32_t actor_monitor(runtime_t *rt, actor_id_t target) {
+    if (!rt->current_actor) return 0;
+    if (rt->monitor_count == rt->monitor_cap) {
+        size_t cap = rt->monitor_cap ? rt->monitor_cap * 2 : 8;
+        monitor_t *m = realloc(rt->monitors, cap * sizeof(*m));
+        if (!m) return 0;
+        rt->monitors = m;
+        rt->monitor_cap = cap;
+    }
+    monitor_t m = { rt->next_monitor_ref++, rt->current_actor->id, target };
+    if (rt->next_monitor_ref == 0) rt->next_monitor_ref = 1;
+
+    /* The target's node is told about the first monitor only */
+    node_id_t node = actor_id_node(target);
+    uint8_t reason = EXIT_NOPROC;
+    bool live;
+    if (node == rt->node_id || node == 0) {
+        live = lookup(rt, target) != NULL;
+    } else {
+        live = target_monitored(rt, target) ||
+               send_to_node(rt, node, actor_id_make(rt->node_id, 0), target,
+                            MSG_MONITOR, NULL, 0);
+        reason = EXIT_NODEDOWN;
+    }
+    if (live) rt->monitors[rt->monitor_count++] = m;
+    else deliver_down(rt, &m, reason);
+    return m.ref;
+}
+
+bool actor_demonitor(runtime_t *rt, uint32_t ref) {
+    if (!rt->current_actor) return false;
+    for (size_t i = 0; i < rt->monitor_count; i++) {
+        if (rt->monitors[i].ref == ref &&
+            rt->monitors[i].watcher == rt->current_actor->id) {
+            monitor_remove(rt, i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void monitors_actor_exited(runtime_t *rt, actor_id_t id,
+                                  uint8_t reason) {
+    fire_monitors(rt, id, reason);
+
+    /* Watchers on other nodes: one compact MSG_ACTOR_EXIT per node */
+    for (size_t i = 0; i < rt->remote_monitor_count;) {
+        remote_monitor_t *r = &rt->remote_monitors[i];
+        if (r->target != id) {
+            i++;
+            continue;
+        }
+        send_to_node(rt, r->node, id, actor_id_make(r->node, 0),
+                     MSG_ACTOR_EXIT, &reason, sizeof(reason));
+        *r = rt->remote_monitors[--rt->remote_monitor_count];
+    }
+
+    /* Monitors the dead actor held itself */
+    for (size_t i = 0; i < rt->monitor_count;) {
+        if (rt->monitors[i].watcher == id) monitor_remove(rt, i);
+        else i++;
+    }
+}
+
+static void monitors_node_down(runtime_t *rt, node_id_t node) {
+    for (size_t i = 0; i < rt->monitor_count;) {
+        monitor_t m = rt->monitors[i];
+        if (actor_id_node(m.target) != node) {
+            i++;
+            continue;
+        }
+        rt->monitors[i] = rt->monitors[--rt->monitor_count];
+        deliver_down(rt, &m, EXIT_NODEDOWN);
+    }
+    for (size_t i = 0; i < rt->remote_monitor_count;) {
+        if (rt->remote_monitors[i].node == node)
+            rt->remote_monitors[i] =
+                rt->remote_monitors[--rt->remote_monitor_count];
+        else
+            i++;
+    }
+}
+
+/* MSG_MONITOR / MSG_DEMONITOR arrive addressed to the target, from the
+   watching node's actor_id_make(node, 0); MSG_ACTOR_EXIT comes back from
+   the target to that node address. */
+static void handle_monitor_msg(runtime_t *rt, const message_t *msg) {
+    node_id_t node = actor_id_node(msg->source);
+    actor_id_t target = msg->dest;
+
+    if (msg->type == MSG_ACTOR_EXIT) {
+        uint8_t reason = EXIT_KILLED;
+        if (msg->payload_size >= 1) reason = *(const uint8_t *)msg->payload;
+        fire_monitors(rt, msg->source, reason);
+        return;
+    }
+
+    size_t i = 0;
+    while (i < rt->remote_monitor_count &&
+           (rt->remote_monitors[i].target != target ||
+            rt->remote_monitors[i].node != node))
+        i++;
+
+    if (msg->type == MSG_DEMONITOR) {
+        if (i < rt->remote_monitor_count)
+            rt->remote_monitors[i] =
+                rt->remote_monitors[--rt->remote_monitor_count];
+        return;
+    }
+
+    if (i < rt->remote_monitor_count) return;   /* already watched */
+    if (!lookup(rt, target)) {
+        uint8_t reason = EXIT_NOPROC;
+        send_to_node(rt, node, target, actor_id_make(node, 0),
+                     MSG_ACTOR_EXIT, &reason, sizeof(reason));
+        return;
+    }
+    if (rt->remote_monitor_count == rt->remote_monitor_cap) {
+        size_t cap = rt->remote_monitor_cap ? rt->remote_monitor_cap * 2 : 8;
+        remote_monitor_t *r = realloc(rt->remote_monitors, cap * sizeof(*r));
+        if (!r) return;
+        rt->remote_monitors = r;
+        rt->remote_monitor_cap = cap;
+    }
+    rt->remote_monitors[rt->remote_monitor_count++] =
+        (remote_monitor_t){ target, node };
+}
+
+/* ── Node liveness ─────────────────────────────────────────────────── */
+
+bool actor_watch_nodes(runtime_t *rt) {
+    if (!rt->current_actor) return false;
+    actor_id_t self = rt->current_actor->id;
+    for (size_t i = 0; i < rt->node_watcher_count; i++)
+        if (rt->node_watchers[i] == self) return true;
+    if (rt->node_watcher_count == rt->node_watcher_cap) {
+        size_t cap = rt->node_watcher_cap ? rt->node_watcher_cap * 2 : 4;
+        actor_id_t *w = realloc(rt->node_watchers, cap * sizeof(*w));
+        if (!w) return false;
+        rt->node_watchers = w;
+        rt->node_watcher_cap = cap;
+    }
+    rt->node_watchers[rt->node_watcher_count++] = self;
+    return true;
+}
+
+bool actor_unwatch_nodes(runtime_t *rt) {
+    if (!rt->current_actor) return false;
+    actor_id_t self = rt->current_actor->id;
+    for (size_t i = 0; i < rt->node_watcher_count; i++) {
+        if (rt->node_watchers[i] != self) continue;
+        rt->node_watchers[i] = rt->node_watchers[--rt->node_watcher_count];
+        return true;
+    }
+    return false;
+}
+
+/* Tell watchers; those that have gone away are dropped */
+static void node_event(runtime_t *rt, node_id_t node, bool up) {
+    rt->ring_dirty = true;
+    if (!up) {
+        /* Whatever the node registered is unreachable now */
+        name_registry_purge_node(rt, node);
+        ns_purge_node_paths(rt, node);
+        flow_forget_node(rt, node);
+        monitors_node_down(rt, node);
+    }
+    node_event_payload_t ev = { .node_id = node };
+    for (size_t i = 0; i < rt->node_watcher_count;) {
+        message_t *msg = message_create(ACTOR_ID_INVALID, rt->node_watchers[i],
+                                        up ? MSG_NODE_UP : MSG_NODE_DOWN,
+                                        &ev, sizeof(ev));
+        if (msg && deliver_local(rt, rt->node_watchers[i], msg)) {
+            i++;
+            continue;
+        }
+        if (msg) message_destroy(msg);
+        if (!lookup(rt, rt->node_watchers[i]))
+            rt->node_watchers[i] = rt->node_watchers[--rt->node_watcher_count];
+        else
+            i++;   /* mailbox full: keep the watcher */
+    }
+}
+
+/* Turn route table changes into node events.  `node` is the peer whose
+   direct link just changed; the route table cannot see its before/after
+   state, so the caller passes whether it was reachable beforehand. */
+static void settle_routes(runtime_t *rt, node_id_t node, bool was_reachable) {
+    for (size_t i = 0; i < rt->routes.change_count; i++) {
+        const route_change_t *c = &rt->routes.changes[i];
+        if (c->node == node) continue;
+        node_event(rt, c->node, c->reachable);
+    }
+    rt->routes.change_count = 0;
+    if (node == 0) return;
+    bool reachable = runtime_get_route(rt, node, NULL, NULL);
+    if (reachable != was_reachable) node_event(rt, node, reachable);
+}
+
+/* Send heartbeats and declare peers down that closed their link or went
+   silent for longer than the timeout.  A peer that has never connected
+   (a listener still waiting to accept) is left alone. */
+static void check_peers(runtime_t *rt) {
+    uint64_t now = now_ms();
+    bool beat = rt->hb_interval_ms && now >= rt->next_hb_ms;
+    if (beat) rt->next_hb_ms = now + rt->hb_interval_ms;
+
+    message_t *hb = NULL;
+    if (beat && peer_table_count(&rt->peers) > 0)
+        hb = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                            MSG_HEARTBEAT, NULL, 0);
+
+    for (size_t i = 0; i < peer_table_count(&rt->peers);) {
+        peer_entry_t *pe = peer_table_entry_at(&rt->peers, i);
+        transport_t *tp = pe->tp;
+        bool connected = tp->is_connected(tp);
+        if (connected && !pe->was_connected) {
+            pe->was_connected = true;
+            pe->last_rx_ms = now;   /* start the silence clock */
+        }
+
+        bool closed = pe->was_connected && !connected;
+        /* Only a peer known to send heartbeats can be judged by silence;
+           older builds and plain links go quiet when idle */
+        bool silent = rt->hb_interval_ms && pe->heard_beat &&
+                      now - pe->last_rx_ms > rt->hb_timeout_ms;
+        if (closed || silent) {
+            runtime_remove_transport(rt, tp->peer_node);
+            continue;   /* the last entry moved into i */
+        }
+        if (hb && connected) tp->send(tp, hb);
+        i++;
+    }
+    if (hb) message_destroy(hb);
+}
+
+/* ── Multi-hop routing ─────────────────────────────────────────────── */
+
+static void send_route_adverts(runtime_t *rt) {
+    rt->routes.dirty = false;
+    for (size_t i = 0; i < peer_table_count(&rt->peers); i++) {
+        transport_t *tp = peer_table_at(&rt->peers, i);
+        size_t count;
+        route_advert_entry_t *e = route_build_advert(&rt->routes, &rt->peers,
+                                                     tp->peer_node, &count);
+        /* An empty advert still withdraws whatever the peer learned */
+        message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                                        MSG_ROUTE_ADVERT, e,
+                                        count * sizeof(*e));
+        free(e);
+        if (!msg) continue;
+        if (!tp->send(tp, msg)) rt->routes.dirty = true;   /* retry later */
+        message_destroy(msg);
+    }
+}
+
+/* Relay a message for another node.  Never hand it back to the peer it
+   came from: with split horizon that only happens mid-convergence. */
+static void forward_msg(runtime_t *rt, node_id_t from, message_t *msg) {
+    transport_t *tp = next_hop_transport(rt, actor_id_node(msg->dest));
+    if (tp && tp->peer_node != from) tp->send(tp, msg);
+    message_destroy(msg);
+}
+
+/* A registration arriving from `from` for an actor on a node we have no
+   path to says the node is reachable that way.  Only used for neighbours
+   that do not advertise routes themselves. */
+static void learn_route_hint(runtime_t *rt, node_id_t from, actor_id_t id) {
+    node_id_t node = actor_id_node(id);
+    if (node == rt->node_id || node == from || node == 0) return;
+    if (peer_table_get(&rt->peers, node)) return;
+    route_add_hint(&rt->routes, node, from, ROUTE_METRIC_HINT);
+    settle_routes(rt, 0, false);
+}
+
+static void apply_registry_change(runtime_t *rt, node_id_t from,
+                                  registry_op_t op, const char *key,
+                                  actor_id_t id) {
+    switch (op) {
+    case REGISTRY_NAME_ADD:
+        name_registry_insert(rt, key, id);
+        learn_route_hint(rt, from, id);
+        break;
+    case REGISTRY_NAME_DEL:
+        name_registry_remove_by_name(rt, key);
+        break;
+    case REGISTRY_PATH_ADD:
+        ns_register_path(rt, key, id);
+        learn_route_hint(rt, from, id);
+        break;
+    case REGISTRY_PATH_DEL:
+        ns_remove_path(rt, key);
+        break;
+    }
+}
+
+static bool handle_registry_msg(runtime_t *rt, node_id_t from,
+                                message_t *msg) {
+    if (msg->type == MSG_HEARTBEAT) return true;
+    if (msg->type == MSG_MONITOR || msg->type == MSG_DEMONITOR ||
+        msg->type == MSG_ACTOR_EXIT) {
+        if (actor_id_node(msg->dest) != rt->node_id) return false;   /* relay */
+        handle_monitor_msg(rt, msg);
+        return true;
+    }
+    if (msg->type == MSG_FLOW_CREDIT) {
+        if (actor_id_node(msg->dest) != rt->node_id) return false;   /* relay */
+        apply_flow_credit(rt, msg);
+        return true;
+    }
+    if (msg->type == MSG_FLOW_METER) {
+        if (actor_id_node(msg->dest) != rt->node_id) return false;   /* relay */
+        apply_flow_meter(rt, msg);
+        return true;
+    }
+    if (msg->type == MSG_ROUTE_ADVERT) {
+        route_apply_advert(&rt->routes, &rt->peers, rt->node_id, from,
+                           msg->payload,
+                           msg->payload_size / sizeof(route_advert_entry_t));
+        settle_routes(rt, 0, false);
+        return true;
+    }
+    if (msg->type == MSG_REGISTRY_DELTA) {
+        if (msg->dest != ACTOR_ID_INVALID &&
+            actor_id_node(msg->dest) != rt->node_id)
+            return false;   /* relay to the ring owner */
+        registry_op_t op;
+        char key[NS_PATH_MAX];
+        actor_id_t id;
+        for (size_t pos = 0; registry_delta_next(msg->payload,
+                                                 msg->payload_size, &pos,
+                                                 &op, key, &id);)
+            apply_registry_change(rt, from, op, key, id);
+        return true;
+    }
+    if (msg->type == MSG_REGISTRY_DIGEST) {
+        answer_registry_digest(rt, from, msg);
+        return true;
+    }
+    if (msg->type == MSG_NAME_QUERY) {
+        if (actor_id_node(msg->dest) != rt->node_id) return false;  /* relay */
+        answer_name_query(rt, msg);
+        return true;
+    }
+    if (msg->type == MSG_NAME_RESOLVED &&
+        actor_id_node(msg->dest) == rt->node_id &&
+        msg->payload_size >= sizeof(name_register_payload_t)) {
+        const name_register_payload_t *p = msg->payload;
+        name_registry_cache(rt, p->name, p->actor_id);
+        return false;   /* and on to the actor that asked */
+    }
+    /* Per-binding messages from peers that predate MSG_REGISTRY_DELTA */
     if (msg->type == MSG_NAME_REGISTER) {
         const name_register_payload_t *p = msg->payload;
-        name_registry_insert(rt, p->name, p->actor_id);
+        apply_registry_change(rt, from, REGISTRY_NAME_ADD, p->name,
+                              p->actor_id);
         return true;
     }
     if (msg->type == MSG_NAME_UNREGISTER) {
         const name_unregister_payload_t *p = msg->payload;
-        name_registry_remove_by_name(rt, p->name);
+        apply_registry_change(rt, from, REGISTRY_NAME_DEL, p->name,
+                              ACTOR_ID_INVALID);
         return true;
     }
     if (msg->type == MSG_PATH_REGISTER) {
         if (msg->payload_size >= sizeof(path_register_payload_t)) {
             const path_register_payload_t *p = msg->payload;
-            ns_register_path(rt, p->path, p->actor_id);
+            apply_registry_change(rt, from, REGISTRY_PATH_ADD, p->path,
+                                  p->actor_id);
         }
         return true;
     }
     if (msg->type == MSG_PATH_UNREGISTER) {
         if (msg->payload_size >= sizeof(path_unregister_payload_t)) {
             const path_unregister_payload_t *p = msg->payload;
-            ns_remove_path(rt, p->path);
+            apply_registry_change(rt, from, REGISTRY_PATH_DEL, p->path,
+                                  ACTOR_ID_INVALID);
         }
         return true;
     }
@@ -4,6 +4,8 @@
 #include "microkernel/runtime.h"
 #include "microkernel/services.h"
 #include "microkernel/mk_socket.h"
+#include "registry_sync.h"
+#include "dns_resolver.h"
 
 /* Internal types shared between runtime.c and service modules */
 
@@ -14,16 +16,53 @@ typedef struct {
     bool        periodic;
 } timer_entry_t;
 
+/* Name registry: open addressing with tombstones, grown by load factor.
+   Names of the same actor are chained through next_same from a second
+   table keyed by actor ID, so per-actor work is O(names per actor). */
+#define NAME_SLOT_EMPTY 0
+#define NAME_SLOT_LIVE  1
+#define NAME_SLOT_TOMB  2
+
+/* Partitioned mode (runtime_set_registry_partitioned) keeps this node's
+   own names, the names it owns on the hash ring, and up to
+   MK_NAME_CACHE_MAX answers from other owners, each for
+   MK_NAME_CACHE_TTL_MS. */
+#ifndef MK_NAME_CACHE_MAX
+#define MK_NAME_CACHE_MAX 256
+#endif
+#ifndef MK_NAME_CACHE_TTL_MS
+#define MK_NAME_CACHE_TTL_MS 5000
+#endif
+
 typedef struct {
     char       name[64];
     actor_id_t actor_id;
-    bool       occupied;
+    uint8_t    state;      /* NAME_SLOT_* */
+    uint32_t   next_same;  /* next slot of the same actor, UINT32_MAX = end */
+    uint64_t   expires_ms; /* cached answer; 0 for a binding held here */
 } name_entry_t;
 
+typedef struct {
+    name_entry_t *slots;
+    size_t        cap;         /* power of two; 0 until the first insert */
+    size_t        live;
+    size_t        tombs;
+    actor_id_t   *owner_keys;  /* cap entries; ACTOR_ID_INVALID = empty */
+    uint32_t     *owner_head;  /* first slot of that actor's chain */
+    uint64_t      epoch;       /* bumped whenever any name, path or mount
+                                  binding changes; see actor_name_resolve */
+    registry_digest_t digest;  /* over names and paths; see registry_sync.h */
+    bool          partitioned; /* names live with their ring owner */
+    size_t        cached;      /* live entries with expires_ms set */
+    size_t        cache_hand;  /* eviction scan position */
+} name_registry_t;
+
 /* ── HTTP connection state machine ─────────────────────────────────── */
 
 typedef enum {
     HTTP_STATE_IDLE,
+    HTTP_STATE_RESOLVING,       /* host lookup on the resolver thread */
+    HTTP_STATE_CONNECTING,      /* non-blocking connect, done on POLLOUT */
     HTTP_STATE_SENDING,
     HTTP_STATE_RECV_STATUS,
     HTTP_STATE_RECV_HEADERS,
@@ -37,6 +76,7 @@ typedef enum {
     HTTP_STATE_SRV_RECV_BODY,
     HTTP_STATE_SRV_SENDING,
     HTTP_STATE_SRV_SSE_ACTIVE,
+    HTTP_STATE_SRV_CHUNKED,     /* actor_http_respond_start until _end */
     HTTP_STATE_DONE,
     HTTP_STATE_ERROR
 } http_state_t;
@@ -54,7 +94,40 @@ typedef enum {
 #define HTTP_READ_BUF_SIZE 8192
 #endif
 #ifndef MAX_HTTP_CONNS
-#define MAX_HTTP_CONNS 32
+#define MAX_HTTP_CONNS 16384         /* table grows on demand up to this */
+#endif
+#ifndef HTTP_KEEPALIVE_IDLE_MS
+#define HTTP_KEEPALIVE_IDLE_MS 5000  /* server conn waiting for a request */
+#endif
+#ifndef MAX_HTTP_POOL
+#define MAX_HTTP_POOL 16             /* idle client sockets kept for reuse */
+#endif
+#ifndef HTTP_POOL_MAX_PER_HOST
+#define HTTP_POOL_MAX_PER_HOST 4
+#endif
+#ifndef HTTP_POOL_IDLE_MS
+#define HTTP_POOL_IDLE_MS 30000
+#endif
+#define HTTP_POOL_KEY_MAX 280        /* "scheme://host:port" */
+#ifndef HTTP_STREAM_WINDOW
+#define HTTP_STREAM_WINDOW (256 * 1024)  /* unacked streamed body bytes */
+#endif
+#ifndef HTTP_SEND_BACKLOG_MAX
+#define HTTP_SEND_BACKLOG_MAX (256 * 1024)  /* unsent SSE/WS bytes per conn */
+#endif
+#ifndef HTTP_FILE_CHUNK
+#define HTTP_FILE_CHUNK (64 * 1024)  /* file bytes per read without sendfile */
+#endif
+/* Client host lookups (dns_resolver.h).  getaddrinfo() gives no record
+   TTLs: answers are kept HTTP_DNS_TTL_MS, failures HTTP_DNS_NEGATIVE_TTL_MS */
+#ifndef HTTP_DNS_CACHE
+#define HTTP_DNS_CACHE 32
+#endif
+#ifndef HTTP_DNS_TTL_MS
+#define HTTP_DNS_TTL_MS 60000
+#endif
+#ifndef HTTP_DNS_NEGATIVE_TTL_MS
+#define HTTP_DNS_NEGATIVE_TTL_MS 5000
 #endif
 
 typedef struct {
@@ -64,14 +137,35 @@ typedef struct {
     actor_id_t       owner;
     mk_socket_t     *sock;
 
-    /* Request buffer (SENDING state) */
+    /* Outbound queue: client request, server response, SSE events and
+       WS frames; flushed on POLLOUT */
     uint8_t         *send_buf;
     size_t           send_size;
     size_t           send_pos;
-
-    /* Read buffer (sliding window) */
-    uint8_t          read_buf[HTTP_READ_BUF_SIZE];
-    size_t           read_len;    /* bytes of valid data from index 0 */
+    size_t           send_cap;
+    bool             close_when_sent; /* owner gone: close once flushed */
+
+    /* File segment sent after send_buf (actor_http_respond_file); the
+       conn's own dup of the fd, open while file_left > 0 */
+    int              file_fd;
+    off_t            file_off;
+    size_t           file_left;
+
+    /* Client connect target; remote_addrs holds the resolved addresses
+       while CONNECTING, remote_next the next one to try on failure */
+    char            *remote_host;
+    uint16_t         remote_port;
+    bool             remote_tls;
+    dns_result_t    *remote_addrs;
+    size_t           remote_next;
+
+    /* Read buffer, HTTP_READ_BUF_SIZE bytes from the table's pool; held
+       only while read_len > 0.  Parsing advances read_pos, and the
+       unparsed bytes move to the front only when the tail is full. */
+    uint8_t         *read_buf;
+    size_t           read_pos;    /* start of unparsed data */
+    size_t           read_len;    /* bytes of unparsed data from read_pos */
+    size_t           crlf_scanned; /* of those, searched without a CRLF */
 
     /* Response state */
     int              status_code;
@@ -83,18 +177,32 @@ typedef struct {
     char            *headers_buf;
     size_t           headers_size;
     size_t           headers_cap;
+    /* Their index entries, one per line, in arrival order */
+    http_header_entry_t *header_index;
+    size_t           header_index_size;  /* bytes */
+    size_t           header_index_cap;
 
-    /* Body accumulator */
+    /* Body accumulator; when streaming, body_size counts bytes delivered
+       and body_buf is unused */
     uint8_t         *body_buf;
     size_t           body_size;
     size_t           body_cap;
 
+    /* Streamed body: a fetch_stream response, or a request on a
+       listen_stream listener; the head is the response or request */
+    bool             stream;
+    bool             stream_head_sent;
+    bool             stream_final_pending;
+    bool             stream_blocked;  /* owner's mailbox was full: retry */
+    size_t           stream_window;
+    size_t           stream_unacked;  /* delivered, not yet acked */
+
     /* Chunked transfer state */
     size_t           chunk_remaining;
     bool             in_chunk_data;
 
     /* SSE state */
-    char             sse_event[256];
+    char            *sse_event;      /* NULL = "message" */
     char            *sse_data;
     size_t           sse_data_size;
     size_t           sse_data_cap;
@@ -111,18 +219,45 @@ typedef struct {
     bool             is_server;
     char            *request_method;
     char            *request_path;
+    bool             keep_alive;      /* per the request (server) or response (client) */
+    bool             http10;          /* request was HTTP/1.0: no chunking */
+    bool             want_write_ready; /* a write_chunk was refused */
+    uint64_t         last_active_ms;  /* last read or response */
+
+    /* Client connection reuse (http:// and https:// fetches, not SSE or WS) */
+    char            *pool_key;      /* NULL = never pooled */
+    bool             reused;        /* socket came from the pool, no reply yet */
+    bool             idempotent;    /* safe to resend after a stale reset */
+    bool             head_request;  /* response carries no body */
+    bool             in_trailer;    /* past the last chunk */
 } http_conn_t;
 
+/* Bytes still to go out: queued in send_buf or left of a file segment */
+static inline bool http_conn_has_output(const http_conn_t *conn) {
+    return conn->send_pos < conn->send_size || conn->file_left > 0;
+}
+
+/* Idle keep-alive client socket */
+typedef struct {
+    mk_socket_t *sock;               /* NULL = free slot */
+    char         key[HTTP_POOL_KEY_MAX];
+    uint64_t     idle_since_ms;
+} http_pool_entry_t;
+
 /* ── HTTP listener (server-side) ──────────────────────────────────── */
 
 #ifndef MAX_HTTP_LISTENERS
 #define MAX_HTTP_LISTENERS 8
 #endif
+#ifndef HTTP_ACCEPT_BATCH
+#define HTTP_ACCEPT_BATCH 64         /* accepts per listener wakeup */
+#endif
 
 typedef struct {
     int         listen_fd;   /* -1 = unused */
     uint16_t    port;
     actor_id_t  owner;
+    size_t      stream_window;  /* 0 = request bodies arrive whole */
 } http_listener_t;
 
 /* ── Accessors for runtime internals (defined in runtime.c) ────────── */
@@ -136,17 +271,21 @@ actor_id_t     runtime_get_log_actor(runtime_t *rt);
 void           runtime_set_log_actor(runtime_t *rt, actor_id_t id);
 int            runtime_get_min_log_level(runtime_t *rt);
 
-name_entry_t  *runtime_get_name_registry(runtime_t *rt);
-size_t         runtime_get_name_registry_size(void);
+name_registry_t *runtime_get_name_registry(runtime_t *rt);
 
-/* Phase 3.5: HTTP connection accessors */
-http_conn_t   *runtime_get_http_conns(runtime_t *rt);
-size_t         runtime_get_max_http_conns(void);
-uint32_t       runtime_alloc_http_conn_id(runtime_t *rt);
+/* Phase 3.5: HTTP connection table (http_table.h) */
+typedef struct http_table http_table_t;
+http_table_t  *runtime_get_http_table(runtime_t *rt);
 
 /* Phase 5: HTTP listener accessors */
 http_listener_t *runtime_get_http_listeners(runtime_t *rt);
 
+http_pool_entry_t *runtime_get_http_pool(runtime_t *rt);
+
+/* Host lookups for client conns, created on first use; NULL if that
+   fails */
+dns_resolver_t *runtime_get_dns(runtime_t *rt);
+
 /* Deliver a message to a local actor (used by http_conn.c) */
 bool runtime_deliver_msg(runtime_t *rt, actor_id_t dest, msg_type_t type,
                          const void *payload, size_t payload_size);
@@ -154,9 +293,31 @@ bool runtime_deliver_msg(runtime_t *rt, actor_id_t dest, msg_type_t type,
 /* Platform-specific timer fd cleanup (Linux: close; ESP32: stop esp_timer + close eventfd) */
 void timer_platform_close(size_t slot, int fd);
 
+/* Close a conn, free what it owns and release its slot */
+void http_conn_free(runtime_t *rt, http_conn_t *conn);
+
 /* Drive an HTTP connection (called from runtime.c poll loop) */
 void http_conn_drive(http_conn_t *conn, short revents, runtime_t *rt);
 
+/* True for a server conn between requests (or partway through reading
+   one): no actor holds its id yet, so the runtime may close it */
+bool http_conn_awaiting_request(const http_conn_t *conn);
+
+/* poll() events the conn waits for; 0 = leave it out of the poll set */
+short http_conn_poll_events(const http_conn_t *conn);
+
+/* Retry a streamed body whose last delivery found the owner's mailbox
+   full; true if it got further */
+bool http_conn_resume(http_conn_t *conn, runtime_t *rt);
+
+/* Streamed body held back for its owner (window full or mailbox full):
+   the socket isn't read, and the peer isn't the one idling */
+bool http_conn_stream_held(const http_conn_t *conn);
+
+/* The resolver finished lookups (dns_collect): move RESOLVING conns on
+   to CONNECTING, or fail them */
+void http_conn_dns_ready(runtime_t *rt);
+
 /* Phase 10: Supervision */
 void runtime_set_actor_parent(runtime_t *rt, actor_id_t child_id,
                                actor_id_t parent_id);
@@ -167,11 +328,44 @@ void *runtime_get_ns_state(runtime_t *rt);
 void  runtime_set_ns_state(runtime_t *rt, void *state);
 
 /* Phase 11: Cross-node registry */
-void runtime_broadcast_registry(runtime_t *rt, msg_type_t type,
-                                 const void *payload, size_t payload_size);
+/* Queue a local registry change for the next MSG_REGISTRY_DELTA to peers */
+void runtime_registry_announce(runtime_t *rt, registry_op_t op,
+                               const char *key, actor_id_t id);
+/* Start anti-entropy with a freshly attached peer */
+void runtime_send_registry_digest(runtime_t *rt, transport_t *tp);
+/* Peer predates MSG_REGISTRY_DELTA: send it one message per change */
+void runtime_set_registry_legacy(runtime_t *rt, node_id_t peer_node);
+/* Ring owner of a global name; this node unless partitioned */
+node_id_t runtime_name_owner(runtime_t *rt, const char *name);
 node_id_t runtime_get_node_id(runtime_t *rt);
+
+/* Transport attached for a peer node, or NULL */
+transport_t *runtime_get_transport(runtime_t *rt, node_id_t peer_node);
+
 bool name_registry_insert(runtime_t *rt, const char *name, actor_id_t id);
 void name_registry_remove_by_name(runtime_t *rt, const char *name);
+/* Drop every name owned by an actor on node (no broadcast) */
+void name_registry_purge_node(runtime_t *rt, node_id_t node);
+void name_registry_free(name_registry_t *reg);
+/* Live entries in slot order: start with *pos = 0, NULL at the end */
+const name_entry_t *name_registry_next(runtime_t *rt, size_t *pos);
+/* Earliest registered name of actor id, or NULL */
+const char *name_registry_first_name(runtime_t *rt, actor_id_t id);
+/* Invalidate every actor_name_handle_t (a mount changed) */
+void name_registry_touch(runtime_t *rt);
+/* Switch modes: names leave (or rejoin) the digest, cached answers go */
+void name_registry_set_partitioned(runtime_t *rt, bool on);
+/* Partitioned mode: remember an owner's answer for a while */
+void name_registry_cache(runtime_t *rt, const char *name, actor_id_t id);
+/* Partitioned mode, ring changed: drop cached answers and names owned
+   elsewhere now, and hand our own names to their (new) owners */
+void name_registry_rehome(runtime_t *rt);
+/* A path was bound or unbound: fold it into the digest and touch */
+void name_registry_account(runtime_t *rt, const char *path, actor_id_t id);
+/* Visit every registered path (ns_actor.c) */
+void ns_walk_paths(runtime_t *rt,
+                   bool (*fn)(const char *path, actor_id_t id, void *ctx),
+                   void *ctx);
 
 /* Phase 19: State persistence */
 const char *runtime_get_state_path(runtime_t *rt);
@@ -16,13 +16,18 @@
 #define MSG_DONTWAIT 0
 #endif
 
+#define TCP_READ_CHUNK    4096
+#define TCP_READ_BUF_KEEP (64 * 1024)  /* free larger buffers once drained */
+
 typedef struct {
     int      listen_fd;     /* -1 for client */
     int      conn_fd;       /* connected socket, -1 until accept/connect */
     bool     is_server;
-    uint8_t *read_buf;      /* partial read accumulation */
-    size_t   read_pos;      /* bytes read so far */
-    size_t   read_target;   /* bytes needed (WIRE_HEADER_SIZE, then header+payload) */
+    uint8_t  wire_version;  /* WIRE_VERSION_1 or WIRE_VERSION_2 */
+    size_t   compress_min;  /* v2: compress payloads >= this, 0 = off */
+    uint8_t *read_buf;      /* buffered stream bytes (may hold several frames) */
+    size_t   read_len;      /* valid bytes in read_buf */
+    size_t   read_cap;      /* allocated size of read_buf */
 } tcp_impl_t;
 
 static void set_nonblocking(int fd) {
@@ -46,6 +51,17 @@ static bool try_accept(transport_t *self) {
     return true;
 }
 
+/* The peer closed or reset the connection, or sent a corrupt frame:
+   stop polling the socket so is_connected() reports it.  A server goes
+   back to accepting. */
+static void tcp_drop_conn(transport_t *self) {
+    tcp_impl_t *impl = self->impl;
+    close(impl->conn_fd);
+    impl->conn_fd = -1;
+    impl->read_len = 0;
+    self->fd = impl->listen_fd;
+}
+
 static bool tcp_send(transport_t *self, const message_t *msg) {
     tcp_impl_t *impl = self->impl;
 
@@ -55,7 +71,9 @@ static bool tcp_send(transport_t *self, const message_t *msg) {
     if (impl->conn_fd < 0) return false;
 
     size_t wire_size;
-    void *buf = wire_serialize_net(msg, &wire_size);
+    void *buf = (impl->wire_version == WIRE_VERSION_2)
+        ? wire_serialize_v2_compressed(msg, impl->compress_min, &wire_size)
+        : wire_serialize_net(msg, &wire_size);
     if (!buf) return false;
 
     /* Write all bytes — loop on partial writes */
@@ -65,6 +83,7 @@ static bool tcp_send(transport_t *self, const message_t *msg) {
                          wire_size - written, MSG_NOSIGNAL);
         if (n < 0) {
             if (errno == EINTR) continue;
+            if (errno == EPIPE || errno == ECONNRESET) tcp_drop_conn(self);
             free(buf);
             return false;
         }
@@ -75,6 +94,31 @@ static bool tcp_send(transport_t *self, const message_t *msg) {
     return true;
 }
 
+/* Length of the frame at the front of read_buf: >0 once its header is
+   complete, 0 if more bytes are needed, -1 if the stream is corrupt. */
+static ssize_t tcp_frame_size(const tcp_impl_t *impl) {
+    if (impl->wire_version == WIRE_VERSION_2) {
+        wire_v2_header_t hdr;
+        int hlen = wire_v2_decode_header(impl->read_buf, impl->read_len, &hdr);
+        if (hlen <= 0) return hlen;
+        return (ssize_t)hlen + (ssize_t)hdr.payload_size;
+    }
+    if (impl->read_len < WIRE_HEADER_SIZE) return 0;
+    const wire_header_t *hdr = (const wire_header_t *)impl->read_buf;
+    return (ssize_t)WIRE_HEADER_SIZE + (ssize_t)ntohl(hdr->payload_size);
+}
+
+static bool tcp_reserve(tcp_impl_t *impl, size_t need) {
+    if (impl->read_cap >= need) return true;
+    size_t cap = impl->read_cap ? impl->read_cap : TCP_READ_CHUNK;
+    while (cap < need) cap *= 2;
+    uint8_t *buf = realloc(impl->read_buf, cap);
+    if (!buf) return false;
+    impl->read_buf = buf;
+    impl->read_cap = cap;
+    return true;
+}
+
 static message_t *tcp_recv(transport_t *self) {
     tcp_impl_t *impl = self->impl;
 
@@ -83,71 +127,49 @@ static message_t *tcp_recv(transport_t *self) {
     }
     if (impl->conn_fd < 0) return NULL;
 
-    /* Allocate read buffer on first call */
-    if (!impl->read_buf) {
-        impl->read_buf = malloc(WIRE_HEADER_SIZE);
-        if (!impl->read_buf) return NULL;
-        impl->read_pos = 0;
-        impl->read_target = WIRE_HEADER_SIZE;
-    }
-
-    /* Read loop: try to fill current target */
-    while (impl->read_pos < impl->read_target) {
-        ssize_t n = recv(impl->conn_fd, impl->read_buf + impl->read_pos,
-                         impl->read_target - impl->read_pos, MSG_DONTWAIT);
-        if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) return NULL;
-            if (errno == EINTR) continue;
-            return NULL;  /* error */
+    for (;;) {
+        /* A previous read may already hold one or more complete frames */
+        ssize_t frame = impl->read_len > 0 ? tcp_frame_size(impl) : 0;
+        if (frame < 0) {
+            /* Corrupt stream: no later byte can be trusted as a frame
+               start, so drop the link and let it be re-established */
+            tcp_drop_conn(self);
+            return NULL;
         }
-        if (n == 0) return NULL;  /* EOF */
-        impl->read_pos += (size_t)n;
-    }
-
-    /* Have we just finished reading the header? */
-    if (impl->read_target == WIRE_HEADER_SIZE) {
-        const wire_header_t *hdr = (const wire_header_t *)impl->read_buf;
-        uint32_t psz = ntohl(hdr->payload_size);
-
-        if (psz == 0) {
-            /* No payload — deserialize immediately */
-            message_t *msg = wire_deserialize_net(impl->read_buf, WIRE_HEADER_SIZE);
-            impl->read_pos = 0;
-            impl->read_target = WIRE_HEADER_SIZE;
+        if (frame > 0 && impl->read_len >= (size_t)frame) {
+            message_t *msg = (impl->wire_version == WIRE_VERSION_2)
+                ? wire_deserialize_v2(impl->read_buf, (size_t)frame)
+                : wire_deserialize_net(impl->read_buf, (size_t)frame);
+
+            impl->read_len -= (size_t)frame;
+            if (impl->read_len > 0) {
+                memmove(impl->read_buf, impl->read_buf + frame, impl->read_len);
+            } else if (impl->read_cap > TCP_READ_BUF_KEEP) {
+                free(impl->read_buf);
+                impl->read_buf = NULL;
+                impl->read_cap = 0;
+            }
             return msg;
         }
 
-        /* Grow buffer and continue reading payload */
-        size_t total = WIRE_HEADER_SIZE + psz;
-        uint8_t *new_buf = realloc(impl->read_buf, total);
-        if (!new_buf) return NULL;
-        impl->read_buf = new_buf;
-        impl->read_target = total;
-
-        /* Try to read payload bytes now (non-blocking) */
-        while (impl->read_pos < impl->read_target) {
-            ssize_t n = recv(impl->conn_fd, impl->read_buf + impl->read_pos,
-                             impl->read_target - impl->read_pos, MSG_DONTWAIT);
-            if (n < 0) {
-                if (errno == EAGAIN || errno == EWOULDBLOCK) return NULL;
-                if (errno == EINTR) continue;
-                return NULL;
-            }
-            if (n == 0) return NULL;
-            impl->read_pos += (size_t)n;
+        /* Need more bytes: make room for the whole frame when known */
+        size_t need = impl->read_len + TCP_READ_CHUNK;
+        if (frame > 0 && (size_t)frame > need) need = (size_t)frame;
+        if (!tcp_reserve(impl, need)) return NULL;
+
+        ssize_t n = recv(impl->conn_fd, impl->read_buf + impl->read_len,
+                         impl->read_cap - impl->read_len, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ECONNRESET) tcp_drop_conn(self);
+            return NULL;  /* EAGAIN or error */
         }
+        if (n == 0) {  /* EOF */
+            tcp_drop_conn(self);
+            return NULL;
+        }
+        impl->read_len += (size_t)n;
     }
-
-    /* Full message accumulated — deserialize and reset */
-    message_t *msg = wire_deserialize_net(impl->read_buf, impl->read_target);
-
-    /* Reset for next message (shrink buffer back to header size) */
-    uint8_t *reset_buf = realloc(impl->read_buf, WIRE_HEADER_SIZE);
-    if (reset_buf) impl->read_buf = reset_buf;
-    impl->read_pos = 0;
-    impl->read_target = WIRE_HEADER_SIZE;
-
-    return msg;
 }
 
 static bool tcp_is_connected(transport_t *self) {
@@ -210,7 +232,7 @@ transport_t *transport_tcp_listen(const char *host, uint16_t port,
     impl->listen_fd = fd;
     impl->conn_fd = -1;
     impl->is_server = true;
-    impl->read_target = WIRE_HEADER_SIZE;
+    impl->wire_version = WIRE_VERSION_1;
 
     tp->peer_node = peer_node;
     tp->fd = fd;  /* listen fd for poll until accept */
@@ -236,7 +258,7 @@ transport_t *transport_tcp_from_fd(int fd, node_id_t peer_node) {
     impl->listen_fd = -1;
     impl->conn_fd = fd;
     impl->is_server = false;
-    impl->read_target = WIRE_HEADER_SIZE;
+    impl->wire_version = WIRE_VERSION_1;
 
     tp->peer_node = peer_node;
     tp->fd = fd;
@@ -282,7 +304,7 @@ transport_t *transport_tcp_connect(const char *host, uint16_t port,
     impl->listen_fd = -1;
     impl->conn_fd = fd;
     impl->is_server = false;
-    impl->read_target = WIRE_HEADER_SIZE;
+    impl->wire_version = WIRE_VERSION_1;
 
     tp->peer_node = peer_node;
     tp->fd = fd;
@@ -294,3 +316,16 @@ transport_t *transport_tcp_connect(const char *host, uint16_t port,
 
     return tp;
 }
+
+void transport_tcp_set_wire_version(transport_t *tp, uint8_t version) {
+    if (!tp || !tp->impl) return;
+    tcp_impl_t *impl = tp->impl;
+    impl->wire_version = (version == WIRE_VERSION_2) ? WIRE_VERSION_2
+                                                     : WIRE_VERSION_1;
+}
+
+void transport_tcp_set_compression(transport_t *tp, size_t min_size) {
+    if (!tp || !tp->impl) return;
+    tcp_impl_t *impl = tp->impl;
+    impl->compress_min = min_size;
+}
@@ -1,21 +1,168 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* sendmmsg / recvmmsg */
+#endif
 #include "microkernel/transport_udp.h"
 #include "microkernel/wire.h"
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <arpa/inet.h>
 
-#define UDP_MAX_DGRAM 65507
+/*
+ * Datagram layout
+ *
+ * Messages that fit in UDP_FRAG_MTU travel as one v1 net frame.  Larger
+ * ones are split into fragments, each a v1 header of the whole message
+ * (reserved = UDP_FRAG_MAGIC) followed by a fragment header and a chunk
+ * of the payload:
+ *
+ *   Offset  Size  Field
+ *   0       28    wire header (payload_size = full payload size)
+ *   28      4     msg_id
+ *   32      2     index
+ *   34      2     count
+ *   36      2     chunk (bytes per fragment except the last)
+ *   38      2     reserved (0)
+ *   40      N     payload[index * chunk .. +N)
+ *
+ * Older receivers drop fragments: payload_size exceeds the datagram.
+ */
+
+#define UDP_FRAG_MAGIC     0x4D4B4652u  /* "MKFR" */
+#define UDP_FRAG_HDR_SIZE  12
+#define UDP_FRAG_CHUNK     (UDP_FRAG_MTU - WIRE_HEADER_SIZE - UDP_FRAG_HDR_SIZE)
+#define UDP_MAX_DGRAM      65507
+/* Receive slots hold the largest datagram: older senders put a whole
+   message of up to 64 KB in one.  The arena is only address space until
+   written, so small datagrams touch a page or so per slot. */
+#define UDP_RX_SLOT        65536
+#define UDP_REASM_SLOTS    8
+#define UDP_REASM_TIMEOUT_MS 2000
+#define UDP_SEND_WAIT_MS   10            /* poll for POLLOUT on EAGAIN */
+#define UDP_GSO_MAX_BYTES  65000         /* kernel caps a GSO send at 64 KB */
+#define UDP_SOCK_BUF       (4 * 1024 * 1024)  /* absorbs fragment bursts */
+
+_Static_assert(UDP_MAX_DGRAM <= UDP_RX_SLOT, "receive slots too small");
+_Static_assert(UDP_FRAG_CHUNK > 0, "UDP_FRAG_MTU too small");
+
+typedef struct {
+    bool        active;
+    uint32_t    msg_id;
+    actor_id_t  source;
+    actor_id_t  dest;
+    msg_type_t  type;
+    uint32_t    total;      /* full payload size */
+    uint16_t    chunk;
+    uint16_t    count;
+    uint16_t    seen;       /* distinct fragments received */
+    uint8_t    *data;
+    uint8_t    *bitmap;     /* one bit per fragment */
+    uint64_t    started_ms;
+} udp_reasm_t;
+
+/*
+ * Reliable mode (opt-in, both ends)
+ *
+ * Every datagram gains a DATA header; the receiver answers with ACKs:
+ *
+ *   DATA  kind(1) channel(1) reserved(2) seq(4) oseq(4)  + datagram above
+ *   ACK   kind(1) reserved(3) cum(4) sack(8)
+ *
+ * seq numbers every reliable datagram and drives acknowledgement and
+ * retransmission.  oseq numbers the ordered channel alone, so traffic on
+ * the unordered channel never waits behind a lost ordered datagram.
+ * cum acknowledges every seq below it; sack bit i covers seq cum + 1 + i.
+ */
+
+#define UDP_REL_KIND_DATA  1
+#define UDP_REL_KIND_ACK   2
+#define UDP_REL_DATA_HDR   12
+#define UDP_REL_ACK_SIZE   16
+#define UDP_REL_SACK_BITS  64
+#define UDP_REL_ACK_EVERY  16    /* data datagrams per ACK while busy */
+#define UDP_REL_INIT_RTO_MS 200
+#define UDP_REL_MIN_RTO_MS 10
+#define UDP_REL_MAX_RTO_MS 2000
+#define UDP_REL_INIT_CWND  10
+#define UDP_REL_DUP_THRESH 3     /* later transmissions ACKed => lost */
+
+_Static_assert(UDP_REL_WINDOW % 64 == 0, "UDP_REL_WINDOW must be a multiple of 64");
+
+enum { REL_FREE, REL_QUEUED, REL_INFLIGHT, REL_ACKED };
+
+typedef struct {
+    uint16_t len;          /* datagram bytes including DATA header */
+    uint8_t  state;        /* REL_* */
+    uint8_t  retries;
+    uint32_t tx;           /* transmission number of the last send */
+    uint64_t sent_ms;
+} rel_slot_t;
+
+typedef struct udp_rel {
+    uint8_t         channel;      /* UDP_RELIABLE_ORDERED / _UNORDERED */
+
+    /* Sender: slot seq % UDP_REL_WINDOW holds datagram seq */
+    uint8_t        *snd_arena;    /* UDP_REL_WINDOW * UDP_FRAG_MTU */
+    rel_slot_t      snd[UDP_REL_WINDOW];
+    uint32_t        snd_una;      /* oldest unacknowledged seq */
+    uint32_t        snd_nxt;      /* next seq to assign */
+    uint32_t        snd_oseq;     /* next ordered-channel seq */
+    uint32_t        snd_new;      /* next seq never transmitted */
+    uint32_t        in_flight;
+    uint32_t        retx_queued;  /* lost datagrams awaiting resend */
+    uint64_t        rto_at;       /* retransmission timer, 0 = idle */
+    uint32_t        tx_next;      /* numbers every transmission */
+    uint32_t        tx_acked;     /* newest transmission known delivered */
+    double          cwnd;         /* congestion window, datagrams */
+    uint32_t        ssthresh;
+    uint32_t        recover;      /* loss episode ends once una passes this */
+    uint32_t        srtt_ms, rttvar_ms, rto_ms;
+    bool            have_rtt;
+
+    /* Receiver */
+    uint8_t        *hold_arena;   /* early ordered datagrams, by oseq */
+    uint16_t        hold_len[UDP_REL_WINDOW];
+    uint64_t        rcv_bits[UDP_REL_WINDOW / 64];  /* seen, by seq */
+    uint32_t        rcv_cum;      /* every seq below this has arrived */
+    uint32_t        rcv_oseq;     /* next ordered seq to deliver */
+    uint32_t        ack_pending;
+
+    udp_rel_stats_t stats;
+} udp_rel_t;
 
 typedef struct {
     int                sock_fd;
     struct sockaddr_in peer_addr;
     bool               has_peer;
-    uint8_t            recv_buf[UDP_MAX_DGRAM];
+
+    /* Send batch: datagrams are framed straight into tx_arena */
+    uint8_t           *tx_arena;          /* UDP_BATCH_MAX * UDP_FRAG_MTU */
+    size_t             tx_len[UDP_BATCH_MAX];
+    uint32_t           tx_train[UDP_BATCH_MAX]; /* msg_id for fragments */
+    size_t             tx_count;
+    size_t             batch_limit;       /* flush when this many queued */
+    uint32_t           next_msg_id;
+    bool               gso_ok;
+
+    /* Receive batch */
+    uint8_t           *rx_arena;          /* UDP_BATCH_MAX * UDP_RX_SLOT */
+    struct mmsghdr     rx_msgs[UDP_BATCH_MAX];
+    struct iovec       rx_iov[UDP_BATCH_MAX];
+    struct sockaddr_in rx_addr[UDP_BATCH_MAX];
+    size_t             rx_count;
+    size_t             rx_next;
+
+    udp_reasm_t        reasm[UDP_REASM_SLOTS];
+
+    udp_rel_t         *rel;               /* NULL unless reliable mode */
 } udp_impl_t;
 
 static void set_nonblocking(int fd) {
@@ -23,44 +170,686 @@ static void set_nonblocking(int fd) {
     if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
-/* ── vtable implementations ────────────────────────────────────────── */
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* ── Send side ─────────────────────────────────────────────────────── */
+
+/* Number of queued datagrams starting at i that can go out as one GSO
+   send: consecutive full-size fragments of one message plus its tail. */
+static size_t gso_run(const udp_impl_t *impl, size_t i) {
+    size_t n = 1;
+    if (!impl->gso_ok || impl->tx_train[i] == 0) return 1;
+    while (i + n < impl->tx_count &&
+           impl->tx_train[i + n] == impl->tx_train[i] &&
+           impl->tx_len[i + n - 1] == UDP_FRAG_MTU &&
+           (n + 1) * UDP_FRAG_MTU <= UDP_GSO_MAX_BYTES)
+        n++;
+    return n;
+}
+
+/* Send everything queued in tx_arena (unreliable mode) */
+static bool tx_flush(transport_t *self) {
+    udp_impl_t *impl = self->impl;
+    if (impl->tx_count == 0) return true;
+    if (!impl->has_peer) {
+        impl->tx_count = 0;
+        return false;
+    }
+
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    struct iovec   iov[UDP_BATCH_MAX];
+#ifdef UDP_SEGMENT
+    char ctrl[UDP_BATCH_MAX][CMSG_SPACE(sizeof(uint16_t))]
+        __attribute__((aligned(sizeof(size_t))));
+#endif
+
+    /* Build one mmsghdr per datagram, or per GSO train */
+    size_t nmsgs = 0;
+    for (size_t i = 0; i < impl->tx_count; ) {
+        size_t run = gso_run(impl, i);
+        size_t bytes = 0;
+        for (size_t k = 0; k < run; k++) bytes += impl->tx_len[i + k];
+
+        memset(&msgs[nmsgs], 0, sizeof(msgs[nmsgs]));
+        iov[nmsgs].iov_base = impl->tx_arena + i * UDP_FRAG_MTU;
+        iov[nmsgs].iov_len = bytes;
+        msgs[nmsgs].msg_hdr.msg_iov = &iov[nmsgs];
+        msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+#ifdef UDP_SEGMENT
+        if (run > 1) {
+            struct msghdr *mh = &msgs[nmsgs].msg_hdr;
+            mh->msg_control = ctrl[nmsgs];
+            mh->msg_controllen = sizeof(ctrl[nmsgs]);
+            struct cmsghdr *cm = CMSG_FIRSTHDR(mh);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t seg = UDP_FRAG_MTU;
+            memcpy(CMSG_DATA(cm), &seg, sizeof(seg));
+        }
+#endif
+        nmsgs++;
+        i += run;
+    }
+
+    size_t sent = 0;
+    bool ok = true;
+    while (sent < nmsgs) {
+        int n = sendmmsg(impl->sock_fd, msgs + sent,
+                         (unsigned)(nmsgs - sent), MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = { .fd = impl->sock_fd, .events = POLLOUT };
+            if (poll(&pfd, 1, UDP_SEND_WAIT_MS) > 0) continue;
+        }
+        if (n < 0 && impl->gso_ok &&
+            (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+            /* No GSO on this path; resend the rest as plain datagrams */
+            size_t done = 0;
+            for (size_t m = 0; m < sent; m++) done += gso_run(impl, done);
+            impl->gso_ok = false;
+            memmove(impl->tx_arena, impl->tx_arena + done * UDP_FRAG_MTU,
+                    (impl->tx_count - done) * UDP_FRAG_MTU);
+            memmove(impl->tx_len, impl->tx_len + done,
+                    (impl->tx_count - done) * sizeof(impl->tx_len[0]));
+            memmove(impl->tx_train, impl->tx_train + done,
+                    (impl->tx_count - done) * sizeof(impl->tx_train[0]));
+            impl->tx_count -= done;
+            return tx_flush(self);
+        }
+        ok = false;   /* datagrams are best-effort: drop what's left */
+        break;
+    }
+
+    impl->tx_count = 0;
+    return ok;
+}
+
+/* Reserve the next datagram slot, flushing a full batch first */
+static uint8_t *tx_slot(transport_t *self, uint32_t train) {
+    udp_impl_t *impl = self->impl;
+    if (!impl->tx_arena) {
+        impl->tx_arena = malloc((size_t)UDP_BATCH_MAX * UDP_FRAG_MTU);
+        if (!impl->tx_arena) return NULL;
+    }
+    if (impl->tx_count == UDP_BATCH_MAX) tx_flush(self);
+    impl->tx_train[impl->tx_count] = train;
+    return impl->tx_arena + impl->tx_count * UDP_FRAG_MTU;
+}
+
+static uint8_t *rel_begin(transport_t *self, uint32_t train);
+static void rel_commit(udp_impl_t *impl, size_t inner_len);
+static bool rel_reserve(udp_impl_t *impl, size_t count);
+static bool rel_transmit(transport_t *self);
+static void rel_send_ack(udp_impl_t *impl);
+
+/* Where the next datagram is framed: the plain send batch, or the
+   reliable retransmit window (behind a DATA header) */
+static uint8_t *dgram_begin(transport_t *self, uint32_t train) {
+    udp_impl_t *impl = self->impl;
+    return impl->rel ? rel_begin(self, train) : tx_slot(self, train);
+}
+
+static void dgram_commit(udp_impl_t *impl, size_t len) {
+    if (impl->rel) rel_commit(impl, len);
+    else impl->tx_len[impl->tx_count++] = len;
+}
+
+static bool udp_flush(transport_t *self) {
+    udp_impl_t *impl = self->impl;
+    if (!impl->rel) return tx_flush(self);
+    rel_send_ack(impl);
+    return rel_transmit(self);
+}
 
 static bool udp_send(transport_t *self, const message_t *msg) {
     udp_impl_t *impl = self->impl;
+    size_t psz = msg->payload_size;
+    const uint8_t *payload = msg->payload;
+    if (psz > 0 && !payload) return false;
+
+    size_t dgram_max = UDP_FRAG_MTU - (impl->rel ? UDP_REL_DATA_HDR : 0);
+    size_t chunk = dgram_max - WIRE_HEADER_SIZE - UDP_FRAG_HDR_SIZE;
+
+    if (WIRE_HEADER_SIZE + psz <= dgram_max) {
+        if (impl->rel && !rel_reserve(impl, 1)) return false;
+        uint8_t *slot = dgram_begin(self, 0);
+        if (!slot) return false;
+        wire_header_to_net(msg, slot);
+        if (psz > 0) memcpy(slot + WIRE_HEADER_SIZE, payload, psz);
+        dgram_commit(impl, WIRE_HEADER_SIZE + psz);
+    } else {
+        if (psz > UDP_MAX_MESSAGE) return false;
+        size_t count = (psz + chunk - 1) / chunk;
+        if (count > 0xFFFF) return false;
+        if (impl->rel && !rel_reserve(impl, count)) return false;
+
+        uint32_t msg_id = ++impl->next_msg_id;
+        if (msg_id == 0) msg_id = ++impl->next_msg_id;
+
+        for (size_t idx = 0; idx < count; idx++) {
+            size_t off = idx * chunk;
+            size_t len = psz - off < chunk ? psz - off : chunk;
+
+            uint8_t *slot = dgram_begin(self, msg_id);
+            if (!slot) return false;
+            wire_header_to_net(msg, slot);
+            uint32_t magic = htonl(UDP_FRAG_MAGIC);
+            memcpy(slot + offsetof(wire_header_t, reserved), &magic, 4);
+
+            uint8_t *fh = slot + WIRE_HEADER_SIZE;
+            uint32_t id_be = htonl(msg_id);
+            uint16_t f[4] = { htons((uint16_t)idx), htons((uint16_t)count),
+                              htons((uint16_t)chunk), 0 };
+            memcpy(fh, &id_be, 4);
+            memcpy(fh + 4, f, sizeof(f));
+            memcpy(fh + UDP_FRAG_HDR_SIZE, payload + off, len);
+            dgram_commit(impl, WIRE_HEADER_SIZE + UDP_FRAG_HDR_SIZE + len);
+        }
+    }
+
+    if (impl->rel) {
+        udp_rel_t *r = impl->rel;
+        if (r->snd_nxt - r->snd_new >= impl->batch_limit) return rel_transmit(self);
+        return true;
+    }
+    if (impl->tx_count >= impl->batch_limit) return tx_flush(self);
+    return true;
+}
 
-    size_t wire_size;
-    void *buf = wire_serialize_net(msg, &wire_size);
-    if (!buf) return false;
+/* ── Receive side ──────────────────────────────────────────────────── */
 
-    if (wire_size > UDP_MAX_DGRAM) {
-        free(buf);
+static void reasm_clear(udp_reasm_t *r) {
+    free(r->data);
+    free(r->bitmap);
+    memset(r, 0, sizeof(*r));
+}
+
+/* Find the partial message for msg_id, or claim a slot for it
+   (evicting timed-out or, failing that, the oldest entry). */
+static udp_reasm_t *reasm_slot(udp_impl_t *impl, uint32_t msg_id,
+                               uint64_t now) {
+    udp_reasm_t *free_slot = NULL, *oldest = NULL;
+    for (size_t i = 0; i < UDP_REASM_SLOTS; i++) {
+        udp_reasm_t *r = &impl->reasm[i];
+        /* Reliable mode never loses fragments, so never times them out */
+        if (r->active && !impl->rel &&
+            now - r->started_ms > UDP_REASM_TIMEOUT_MS)
+            reasm_clear(r);
+        if (!r->active) {
+            if (!free_slot) free_slot = r;
+            continue;
+        }
+        if (r->msg_id == msg_id) return r;
+        if (!oldest || r->started_ms < oldest->started_ms) oldest = r;
+    }
+    if (free_slot) return free_slot;
+    reasm_clear(oldest);
+    return oldest;
+}
+
+/* Feed one fragment; returns the message once all fragments are in */
+static message_t *reasm_fragment(udp_impl_t *impl, const wire_header_t *hdr,
+                                 const uint8_t *buf, size_t len) {
+    if (len < WIRE_HEADER_SIZE + UDP_FRAG_HDR_SIZE) return NULL;
+    const uint8_t *fh = buf + WIRE_HEADER_SIZE;
+    uint32_t msg_id;
+    uint16_t f[4];
+    memcpy(&msg_id, fh, 4);
+    memcpy(f, fh + 4, sizeof(f));
+    msg_id = ntohl(msg_id);
+    uint16_t idx = ntohs(f[0]), count = ntohs(f[1]), chunk = ntohs(f[2]);
+
+    uint32_t total = hdr->payload_size;
+    if (chunk == 0 || total == 0 || total > UDP_MAX_MESSAGE) return NULL;
+    if (count != (total + chunk - 1) / chunk || idx >= count) return NULL;
+    size_t off = (size_t)idx * chunk;
+    size_t want = total - off < chunk ? total - off : chunk;
+    if (len - WIRE_HEADER_SIZE - UDP_FRAG_HDR_SIZE != want) return NULL;
+
+    uint64_t now = now_ms();
+    udp_reasm_t *r = reasm_slot(impl, msg_id, now);
+    if (!r->active) {
+        r->data = malloc(total);
+        r->bitmap = calloc(((size_t)count + 7) / 8, 1);
+        if (!r->data || !r->bitmap) {
+            reasm_clear(r);
+            return NULL;
+        }
+        r->active = true;
+        r->msg_id = msg_id;
+        r->source = hdr->source;
+        r->dest = hdr->dest;
+        r->type = hdr->type;
+        r->total = total;
+        r->chunk = chunk;
+        r->count = count;
+        r->started_ms = now;
+    } else if (r->total != total || r->chunk != chunk) {
+        return NULL;
+    }
+
+    uint8_t bit = (uint8_t)(1u << (idx % 8));
+    if (r->bitmap[idx / 8] & bit) return NULL;   /* duplicate */
+    r->bitmap[idx / 8] |= bit;
+    memcpy(r->data + off, fh + UDP_FRAG_HDR_SIZE, want);
+    if (++r->seen < r->count) return NULL;
+
+    /* Complete: hand the reassembly buffer to the message */
+    message_t *msg = message_create(r->source, r->dest, r->type, NULL, 0);
+    if (msg) {
+        msg->payload = r->data;
+        msg->payload_size = r->total;
+        msg->free_payload = free;
+        r->data = NULL;
+    }
+    reasm_clear(r);
+    return msg;
+}
+
+/* Refill the receive batch with one recvmmsg; false if nothing arrived */
+static bool rx_fill(udp_impl_t *impl) {
+    if (!impl->rx_arena) {
+        impl->rx_arena = malloc((size_t)UDP_BATCH_MAX * UDP_RX_SLOT);
+        if (!impl->rx_arena) return false;
+    }
+    for (size_t i = 0; i < UDP_BATCH_MAX; i++) {
+        impl->rx_iov[i].iov_base = impl->rx_arena + i * UDP_RX_SLOT;
+        impl->rx_iov[i].iov_len = UDP_RX_SLOT;
+        memset(&impl->rx_msgs[i], 0, sizeof(impl->rx_msgs[i]));
+        impl->rx_msgs[i].msg_hdr.msg_iov = &impl->rx_iov[i];
+        impl->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+        if (!impl->has_peer) {
+            impl->rx_msgs[i].msg_hdr.msg_name = &impl->rx_addr[i];
+            impl->rx_msgs[i].msg_hdr.msg_namelen = sizeof(impl->rx_addr[i]);
+        }
+    }
+
+    int n = recvmmsg(impl->sock_fd, impl->rx_msgs, UDP_BATCH_MAX,
+                     MSG_DONTWAIT, NULL);
+    if (n <= 0) return false;
+    impl->rx_count = (size_t)n;
+    impl->rx_next = 0;
+    return true;
+}
+
+/* Decode one (unreliable-layout) datagram: a whole frame or a fragment */
+static message_t *decode_dgram(udp_impl_t *impl, const uint8_t *buf,
+                               size_t len) {
+    if (len < WIRE_HEADER_SIZE) return NULL;
+    wire_header_t hdr;
+    wire_header_from_net(buf, &hdr);
+    return (hdr.reserved == UDP_FRAG_MAGIC)
+        ? reasm_fragment(impl, &hdr, buf, len)
+        : wire_deserialize_net(buf, len);
+}
+
+/* ── Reliable mode ─────────────────────────────────────────────────── */
+
+static bool seq_lt(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static rel_slot_t *snd_slot(udp_rel_t *r, uint32_t seq) {
+    return &r->snd[seq % UDP_REL_WINDOW];
+}
+
+static bool rcv_bit(const udp_rel_t *r, uint32_t seq) {
+    uint32_t i = seq % UDP_REL_WINDOW;
+    return (r->rcv_bits[i / 64] >> (i % 64)) & 1;
+}
+
+static void rcv_mark(udp_rel_t *r, uint32_t seq) {
+    uint32_t i = seq % UDP_REL_WINDOW;
+    r->rcv_bits[i / 64] |= 1ULL << (i % 64);
+    while (rcv_bit(r, r->rcv_cum)) {
+        i = r->rcv_cum % UDP_REL_WINDOW;
+        r->rcv_bits[i / 64] &= ~(1ULL << (i % 64));
+        r->rcv_cum++;
+    }
+}
+
+static bool rel_reserve(udp_impl_t *impl, size_t count) {
+    udp_rel_t *r = impl->rel;
+    return (size_t)(r->snd_nxt - r->snd_una) + count <= UDP_REL_WINDOW;
+}
+
+static uint8_t *rel_begin(transport_t *self, uint32_t train) {
+    udp_impl_t *impl = self->impl;
+    udp_rel_t *r = impl->rel;
+
+    /* Fragments of one message stay on the ordered sequence so that at
+       most one message is ever half reassembled */
+    uint8_t channel = train ? UDP_RELIABLE_ORDERED : r->channel;
+    uint32_t seq = r->snd_nxt;
+    uint32_t oseq = (channel == UDP_RELIABLE_ORDERED) ? r->snd_oseq++ : 0;
+
+    uint8_t *d = r->snd_arena + (seq % UDP_REL_WINDOW) * UDP_FRAG_MTU;
+    uint32_t seq_be = htonl(seq), oseq_be = htonl(oseq);
+    d[0] = UDP_REL_KIND_DATA;
+    d[1] = channel;
+    d[2] = d[3] = 0;
+    memcpy(d + 4, &seq_be, 4);
+    memcpy(d + 8, &oseq_be, 4);
+    return d + UDP_REL_DATA_HDR;
+}
+
+static void rel_commit(udp_impl_t *impl, size_t inner_len) {
+    udp_rel_t *r = impl->rel;
+    rel_slot_t *sl = snd_slot(r, r->snd_nxt++);
+    sl->len = (uint16_t)(UDP_REL_DATA_HDR + inner_len);
+    sl->state = REL_QUEUED;
+    sl->retries = 0;
+}
+
+static void rel_update_rto(udp_rel_t *r, uint32_t rtt) {
+    if (!r->have_rtt) {
+        r->srtt_ms = rtt;
+        r->rttvar_ms = rtt / 2;
+        r->have_rtt = true;
+    } else {
+        uint32_t err = r->srtt_ms > rtt ? r->srtt_ms - rtt : rtt - r->srtt_ms;
+        r->rttvar_ms = (3 * r->rttvar_ms + err) / 4;
+        r->srtt_ms = (7 * r->srtt_ms + rtt) / 8;
+    }
+    uint32_t rto = r->srtt_ms + 4 * r->rttvar_ms;
+    if (rto < UDP_REL_MIN_RTO_MS) rto = UDP_REL_MIN_RTO_MS;
+    if (rto > UDP_REL_MAX_RTO_MS) rto = UDP_REL_MAX_RTO_MS;
+    r->rto_ms = rto;
+}
+
+/* Loss detected: halve the window, once per round trip of data */
+static void rel_on_loss(udp_rel_t *r, uint32_t seq, bool timeout) {
+    if (!timeout && seq_lt(seq, r->recover)) return;
+    uint32_t half = (uint32_t)(r->cwnd / 2);
+    r->ssthresh = half > 2 ? half : 2;
+    r->cwnd = timeout ? 1 : r->ssthresh;
+    r->recover = r->snd_nxt;
+}
+
+static void rel_requeue(udp_rel_t *r, rel_slot_t *sl) {
+    sl->state = REL_QUEUED;
+    sl->retries++;
+    r->in_flight--;
+    r->retx_queued++;
+}
+
+static bool rel_sendmmsg(udp_impl_t *impl, struct mmsghdr *msgs, size_t n) {
+    /* Anything the socket refuses stays in flight and is recovered by
+       the retransmission timer */
+    size_t sent = 0;
+    while (sent < n) {
+        int k = sendmmsg(impl->sock_fd, msgs + sent, (unsigned)(n - sent),
+                         MSG_NOSIGNAL);
+        if (k > 0) { sent += (size_t)k; continue; }
+        if (k < 0 && errno == EINTR) continue;
         return false;
     }
+    return true;
+}
+
+/* Transmit due retransmissions and as much new data as cwnd allows */
+static bool rel_transmit(transport_t *self) {
+    udp_impl_t *impl = self->impl;
+    udp_rel_t *r = impl->rel;
+    if (!impl->has_peer) return false;
+    uint64_t now = now_ms();
+
+    /* Retransmission timeout: resend what the receiver's ACKs can speak
+       for (the oldest datagram and the SACK range above it).  Later
+       datagrams may simply be waiting behind a hole, so leave them. */
+    if (r->rto_at && now >= r->rto_at) {
+        bool first = true;
+        for (uint32_t s = r->snd_una;
+             s != r->snd_new && s - r->snd_una <= UDP_REL_SACK_BITS; s++) {
+            rel_slot_t *sl = snd_slot(r, s);
+            if (sl->state == REL_INFLIGHT && now - sl->sent_ms >= r->rto_ms) {
+                if (first) rel_on_loss(r, s, true);
+                rel_requeue(r, sl);
+                first = false;
+            }
+        }
+        r->rto_ms = r->rto_ms * 2 < UDP_REL_MAX_RTO_MS
+                  ? r->rto_ms * 2 : UDP_REL_MAX_RTO_MS;
+        r->rto_at = 0;
+    }
+
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    struct iovec   iov[UDP_BATCH_MAX];
+    size_t n = 0;
+    bool ok = true;
+
+    /* Retransmissions always go; new data only while within cwnd */
+    uint32_t s = r->retx_queued ? r->snd_una : r->snd_new;
+    for (; s != r->snd_nxt; s++) {
+        rel_slot_t *sl = snd_slot(r, s);
+        if (s == r->snd_new) {
+            if (r->in_flight >= (uint32_t)r->cwnd) break;
+            r->snd_new++;
+        } else if (sl->state != REL_QUEUED) {
+            continue;
+        } else {
+            r->retx_queued--;
+            r->stats.retransmits++;
+        }
+
+        iov[n].iov_base = r->snd_arena + (s % UDP_REL_WINDOW) * UDP_FRAG_MTU;
+        iov[n].iov_len = sl->len;
+        memset(&msgs[n], 0, sizeof(msgs[n]));
+        msgs[n].msg_hdr.msg_iov = &iov[n];
+        msgs[n].msg_hdr.msg_iovlen = 1;
+        n++;
+
+        r->stats.sent++;
+        sl->state = REL_INFLIGHT;
+        sl->sent_ms = now;
+        sl->tx = r->tx_next++;
+        r->in_flight++;
+
+        if (n == UDP_BATCH_MAX) {
+            ok = rel_sendmmsg(impl, msgs, n) && ok;
+            n = 0;
+        }
+    }
+    if (n > 0) ok = rel_sendmmsg(impl, msgs, n) && ok;
 
-    ssize_t n = send(impl->sock_fd, buf, wire_size, MSG_NOSIGNAL);
-    free(buf);
-    return n == (ssize_t)wire_size;
+    if (!r->rto_at && r->in_flight) r->rto_at = now + r->rto_ms;
+    return ok;
 }
 
-static message_t *udp_recv(transport_t *self) {
+static void rel_send_ack(udp_impl_t *impl) {
+    udp_rel_t *r = impl->rel;
+    if (r->ack_pending == 0 || !impl->has_peer) return;
+
+    uint64_t sack = 0;
+    for (uint32_t i = 0; i < UDP_REL_SACK_BITS; i++)
+        if (rcv_bit(r, r->rcv_cum + 1 + i)) sack |= 1ULL << i;
+
+    uint8_t ack[UDP_REL_ACK_SIZE] = { UDP_REL_KIND_ACK, 0, 0, 0 };
+    uint32_t cum_be = htonl(r->rcv_cum);
+    memcpy(ack + 4, &cum_be, 4);
+    for (int i = 0; i < 8; i++) ack[8 + i] = (uint8_t)(sack >> (56 - 8 * i));
+
+    send(impl->sock_fd, ack, sizeof(ack), MSG_NOSIGNAL | MSG_DONTWAIT);
+    r->ack_pending = 0;
+    r->stats.acks_sent++;
+}
+
+/* Returns 1 if seq was newly acknowledged */
+static uint32_t rel_mark_acked(udp_rel_t *r, uint32_t seq, uint64_t now) {
+    rel_slot_t *sl = snd_slot(r, seq);
+    if (sl->state == REL_INFLIGHT) {
+        r->in_flight--;
+        if (sl->retries == 0) rel_update_rto(r, (uint32_t)(now - sl->sent_ms));
+        if (seq_lt(r->tx_acked, sl->tx)) r->tx_acked = sl->tx;
+    } else if (sl->state == REL_QUEUED && sl->retries) {
+        r->retx_queued--;
+    } else {
+        return 0;
+    }
+    sl->state = REL_ACKED;
+    return 1;
+}
+
+static void rel_on_ack(transport_t *self, const uint8_t *buf) {
     udp_impl_t *impl = self->impl;
+    udp_rel_t *r = impl->rel;
+    uint64_t now = now_ms();
 
-    struct sockaddr_in from_addr;
-    socklen_t from_len = sizeof(from_addr);
+    uint32_t cum;
+    memcpy(&cum, buf + 4, 4);
+    cum = ntohl(cum);
+    uint64_t sack = 0;
+    for (int i = 0; i < 8; i++) sack = (sack << 8) | buf[8 + i];
+    if (seq_lt(r->snd_nxt, cum)) return;   /* acks data never sent */
 
-    ssize_t n = recvfrom(impl->sock_fd, impl->recv_buf, UDP_MAX_DGRAM,
-                         MSG_DONTWAIT, (struct sockaddr *)&from_addr, &from_len);
-    if (n <= 0) return NULL;
+    uint32_t newly = 0;
+    for (uint32_t s = r->snd_una; seq_lt(s, cum); s++)
+        newly += rel_mark_acked(r, s, now);
 
-    /* On first recv from bind side: lock in the peer */
-    if (!impl->has_peer) {
-        impl->peer_addr = from_addr;
-        impl->has_peer = true;
-        /* connect() to filter incoming and enable send() */
-        connect(impl->sock_fd, (struct sockaddr *)&from_addr, sizeof(from_addr));
+    uint32_t high = cum;   /* one past the highest SACKed seq */
+    for (uint32_t i = 0; i < UDP_REL_SACK_BITS; i++) {
+        uint32_t s = cum + 1 + i;
+        if (!seq_lt(s, r->snd_nxt)) break;
+        if (!((sack >> i) & 1) || seq_lt(s, r->snd_una)) continue;
+        newly += rel_mark_acked(r, s, now);
+        high = s + 1;
+    }
+
+    while (r->snd_una != r->snd_nxt &&
+           snd_slot(r, r->snd_una)->state == REL_ACKED) {
+        snd_slot(r, r->snd_una)->state = REL_FREE;
+        r->snd_una++;
+    }
+
+    if (newly > 0) {
+        r->rto_at = 0;   /* progress: restart the timer */
+        if (r->cwnd < r->ssthresh) r->cwnd += newly;
+        else r->cwnd += (double)newly / r->cwnd;
+        if (r->cwnd > UDP_REL_WINDOW) r->cwnd = UDP_REL_WINDOW;
+    }
+
+    /* Fast retransmit: a datagram is lost once enough transmissions made
+       after it have been acknowledged.  Counting transmissions rather
+       than sequence numbers also catches lost retransmissions. */
+    for (uint32_t s = r->snd_una; seq_lt(s, high); s++) {
+        rel_slot_t *sl = snd_slot(r, s);
+        if (sl->state == REL_INFLIGHT &&
+            (int32_t)(r->tx_acked - sl->tx) >= UDP_REL_DUP_THRESH) {
+            rel_on_loss(r, s, false);
+            rel_requeue(r, sl);
+        }
+    }
+
+    rel_transmit(self);
+}
+
+/* Accept one DATA datagram; returns a message if one is now complete */
+static message_t *rel_on_data(udp_impl_t *impl, const uint8_t *buf,
+                              size_t len) {
+    udp_rel_t *r = impl->rel;
+    if (len < UDP_REL_DATA_HDR + WIRE_HEADER_SIZE) return NULL;
+
+    uint32_t seq, oseq;
+    memcpy(&seq, buf + 4, 4);
+    memcpy(&oseq, buf + 8, 4);
+    seq = ntohl(seq);
+    oseq = ntohl(oseq);
+    const uint8_t *inner = buf + UDP_REL_DATA_HDR;
+    size_t inner_len = len - UDP_REL_DATA_HDR;
+
+    r->ack_pending++;
+    if (seq_lt(seq, r->rcv_cum) || rcv_bit(r, seq)) {
+        r->stats.dup_received++;
+        return NULL;
+    }
+    /* Outside the window: leave unacknowledged so it is sent again */
+    if (seq - r->rcv_cum >= UDP_REL_WINDOW) return NULL;
+
+    if (buf[1] != UDP_RELIABLE_ORDERED) {
+        rcv_mark(r, seq);
+        return decode_dgram(impl, inner, inner_len);
+    }
+
+    if (oseq - r->rcv_oseq >= UDP_REL_WINDOW ||
+        inner_len > UDP_FRAG_MTU - UDP_REL_DATA_HDR)
+        return NULL;
+    rcv_mark(r, seq);
+    if (oseq != r->rcv_oseq) {
+        uint32_t h = oseq % UDP_REL_WINDOW;
+        memcpy(r->hold_arena + (size_t)h * UDP_FRAG_MTU, inner, inner_len);
+        r->hold_len[h] = (uint16_t)inner_len;
+        return NULL;
     }
+    r->rcv_oseq++;
+    return decode_dgram(impl, inner, inner_len);
+}
+
+static message_t *udp_recv(transport_t *self) {
+    udp_impl_t *impl = self->impl;
+    udp_rel_t *r = impl->rel;
+
+    for (;;) {
+        if (r) {
+            /* Release ordered datagrams that were waiting on a gap */
+            uint32_t h = r->rcv_oseq % UDP_REL_WINDOW;
+            if (r->hold_len[h]) {
+                size_t hl = r->hold_len[h];
+                r->hold_len[h] = 0;
+                r->rcv_oseq++;
+                message_t *msg = decode_dgram(impl,
+                    r->hold_arena + (size_t)h * UDP_FRAG_MTU, hl);
+                if (msg) return msg;
+                continue;
+            }
+            if (r->ack_pending >= UDP_REL_ACK_EVERY) rel_send_ack(impl);
+        }
+
+        if (impl->rx_next >= impl->rx_count && !rx_fill(impl)) {
+            if (r) {
+                rel_send_ack(impl);
+                rel_transmit(self);
+            }
+            return NULL;
+        }
 
-    return wire_deserialize_net(impl->recv_buf, (size_t)n);
+        size_t i = impl->rx_next++;
+        struct msghdr *mh = &impl->rx_msgs[i].msg_hdr;
+        size_t len = impl->rx_msgs[i].msg_len;
+        const uint8_t *buf = impl->rx_iov[i].iov_base;
+
+        /* On first recv from bind side: lock in the peer */
+        if (!impl->has_peer && mh->msg_name) {
+            impl->peer_addr = impl->rx_addr[i];
+            impl->has_peer = true;
+            /* connect() to filter incoming and enable send() */
+            connect(impl->sock_fd, (struct sockaddr *)&impl->peer_addr,
+                    sizeof(impl->peer_addr));
+        }
+
+        if (mh->msg_flags & MSG_TRUNC) continue;
+
+        message_t *msg;
+        if (!r) {
+            msg = decode_dgram(impl, buf, len);
+        } else if (len >= UDP_REL_ACK_SIZE && buf[0] == UDP_REL_KIND_ACK) {
+            rel_on_ack(self, buf);
+            continue;
+        } else if (len > 0 && buf[0] == UDP_REL_KIND_DATA) {
+            msg = rel_on_data(impl, buf, len);
+        } else {
+            continue;
+        }
+        if (msg) return msg;
+    }
 }
 
 static bool udp_is_connected(transport_t *self) {
@@ -72,6 +861,16 @@ static void udp_destroy(transport_t *self) {
     if (!self) return;
     udp_impl_t *impl = self->impl;
     if (impl) {
+        udp_flush(self);
+        for (size_t i = 0; i < UDP_REASM_SLOTS; i++)
+            reasm_clear(&impl->reasm[i]);
+        if (impl->rel) {
+            free(impl->rel->snd_arena);
+            free(impl->rel->hold_arena);
+            free(impl->rel);
+        }
+        free(impl->tx_arena);
+        free(impl->rx_arena);
         if (impl->sock_fd >= 0) close(impl->sock_fd);
         free(impl);
     }
@@ -80,30 +879,14 @@ static void udp_destroy(transport_t *self) {
 
 /* ── Constructors ──────────────────────────────────────────────────── */
 
-transport_t *transport_udp_bind(const char *host, uint16_t port,
-                                node_id_t peer_node) {
-    int fd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (fd < 0) return NULL;
-
-    int opt = 1;
-    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port);
-    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
-        close(fd);
-        return NULL;
-    }
-
-    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        close(fd);
-        return NULL;
-    }
-
+static transport_t *udp_wrap(int fd, node_id_t peer_node) {
     set_nonblocking(fd);
 
+    /* Best effort: the kernel clamps to net.core.{r,w}mem_max */
+    int bufsz = UDP_SOCK_BUF;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsz, sizeof(bufsz));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsz, sizeof(bufsz));
+
     transport_t *tp = calloc(1, sizeof(*tp));
     udp_impl_t *impl = calloc(1, sizeof(*impl));
     if (!tp || !impl) {
@@ -114,7 +897,10 @@ transport_t *transport_udp_bind(const char *host, uint16_t port,
     }
 
     impl->sock_fd = fd;
-    impl->has_peer = false;
+    impl->batch_limit = 1;
+#ifdef UDP_SEGMENT
+    impl->gso_ok = true;
+#endif
 
     tp->peer_node = peer_node;
     tp->fd = fd;
@@ -122,16 +908,20 @@ transport_t *transport_udp_bind(const char *host, uint16_t port,
     tp->recv = udp_recv;
     tp->is_connected = udp_is_connected;
     tp->destroy = udp_destroy;
+    tp->flush = udp_flush;
     tp->impl = impl;
 
     return tp;
 }
 
-transport_t *transport_udp_connect(const char *host, uint16_t port,
-                                    node_id_t peer_node) {
+transport_t *transport_udp_bind(const char *host, uint16_t port,
+                                node_id_t peer_node) {
     int fd = socket(AF_INET, SOCK_DGRAM, 0);
     if (fd < 0) return NULL;
 
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
@@ -141,33 +931,94 @@ transport_t *transport_udp_connect(const char *host, uint16_t port,
         return NULL;
     }
 
-    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
         close(fd);
         return NULL;
     }
 
-    set_nonblocking(fd);
+    return udp_wrap(fd, peer_node);
+}
 
-    transport_t *tp = calloc(1, sizeof(*tp));
-    udp_impl_t *impl = calloc(1, sizeof(*impl));
-    if (!tp || !impl) {
-        free(tp);
-        free(impl);
+transport_t *transport_udp_connect(const char *host, uint16_t port,
+                                    node_id_t peer_node) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return NULL;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
         close(fd);
         return NULL;
     }
 
-    impl->sock_fd = fd;
-    impl->has_peer = true;
-    impl->peer_addr = addr;
-
-    tp->peer_node = peer_node;
-    tp->fd = fd;
-    tp->send = udp_send;
-    tp->recv = udp_recv;
-    tp->is_connected = udp_is_connected;
-    tp->destroy = udp_destroy;
-    tp->impl = impl;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return NULL;
+    }
 
+    transport_t *tp = udp_wrap(fd, peer_node);
+    if (tp) {
+        udp_impl_t *impl = tp->impl;
+        impl->has_peer = true;
+        impl->peer_addr = addr;
+    }
     return tp;
 }
+
+void transport_udp_set_batch(transport_t *tp, size_t max_batch) {
+    if (!tp || !tp->impl) return;
+    udp_impl_t *impl = tp->impl;
+    if (max_batch < 1) max_batch = 1;
+    if (max_batch > UDP_BATCH_MAX) max_batch = UDP_BATCH_MAX;
+    impl->batch_limit = max_batch;
+}
+
+bool transport_udp_set_reliable(transport_t *tp, udp_reliable_mode_t mode) {
+    if (!tp || !tp->impl) return false;
+    udp_impl_t *impl = tp->impl;
+
+    if (mode == UDP_RELIABLE_OFF) {
+        if (impl->rel) {
+            free(impl->rel->snd_arena);
+            free(impl->rel->hold_arena);
+            free(impl->rel);
+            impl->rel = NULL;
+        }
+        return true;
+    }
+
+    if (!impl->rel) {
+        udp_rel_t *r = calloc(1, sizeof(*r));
+        if (!r) return false;
+        r->snd_arena = malloc((size_t)UDP_REL_WINDOW * UDP_FRAG_MTU);
+        r->hold_arena = malloc((size_t)UDP_REL_WINDOW * UDP_FRAG_MTU);
+        if (!r->snd_arena || !r->hold_arena) {
+            free(r->snd_arena);
+            free(r->hold_arena);
+            free(r);
+            return false;
+        }
+        r->cwnd = UDP_REL_INIT_CWND;
+        r->ssthresh = UDP_REL_WINDOW;
+        r->rto_ms = UDP_REL_INIT_RTO_MS;
+        tx_flush(tp);   /* don't mix unreliable datagrams into the stream */
+        impl->rel = r;
+    }
+    impl->rel->channel = (uint8_t)mode;
+    return true;
+}
+
+bool transport_udp_get_stats(transport_t *tp, udp_rel_stats_t *out) {
+    if (!tp || !tp->impl || !out) return false;
+    udp_impl_t *impl = tp->impl;
+    if (!impl->rel) return false;
+    udp_rel_t *r = impl->rel;
+    *out = r->stats;
+    out->in_flight = r->in_flight;
+    out->cwnd = (uint32_t)r->cwnd;
+    out->srtt_ms = r->srtt_ms;
+    out->rto_ms = r->rto_ms;
+    return true;
+}
@@ -931,24 +931,18 @@ reload_result_t actor_reload_wasm(runtime_t *rt, actor_id_t old_id,
         return RELOAD_ERR_INSTANCE;
     }
 
-    /* 8. Transfer names: scan registry for old_id, re-register as new_id */
-    name_entry_t *reg = runtime_get_name_registry(rt);
-    size_t reg_cap = runtime_get_name_registry_size();
-    for (size_t i = 0; i < reg_cap; i++) {
-        if (reg[i].occupied && reg[i].actor_id == old_id) {
-            char name_copy[64];
-            snprintf(name_copy, sizeof(name_copy), "%s", reg[i].name);
-            /* Remove old entry and insert with new ID */
-            name_registry_remove_by_name(rt, name_copy);
-            name_registry_insert(rt, name_copy, new_id);
-            /* Broadcast update to peers */
-            name_register_payload_t payload;
-            memset(&payload, 0, sizeof(payload));
-            snprintf(payload.name, sizeof(payload.name), "%s", name_copy);
-            payload.actor_id = new_id;
-            runtime_broadcast_registry(rt, MSG_NAME_REGISTER,
-                                        &payload, sizeof(payload));
-        }
+    /* 8. Transfer names: re-register each of old_id's names as new_id */
+    const char *old_name;
+    while ((old_name = name_registry_first_name(rt, old_id)) != NULL) {
+        char name_copy[64];
+        snprintf(name_copy, sizeof(name_copy), "%s", old_name);
+        /* Remove old entry and insert with new ID */
+        name_registry_remove_by_name(rt, name_copy);
+        name_registry_insert(rt, name_copy, new_id);
+        /* Peers keep the first binding of a name, so unbind it first */
+        runtime_registry_announce(rt, REGISTRY_NAME_DEL, name_copy,
+                                  ACTOR_ID_INVALID);
+        runtime_registry_announce(rt, REGISTRY_NAME_ADD, name_copy, new_id);
     }
 
     /* 9. Forward queued mailbox messages */
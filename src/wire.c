@@ -2,6 +2,7 @@
 #define _GNU_SOURCE
 #endif
 #include "microkernel/wire.h"
+#include "lz.h"
 #include <stdlib.h>
 #include <string.h>
 #include <arpa/inet.h>
@@ -71,12 +72,7 @@ void *wire_serialize_net(const message_t *msg, size_t *out_size) {
     uint8_t *buf = malloc(total);
     if (!buf) return NULL;
 
-    wire_header_t *hdr = (wire_header_t *)buf;
-    hdr->source       = htobe64(msg->source);
-    hdr->dest         = htobe64(msg->dest);
-    hdr->type         = htonl(msg->type);
-    hdr->payload_size = htonl(psz);
-    hdr->reserved     = 0;
+    wire_header_to_net(msg, buf);
 
     if (psz > 0 && msg->payload) {
         memcpy(buf + WIRE_HEADER_SIZE, msg->payload, psz);
@@ -89,19 +85,244 @@ void *wire_serialize_net(const message_t *msg, size_t *out_size) {
 message_t *wire_deserialize_net(const void *buf, size_t buf_size) {
     if (!buf || buf_size < WIRE_HEADER_SIZE) return NULL;
 
-    const wire_header_t *hdr = (const wire_header_t *)buf;
-
-    actor_id_t source = be64toh(hdr->source);
-    actor_id_t dest   = be64toh(hdr->dest);
-    msg_type_t type   = ntohl(hdr->type);
-    uint32_t   psz    = ntohl(hdr->payload_size);
+    wire_header_t hdr;
+    wire_header_from_net(buf, &hdr);
 
-    if (buf_size < WIRE_HEADER_SIZE + psz) return NULL;
+    if (buf_size < WIRE_HEADER_SIZE + hdr.payload_size) return NULL;
 
     const void *payload = NULL;
-    if (psz > 0) {
+    if (hdr.payload_size > 0) {
         payload = (const uint8_t *)buf + WIRE_HEADER_SIZE;
     }
 
-    return message_create(source, dest, type, payload, psz);
+    return message_create(hdr.source, hdr.dest, hdr.type,
+                          payload, hdr.payload_size);
+}
+
+void wire_header_to_net(const message_t *msg, void *out) {
+    wire_header_t hdr = {
+        .source       = htobe64(msg->source),
+        .dest         = htobe64(msg->dest),
+        .type         = htonl(msg->type),
+        .payload_size = htonl((uint32_t)msg->payload_size),
+        .reserved     = 0
+    };
+    memcpy(out, &hdr, sizeof(hdr));
+}
+
+void wire_header_from_net(const void *buf, wire_header_t *hdr) {
+    wire_header_t raw;
+    memcpy(&raw, buf, sizeof(raw));
+    hdr->source       = be64toh(raw.source);
+    hdr->dest         = be64toh(raw.dest);
+    hdr->type         = ntohl(raw.type);
+    hdr->payload_size = ntohl(raw.payload_size);
+    hdr->reserved     = ntohl(raw.reserved);
+}
+
+/* ── Compact v2 framing ───────────────────────────────────────────── */
+
+#define WIRE_SYS_TYPE_MASK 0xFF000000u
+
+static size_t varint_put(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+/* Returns bytes consumed, 0 if truncated, -1 if longer than max_bytes */
+static int varint_get(const uint8_t *buf, size_t len, size_t max_bytes,
+                      uint64_t *out) {
+    if (len > 0 && buf[0] < 0x80) {   /* common case: one byte */
+        *out = buf[0];
+        return 1;
+    }
+    uint64_t v = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (i >= max_bytes) return -1;
+        v |= (uint64_t)(buf[i] & 0x7F) << (7 * i);
+        if (!(buf[i] & 0x80)) {
+            *out = v;
+            return (int)(i + 1);
+        }
+    }
+    return len >= max_bytes ? -1 : 0;
+}
+
+size_t wire_v2_encode_header(const wire_v2_header_t *hdr, uint8_t *out) {
+    uint8_t flags = hdr->flags & (WIRE_FLAG_COMPRESSED | WIRE_FLAG_TRACE);
+    uint32_t type = hdr->type;
+    if ((type & WIRE_SYS_TYPE_MASK) == WIRE_SYS_TYPE_MASK) {
+        flags |= WIRE_FLAG_SYS_TYPE;
+        type &= ~WIRE_SYS_TYPE_MASK;
+    }
+
+    size_t n = 0;
+    out[n++] = flags;
+    n += varint_put(out + n, hdr->payload_size);
+    n += varint_put(out + n, type);
+    n += varint_put(out + n, actor_id_node(hdr->source));
+    n += varint_put(out + n, actor_id_seq(hdr->source));
+    n += varint_put(out + n, actor_id_node(hdr->dest));
+    n += varint_put(out + n, actor_id_seq(hdr->dest));
+    if (flags & WIRE_FLAG_TRACE)
+        n += varint_put(out + n, hdr->trace_id);
+    if (flags & WIRE_FLAG_COMPRESSED)
+        n += varint_put(out + n, hdr->raw_size);
+    return n;
+}
+
+int wire_v2_decode_header(const void *buf, size_t buf_size,
+                          wire_v2_header_t *hdr) {
+    const uint8_t *p = buf;
+    if (!p || buf_size == 0) return 0;
+
+    uint8_t flags = p[0];
+    if (flags & ~WIRE_FLAGS_KNOWN) return -1;
+
+    /* payload_size, type, src node/seq, dst node/seq are 32-bit fields */
+    uint64_t f[6];
+    size_t pos = 1;
+    for (size_t i = 0; i < 6; i++) {
+        int r = varint_get(p + pos, buf_size - pos, 5, &f[i]);
+        if (r <= 0) return r;
+        if (f[i] > 0xFFFFFFFFu) return -1;
+        pos += (size_t)r;
+    }
+
+    uint64_t trace_id = 0;
+    if (flags & WIRE_FLAG_TRACE) {
+        int r = varint_get(p + pos, buf_size - pos, 10, &trace_id);
+        if (r <= 0) return r;
+        pos += (size_t)r;
+    }
+
+    uint64_t raw_size = 0;
+    if (flags & WIRE_FLAG_COMPRESSED) {
+        int r = varint_get(p + pos, buf_size - pos, 5, &raw_size);
+        if (r <= 0) return r;
+        if (raw_size > 0xFFFFFFFFu) return -1;
+        pos += (size_t)r;
+    }
+
+    uint32_t type = (uint32_t)f[1];
+    if (flags & WIRE_FLAG_SYS_TYPE) {
+        if (type & WIRE_SYS_TYPE_MASK) return -1;
+        type |= WIRE_SYS_TYPE_MASK;
+    }
+
+    hdr->flags        = flags;
+    hdr->payload_size = (uint32_t)f[0];
+    hdr->type         = type;
+    hdr->source       = actor_id_make((node_id_t)f[2], (uint32_t)f[3]);
+    hdr->dest         = actor_id_make((node_id_t)f[4], (uint32_t)f[5]);
+    hdr->trace_id     = trace_id;
+    hdr->raw_size     = (uint32_t)raw_size;
+    return (int)pos;
+}
+
+void *wire_serialize_v2_compressed(const message_t *msg, size_t min_size,
+                                   size_t *out_size) {
+    if (!msg || !out_size) return NULL;
+
+    wire_v2_header_t hdr = {
+        .source       = msg->source,
+        .dest         = msg->dest,
+        .type         = msg->type,
+        .payload_size = (uint32_t)msg->payload_size
+    };
+    uint8_t head[WIRE_V2_MAX_HEADER];
+    size_t hlen = wire_v2_encode_header(&hdr, head);
+
+    uint8_t *buf = malloc(hlen + hdr.payload_size);
+    if (!buf) return NULL;
+
+    /* Compress straight into the frame; the output must fit where the
+       plain payload would have gone, less the extra header bytes */
+    if (min_size > 0 && hdr.payload_size >= min_size && msg->payload) {
+        wire_v2_header_t zhdr = hdr;
+        zhdr.flags    = WIRE_FLAG_COMPRESSED;
+        zhdr.raw_size = hdr.payload_size;
+        uint8_t zhead[WIRE_V2_MAX_HEADER];
+        size_t zhlen = wire_v2_encode_header(&zhdr, zhead);
+        size_t room = hlen + hdr.payload_size;
+        room = room > zhlen + 1 ? room - zhlen - 1 : 0;
+
+        size_t zlen = room ? lz_compress(msg->payload, hdr.payload_size,
+                                         buf + zhlen, room) : 0;
+        if (zlen > 0) {
+            zhdr.payload_size = (uint32_t)zlen;
+            size_t final_hlen = wire_v2_encode_header(&zhdr, zhead);
+            if (final_hlen != zhlen)   /* shorter size varint: shift down */
+                memmove(buf + final_hlen, buf + zhlen, zlen);
+            memcpy(buf, zhead, final_hlen);
+            *out_size = final_hlen + zlen;
+            return buf;
+        }
+    }
+
+    memcpy(buf, head, hlen);
+    if (hdr.payload_size > 0 && msg->payload) {
+        memcpy(buf + hlen, msg->payload, hdr.payload_size);
+    }
+
+    *out_size = hlen + hdr.payload_size;
+    return buf;
+}
+
+void *wire_serialize_v2(const message_t *msg, size_t *out_size) {
+    return wire_serialize_v2_compressed(msg, 0, out_size);
+}
+
+/* LZ blocks expand at most ~255x; anything claiming more is bogus */
+#define WIRE_LZ_MAX_RATIO 255
+
+static message_t *inflate_v2(const wire_v2_header_t *hdr,
+                             const uint8_t *zdata) {
+    if (hdr->raw_size == 0 ||
+        (uint64_t)hdr->raw_size >
+            (uint64_t)hdr->payload_size * WIRE_LZ_MAX_RATIO + 16)
+        return NULL;
+
+    uint8_t *raw = malloc(hdr->raw_size);
+    if (!raw) return NULL;
+    if (lz_decompress(zdata, hdr->payload_size, raw, hdr->raw_size)
+            != hdr->raw_size) {
+        free(raw);
+        return NULL;
+    }
+
+    /* Hand the inflated buffer to the message instead of copying it */
+    message_t *msg = message_create(hdr->source, hdr->dest, hdr->type,
+                                    NULL, 0);
+    if (!msg) {
+        free(raw);
+        return NULL;
+    }
+    msg->payload = raw;
+    msg->payload_size = hdr->raw_size;
+    msg->free_payload = free;
+    return msg;
+}
+
+message_t *wire_deserialize_v2(const void *buf, size_t buf_size) {
+    wire_v2_header_t hdr;
+    int hlen = wire_v2_decode_header(buf, buf_size, &hdr);
+    if (hlen <= 0) return NULL;
+    if (buf_size < (size_t)hlen + hdr.payload_size) return NULL;
+
+    if (hdr.flags & WIRE_FLAG_COMPRESSED)
+        return inflate_v2(&hdr, (const uint8_t *)buf + hlen);
+
+    const void *payload = NULL;
+    if (hdr.payload_size > 0) {
+        payload = (const uint8_t *)buf + hlen;
+    }
+
+    return message_create(hdr.source, hdr.dest, hdr.type,
+                          payload, hdr.payload_size);
 }
@@ -0,0 +1,157 @@
+#define _DEFAULT_SOURCE
+#include "microkernel/runtime.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#define NODE_A 1
+#define NODE_B 2
+#define MSG_DATA  200
+#define MSG_START 201
+
+#define RUN_MS       2000
+#define TICK_MS      1
+#define BURST        64      /* offered per tick: ~64k msg/s */
+#define WORK_US      50      /* per message: the consumer manages ~20k/s */
+#define MAILBOX      64
+#define PAYLOAD_SIZE 256
+
+/* ── Actors ────────────────────────────────────────────────────────── */
+
+typedef struct {
+    actor_id_t dest;
+    uint64_t   sent;
+    uint64_t   refused;
+    timer_id_t tick;
+    timer_id_t stop;
+} producer_t;
+
+static void send_burst(runtime_t *rt, producer_t *p) {
+    uint8_t payload[PAYLOAD_SIZE] = {0};
+    for (int i = 0; i < BURST; i++) {
+        if (!actor_send(rt, p->dest, MSG_DATA, payload, sizeof(payload))) {
+            p->refused++;
+            return;   /* out of credit: MSG_SEND_READY resumes us */
+        }
+        p->sent++;
+    }
+}
+
+static bool producer_behavior(runtime_t *rt, actor_t *self,
+                              message_t *msg, void *state) {
+    (void)self;
+    producer_t *p = state;
+    if (msg->type == MSG_START) {
+        p->tick = actor_set_timer(rt, TICK_MS, true);
+        p->stop = actor_set_timer(rt, RUN_MS, false);
+    } else if (msg->type == MSG_TIMER) {
+        const timer_payload_t *t = msg->payload;
+        if (t->id == p->stop) {
+            runtime_stop(rt);
+            return false;
+        }
+        send_burst(rt, p);
+    }
+    return true;
+}
+
+typedef struct {
+    uint64_t   consumed;
+    timer_id_t stop;
+} consumer_t;
+
+static void busy_wait_us(long us) {
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &b);
+    } while ((b.tv_sec - a.tv_sec) * 1000000L +
+             (b.tv_nsec - a.tv_nsec) / 1000L < us);
+}
+
+static bool consumer_behavior(runtime_t *rt, actor_t *self,
+                              message_t *msg, void *state) {
+    (void)self;
+    consumer_t *c = state;
+    if (msg->type == MSG_START) {
+        /* Outlive the producer so messages in flight are counted */
+        c->stop = actor_set_timer(rt, RUN_MS + 200, false);
+    } else if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    } else if (msg->type == MSG_DATA) {
+        busy_wait_us(WORK_US);
+        c->consumed++;
+    }
+    return true;
+}
+
+/* ── Harness ───────────────────────────────────────────────────────── */
+
+static void *run_thread(void *arg) {
+    runtime_run(arg);
+    return NULL;
+}
+
+static double elapsed_sec(const struct timespec *a, const struct timespec *b) {
+    return (double)(b->tv_sec - a->tv_sec) +
+           (double)(b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void run(const char *label, uint32_t window) {
+    runtime_t *a = runtime_init(NODE_A, 64);
+    runtime_t *b = runtime_init(NODE_B, 64);
+    runtime_set_flow_window(a, window);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0 ||
+        !runtime_add_transport(a, transport_tcp_from_fd(sv[0], NODE_B)) ||
+        !runtime_add_transport(b, transport_tcp_from_fd(sv[1], NODE_A))) {
+        fprintf(stderr, "link setup failed\n");
+        exit(1);
+    }
+
+    consumer_t c = {0};
+    actor_id_t cons = actor_spawn(b, consumer_behavior, &c, NULL, MAILBOX);
+    producer_t p = { .dest = cons };
+    actor_id_t prod = actor_spawn(a, producer_behavior, &p, NULL, 16);
+    actor_send(b, cons, MSG_START, NULL, 0);
+    actor_send(a, prod, MSG_START, NULL, 0);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_t ta, tb;
+    pthread_create(&tb, NULL, run_thread, b);
+    pthread_create(&ta, NULL, run_thread, a);
+    pthread_join(ta, NULL);
+    pthread_join(tb, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = elapsed_sec(&t0, &t1);
+
+    uint64_t lost = p.sent > c.consumed ? p.sent - c.consumed : 0;
+    printf("  %-20s sent %8.0f msg/s  goodput %8.0f msg/s  lost %5.1f%%"
+           "  refused %llu\n", label,
+           (double)p.sent / secs, (double)c.consumed / secs,
+           p.sent ? 100.0 * (double)lost / (double)p.sent : 0.0,
+           (unsigned long long)p.refused);
+
+    runtime_destroy(a);
+    runtime_destroy(b);
+}
+
+int main(void) {
+    printf("=== Flow control benchmark ===\n\n");
+    printf("Slow consumer (%d us/msg, mailbox %d), producer offers %d msg"
+           " per %d ms:\n", WORK_US, MAILBOX, BURST, TICK_MS);
+    run("no flow control", 0);
+    run("window 16", 16);
+    run("window 32", 32);
+    return 0;
+}
@@ -0,0 +1,183 @@
+#define _GNU_SOURCE
+#include "microkernel/runtime.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/http.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#define BENCH_PORT 19911
+#define REQUESTS   2000      /* per mode */
+#define DEPTH      16        /* pipelined requests in flight */
+#define TOTAL_REQUESTS (3 * REQUESTS)
+
+/* ── Server actor (built-in HTTP server under test) ───────────────── */
+
+typedef struct {
+    int requests;
+} server_state_t;
+
+static bool server_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
+                            message_t *msg, void *state) {
+    server_state_t *s = state;
+
+    if (msg->type == 0) {
+        actor_http_listen(rt, BENCH_PORT);
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_REQUEST) {
+        const http_request_payload_t *p = msg->payload;
+        actor_http_respond(rt, p->conn_id, 200, NULL, 0, "ok", 2);
+        if (++s->requests >= TOTAL_REQUESTS) {
+            runtime_stop(rt);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ── Raw socket client ────────────────────────────────────────────── */
+
+static int connect_retry(void) {
+    for (int i = 0; i < 50; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(BENCH_PORT),
+            .sin_addr.s_addr = inet_addr("127.0.0.1")
+        };
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return fd;
+        }
+        close(fd);
+        usleep(20000);
+    }
+    return -1;
+}
+
+/* Read one response; bodies are always "ok" */
+static size_t read_response(int fd, char *buf, size_t cap) {
+    size_t pos = 0;
+    buf[0] = '\0';
+    while (pos < cap - 1) {
+        ssize_t n = recv(fd, buf + pos, cap - 1 - pos, 0);
+        if (n <= 0) break;
+        pos += (size_t)n;
+        buf[pos] = '\0';
+        char *end = strstr(buf, "\r\n\r\n");
+        if (end && pos >= (size_t)(end + 4 - buf) + 2) break;
+    }
+    return pos;
+}
+
+static bool read_exact(int fd, char *buf, size_t n) {
+    size_t pos = 0;
+    while (pos < n) {
+        ssize_t r = recv(fd, buf + pos, n - pos, 0);
+        if (r <= 0) return false;
+        pos += (size_t)r;
+    }
+    return true;
+}
+
+static double elapsed_s(const struct timespec *a, const struct timespec *b) {
+    return (double)(b->tv_sec - a->tv_sec) +
+           (double)(b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void report(const char *mode, double secs) {
+    printf("  %-22s %8.0f req/s  %7.1f us/req\n", mode,
+           REQUESTS / secs, secs * 1e6 / REQUESTS);
+}
+
+static const char *REQ_CLOSE =
+    "GET /bench HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+static const char *REQ_KEEP =
+    "GET /bench HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+static void run_client(void) {
+    char buf[4096];
+    struct timespec t0, t1;
+
+    /* New connection per request */
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < REQUESTS; i++) {
+        int fd = connect_retry();
+        if (fd < 0) _exit(1);
+        send(fd, REQ_CLOSE, strlen(REQ_CLOSE), 0);
+        if (read_response(fd, buf, sizeof(buf)) == 0) _exit(2);
+        close(fd);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    report("connection per request", elapsed_s(&t0, &t1));
+
+    /* One persistent connection, one request at a time */
+    int fd = connect_retry();
+    if (fd < 0) _exit(1);
+    size_t resp_len = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < REQUESTS; i++) {
+        send(fd, REQ_KEEP, strlen(REQ_KEEP), 0);
+        size_t n = read_response(fd, buf, sizeof(buf));
+        if (n == 0) _exit(3);
+        resp_len = n;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    report("keep-alive", elapsed_s(&t0, &t1));
+
+    /* Same connection, DEPTH requests per write */
+    static char batch[DEPTH * 64];
+    size_t req_len = strlen(REQ_KEEP);
+    for (int i = 0; i < DEPTH; i++)
+        memcpy(batch + (size_t)i * req_len, REQ_KEEP, req_len);
+
+    static char resps[DEPTH * 128];
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < REQUESTS; i += DEPTH) {
+        send(fd, batch, req_len * DEPTH, 0);
+        if (!read_exact(fd, resps, resp_len * DEPTH)) _exit(4);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    report("pipelined (depth 16)", elapsed_s(&t0, &t1));
+
+    close(fd);
+    fflush(stdout);
+    _exit(0);
+}
+
+/* ── Main ─────────────────────────────────────────────────────────── */
+
+int main(void) {
+    signal(SIGPIPE, SIG_IGN);
+    printf("bench_http_keepalive:\n");
+    fflush(stdout);
+
+    pid_t client = fork();
+    if (client == 0) run_client();
+
+    runtime_t *rt = runtime_init(1, 64);
+    server_state_t state = {0};
+    actor_id_t aid = actor_spawn(rt, server_behavior, &state, NULL, 64);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+
+    int status;
+    waitpid(client, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        printf("  FAIL: client exited with %d\n", WEXITSTATUS(status));
+
+    printf("\nbench_http_keepalive: done\n");
+    return 0;
+}
@@ -0,0 +1,179 @@
+#define _GNU_SOURCE
+#include "microkernel/runtime.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/http.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#define BENCH_PORT 19920
+#define HEADERS    64        /* per request, about 3 KB */
+#define REQUESTS   5000      /* per mode */
+#define DEPTH      16        /* pipelined requests in flight */
+#define TRICKLE    64        /* bytes per write in trickled mode */
+#define TRICKLE_REQUESTS 500
+#define TOTAL_REQUESTS (REQUESTS + TRICKLE_REQUESTS)
+
+/* ── Server actor (built-in HTTP server under test) ───────────────── */
+
+typedef struct {
+    int requests;
+    size_t headers;
+} server_state_t;
+
+static bool server_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
+                            message_t *msg, void *state) {
+    server_state_t *s = state;
+
+    if (msg->type == 0) {
+        actor_http_listen(rt, BENCH_PORT);
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_REQUEST) {
+        const http_request_payload_t *p = msg->payload;
+        s->headers += p->headers_size;
+        actor_http_respond(rt, p->conn_id, 200, NULL, 0, "ok", 2);
+        if (++s->requests >= TOTAL_REQUESTS) {
+            runtime_stop(rt);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ── Raw socket client ────────────────────────────────────────────── */
+
+static int connect_retry(void) {
+    for (int i = 0; i < 50; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(BENCH_PORT),
+            .sin_addr.s_addr = inet_addr("127.0.0.1")
+        };
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return fd;
+        }
+        close(fd);
+        usleep(20000);
+    }
+    return -1;
+}
+
+static bool read_exact(int fd, char *buf, size_t n) {
+    size_t pos = 0;
+    while (pos < n) {
+        ssize_t r = recv(fd, buf + pos, n - pos, 0);
+        if (r <= 0) return false;
+        pos += (size_t)r;
+    }
+    return true;
+}
+
+static double elapsed_s(const struct timespec *a, const struct timespec *b) {
+    return (double)(b->tv_sec - a->tv_sec) +
+           (double)(b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void report(const char *mode, int requests, size_t req_len,
+                   double secs) {
+    printf("  %-22s %8.0f req/s  %7.1f us/req  %6.1f MB/s\n", mode,
+           requests / secs, secs * 1e6 / requests,
+           (double)req_len * requests / secs / 1e6);
+}
+
+/* GET with HEADERS browser-like headers */
+static size_t build_request(char *buf, size_t cap) {
+    int pos = snprintf(buf, cap, "GET /bench HTTP/1.1\r\nHost: localhost\r\n");
+    for (int i = 0; i < HEADERS; i++)
+        pos += snprintf(buf + pos, cap - (size_t)pos,
+                        "X-Bench-Header-%02d: value-%02d; q=0.9, "
+                        "text/html, application/json\r\n", i, i);
+    pos += snprintf(buf + pos, cap - (size_t)pos, "\r\n");
+    return (size_t)pos;
+}
+
+static void run_client(void) {
+    static char req[8192];
+    static char batch[DEPTH * 8192];
+    char resp[256];
+    size_t req_len = build_request(req, sizeof(req));
+    struct timespec t0, t1;
+
+    int fd = connect_retry();
+    if (fd < 0) _exit(1);
+
+    /* Learn the response size from the first request */
+    send(fd, req, req_len, 0);
+    ssize_t n = recv(fd, resp, sizeof(resp), 0);
+    if (n <= 0) _exit(2);
+    size_t resp_len = (size_t)n;
+
+    /* DEPTH requests per write: many header lines per read */
+    for (int i = 0; i < DEPTH; i++)
+        memcpy(batch + (size_t)i * req_len, req, req_len);
+    static char resps[DEPTH * 256];
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 1; i < REQUESTS; i += DEPTH) {
+        int depth = REQUESTS - i < DEPTH ? REQUESTS - i : DEPTH;
+        send(fd, batch, req_len * (size_t)depth, 0);
+        if (!read_exact(fd, resps, resp_len * (size_t)depth)) _exit(3);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    report("pipelined (depth 16)", REQUESTS - 1, req_len,
+           elapsed_s(&t0, &t1));
+
+    /* Small writes: each line arrives over several reads */
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < TRICKLE_REQUESTS; i++) {
+        for (size_t off = 0; off < req_len; off += TRICKLE) {
+            size_t len = req_len - off < TRICKLE ? req_len - off : TRICKLE;
+            send(fd, req + off, len, 0);
+        }
+        if (!read_exact(fd, resps, resp_len)) _exit(4);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    report("trickled (64 B writes)", TRICKLE_REQUESTS, req_len,
+           elapsed_s(&t0, &t1));
+
+    close(fd);
+    fflush(stdout);
+    _exit(0);
+}
+
+/* ── Main ─────────────────────────────────────────────────────────── */
+
+int main(void) {
+    signal(SIGPIPE, SIG_IGN);
+    printf("bench_http_parse: %d headers per request\n", HEADERS);
+    fflush(stdout);
+
+    pid_t client = fork();
+    if (client == 0) run_client();
+
+    runtime_t *rt = runtime_init(1, 64);
+    server_state_t state = {0};
+    actor_id_t aid = actor_spawn(rt, server_behavior, &state, NULL, 64);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+
+    int status;
+    waitpid(client, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        printf("  FAIL: client exited with %d\n", WEXITSTATUS(status));
+
+    printf("\nbench_http_parse: done\n");
+    return 0;
+}
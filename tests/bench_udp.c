@@ -0,0 +1,175 @@
+#define _DEFAULT_SOURCE
+#include "udp_shim.h"
+#include "microkernel/message.h"
+#include "microkernel/transport_udp.h"
+#include "microkernel/transport_tcp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_PORT 19892
+#define SHIM_PORT  19895
+#define TCP_PORT   19896
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Send count messages in rounds of `round`, draining the receiver after
+   each round.  Reports delivered messages/s and loss. */
+static void run(const char *label, size_t batch, size_t payload_size,
+                int count, int round) {
+    transport_t *rx = transport_udp_bind("127.0.0.1", BENCH_PORT, 2);
+    transport_t *tx = transport_udp_connect("127.0.0.1", BENCH_PORT, 1);
+    if (!rx || !tx) {
+        fprintf(stderr, "transport setup failed\n");
+        exit(1);
+    }
+    transport_udp_set_batch(tx, batch);
+
+    uint8_t *payload = calloc(1, payload_size ? payload_size : 1);
+    message_t *msg = message_create(0x200000001ULL, 0x100000001ULL, 7,
+                                    payload, payload_size);
+
+    int received = 0;
+    double start = now_sec();
+    for (int sent = 0; sent < count; ) {
+        for (int i = 0; i < round && sent < count; i++, sent++)
+            tx->send(tx, msg);
+        tx->flush(tx);
+        message_t *in;
+        while ((in = rx->recv(rx)) != NULL) {
+            message_destroy(in);
+            received++;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    printf("  %-22s %9.0f msg/s  %8.1f MB/s  loss %.2f%%\n", label,
+           (double)received / elapsed,
+           (double)received * (double)payload_size / elapsed / 1e6,
+           100.0 * (double)(count - received) / (double)count);
+
+    message_destroy(msg);
+    free(payload);
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+/* Reliable ordered delivery through the lossy relay.  Messages are sent
+   as fast as the window allows; reports delivered throughput and how
+   many datagrams were retransmitted. */
+static void run_reliable(const char *label, double loss, size_t payload_size,
+                         int count) {
+    udp_shim_t shim;
+    if (!udp_shim_open(&shim, SHIM_PORT, BENCH_PORT, loss, 0.0, 7)) {
+        fprintf(stderr, "shim setup failed\n");
+        exit(1);
+    }
+    transport_t *rx = transport_udp_bind("127.0.0.1", BENCH_PORT, 2);
+    transport_t *tx = transport_udp_connect("127.0.0.1", SHIM_PORT, 1);
+    if (!rx || !tx) {
+        fprintf(stderr, "transport setup failed\n");
+        exit(1);
+    }
+    transport_udp_set_reliable(rx, UDP_RELIABLE_ORDERED);
+    transport_udp_set_reliable(tx, UDP_RELIABLE_ORDERED);
+    transport_udp_set_batch(tx, 64);
+
+    uint8_t *payload = calloc(1, payload_size);
+    message_t *msg = message_create(0x200000001ULL, 0x100000001ULL, 7,
+                                    payload, payload_size);
+
+    int sent = 0, received = 0;
+    double start = now_sec();
+    double deadline = start + 30.0;
+    while (received < count && now_sec() < deadline) {
+        while (sent < count && tx->send(tx, msg)) sent++;
+        tx->flush(tx);
+        udp_shim_pump(&shim);
+        message_t *in;
+        while ((in = rx->recv(rx)) != NULL) {
+            message_destroy(in);
+            received++;
+        }
+        rx->flush(rx);
+        while ((in = tx->recv(tx)) != NULL) message_destroy(in);
+    }
+    double elapsed = now_sec() - start;
+
+    udp_rel_stats_t st;
+    transport_udp_get_stats(tx, &st);
+    printf("  %-22s %9.0f msg/s  %8.1f MB/s  retransmit %5.1f%%%s\n", label,
+           (double)received / elapsed,
+           (double)received * (double)payload_size / elapsed / 1e6,
+           100.0 * (double)st.retransmits / (double)(st.sent ? st.sent : 1),
+           received < count ? "  (timed out)" : "");
+
+    message_destroy(msg);
+    free(payload);
+    tx->destroy(tx);
+    rx->destroy(rx);
+    udp_shim_close(&shim);
+}
+
+/* TCP over loopback, for reference: same payload, no loss */
+static void run_tcp(size_t payload_size, int count) {
+    transport_t *rx = transport_tcp_listen("127.0.0.1", TCP_PORT, 2);
+    transport_t *tx = transport_tcp_connect("127.0.0.1", TCP_PORT, 1);
+    if (!rx || !tx) {
+        fprintf(stderr, "tcp setup failed\n");
+        exit(1);
+    }
+    uint8_t *payload = calloc(1, payload_size);
+    message_t *msg = message_create(0x200000001ULL, 0x100000001ULL, 7,
+                                    payload, payload_size);
+
+    int received = 0;
+    double start = now_sec();
+    for (int sent = 0; sent < count; ) {
+        for (int i = 0; i < 64 && sent < count; i++, sent++)
+            tx->send(tx, msg);
+        for (int i = 0; i < 64 && received < sent; ) {
+            message_t *in = rx->recv(rx);
+            if (!in) continue;
+            message_destroy(in);
+            received++;
+            i++;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    printf("  %-22s %9.0f msg/s  %8.1f MB/s\n", "tcp (loopback)",
+           (double)received / elapsed,
+           (double)received * (double)payload_size / elapsed / 1e6);
+
+    message_destroy(msg);
+    free(payload);
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+int main(void) {
+    printf("=== UDP transport benchmark ===\n\n");
+
+    printf("Telemetry (32-byte payload):\n");
+    run("unbatched", 1, 32, 500000, 32);
+    run("batch 64 (sendmmsg)", 64, 32, 500000, 64);
+
+    printf("\nFragmented (256 KB payload):\n");
+    run("fragment + GSO", 1, 256 * 1024, 500, 1);
+
+    /* Loss is injected by a relay in this process, which also caps the
+       reliable rates.  Lossy TCP needs kernel-level emulation (netem). */
+    printf("\nReliable ordered (1 KB payload, relayed):\n");
+    run_reliable("0% loss", 0.00, 1024, 100000);
+    run_reliable("1% loss", 0.01, 1024, 100000);
+    run_reliable("5% loss", 0.05, 1024, 100000);
+    run_reliable("10% loss", 0.10, 1024, 100000);
+    run_tcp(1024, 100000);
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+#define _POSIX_C_SOURCE 200809L
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/wire.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/socket.h>
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+typedef struct {
+    const char *label;
+    msg_type_t  type;
+    size_t      payload_size;
+} sample_t;
+
+static const sample_t samples[] = {
+    { "ping",      1,                 0 },
+    { "midi",      100,               3 },
+    { "name_reg",  MSG_NAME_REGISTER, sizeof(name_register_payload_t) },
+    { "4k_blob",   200,               4096 },
+};
+
+#define NUM_SAMPLES (sizeof(samples) / sizeof(samples[0]))
+
+static message_t *make_sample(const sample_t *s) {
+    uint8_t payload[4096];
+    memset(payload, 0x5A, sizeof(payload));
+    return message_create(actor_id_make(3, 42), actor_id_make(1, 7),
+                          s->type, s->payload_size ? payload : NULL,
+                          s->payload_size);
+}
+
+/* ── Encoded size ──────────────────────────────────────────────────── */
+
+static void bench_sizes(void) {
+    printf("  %-10s %8s %8s %8s\n", "message", "v1", "v2", "saved");
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        message_t *msg = make_sample(&samples[i]);
+        size_t v1, v2;
+        free(wire_serialize_net(msg, &v1));
+        free(wire_serialize_v2(msg, &v2));
+        printf("  %-10s %8zu %8zu %7.1f%%\n", samples[i].label, v1, v2,
+               100.0 * (double)(v1 - v2) / (double)v1);
+        message_destroy(msg);
+    }
+}
+
+/* ── Encode + decode rate ─────────────────────────────────────────── */
+
+static void bench_codec(const char *label,
+                        void *(*ser)(const message_t *, size_t *),
+                        message_t *(*de)(const void *, size_t),
+                        const message_t *msg, int iters) {
+    double start = now_sec();
+    for (int i = 0; i < iters; i++) {
+        size_t sz;
+        void *buf = ser(msg, &sz);
+        message_t *out = de(buf, sz);
+        message_destroy(out);
+        free(buf);
+    }
+    double elapsed = now_sec() - start;
+    printf("  %-10s %.0f roundtrips/s\n", label, (double)iters / elapsed);
+}
+
+/* ── Payload compression ───────────────────────────────────────────── */
+
+/* JSON rows shaped like cf_proxy query results */
+static size_t fill_json(char *buf, size_t cap) {
+    size_t n = 0;
+    int row = 0;
+    while (n + 96 < cap) {
+        n += (size_t)snprintf(buf + n, cap - n,
+            "{\"id\":%d,\"name\":\"sensor-%d\",\"room\":\"lab\","
+            "\"value\":%d.%02d,\"ok\":true},", row, row % 17,
+            (row * 37) % 100, (row * 13) % 100);
+        row++;
+    }
+    return n;
+}
+
+/* Byte stream mixing recurring 8-byte sequences with random immediates,
+   roughly like compiled wasm */
+static size_t fill_binary(uint8_t *buf, size_t cap) {
+    uint8_t dict[64][8];
+    uint32_t x = 2463534242u;
+    for (size_t i = 0; i < sizeof(dict); i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        dict[i / 8][i % 8] = (uint8_t)(x >> 24);
+    }
+    size_t n = 0;
+    while (n + 8 <= cap) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        if (x & 1) {
+            memcpy(buf + n, dict[(x >> 8) & 63], 8);
+            n += 8;
+        } else {
+            memcpy(buf + n, &x, 4);
+            n += 4;
+        }
+    }
+    return n;
+}
+
+static void bench_compress_one(const char *label, const uint8_t *data,
+                               size_t len, int iters) {
+    message_t *msg = message_create(actor_id_make(3, 42), actor_id_make(1, 7),
+                                    300, data, len);
+    size_t plain_size, z_size = 0;
+    free(wire_serialize_v2(msg, &plain_size));
+
+    double start = now_sec();
+    void *z = NULL;
+    for (int i = 0; i < iters; i++) {
+        free(z);
+        z = wire_serialize_v2_compressed(msg, WIRE_COMPRESS_THRESHOLD, &z_size);
+    }
+    double enc = now_sec() - start;
+
+    start = now_sec();
+    for (int i = 0; i < iters; i++)
+        message_destroy(wire_deserialize_v2(z, z_size));
+    double dec = now_sec() - start;
+
+    double mb = (double)len * iters / 1e6;
+    printf("  %-12s %7zu -> %7zu bytes (%5.1f%% saved), "
+           "compress %6.0f MB/s, inflate %6.0f MB/s\n",
+           label, plain_size, z_size,
+           100.0 * (double)(plain_size - z_size) / (double)plain_size,
+           mb / enc, mb / dec);
+
+    free(z);
+    message_destroy(msg);
+}
+
+static void bench_compression(void) {
+    static uint8_t buf[256 * 1024];
+    size_t sizes[] = {2048, 16 * 1024, 256 * 1024};
+    char label[32];
+
+    for (size_t i = 0; i < 3; i++) {
+        size_t n = fill_json((char *)buf, sizes[i]);
+        snprintf(label, sizeof(label), "json %zuK", sizes[i] / 1024);
+        bench_compress_one(label, buf, n, (int)(20000000 / sizes[i]) + 1);
+    }
+    for (size_t i = 0; i < 3; i++) {
+        size_t n = fill_binary(buf, sizes[i]);
+        snprintf(label, sizeof(label), "binary %zuK", sizes[i] / 1024);
+        bench_compress_one(label, buf, n, (int)(20000000 / sizes[i]) + 1);
+    }
+}
+
+/* ── Transport throughput over a socketpair ───────────────────────── */
+
+static void bench_transport(uint8_t version, const sample_t *s, int count) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        perror("socketpair");
+        return;
+    }
+    transport_t *tx = transport_tcp_from_fd(sv[0], 2);
+    transport_t *rx = transport_tcp_from_fd(sv[1], 1);
+    transport_tcp_set_wire_version(tx, version);
+    transport_tcp_set_wire_version(rx, version);
+
+    message_t *msg = make_sample(s);
+    int sent = 0, received = 0;
+    size_t frame_size;
+    free(version >= WIRE_VERSION_2 ? wire_serialize_v2(msg, &frame_size)
+                                   : wire_serialize_net(msg, &frame_size));
+
+    /* Small batches keep blocking sends under the socket buffer size */
+    double start = now_sec();
+    while (received < count) {
+        for (int b = 0; b < 8 && sent < count; b++, sent++)
+            tx->send(tx, msg);
+        message_t *in;
+        while ((in = rx->recv(rx)) != NULL) {
+            message_destroy(in);
+            received++;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    printf("  v%u %-10s %.0f msg/s, %.1f MB/s on the wire\n",
+           version, s->label, (double)count / elapsed,
+           (double)count * (double)frame_size / elapsed / 1e6);
+
+    message_destroy(msg);
+    tx->destroy(tx);
+    rx->destroy(rx);
+}
+
+int main(void) {
+    printf("=== Wire protocol benchmark ===\n\n");
+
+    printf("Encoded size (bytes):\n");
+    bench_sizes();
+
+    printf("\nSerialize + deserialize (midi):\n");
+    message_t *midi = make_sample(&samples[1]);
+    bench_codec("v1", wire_serialize_net, wire_deserialize_net, midi, 1000000);
+    bench_codec("v2", wire_serialize_v2, wire_deserialize_v2, midi, 1000000);
+    message_destroy(midi);
+
+    printf("\nPayload compression (v2, threshold %d):\n",
+           WIRE_COMPRESS_THRESHOLD);
+    bench_compression();
+
+    printf("\nTransport throughput (socketpair):\n");
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        bench_transport(WIRE_VERSION_1, &samples[i], 200000);
+        bench_transport(WIRE_VERSION_2, &samples[i], 200000);
+    }
+
+    return 0;
+}
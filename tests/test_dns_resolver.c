@@ -0,0 +1,127 @@
+#define _GNU_SOURCE
+#include "test_framework.h"
+#include "dns_resolver.h"
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#define MISSING_HOST "no-such-host.invalid"   /* RFC 6761: never resolves */
+
+/* Wait for the resolver thread and collect what it finished */
+static bool wait_collect(dns_resolver_t *r) {
+    for (int i = 0; i < 50; i++) {
+        struct pollfd pfd = { .fd = dns_resolver_fd(r), .events = POLLIN };
+        if (pfd.fd < 0) return false;
+        poll(&pfd, 1, 100);
+        if (dns_collect(r)) return true;
+    }
+    return false;
+}
+
+static int test_dns_numeric(void) {
+    dns_resolver_t *r = dns_resolver_create(4, 60000, 5000);
+    ASSERT_NOT_NULL(r);
+    dns_result_t res;
+
+    ASSERT_EQ(dns_lookup(r, "127.0.0.1", 8080, &res), DNS_DONE);
+    ASSERT_EQ(res.count, 1);
+    ASSERT_EQ(res.addrs[0].addr.sa.sa_family, AF_INET);
+    ASSERT_EQ(ntohs(res.addrs[0].addr.in.sin_port), 8080);
+
+    ASSERT_EQ(dns_lookup(r, "::1", 443, &res), DNS_DONE);
+    ASSERT_EQ(res.addrs[0].addr.sa.sa_family, AF_INET6);
+    ASSERT_EQ(ntohs(res.addrs[0].addr.in6.sin6_port), 443);
+
+    /* Nothing was queued */
+    ASSERT_EQ(dns_resolver_fd(r), -1);
+    dns_resolver_destroy(r);
+    return 0;
+}
+
+static int test_dns_cached(void) {
+    dns_resolver_t *r = dns_resolver_create(4, 60000, 5000);
+    dns_result_t res;
+
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_PENDING);
+    ASSERT(dns_resolver_fd(r) >= 0);
+    /* A second ask joins the lookup in flight */
+    ASSERT_EQ(dns_lookup(r, "localhost", 81, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    ASSERT_EQ(dns_resolver_fd(r), -1);
+
+    /* Answered from the cache, with each caller's port */
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_DONE);
+    ASSERT(res.count >= 1);
+    for (size_t i = 0; i < res.count; i++) {
+        const dns_addr_t *a = &res.addrs[i];
+        uint16_t port = a->addr.sa.sa_family == AF_INET6 ?
+                        a->addr.in6.sin6_port : a->addr.in.sin_port;
+        ASSERT_EQ(ntohs(port), 80);
+    }
+    ASSERT_EQ(dns_lookup(r, "localhost", 81, &res), DNS_DONE);
+    ASSERT_EQ(dns_resolver_fd(r), -1);
+    dns_resolver_destroy(r);
+    return 0;
+}
+
+static int test_dns_failed(void) {
+    dns_resolver_t *r = dns_resolver_create(4, 60000, 5000);
+    dns_result_t res;
+
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    /* The failure is cached too */
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_FAILED);
+    ASSERT_EQ(dns_resolver_fd(r), -1);
+
+    ASSERT_EQ(dns_lookup(r, "", 80, &res), DNS_FAILED);
+    dns_resolver_destroy(r);
+    return 0;
+}
+
+static int test_dns_expiry(void) {
+    dns_resolver_t *r = dns_resolver_create(1, 50, 50);
+    dns_result_t res;
+
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_DONE);
+
+    /* Past the TTL the host is looked up again */
+    usleep(100000);
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_DONE);
+
+    /* A full cache gives up its least recently used answer */
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_PENDING);
+    /* ... but never a lookup in flight: the next host waits its turn */
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_PENDING);
+    ASSERT(wait_collect(r));
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_FAILED);
+    dns_resolver_destroy(r);
+    return 0;
+}
+
+static int test_dns_destroy_pending(void) {
+    dns_resolver_t *r = dns_resolver_create(4, 60000, 5000);
+    dns_result_t res;
+    ASSERT_EQ(dns_lookup(r, "localhost", 80, &res), DNS_PENDING);
+    ASSERT_EQ(dns_lookup(r, MISSING_HOST, 80, &res), DNS_PENDING);
+    dns_resolver_destroy(r);   /* joins the thread, frees the jobs */
+    return 0;
+}
+
+int main(void) {
+    printf("test_dns_resolver:\n");
+    RUN_TEST(test_dns_numeric);
+    RUN_TEST(test_dns_cached);
+    RUN_TEST(test_dns_failed);
+    RUN_TEST(test_dns_expiry);
+    RUN_TEST(test_dns_destroy_pending);
+    TEST_REPORT();
+}
@@ -0,0 +1,303 @@
+#define _GNU_SOURCE
+#include "test_framework.h"
+#include "microkernel/runtime.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include "microkernel/file_server.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define TEST_PORT 19919
+#define BIG_SIZE  (8 * 1024 * 1024)   /* more than loopback buffers */
+
+static char root[64];
+
+/* ── Fixture ───────────────────────────────────────────────────────── */
+
+static void write_file(const char *name, const void *data, size_t size) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    FILE *f = fopen(path, "wb");
+    fwrite(data, 1, size, f);
+    fclose(f);
+}
+
+static void make_root(void) {
+    snprintf(root, sizeof(root), "/tmp/mk_fs_test_%d", (int)getpid());
+    mkdir(root, 0755);
+    char sub[96];
+    snprintf(sub, sizeof(sub), "%s/sub", root);
+    mkdir(sub, 0755);
+
+    write_file("index.html", "<h1>hi</h1>", 11);
+    write_file("sub/index.html", "sub", 3);
+    uint8_t *big = malloc(BIG_SIZE);
+    for (size_t i = 0; i < BIG_SIZE; i++) big[i] = (uint8_t)(i % 251);
+    write_file("big.bin", big, BIG_SIZE);
+    free(big);
+}
+
+static void remove_root(void) {
+    char cmd[96];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", root);
+    if (system(cmd) != 0) fprintf(stderr, "could not remove %s\n", root);
+}
+
+/* ── Client helpers ────────────────────────────────────────────────── */
+
+static int connect_retry(uint16_t port, int max_retries) {
+    for (int i = 0; i < max_retries; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = inet_addr("127.0.0.1")
+        };
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+            return fd;
+        close(fd);
+        usleep(20000);
+    }
+    return -1;
+}
+
+typedef struct {
+    int  status;
+    long length;
+    char etag[64];
+    char range[80];
+    char type[64];
+} resp_t;
+
+static void request(int fd, const char *method, const char *path,
+                    const char *extra) {
+    char req[512];
+    int n = snprintf(req, sizeof(req),
+                     "%s %s HTTP/1.1\r\nHost: localhost\r\n%s\r\n",
+                     method, path, extra ? extra : "");
+    send(fd, req, (size_t)n, 0);
+}
+
+static void header_value(const char *line, size_t name_len, char *out,
+                         size_t cap) {
+    const char *v = line + name_len;
+    while (*v == ' ') v++;
+    snprintf(out, cap, "%.*s", (int)strcspn(v, "\r\n"), v);
+}
+
+static bool read_head(FILE *in, resp_t *r) {
+    char line[256];
+    memset(r, 0, sizeof(*r));
+    r->length = -1;
+    if (!fgets(line, sizeof(line), in) ||
+        sscanf(line, "HTTP/1.1 %d", &r->status) != 1)
+        return false;
+    while (fgets(line, sizeof(line), in) && strcmp(line, "\r\n") != 0) {
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+            r->length = atol(line + 15);
+        else if (strncasecmp(line, "ETag:", 5) == 0)
+            header_value(line, 5, r->etag, sizeof(r->etag));
+        else if (strncasecmp(line, "Content-Range:", 14) == 0)
+            header_value(line, 14, r->range, sizeof(r->range));
+        else if (strncasecmp(line, "Content-Type:", 13) == 0)
+            header_value(line, 13, r->type, sizeof(r->type));
+    }
+    return true;
+}
+
+/* Body matches big.bin from offset */
+static bool read_big(FILE *in, long len, long offset) {
+    for (long i = 0; i < len; i++) {
+        int c = fgetc(in);
+        if (c == EOF || (uint8_t)c != (uint8_t)((offset + i) % 251))
+            return false;
+    }
+    return true;
+}
+
+static bool read_text(FILE *in, long len, const char *want) {
+    char buf[64];
+    if (len < 0 || (size_t)len >= sizeof(buf)) return false;
+    if (fread(buf, 1, (size_t)len, in) != (size_t)len) return false;
+    buf[len] = '\0';
+    return strcmp(buf, want) == 0;
+}
+
+/* ── Server side: run until the client exits ──────────────────────── */
+
+typedef struct {
+    pid_t client;
+    int   status;
+} watch_state_t;
+
+static bool watch_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
+                           message_t *msg, void *state) {
+    watch_state_t *w = state;
+    if (msg->type == 0) {
+        actor_set_timer(rt, 20, true);
+    } else if (msg->type == MSG_TIMER &&
+               waitpid(w->client, &w->status, WNOHANG) == w->client) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+/* Serve root until the client exits; its exit code */
+static int serve(pid_t client) {
+    runtime_t *rt = runtime_init(1, 16);
+    file_server_config_t config = { .port = TEST_PORT };
+    snprintf(config.root, sizeof(config.root), "%s", root);
+    file_server_init(rt, &config);
+
+    watch_state_t w = { .client = client, .status = -1 };
+    actor_id_t aid = actor_spawn(rt, watch_behavior, &w, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+
+    if (!WIFEXITED(w.status)) return -1;
+    return WEXITSTATUS(w.status);
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────── */
+
+static int test_file_server_get(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(TEST_PORT, 50);
+        if (fd < 0) _exit(1);
+        FILE *in = fdopen(dup(fd), "r");
+        resp_t r;
+
+        request(fd, "GET", "/", NULL);
+        if (!read_head(in, &r) || r.status != 200) _exit(2);
+        if (strncmp(r.type, "text/html", 9) != 0 || !r.etag[0]) _exit(3);
+        if (!read_text(in, r.length, "<h1>hi</h1>")) _exit(4);
+
+        /* Big file, read late so the sends hit a full socket */
+        request(fd, "GET", "/big.bin", NULL);
+        usleep(100000);
+        if (!read_head(in, &r) || r.status != 200) _exit(5);
+        if (r.length != BIG_SIZE || !read_big(in, r.length, 0)) _exit(6);
+        char etag[64];
+        snprintf(etag, sizeof(etag), "%s", r.etag);
+
+        char extra[128];
+        snprintf(extra, sizeof(extra), "If-None-Match: %s\r\n", etag);
+        request(fd, "GET", "/big.bin", extra);
+        if (!read_head(in, &r) || r.status != 304) _exit(7);
+        if (strcmp(r.etag, etag) != 0 || r.length > 0) _exit(8);
+
+        /* HEAD: the length, no body, so the next reply follows at once */
+        request(fd, "HEAD", "/big.bin", NULL);
+        if (!read_head(in, &r) || r.status != 200 || r.length != BIG_SIZE)
+            _exit(9);
+        request(fd, "GET", "/sub/", NULL);
+        if (!read_head(in, &r) || r.status != 200) _exit(10);
+        if (!read_text(in, r.length, "sub")) _exit(11);
+        request(fd, "GET", "/sub", NULL);
+        if (!read_head(in, &r) || r.status != 200) _exit(12);
+        if (!read_text(in, r.length, "sub")) _exit(13);
+
+        request(fd, "GET", "/missing.txt", NULL);
+        if (!read_head(in, &r) || r.status != 404) _exit(14);
+        if (!read_text(in, r.length, "404\n")) _exit(15);
+        request(fd, "GET", "/sub/../../etc/passwd", NULL);
+        if (!read_head(in, &r) || r.status != 400) _exit(16);
+        if (!read_text(in, r.length, "400\n")) _exit(17);
+        request(fd, "GET", "/%2e%2e/etc/passwd", NULL);
+        if (!read_head(in, &r) || r.status != 400) _exit(18);
+        if (!read_text(in, r.length, "400\n")) _exit(19);
+        request(fd, "DELETE", "/index.html", NULL);
+        if (!read_head(in, &r) || r.status != 405 || r.length != 0) _exit(20);
+
+        /* A changed file is reopened, under a new ETag */
+        char old_etag[64];
+        request(fd, "GET", "/index.html", NULL);
+        if (!read_head(in, &r) || !read_text(in, r.length, "<h1>hi</h1>"))
+            _exit(21);
+        snprintf(old_etag, sizeof(old_etag), "%s", r.etag);
+        write_file("index.html", "<h1>changed</h1>", 16);
+        request(fd, "GET", "/index.html", NULL);
+        if (!read_head(in, &r) || r.status != 200) _exit(22);
+        if (!read_text(in, r.length, "<h1>changed</h1>")) _exit(23);
+        if (strcmp(r.etag, old_etag) == 0) _exit(24);
+
+        fclose(in);
+        close(fd);
+        _exit(0);
+    }
+
+    ASSERT_EQ(serve(pid), 0);
+    return 0;
+}
+
+static int test_file_server_range(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(TEST_PORT, 50);
+        if (fd < 0) _exit(1);
+        FILE *in = fdopen(dup(fd), "r");
+        resp_t r;
+
+        request(fd, "GET", "/big.bin", "Range: bytes=1000-1999\r\n");
+        if (!read_head(in, &r) || r.status != 206) _exit(2);
+        if (strcmp(r.range, "bytes 1000-1999/8388608") != 0) _exit(3);
+        if (r.length != 1000 || !read_big(in, r.length, 1000)) _exit(4);
+
+        request(fd, "GET", "/big.bin", "Range: bytes=-10\r\n");
+        if (!read_head(in, &r) || r.status != 206) _exit(5);
+        if (strcmp(r.range, "bytes 8388598-8388607/8388608") != 0) _exit(6);
+        if (r.length != 10 || !read_big(in, r.length, BIG_SIZE - 10)) _exit(7);
+
+        /* Open-ended, and a last byte past the end, both run to the end */
+        request(fd, "GET", "/big.bin", "Range: bytes=8388000-\r\n");
+        if (!read_head(in, &r) || r.status != 206) _exit(8);
+        if (r.length != 608 || !read_big(in, r.length, 8388000)) _exit(9);
+        request(fd, "GET", "/big.bin", "Range: bytes=8388500-99999999\r\n");
+        if (!read_head(in, &r) || r.status != 206) _exit(10);
+        if (r.length != 108 || !read_big(in, r.length, 8388500)) _exit(11);
+
+        request(fd, "GET", "/big.bin", "Range: bytes=9000000-\r\n");
+        if (!read_head(in, &r) || r.status != 416) _exit(12);
+        if (strcmp(r.range, "bytes */8388608") != 0 || r.length != 0)
+            _exit(13);
+
+        /* Several ranges, or a stale If-Range: the whole file */
+        request(fd, "HEAD", "/big.bin", "Range: bytes=0-1,5-6\r\n");
+        if (!read_head(in, &r) || r.status != 200 || r.length != BIG_SIZE)
+            _exit(14);
+        request(fd, "HEAD", "/big.bin",
+                "Range: bytes=0-1\r\nIf-Range: \"stale\"\r\n");
+        if (!read_head(in, &r) || r.status != 200 || r.length != BIG_SIZE)
+            _exit(15);
+
+        fclose(in);
+        close(fd);
+        _exit(0);
+    }
+
+    ASSERT_EQ(serve(pid), 0);
+    return 0;
+}
+
+int main(void) {
+    signal(SIGPIPE, SIG_IGN);
+    printf("test_file_server:\n");
+    make_root();
+    RUN_TEST(test_file_server_get);
+    RUN_TEST(test_file_server_range);
+    remove_root();
+    TEST_REPORT();
+}
@@ -0,0 +1,256 @@
+#define _DEFAULT_SOURCE
+#include "test_framework.h"
+#include "microkernel/runtime.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include <sys/socket.h>
+
+#define NODE_A 1
+#define NODE_B 2
+#define NODE_C 3
+#define MSG_DATA 200
+#define MSG_INIT 202
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    if (msg->type == MSG_INIT) {
+        actor_set_timer(rt, *(int *)state, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_runtime(runtime_t *rt, int ms) {
+    actor_id_t id = actor_spawn(rt, stopper_behavior, &ms, NULL, 4);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    runtime_run(rt);
+}
+
+static void pump_all(runtime_t **rts, size_t n, int rounds) {
+    for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < n; i++) pump_runtime(rts[i], 5);
+}
+
+/* In-process link between rts[a] (node a + 1) and rts[b] over a socketpair */
+static bool link_nodes(runtime_t **rts, size_t a, size_t b) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return false;
+    transport_t *ta = transport_tcp_from_fd(sv[0], (node_id_t)(b + 1));
+    transport_t *tb = transport_tcp_from_fd(sv[1], (node_id_t)(a + 1));
+    return ta && tb && runtime_add_transport(rts[a], ta) &&
+           runtime_add_transport(rts[b], tb);
+}
+
+/* ── Producer / consumer ───────────────────────────────────────────── */
+
+typedef struct {
+    actor_id_t dest;
+    uint32_t   total;
+    uint32_t   sent;
+    int        refused;
+    int        readies;
+    uint32_t   credit_when_refused;
+} producer_t;
+
+static bool producer_behavior(runtime_t *rt, actor_t *self,
+                              message_t *msg, void *state) {
+    (void)self;
+    producer_t *p = state;
+    if (msg->type == MSG_SEND_READY) p->readies++;
+    else if (msg->type != MSG_INIT) return true;
+
+    while (p->sent < p->total) {
+        if (!actor_send(rt, p->dest, MSG_DATA, &p->sent, sizeof(p->sent))) {
+            p->refused++;
+            p->credit_when_refused = actor_send_credit(rt, p->dest);
+            break;
+        }
+        p->sent++;
+    }
+    return true;
+}
+
+typedef struct {
+    uint32_t received;
+    bool     in_order;
+} consumer_t;
+
+static bool consumer_behavior(runtime_t *rt, actor_t *self,
+                              message_t *msg, void *state) {
+    (void)rt; (void)self;
+    consumer_t *c = state;
+    if (msg->type != MSG_DATA) return true;
+    uint32_t seq;
+    memcpy(&seq, msg->payload, sizeof(seq));
+    if (seq != c->received) c->in_order = false;
+    c->received++;
+    return true;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────── */
+
+static int test_window_refuses_then_wakes(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    runtime_set_flow_window(rts[0], 8);
+    ASSERT(link_nodes(rts, 0, 1));
+
+    consumer_t c = { 0, true };
+    actor_id_t cons = actor_spawn(rts[1], consumer_behavior, &c, NULL, 64);
+    producer_t p = { .dest = cons, .total = 20 };
+    actor_id_t prod = actor_spawn(rts[0], producer_behavior, &p, NULL, 16);
+
+    /* B does not run: A stops at the window instead of flooding it */
+    actor_send(rts[0], prod, MSG_INIT, NULL, 0);
+    pump_runtime(rts[0], 10);
+    ASSERT_EQ(p.sent, 8u);
+    ASSERT_EQ(p.refused, 1);
+    ASSERT_EQ(p.credit_when_refused, 0u);
+
+    /* B consumes and returns credit; A's producer is woken and finishes */
+    pump_all(rts, 2, 10);
+    ASSERT(p.readies >= 1);
+    ASSERT_EQ(p.sent, 20u);
+    ASSERT_EQ(c.received, 20u);
+    ASSERT(c.in_order);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_small_mailbox_loses_nothing(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    runtime_set_flow_window(rts[0], 8);
+    ASSERT(link_nodes(rts, 0, 1));
+
+    consumer_t c = { 0, true };
+    actor_id_t cons = actor_spawn(rts[1], consumer_behavior, &c, NULL, 8);
+    producer_t p = { .dest = cons, .total = 500 };
+    actor_id_t prod = actor_spawn(rts[0], producer_behavior, &p, NULL, 16);
+    actor_send(rts[0], prod, MSG_INIT, NULL, 0);
+
+    for (int i = 0; i < 200 && c.received < p.total; i++)
+        pump_all(rts, 2, 1);
+    ASSERT_EQ(c.received, 500u);
+    ASSERT(c.in_order);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_credit_crosses_gateway(void) {
+    runtime_t *rts[3] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256),
+                          runtime_init(NODE_C, 256) };
+    runtime_set_flow_window(rts[0], 4);
+    ASSERT(link_nodes(rts, 0, 1));
+    ASSERT(link_nodes(rts, 1, 2));
+    pump_all(rts, 3, 6);
+
+    consumer_t c = { 0, true };
+    actor_id_t cons = actor_spawn(rts[2], consumer_behavior, &c, NULL, 4);
+    producer_t p = { .dest = cons, .total = 100 };
+    actor_id_t prod = actor_spawn(rts[0], producer_behavior, &p, NULL, 16);
+    actor_send(rts[0], prod, MSG_INIT, NULL, 0);
+
+    for (int i = 0; i < 200 && c.received < p.total; i++)
+        pump_all(rts, 3, 1);
+    ASSERT_EQ(c.received, 100u);
+    ASSERT(c.in_order);
+
+    for (int i = 0; i < 3; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+static int test_window_off_sends_freely(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    /* Off by default: nothing is negotiated with the peer */
+    ASSERT(link_nodes(rts, 0, 1));
+
+    consumer_t c = { 0, true };
+    actor_id_t cons = actor_spawn(rts[1], consumer_behavior, &c, NULL, 8);
+    producer_t p = { .dest = cons, .total = 100 };
+    actor_id_t prod = actor_spawn(rts[0], producer_behavior, &p, NULL, 16);
+    actor_send(rts[0], prod, MSG_INIT, NULL, 0);
+    pump_runtime(rts[0], 10);
+    ASSERT_EQ(p.sent, 100u);
+    ASSERT_EQ(p.refused, 0);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+/* Count MSG_FLOW_CREDIT that B has sent down the raw end of its link */
+static int credits_from(runtime_t *b, transport_t *peer) {
+    pump_runtime(b, 10);
+    int credits = 0;
+    message_t *msg;
+    while ((msg = peer->recv(peer)) != NULL) {
+        if (msg->type == MSG_FLOW_CREDIT) credits++;
+        message_destroy(msg);
+    }
+    return credits;
+}
+
+static int test_credit_only_when_metered(void) {
+    runtime_t *b = runtime_init(NODE_B, 256);
+    runtime_set_heartbeat(b, 0, 0);
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    ASSERT(runtime_add_transport(b, transport_tcp_from_fd(sv[1], NODE_A)));
+    transport_t *a = transport_tcp_from_fd(sv[0], NODE_B);   /* node A */
+
+    consumer_t c = { 0, true };
+    actor_id_t cons = actor_spawn(b, consumer_behavior, &c, NULL, 64);
+    actor_id_t sender = actor_id_make(NODE_A, 1);
+    uint32_t seq = 0;
+    message_t *msg;
+
+    /* A never said it meters: B keeps and returns no credit */
+    for (; seq < 4; seq++) {
+        msg = message_create(sender, cons, MSG_DATA, &seq, sizeof(seq));
+        ASSERT(a->send(a, msg));
+        message_destroy(msg);
+    }
+    ASSERT_EQ(credits_from(b, a), 0);
+    ASSERT_EQ(c.received, 4u);
+
+    /* Once announced, consumed messages are credited */
+    uint32_t window = 8;
+    msg = message_create(actor_id_make(NODE_A, 0), actor_id_make(NODE_B, 0),
+                         MSG_FLOW_METER, &window, sizeof(window));
+    ASSERT(a->send(a, msg));
+    message_destroy(msg);
+    msg = message_create(sender, cons, MSG_DATA, &seq, sizeof(seq));
+    ASSERT(a->send(a, msg));
+    message_destroy(msg);
+    ASSERT_EQ(credits_from(b, a), 1);
+
+    a->destroy(a);
+    runtime_destroy(b);
+    return 0;
+}
+
+int main(void) {
+    printf("test_flow_control:\n");
+    RUN_TEST(test_window_refuses_then_wakes);
+    RUN_TEST(test_small_mailbox_loses_nothing);
+    RUN_TEST(test_credit_crosses_gateway);
+    RUN_TEST(test_window_off_sends_freely);
+    RUN_TEST(test_credit_only_when_metered);
+    TEST_REPORT();
+}
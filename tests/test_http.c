@@ -13,6 +13,10 @@
 #include <errno.h>
 
 #define TEST_PORT 19880
+#define POOL_PORT 19912
+#define STREAM_PORT 19916
+#define CLOSED_PORT 19921       /* nothing listens here */
+#define STREAM_SIZE (4 * 1024 * 1024)
 
 /* ── Test HTTP server ──────────────────────────────────────────────── */
 
@@ -120,6 +124,84 @@ static pid_t start_http_server(http_scenario_t scenario) {
     _exit(0);
 }
 
+/* Keep-alive server: answers requests on each connection until it has
+   served `requests` in all.  With drop_second it reads the second request
+   on the first connection and closes without answering, as a server
+   timing out an idle connection would.  Exits with the accept count. */
+static pid_t start_pool_server(int requests, bool drop_second) {
+    pid_t pid = fork();
+    if (pid != 0) { usleep(50000); return pid; }
+
+    int lfd = listen_tcp(POOL_PORT);
+    int accepts = 0, served = 0;
+    while (served < requests) {
+        int cfd = accept(lfd, NULL, NULL);
+        if (cfd < 0) _exit(100);
+        accepts++;
+        while (served < requests) {
+            char req[4096];
+            req[0] = '\0';
+            read_request(cfd, req, sizeof(req));
+            if (!strstr(req, "\r\n\r\n")) break;   /* client closed */
+            if (drop_second && accepts == 1 && served == 1) break;
+
+            char resp[128];
+            int n = snprintf(resp, sizeof(resp),
+                             "HTTP/1.1 200 OK\r\n"
+                             "Content-Length: 2\r\n"
+                             "\r\n"
+                             "r%d", served);
+            send(cfd, resp, (size_t)n, 0);
+            served++;
+        }
+        close(cfd);
+    }
+    close(lfd);
+    _exit(accepts);
+}
+
+/* Serves STREAM_SIZE bytes of a known pattern, with Content-Length or
+   in small chunks, many to a read */
+static pid_t start_stream_server(bool chunked) {
+    pid_t pid = fork();
+    if (pid != 0) { usleep(50000); return pid; }
+
+    int lfd = listen_tcp(STREAM_PORT);
+    int cfd = accept(lfd, NULL, NULL);
+    if (cfd < 0) _exit(1);
+
+    char req[4096];
+    read_request(cfd, req, sizeof(req));
+
+    char head[128];
+    int n = chunked ?
+        snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\n"
+                 "Transfer-Encoding: chunked\r\n\r\n") :
+        snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\n"
+                 "Content-Length: %d\r\n\r\n", STREAM_SIZE);
+    send(cfd, head, (size_t)n, 0);
+
+    static char block[10000];
+    size_t step = chunked ? 1000 : sizeof(block);
+    for (size_t off = 0; off < STREAM_SIZE; ) {
+        size_t len = STREAM_SIZE - off < step ? STREAM_SIZE - off : step;
+        for (size_t i = 0; i < len; i++)
+            block[i] = (char)((off + i) % 251);
+        if (chunked) {
+            n = snprintf(head, sizeof(head), "%zx\r\n", len);
+            send(cfd, head, (size_t)n, 0);
+        }
+        if (send(cfd, block, len, 0) != (ssize_t)len) _exit(2);
+        if (chunked) send(cfd, "\r\n", 2, 0);
+        off += len;
+    }
+    if (chunked) send(cfd, "0\r\n\r\n", 5, 0);
+
+    close(cfd);
+    close(lfd);
+    _exit(0);
+}
+
 /* ── Actor test infrastructure ─────────────────────────────────────── */
 
 typedef struct {
@@ -128,8 +210,11 @@ typedef struct {
     size_t body_size;
     char headers[512];
     size_t headers_size;
+    char custom[32];          /* X-Custom, looked up by index */
     bool got_response;
     bool got_error;
+    char error[128];
+    bool failed_at_once;      /* the fetch call itself failed */
     char url[128];
     const char *method;
     const char *post_body;
@@ -142,11 +227,17 @@ static bool http_test_behavior(runtime_t *rt, actor_t *self __attribute__((unuse
 
     if (msg->type == 0) {
         /* Init message: start the HTTP request */
+        http_conn_id_t id;
         if (s->method && strcmp(s->method, "POST") == 0) {
-            actor_http_fetch(rt, "POST", s->url, NULL, 0,
-                             s->post_body, s->post_body_size);
+            id = actor_http_fetch(rt, "POST", s->url, NULL, 0,
+                                  s->post_body, s->post_body_size);
         } else {
-            actor_http_get(rt, s->url);
+            id = actor_http_get(rt, s->url);
+        }
+        if (id == HTTP_CONN_ID_INVALID) {
+            s->failed_at_once = true;
+            runtime_stop(rt);
+            return false;
         }
         return true;
     }
@@ -157,6 +248,8 @@ static bool http_test_behavior(runtime_t *rt, actor_t *self __attribute__((unuse
         s->headers_size = p->headers_size < sizeof(s->headers) ?
                           p->headers_size : sizeof(s->headers) - 1;
         memcpy(s->headers, http_response_headers(p), s->headers_size);
+        const char *custom = http_response_header(p, "X-CUSTOM");
+        snprintf(s->custom, sizeof(s->custom), "%s", custom ? custom : "");
 
         s->body_size = p->body_size < sizeof(s->body) ?
                        p->body_size : sizeof(s->body) - 1;
@@ -169,7 +262,9 @@ static bool http_test_behavior(runtime_t *rt, actor_t *self __attribute__((unuse
     }
 
     if (msg->type == MSG_HTTP_ERROR) {
+        const http_error_payload_t *p = msg->payload;
         s->got_error = true;
+        snprintf(s->error, sizeof(s->error), "%s", p->message);
         runtime_stop(rt);
         return false;
     }
@@ -189,6 +284,135 @@ static bool find_in_headers(const char *headers, size_t size, const char *needle
     return false;
 }
 
+/* Sequential GETs: each response triggers the next fetch */
+typedef struct {
+    char url[128];
+    int target;
+    int responses;
+    int errors;
+    char last_body[8];
+} pool_test_state_t;
+
+static bool pool_test_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
+                               message_t *msg, void *state) {
+    pool_test_state_t *s = state;
+
+    if (msg->type == MSG_HTTP_RESPONSE) {
+        const http_response_payload_t *p = msg->payload;
+        size_t n = p->body_size < sizeof(s->last_body) - 1 ?
+                   p->body_size : sizeof(s->last_body) - 1;
+        memcpy(s->last_body, http_response_body(p), n);
+        s->last_body[n] = '\0';
+        actor_http_close(rt, p->conn_id);
+        s->responses++;
+    } else if (msg->type == MSG_HTTP_ERROR) {
+        s->errors++;
+        runtime_stop(rt);
+        return false;
+    } else if (msg->type != 0) {
+        return true;
+    }
+
+    if (s->responses >= s->target) {
+        runtime_stop(rt);
+        return false;
+    }
+    actor_http_get(rt, s->url);
+    return true;
+}
+
+/* Streamed GET that acks in half-window batches */
+typedef struct {
+    char url[128];
+    size_t window;
+    int status_code;
+    bool got_head;
+    bool chunk_before_head;
+    bool got_final;
+    bool got_error;
+    bool bad_byte;
+    size_t received;
+    size_t unacked;
+    size_t max_unacked;
+} stream_test_state_t;
+
+static bool stream_test_behavior(runtime_t *rt,
+                                 actor_t *self __attribute__((unused)),
+                                 message_t *msg, void *state) {
+    stream_test_state_t *s = state;
+
+    if (msg->type == 0) {
+        actor_http_fetch_stream(rt, "GET", s->url, NULL, 0, NULL, 0,
+                                s->window);
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_RESPONSE_HEAD) {
+        const http_response_payload_t *p = msg->payload;
+        s->status_code = p->status_code;
+        s->got_head = true;
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_BODY_CHUNK) {
+        const http_body_chunk_payload_t *p = msg->payload;
+        const uint8_t *data = http_body_chunk_data(p);
+        if (!s->got_head) s->chunk_before_head = true;
+        for (size_t i = 0; i < p->size; i++)
+            if (data[i] != (s->received + i) % 251) s->bad_byte = true;
+        s->received += p->size;
+        s->unacked += p->size;
+        if (s->unacked > s->max_unacked) s->max_unacked = s->unacked;
+        if (s->unacked >= s->window / 2) {
+            actor_http_body_ack(rt, p->conn_id, s->unacked);
+            s->unacked = 0;
+        }
+        if (p->final) {
+            s->got_final = true;
+            runtime_stop(rt);
+            return false;
+        }
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_ERROR || msg->type == MSG_HTTP_RESPONSE) {
+        s->got_error = true;
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static int run_stream_client(stream_test_state_t *state, size_t window,
+                             size_t mailbox) {
+    runtime_t *rt = runtime_init(1, 16);
+    memset(state, 0, sizeof(*state));
+    snprintf(state->url, sizeof(state->url),
+             "http://127.0.0.1:%d/stream", STREAM_PORT);
+    state->window = window;
+
+    actor_id_t aid = actor_spawn(rt, stream_test_behavior, state, NULL,
+                                 mailbox);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int run_pool_client(pool_test_state_t *state, int target) {
+    runtime_t *rt = runtime_init(1, 16);
+    memset(state, 0, sizeof(*state));
+    snprintf(state->url, sizeof(state->url),
+             "http://127.0.0.1:%d/pool", POOL_PORT);
+    state->target = target;
+
+    actor_id_t aid = actor_spawn(rt, pool_test_behavior, state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+    return state->responses;
+}
+
 /* ── Tests ─────────────────────────────────────────────────────────── */
 
 static int test_http_get_200(void) {
@@ -304,12 +528,138 @@ static int test_http_headers(void) {
     ASSERT(state.headers_size > 0);
     /* Headers are packed as "Key: Value\0Key: Value\0..." */
     ASSERT(find_in_headers(state.headers, state.headers_size, "X-Custom: foo"));
+    ASSERT(strcmp(state.custom, "foo") == 0);
 
     runtime_destroy(rt);
     waitpid(server, NULL, 0);
     return 0;
 }
 
+/* By name: looked up on the resolver thread, then connected without
+   blocking (and past ::1 if localhost lists it, as nothing listens there) */
+static int test_http_hostname(void) {
+    pid_t server = start_http_server(SCENARIO_200_CONTENT_LENGTH);
+
+    runtime_t *rt = runtime_init(1, 16);
+    http_test_state_t state;
+    memset(&state, 0, sizeof(state));
+    snprintf(state.url, sizeof(state.url),
+             "http://localhost:%d/test", TEST_PORT);
+
+    actor_id_t aid = actor_spawn(rt, http_test_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+
+    ASSERT(state.got_response);
+    ASSERT_EQ(state.status_code, 200);
+    ASSERT(memcmp(state.body, "hello", 5) == 0);
+
+    runtime_destroy(rt);
+    waitpid(server, NULL, 0);
+    return 0;
+}
+
+/* Neither failure blocks the fetch call: both arrive as MSG_HTTP_ERROR */
+static int test_http_connect_errors(void) {
+    runtime_t *rt = runtime_init(1, 16);
+    http_test_state_t state;
+    memset(&state, 0, sizeof(state));
+    snprintf(state.url, sizeof(state.url), "http://no-such-host.invalid/");
+    actor_id_t aid = actor_spawn(rt, http_test_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+
+    ASSERT(!state.failed_at_once);
+    ASSERT(state.got_error);
+    ASSERT(strcmp(state.error, "host not found") == 0);
+
+    memset(&state, 0, sizeof(state));
+    snprintf(state.url, sizeof(state.url),
+             "http://127.0.0.1:%d/", CLOSED_PORT);
+    aid = actor_spawn(rt, http_test_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+
+    /* Loopback may refuse before connect() returns */
+    ASSERT(state.failed_at_once || state.got_error);
+    if (state.got_error) ASSERT(strcmp(state.error, "connect failed") == 0);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_http_pool_reuse(void) {
+    pid_t server = start_pool_server(3, false);
+
+    pool_test_state_t state;
+    ASSERT_EQ(run_pool_client(&state, 3), 3);
+    ASSERT_EQ(state.errors, 0);
+    ASSERT(strcmp(state.last_body, "r2") == 0);
+
+    /* All three over one connection */
+    int status;
+    waitpid(server, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 1);
+    return 0;
+}
+
+static int test_http_pool_stale_retry(void) {
+    pid_t server = start_pool_server(2, true);
+
+    pool_test_state_t state;
+    ASSERT_EQ(run_pool_client(&state, 2), 2);
+    ASSERT_EQ(state.errors, 0);
+    ASSERT(strcmp(state.last_body, "r1") == 0);
+
+    /* The second GET was resent on a new connection */
+    int status;
+    waitpid(server, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 2);
+    return 0;
+}
+
+static int test_http_stream_window(void) {
+    pid_t server = start_stream_server(false);
+
+    stream_test_state_t state;
+    run_stream_client(&state, 64 * 1024, 16);
+
+    ASSERT(state.got_head);
+    ASSERT(!state.chunk_before_head);
+    ASSERT_EQ(state.status_code, 200);
+    ASSERT(state.got_final);
+    ASSERT(!state.got_error);
+    ASSERT(!state.bad_byte);
+    ASSERT_EQ(state.received, STREAM_SIZE);
+    ASSERT(state.max_unacked <= 64 * 1024);
+
+    int status;
+    waitpid(server, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+/* Mailbox smaller than the window: chunks wait for room in it */
+static int test_http_stream_full_mailbox(void) {
+    pid_t server = start_stream_server(true);
+
+    stream_test_state_t state;
+    run_stream_client(&state, 256 * 1024, 2);
+
+    ASSERT(state.got_head);
+    ASSERT(!state.chunk_before_head);
+    ASSERT(state.got_final);
+    ASSERT(!state.got_error);
+    ASSERT(!state.bad_byte);
+    ASSERT_EQ(state.received, STREAM_SIZE);
+
+    waitpid(server, NULL, 0);
+    return 0;
+}
+
 int main(void) {
     signal(SIGPIPE, SIG_IGN);
     printf("test_http:\n");
@@ -318,5 +668,11 @@ int main(void) {
     RUN_TEST(test_http_post);
     RUN_TEST(test_http_404);
     RUN_TEST(test_http_headers);
+    RUN_TEST(test_http_hostname);
+    RUN_TEST(test_http_connect_errors);
+    RUN_TEST(test_http_pool_reuse);
+    RUN_TEST(test_http_pool_stale_retry);
+    RUN_TEST(test_http_stream_window);
+    RUN_TEST(test_http_stream_full_mailbox);
     TEST_REPORT();
 }
@@ -0,0 +1,116 @@
+#include "test_framework.h"
+#include "http_headers.h"
+#include <stdlib.h>
+
+/* Pack lines as the parser does, with an index entry per line */
+typedef struct {
+    char                block[4096];
+    size_t              size;
+    http_header_entry_t entries[128];
+    size_t              count;
+} packed_t;
+
+static void pack(packed_t *h, const char *line) {
+    const char *colon = strchr(line, ':');
+    const char *val = colon + 1;
+    while (*val == ' ') val++;
+    h->entries[h->count++] = (http_header_entry_t){
+        .hash = http_header_hash(line, (size_t)(colon - line)),
+        .offset = (uint32_t)h->size,
+        .name_len = (uint16_t)(colon - line),
+        .value = (uint16_t)(val - line)
+    };
+    size_t len = strlen(line) + 1;
+    memcpy(h->block + h->size, line, len);
+    h->size += len;
+}
+
+static http_header_index_t *build(const packed_t *h) {
+    http_header_index_t *index = malloc(http_header_index_size(h->count));
+    http_header_index_write(index, h->entries, h->count);
+    return index;
+}
+
+static int test_header_lookup(void) {
+    packed_t h = {0};
+    pack(&h, "Host: example.com");
+    pack(&h, "Content-Type: text/plain");
+    pack(&h, "X-Empty:");
+    http_header_index_t *index = build(&h);
+
+    ASSERT_EQ(index->count, 3);
+    const char *v = http_header_get(h.block, index, "host");
+    ASSERT_NOT_NULL(v);
+    ASSERT(strcmp(v, "example.com") == 0);
+    v = http_header_get(h.block, index, "CONTENT-TYPE");
+    ASSERT_NOT_NULL(v);
+    ASSERT(strcmp(v, "text/plain") == 0);
+    v = http_header_get(h.block, index, "X-Empty");
+    ASSERT_NOT_NULL(v);
+    ASSERT(strcmp(v, "") == 0);
+
+    /* A prefix or extension of a name is a different name */
+    ASSERT_NULL(http_header_get(h.block, index, "Content"));
+    ASSERT_NULL(http_header_get(h.block, index, "Content-Type2"));
+    ASSERT_NULL(http_header_get(h.block, index, "Accept"));
+    free(index);
+    return 0;
+}
+
+static int test_header_repeated(void) {
+    packed_t h = {0};
+    pack(&h, "Set-Cookie: a=1");
+    pack(&h, "Vary: Accept");
+    pack(&h, "set-cookie: b=2");
+    http_header_index_t *index = build(&h);
+
+    /* The first line of a repeated name wins */
+    const char *v = http_header_get(h.block, index, "Set-Cookie");
+    ASSERT_NOT_NULL(v);
+    ASSERT(strcmp(v, "a=1") == 0);
+    free(index);
+    return 0;
+}
+
+static int test_header_many(void) {
+    packed_t h = {0};
+    char names[100][24];
+    for (int i = 0; i < 100; i++) {
+        char line[48];
+        snprintf(names[i], sizeof(names[i]), "X-Header-%d", i);
+        snprintf(line, sizeof(line), "%s: value-%d", names[i], i);
+        pack(&h, line);
+    }
+    http_header_index_t *index = build(&h);
+
+    ASSERT_EQ(index->count, 100);
+    ASSERT(index->mask + 1 >= 200);
+    for (int i = 0; i < 100; i++) {
+        char want[16];
+        snprintf(want, sizeof(want), "value-%d", i);
+        const char *v = http_header_get(h.block, index, names[i]);
+        ASSERT_NOT_NULL(v);
+        ASSERT(strcmp(v, want) == 0);
+    }
+    ASSERT_NULL(http_header_get(h.block, index, "X-Header-100"));
+    free(index);
+    return 0;
+}
+
+static int test_header_empty(void) {
+    http_header_index_t *index = malloc(http_header_index_size(0));
+    http_header_index_write(index, NULL, 0);
+    ASSERT_EQ(index->count, 0);
+    ASSERT_NULL(http_header_get("", index, "Host"));
+    free(index);
+    return 0;
+}
+
+int main(void) {
+    printf("test_http_headers:\n");
+    RUN_TEST(test_header_lookup);
+    RUN_TEST(test_header_repeated);
+    RUN_TEST(test_header_many);
+    RUN_TEST(test_header_empty);
+    TEST_REPORT();
+}
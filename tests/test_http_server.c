@@ -11,11 +11,20 @@
 #include <unistd.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 
 #define TEST_PORT 19884
+#define KEEPALIVE_PORT 19908
+#define SLOW_READER_PORT 19913
+#define UPLOAD_PORT 19917
+#define DOWNLOAD_PORT 19918
+#define HEAD_PORT 19922
+#define BAD_LENGTH_PORT 19923
+#define MAX_CLIENTS_REUSE 40   /* more than the 32 conn slots */
 
 /* ── Client helper: connect with retries ───────────────────────────── */
 
@@ -67,6 +76,19 @@ static size_t read_response(int fd, char *buf, size_t cap) {
     return pos;
 }
 
+/* Read until needle shows up (or the peer closes / buffer fills) */
+static size_t read_until(int fd, char *buf, size_t cap, const char *needle) {
+    size_t pos = 0;
+    buf[0] = '\0';
+    while (pos < cap - 1 && !strstr(buf, needle)) {
+        ssize_t n = recv(fd, buf + pos, cap - 1 - pos, 0);
+        if (n <= 0) break;
+        pos += (size_t)n;
+        buf[pos] = '\0';
+    }
+    return pos;
+}
+
 /* ── Server actor behavior ─────────────────────────────────────────── */
 
 typedef struct {
@@ -80,6 +102,10 @@ typedef struct {
     size_t last_body_size;
     char last_headers[512];
     size_t last_headers_size;
+    char client_custom[32];   /* X-Client-Custom, looked up by index */
+    bool has_missing;
+    int stop_after;
+    double respond_secs;
 } server_state_t;
 
 enum {
@@ -87,9 +113,13 @@ enum {
     SCENARIO_POST_ECHO,
     SCENARIO_404,
     SCENARIO_HEADERS,
-    SCENARIO_MULTIPLE
+    SCENARIO_MULTIPLE,
+    SCENARIO_ECHO_PATH,
+    SCENARIO_LARGE
 };
 
+#define LARGE_BODY_SIZE (32 * 1024 * 1024)
+
 static bool server_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
                             message_t *msg, void *state) {
     server_state_t *s = state;
@@ -119,6 +149,10 @@ static bool server_behavior(runtime_t *rt, actor_t *self __attribute__((unused))
             memcpy(s->last_headers, http_request_headers(p), p->headers_size);
             s->last_headers_size = p->headers_size;
         }
+        const char *custom = http_request_header(p, "x-client-custom");
+        snprintf(s->client_custom, sizeof(s->client_custom), "%s",
+                 custom ? custom : "");
+        s->has_missing = http_request_header(p, "X-Missing") != NULL;
 
         switch (s->scenario) {
         case SCENARIO_GET_200: {
@@ -161,6 +195,34 @@ static bool server_behavior(runtime_t *rt, actor_t *self __attribute__((unused))
             }
             return true;
         }
+        case SCENARIO_LARGE: {
+            if (strcmp(path, "/done") == 0) {
+                actor_http_respond(rt, p->conn_id, 200, NULL, 0, "ok", 2);
+                runtime_stop(rt);
+                return false;
+            }
+            /* Far more than the socket takes: the rest is queued */
+            char *big = malloc(LARGE_BODY_SIZE);
+            memset(big, 'x', LARGE_BODY_SIZE);
+            struct timespec t0, t1;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            actor_http_respond(rt, p->conn_id, 200, NULL, 0,
+                               big, LARGE_BODY_SIZE);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            free(big);
+            s->respond_secs = (double)(t1.tv_sec - t0.tv_sec) +
+                              (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+            return true;
+        }
+        case SCENARIO_ECHO_PATH: {
+            actor_http_respond(rt, p->conn_id, 200, NULL, 0,
+                               path, strlen(path));
+            if (s->request_count >= s->stop_after) {
+                runtime_stop(rt);
+                return false;
+            }
+            return true;
+        }
         }
         return true;
     }
@@ -168,6 +230,100 @@ static bool server_behavior(runtime_t *rt, actor_t *self __attribute__((unused))
     return true;
 }
 
+/* ── Streaming server actor ────────────────────────────────────────── */
+
+#define STREAM_BODY_SIZE (8 * 1024 * 1024)
+#define UPLOAD_WINDOW (64 * 1024)
+
+typedef struct {
+    uint16_t port;
+    bool upload;             /* else a chunked download */
+    int requests;
+    bool streamed;
+    bool bad_byte;
+    size_t received;
+    size_t unacked;
+    size_t max_unacked;
+    size_t sent;
+    int refused;
+    int write_ready;
+} stream_server_state_t;
+
+/* Write the download until the socket backs up */
+static void write_download(runtime_t *rt, stream_server_state_t *s,
+                           http_conn_id_t id) {
+    static char block[16384];
+    while (s->sent < STREAM_BODY_SIZE) {
+        for (size_t i = 0; i < sizeof(block); i++)
+            block[i] = (char)((s->sent + i) % 251);
+        if (!actor_http_write_chunk(rt, id, block, sizeof(block))) {
+            s->refused++;
+            return;
+        }
+        s->sent += sizeof(block);
+    }
+    actor_http_end(rt, id);
+}
+
+static bool stream_server_behavior(runtime_t *rt,
+                                   actor_t *self __attribute__((unused)),
+                                   message_t *msg, void *state) {
+    stream_server_state_t *s = state;
+
+    if (msg->type == 0) {
+        if (s->upload)
+            actor_http_listen_stream(rt, s->port, UPLOAD_WINDOW);
+        else
+            actor_http_listen(rt, s->port);
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_REQUEST) {
+        const http_request_payload_t *p = msg->payload;
+        s->requests++;
+        if (strcmp(http_request_path(p), "/done") == 0) {
+            actor_http_respond(rt, p->conn_id, 200, NULL, 0, "ok", 2);
+            runtime_stop(rt);
+            return false;
+        }
+        if (s->upload) {
+            s->streamed = p->body_streamed;
+        } else {
+            const char *hdrs[] = { "Content-Type: application/octet-stream" };
+            actor_http_respond_start(rt, p->conn_id, 200, hdrs, 1);
+            write_download(rt, s, p->conn_id);
+        }
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_BODY_CHUNK) {
+        const http_body_chunk_payload_t *p = msg->payload;
+        const uint8_t *data = http_body_chunk_data(p);
+        for (size_t i = 0; i < p->size; i++)
+            if (data[i] != (s->received + i) % 251) s->bad_byte = true;
+        s->received += p->size;
+        s->unacked += p->size;
+        if (s->unacked > s->max_unacked) s->max_unacked = s->unacked;
+        if (s->unacked >= UPLOAD_WINDOW / 2) {
+            actor_http_body_ack(rt, p->conn_id, s->unacked);
+            s->unacked = 0;
+        }
+        if (p->final) {
+            char resp[32];
+            int n = snprintf(resp, sizeof(resp), "%zu", s->received);
+            actor_http_respond(rt, p->conn_id, 200, NULL, 0, resp, (size_t)n);
+        }
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_WRITE_READY) {
+        const ws_status_payload_t *p = msg->payload;
+        s->write_ready++;
+        write_download(rt, s, p->conn_id);
+    }
+    return true;
+}
+
 /* ── Tests ─────────────────────────────────────────────────────────── */
 
 static int test_server_get_200(void) {
@@ -341,6 +497,8 @@ static int test_server_headers(void) {
     ASSERT_EQ(state.request_count, 1);
     /* Verify we received the client's custom header */
     ASSERT(state.last_headers_size > 0);
+    ASSERT(strcmp(state.client_custom, "test-val") == 0);
+    ASSERT(!state.has_missing);
 
     runtime_destroy(rt);
 
@@ -396,6 +554,401 @@ static int test_server_multiple(void) {
     return 0;
 }
 
+static int run_echo_server(uint16_t port, int stop_after) {
+    runtime_t *rt = runtime_init(1, 16);
+    server_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.port = port;
+    state.scenario = SCENARIO_ECHO_PATH;
+    state.stop_after = stop_after;
+
+    actor_id_t aid = actor_spawn(rt, server_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+    return state.request_count;
+}
+
+static int test_server_keepalive(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(KEEPALIVE_PORT, 50);
+        if (fd < 0) _exit(1);
+
+        /* Two requests one after the other on the same connection */
+        const char *paths[] = { "/a", "/b" };
+        for (int i = 0; i < 2; i++) {
+            char req[128];
+            snprintf(req, sizeof(req),
+                     "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", paths[i]);
+            send(fd, req, strlen(req), 0);
+
+            char resp[4096];
+            if (read_response(fd, resp, sizeof(resp)) == 0) _exit(2);
+            if (!strstr(resp, "Connection: keep-alive")) _exit(3);
+            if (!strstr(resp, paths[i])) _exit(4);
+        }
+
+        /* Two pipelined in one write: answered in order */
+        const char *pipelined = "GET /c HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                                "GET /d HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, pipelined, strlen(pipelined), 0);
+
+        char resp[4096];
+        read_until(fd, resp, sizeof(resp), "\r\n\r\n/d");
+        char *c = strstr(resp, "\r\n\r\n/c");
+        char *d = strstr(resp, "\r\n\r\n/d");
+        close(fd);
+        if (!c || !d) _exit(5);
+        if (c > d) _exit(6);
+        _exit(0);
+    }
+
+    ASSERT_EQ(run_echo_server(KEEPALIVE_PORT, 4), 4);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+static int test_server_head_keepalive(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(HEAD_PORT, 50);
+        if (fd < 0) _exit(1);
+
+        /* HEAD then GET on one conn: the HEAD reply must end at its head */
+        const char *reqs = "HEAD /h HTTP/1.1\r\nHost: localhost\r\n\r\n"
+                           "GET /g HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, reqs, strlen(reqs), 0);
+
+        char resp[4096];
+        read_until(fd, resp, sizeof(resp), "\r\n\r\n/g");
+        close(fd);
+        if (!strstr(resp, "Content-Length: 2\r\n")) _exit(2);
+        char *end = strstr(resp, "\r\n\r\n");
+        if (!end || strncmp(end + 4, "HTTP/1.1 200", 12) != 0) _exit(3);
+        if (!strstr(end, "\r\n\r\n/g")) _exit(4);
+        _exit(0);
+    }
+
+    ASSERT_EQ(run_echo_server(HEAD_PORT, 2), 2);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+static int test_server_bad_content_length(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        /* What follows the head must not be taken for a next request */
+        const char *lengths[] = { "-5", "12abc", "99999999999999999999" };
+        for (int i = 0; i < 3; i++) {
+            int fd = connect_retry(BAD_LENGTH_PORT, 50);
+            if (fd < 0) _exit(1);
+            char req[256];
+            snprintf(req, sizeof(req),
+                     "POST /x HTTP/1.1\r\nHost: localhost\r\n"
+                     "Content-Length: %s\r\n\r\n"
+                     "GET /smuggled HTTP/1.1\r\nHost: localhost\r\n\r\n",
+                     lengths[i]);
+            send(fd, req, strlen(req), 0);
+
+            char resp[4096];
+            read_until(fd, resp, sizeof(resp), "\r\n\r\n");
+            if (!strstr(resp, "HTTP/1.1 400 Bad Request")) _exit(2 + i);
+
+            /* Server closes after the 400 */
+            char extra[64];
+            ssize_t n = recv(fd, extra, sizeof(extra), 0);
+            close(fd);
+            if (n != 0) _exit(5 + i);
+        }
+
+        int fd = connect_retry(BAD_LENGTH_PORT, 50);
+        if (fd < 0) _exit(8);
+        const char *req = "GET /ok HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+        char resp[4096];
+        read_response(fd, resp, sizeof(resp));
+        close(fd);
+        if (!strstr(resp, "\r\n\r\n/ok")) _exit(9);
+        _exit(0);
+    }
+
+    /* Only the last request reaches the actor */
+    ASSERT_EQ(run_echo_server(BAD_LENGTH_PORT, 1), 1);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+static int test_server_connection_close(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        /* HTTP/1.0 without keep-alive, then 1.1 asking to close */
+        const char *reqs[] = {
+            "GET /old HTTP/1.0\r\n\r\n",
+            "GET /bye HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n"
+        };
+        for (int i = 0; i < 2; i++) {
+            int fd = connect_retry(KEEPALIVE_PORT + 1, 50);
+            if (fd < 0) _exit(1);
+            send(fd, reqs[i], strlen(reqs[i]), 0);
+
+            char resp[4096];
+            read_until(fd, resp, sizeof(resp), "\r\n\r\n/");
+            if (!strstr(resp, "Connection: close")) _exit(2 + i);
+
+            /* Server closes after the response */
+            char extra[64];
+            ssize_t n = recv(fd, extra, sizeof(extra), 0);
+            close(fd);
+            if (n != 0) _exit(4 + i);
+        }
+        _exit(0);
+    }
+
+    ASSERT_EQ(run_echo_server(KEEPALIVE_PORT + 1, 2), 2);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+static int test_server_slot_reuse(void) {
+    /* More keep-alive clients than slots, one at a time: each slot is
+       freed when its client hangs up */
+    int clients = MAX_CLIENTS_REUSE;
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (int i = 0; i < clients; i++) {
+            int fd = connect_retry(KEEPALIVE_PORT + 2, 50);
+            if (fd < 0) _exit(1);
+            const char *req = "GET /r HTTP/1.1\r\nHost: localhost\r\n\r\n";
+            send(fd, req, strlen(req), 0);
+
+            char resp[4096];
+            read_response(fd, resp, sizeof(resp));
+            close(fd);
+            if (!strstr(resp, "200 OK")) _exit(2);
+        }
+        _exit(0);
+    }
+
+    ASSERT_EQ(run_echo_server(KEEPALIVE_PORT + 2, clients), clients);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+static int test_server_slow_reader(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(SLOW_READER_PORT, 50);
+        if (fd < 0) _exit(1);
+        const char *req = "GET /big HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+
+        /* Don't read for a while: the server must keep running */
+        usleep(300000);
+
+        static char buf[65536];
+        size_t total = 0, body = 0;
+        char *hdr_end = NULL;
+        while (!hdr_end) {
+            ssize_t n = recv(fd, buf + total, sizeof(buf) - 1 - total, 0);
+            if (n <= 0) _exit(2);
+            total += (size_t)n;
+            buf[total] = '\0';
+            hdr_end = strstr(buf, "\r\n\r\n");
+        }
+        body = total - (size_t)(hdr_end + 4 - buf);
+        while (body < LARGE_BODY_SIZE) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) _exit(3);
+            for (ssize_t i = 0; i < n; i++)
+                if (buf[i] != 'x') _exit(4);
+            body += (size_t)n;
+        }
+        if (body != LARGE_BODY_SIZE) _exit(5);
+
+        /* Same conn is usable once the reply is out */
+        req = "GET /done HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+        char resp[4096];
+        read_response(fd, resp, sizeof(resp));
+        close(fd);
+        if (!strstr(resp, "200 OK")) _exit(6);
+        _exit(0);
+    }
+
+    runtime_t *rt = runtime_init(1, 16);
+    server_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.port = SLOW_READER_PORT;
+    state.scenario = SCENARIO_LARGE;
+
+    actor_id_t aid = actor_spawn(rt, server_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+
+    /* Returned without waiting for the client, which sleeps 300 ms */
+    ASSERT(state.respond_secs < 0.1);
+    ASSERT_EQ(state.request_count, 2);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+/* Chunked upload, delivered as it arrives within the window */
+static int test_server_stream_upload(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(UPLOAD_PORT, 50);
+        if (fd < 0) _exit(1);
+        const char *req = "POST /upload HTTP/1.1\r\nHost: localhost\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+
+        static char block[7000];
+        for (size_t off = 0; off < STREAM_BODY_SIZE; ) {
+            size_t len = STREAM_BODY_SIZE - off < sizeof(block) ?
+                         STREAM_BODY_SIZE - off : sizeof(block);
+            for (size_t i = 0; i < len; i++)
+                block[i] = (char)((off + i) % 251);
+            char size_line[32];
+            int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+            send(fd, size_line, (size_t)n, 0);
+            if (send(fd, block, len, 0) != (ssize_t)len) _exit(2);
+            send(fd, "\r\n", 2, 0);
+            off += len;
+        }
+        send(fd, "0\r\n\r\n", 5, 0);
+
+        char resp[4096];
+        read_response(fd, resp, sizeof(resp));
+        char expect[32];
+        snprintf(expect, sizeof(expect), "\r\n\r\n%d", STREAM_BODY_SIZE);
+        if (!strstr(resp, expect)) _exit(3);
+
+        /* Keep-alive: the next request on the conn is parsed normally */
+        req = "GET /done HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+        read_response(fd, resp, sizeof(resp));
+        close(fd);
+        if (!strstr(resp, "200 OK")) _exit(4);
+        _exit(0);
+    }
+
+    runtime_t *rt = runtime_init(1, 16);
+    stream_server_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.port = UPLOAD_PORT;
+    state.upload = true;
+
+    actor_id_t aid = actor_spawn(rt, stream_server_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+
+    ASSERT(state.streamed);
+    ASSERT(!state.bad_byte);
+    ASSERT_EQ(state.received, STREAM_BODY_SIZE);
+    ASSERT(state.max_unacked <= UPLOAD_WINDOW);
+    ASSERT_EQ(state.requests, 2);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+/* Chunked download to a client that starts reading late */
+static int test_server_chunked_response(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(DOWNLOAD_PORT, 50);
+        if (fd < 0) _exit(1);
+        const char *req = "GET /download HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+        usleep(200000);
+
+        FILE *in = fdopen(dup(fd), "r");
+        char line[256];
+        bool chunked = false;
+        while (fgets(line, sizeof(line), in) && strcmp(line, "\r\n") != 0)
+            if (strcasecmp(line, "Transfer-Encoding: chunked\r\n") == 0)
+                chunked = true;
+        if (!chunked) _exit(2);
+
+        size_t total = 0;
+        for (;;) {
+            if (!fgets(line, sizeof(line), in)) _exit(3);
+            size_t len = strtoul(line, NULL, 16);
+            if (len == 0) break;
+            for (size_t i = 0; i < len; i++) {
+                int c = fgetc(in);
+                if (c == EOF || (uint8_t)c != (total + i) % 251) _exit(4);
+            }
+            total += len;
+            if (!fgets(line, sizeof(line), in)) _exit(5);   /* CRLF */
+        }
+        if (!fgets(line, sizeof(line), in) || strcmp(line, "\r\n") != 0)
+            _exit(6);
+        fclose(in);
+        if (total != STREAM_BODY_SIZE) _exit(7);
+
+        req = "GET /done HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, req, strlen(req), 0);
+        char resp[4096];
+        read_response(fd, resp, sizeof(resp));
+        close(fd);
+        if (!strstr(resp, "200 OK")) _exit(8);
+        _exit(0);
+    }
+
+    runtime_t *rt = runtime_init(1, 16);
+    stream_server_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.port = DOWNLOAD_PORT;
+
+    actor_id_t aid = actor_spawn(rt, stream_server_behavior, &state, NULL, 16);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+    runtime_destroy(rt);
+
+    /* Writes were refused while the client wasn't reading, then resumed */
+    ASSERT(state.refused > 0);
+    ASSERT_EQ(state.write_ready, state.refused);
+    ASSERT_EQ(state.sent, STREAM_BODY_SIZE);
+    ASSERT_EQ(state.requests, 2);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
 int main(void) {
     signal(SIGPIPE, SIG_IGN);
     printf("test_http_server:\n");
@@ -404,5 +957,13 @@ int main(void) {
     RUN_TEST(test_server_404);
     RUN_TEST(test_server_headers);
     RUN_TEST(test_server_multiple);
+    RUN_TEST(test_server_keepalive);
+    RUN_TEST(test_server_head_keepalive);
+    RUN_TEST(test_server_bad_content_length);
+    RUN_TEST(test_server_connection_close);
+    RUN_TEST(test_server_slot_reuse);
+    RUN_TEST(test_server_slow_reader);
+    RUN_TEST(test_server_stream_upload);
+    RUN_TEST(test_server_chunked_response);
     TEST_REPORT();
 }
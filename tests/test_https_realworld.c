@@ -133,7 +133,7 @@ static bool wss_rw_behavior(runtime_t *rt,
         return false;
     }
 
-    if (msg->type == MSG_WS_ERROR) {
+    if (msg->type == MSG_WS_ERROR || msg->type == MSG_HTTP_ERROR) {
         s->error = true;
         runtime_stop(rt);
         return false;
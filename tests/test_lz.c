@@ -0,0 +1,79 @@
+#include "test_framework.h"
+#include "lz.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int roundtrip(const uint8_t *src, size_t len) {
+    size_t cap = len + len / 255 + 16;
+    uint8_t *z = malloc(cap);
+    uint8_t *out = malloc(len + 1);
+    ASSERT_NOT_NULL(z);
+    ASSERT_NOT_NULL(out);
+
+    size_t zlen = lz_compress(src, len, z, cap);
+    ASSERT(zlen > 0);
+    ASSERT_EQ(lz_decompress(z, zlen, out, len), len);
+    ASSERT(memcmp(src, out, len) == 0);
+
+    free(z);
+    free(out);
+    return 0;
+}
+
+static int test_lz_text_shrinks(void) {
+    char text[4096];
+    size_t n = 0;
+    while (n + 40 < sizeof(text))
+        n += (size_t)snprintf(text + n, sizeof(text) - n,
+                              "{\"name\":\"row%zu\",\"value\":42},", n % 7);
+
+    uint8_t z[4096];
+    size_t zlen = lz_compress((uint8_t *)text, n, z, n - 1);
+    ASSERT(zlen > 0);
+    ASSERT(zlen < n / 4);
+    return roundtrip((uint8_t *)text, n);
+}
+
+static int test_lz_edge_inputs(void) {
+    uint8_t zeros[100000];
+    memset(zeros, 0, sizeof(zeros));
+    ASSERT_EQ(roundtrip(zeros, sizeof(zeros)), 0);   /* long overlapping runs */
+    ASSERT_EQ(roundtrip(zeros, 1), 0);
+    ASSERT_EQ(roundtrip((const uint8_t *)"abcdabcdabcdabcd", 16), 0);
+
+    /* Pseudo-random bytes do not shrink */
+    uint8_t noise[2048];
+    uint32_t x = 12345;
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        x = x * 1103515245u + 12345u;
+        noise[i] = (uint8_t)(x >> 16);
+    }
+    uint8_t z[2048];
+    ASSERT_EQ(lz_compress(noise, sizeof(noise), z, sizeof(noise) - 1), (size_t)0);
+    return roundtrip(noise, sizeof(noise));
+}
+
+static int test_lz_malformed_rejected(void) {
+    uint8_t out[64];
+
+    /* Truncated literal length extension */
+    uint8_t trunc[] = {0xF0};
+    ASSERT_EQ(lz_decompress(trunc, sizeof(trunc), out, sizeof(out)), (size_t)0);
+
+    /* Offset pointing before the start of output */
+    uint8_t bad_off[] = {0x10, 'a', 0x05, 0x00};
+    ASSERT_EQ(lz_decompress(bad_off, sizeof(bad_off), out, sizeof(out)), (size_t)0);
+
+    /* Match that would overflow the output buffer */
+    uint8_t overflow[] = {0x1F, 'a', 0x01, 0x00, 200};
+    ASSERT_EQ(lz_decompress(overflow, sizeof(overflow), out, sizeof(out)), (size_t)0);
+    return 0;
+}
+
+int main(void) {
+    printf("test_lz:\n");
+    RUN_TEST(test_lz_text_shrinks);
+    RUN_TEST(test_lz_edge_inputs);
+    RUN_TEST(test_lz_malformed_rejected);
+    TEST_REPORT();
+}
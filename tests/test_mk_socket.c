@@ -124,6 +124,37 @@ static int test_socket_get_fd(void) {
     return 0;
 }
 
+static int test_socket_sendfile_no_sigpipe(void) {
+    /* The default action would kill the test if the signal got through */
+    signal(SIGPIPE, SIG_DFL);
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    mk_socket_t *sock = mk_socket_tcp_wrap(sv[0]);
+    ASSERT_NOT_NULL(sock);
+    ASSERT_NOT_NULL(sock->sendfile);
+    close(sv[1]);
+
+    char path[] = "/tmp/mk_sendfile_XXXXXX";
+    int file = mkstemp(path);
+    ASSERT(file >= 0);
+    unlink(path);
+    ASSERT_EQ(write(file, "data", 4), 4);
+
+    off_t off = 0;
+    errno = 0;
+    ASSERT_EQ(sock->sendfile(sock, file, &off, 4), -1);
+    ASSERT_EQ(errno, EPIPE);
+
+    sigset_t pending;
+    sigpending(&pending);
+    ASSERT(!sigismember(&pending, SIGPIPE));
+
+    close(file);
+    sock->close(sock);
+    signal(SIGPIPE, SIG_IGN);
+    return 0;
+}
+
 int main(void) {
     signal(SIGPIPE, SIG_IGN);
     printf("test_mk_socket:\n");
@@ -132,5 +163,6 @@ int main(void) {
     RUN_TEST(test_socket_write_read);
     RUN_TEST(test_socket_nonblocking_read);
     RUN_TEST(test_socket_get_fd);
+    RUN_TEST(test_socket_sendfile_no_sigpipe);
     TEST_REPORT();
 }
@@ -0,0 +1,229 @@
+#define _DEFAULT_SOURCE
+#include "test_framework.h"
+#include "microkernel/runtime.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include "microkernel/supervision.h"
+#include <sys/socket.h>
+
+#define NODE_A 1
+#define NODE_B 2
+#define NODE_C 3
+#define MSG_INIT 202
+#define MSG_QUIT 203
+#define MSG_DEMON 204
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    if (msg->type == MSG_INIT) {
+        actor_set_timer(rt, *(int *)state, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_runtime(runtime_t *rt, int ms) {
+    actor_id_t id = actor_spawn(rt, stopper_behavior, &ms, NULL, 4);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    runtime_run(rt);
+}
+
+static void pump_all(runtime_t **rts, size_t n, int rounds) {
+    for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < n; i++) pump_runtime(rts[i], 5);
+}
+
+/* In-process link between rts[a] (node a + 1) and rts[b] over a socketpair */
+static bool link_nodes(runtime_t **rts, size_t a, size_t b) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return false;
+    transport_t *ta = transport_tcp_from_fd(sv[0], (node_id_t)(b + 1));
+    transport_t *tb = transport_tcp_from_fd(sv[1], (node_id_t)(a + 1));
+    return ta && tb && runtime_add_transport(rts[a], ta) &&
+           runtime_add_transport(rts[b], tb);
+}
+
+/* ── Target and watcher actors ─────────────────────────────────────── */
+
+/* Exits normally on MSG_QUIT */
+static bool target_behavior(runtime_t *rt, actor_t *self,
+                            message_t *msg, void *state) {
+    (void)rt; (void)self; (void)state;
+    return msg->type != MSG_QUIT;
+}
+
+typedef struct {
+    actor_id_t target;
+    uint32_t   ref;
+    int        downs;
+    down_payload_t last;
+} watcher_t;
+
+static bool watcher_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    watcher_t *w = state;
+    if (msg->type == MSG_INIT) {
+        w->ref = actor_monitor(rt, w->target);
+    } else if (msg->type == MSG_DEMON) {
+        actor_demonitor(rt, w->ref);
+    } else if (msg->type == MSG_DOWN) {
+        memcpy(&w->last, msg->payload, sizeof(w->last));
+        w->downs++;
+    }
+    return true;
+}
+
+static actor_id_t start_watcher(runtime_t *rt, watcher_t *w) {
+    actor_id_t id = actor_spawn(rt, watcher_behavior, w, NULL, 16);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    return id;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────── */
+
+static int test_local_monitor(void) {
+    runtime_t *rt = runtime_init(NODE_A, 64);
+    actor_id_t target = actor_spawn(rt, target_behavior, NULL, NULL, 4);
+    watcher_t w = { .target = target };
+    start_watcher(rt, &w);
+    pump_runtime(rt, 5);
+    ASSERT(w.ref != 0);
+    ASSERT_EQ(w.downs, 0);
+
+    actor_stop(rt, target);
+    pump_runtime(rt, 5);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(w.last.ref, w.ref);
+    ASSERT_EQ(w.last.actor, target);
+    ASSERT_EQ(w.last.exit_reason, EXIT_KILLED);
+
+    /* Monitoring an actor that no longer exists answers at once */
+    watcher_t w2 = { .target = target };
+    start_watcher(rt, &w2);
+    pump_runtime(rt, 5);
+    ASSERT_EQ(w2.downs, 1);
+    ASSERT_EQ(w2.last.exit_reason, EXIT_NOPROC);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_remote_exit(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    actor_id_t target = actor_spawn(rts[1], target_behavior, NULL, NULL, 4);
+    watcher_t w = { .target = target };
+    watcher_t w2 = { .target = target };
+    start_watcher(rts[0], &w);
+    start_watcher(rts[0], &w2);
+    pump_all(rts, 2, 2);
+    ASSERT_EQ(w.downs, 0);
+
+    actor_send(rts[1], target, MSG_QUIT, NULL, 0);
+    pump_all(rts, 2, 2);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(w.last.actor, target);
+    ASSERT_EQ(w.last.exit_reason, EXIT_NORMAL);
+    ASSERT_EQ(w2.downs, 1);
+    ASSERT_EQ(w2.last.ref, w2.ref);
+
+    /* A remote actor that does not exist */
+    watcher_t w3 = { .target = actor_id_make(NODE_B, 200) };
+    start_watcher(rts[0], &w3);
+    pump_all(rts, 2, 2);
+    ASSERT_EQ(w3.downs, 1);
+    ASSERT_EQ(w3.last.exit_reason, EXIT_NOPROC);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_demonitor(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    actor_id_t target = actor_spawn(rts[1], target_behavior, NULL, NULL, 4);
+    watcher_t w = { .target = target };
+    actor_id_t wid = start_watcher(rts[0], &w);
+    pump_all(rts, 2, 2);
+
+    actor_send(rts[0], wid, MSG_DEMON, NULL, 0);
+    pump_all(rts, 2, 2);
+    actor_send(rts[1], target, MSG_QUIT, NULL, 0);
+    pump_all(rts, 2, 2);
+    ASSERT_EQ(w.downs, 0);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_node_down(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    actor_id_t target = actor_spawn(rts[1], target_behavior, NULL, NULL, 4);
+    watcher_t w = { .target = target };
+    start_watcher(rts[0], &w);
+    pump_all(rts, 2, 2);
+
+    ASSERT(runtime_remove_transport(rts[0], NODE_B));
+    pump_runtime(rts[0], 5);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(w.last.exit_reason, EXIT_NODEDOWN);
+
+    /* And an unreachable node answers at once */
+    watcher_t w2 = { .target = target };
+    start_watcher(rts[0], &w2);
+    pump_runtime(rts[0], 5);
+    ASSERT_EQ(w2.downs, 1);
+    ASSERT_EQ(w2.last.exit_reason, EXIT_NODEDOWN);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_monitor_through_gateway(void) {
+    runtime_t *rts[3] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256),
+                          runtime_init(NODE_C, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    ASSERT(link_nodes(rts, 1, 2));
+    pump_all(rts, 3, 6);
+
+    actor_id_t target = actor_spawn(rts[2], target_behavior, NULL, NULL, 4);
+    watcher_t w = { .target = target };
+    start_watcher(rts[0], &w);
+    pump_all(rts, 3, 2);
+
+    actor_stop(rts[2], target);
+    pump_all(rts, 3, 3);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(w.last.exit_reason, EXIT_KILLED);
+
+    for (int i = 0; i < 3; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+int main(void) {
+    printf("test_monitor:\n");
+    RUN_TEST(test_local_monitor);
+    RUN_TEST(test_remote_exit);
+    RUN_TEST(test_demonitor);
+    RUN_TEST(test_node_down);
+    RUN_TEST(test_monitor_through_gateway);
+    TEST_REPORT();
+}
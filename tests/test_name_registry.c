@@ -3,6 +3,8 @@
 #include "microkernel/actor.h"
 #include "microkernel/message.h"
 #include "microkernel/services.h"
+#include <stdio.h>
+#include <string.h>
 
 /* ── Behaviors ─────────────────────────────────────────────────────── */
 
@@ -70,11 +72,133 @@ static int test_deregister_on_actor_stop(void) {
     return 0;
 }
 
+static int test_grows_past_initial_size(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    actor_id_t id = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    char name[32];
+
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "svc_%d", i);
+        ASSERT(actor_register_name(rt, name, id));
+    }
+    for (int i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "svc_%d", i);
+        ASSERT_EQ(actor_lookup(rt, name), id);
+    }
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_removal_keeps_probe_chains(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    actor_id_t ids[8];
+    char name[32];
+    for (int a = 0; a < 8; a++)
+        ids[a] = actor_spawn(rt, a % 2 ? stop_behavior : noop_behavior,
+                             NULL, NULL, 16);
+
+    /* Interleave names so that every probe chain mixes actors */
+    for (int i = 0; i < 400; i++) {
+        snprintf(name, sizeof(name), "n%d", i);
+        ASSERT(actor_register_name(rt, name, ids[i % 8]));
+    }
+
+    /* The odd actors stop and take their names with them */
+    for (int a = 1; a < 8; a += 2) actor_send(rt, ids[a], 0, NULL, 0);
+    for (int a = 0; a < 4; a++) runtime_step(rt);
+
+    for (int i = 0; i < 400; i++) {
+        snprintf(name, sizeof(name), "n%d", i);
+        actor_id_t want = (i % 8) % 2 ? ACTOR_ID_INVALID : ids[i % 8];
+        ASSERT_EQ(actor_lookup(rt, name), want);
+    }
+
+    /* Freed names can be taken again */
+    ASSERT(actor_register_name(rt, "n1", ids[0]));
+    ASSERT_EQ(actor_lookup(rt, "n1"), ids[0]);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_reverse_lookup_all_names(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    actor_id_t id = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    actor_id_t other = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    char buf[128];
+
+    ASSERT(actor_register_name(rt, "alpha", id));
+    ASSERT(actor_register_name(rt, "unrelated", other));
+    ASSERT(actor_register_name(rt, "beta", id));
+    ASSERT(actor_register_name(rt, "gamma", id));
+
+    /* Registration order, first name for the single lookup */
+    actor_reverse_lookup_all(rt, id, buf, sizeof(buf));
+    ASSERT_EQ(strcmp(buf, "alpha, beta, gamma"), 0);
+    actor_reverse_lookup(rt, id, buf, sizeof(buf));
+    ASSERT_EQ(strcmp(buf, "alpha"), 0);
+
+    actor_stop(rt, id);
+    runtime_step(rt);
+    ASSERT_EQ(actor_reverse_lookup_all(rt, id, buf, sizeof(buf)), 0u);
+    ASSERT_EQ(actor_lookup(rt, "beta"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(rt, "unrelated"), other);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+static bool count_behavior(runtime_t *rt, actor_t *self,
+                           message_t *msg, void *state) {
+    (void)rt; (void)self; (void)msg;
+    (*(int *)state)++;
+    return true;
+}
+
+static int test_name_handle_follows_rebinding(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    int first = 0, second = 0;
+    actor_id_t a = actor_spawn(rt, count_behavior, &first, NULL, 16);
+    actor_id_t b = actor_spawn(rt, count_behavior, &second, NULL, 16);
+
+    /* Resolving before the name exists caches the miss */
+    actor_name_handle_t h = actor_name_resolve(rt, "svc");
+    ASSERT_EQ(h.id, ACTOR_ID_INVALID);
+    ASSERT(!actor_send_handle(rt, &h, 1, NULL, 0));
+
+    ASSERT(actor_register_name(rt, "svc", a));
+    ASSERT(actor_send_handle(rt, &h, 1, NULL, 0));
+    ASSERT_EQ(h.id, a);
+
+    /* Unrelated changes leave the binding alone */
+    ASSERT(actor_register_name(rt, "other", b));
+    ASSERT_EQ(actor_name_handle_id(rt, &h), a);
+    runtime_step(rt);
+    ASSERT_EQ(first, 1);
+
+    /* The name moves to b once a is gone */
+    actor_stop(rt, a);
+    runtime_step(rt);
+    ASSERT(!actor_send_handle(rt, &h, 1, NULL, 0));
+    ASSERT(actor_register_name(rt, "svc", b));
+    ASSERT(actor_send_handle(rt, &h, 1, NULL, 0));
+    runtime_step(rt);
+    ASSERT_EQ(second, 1);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
 int main(void) {
     printf("test_name_registry:\n");
     RUN_TEST(test_register_and_lookup);
     RUN_TEST(test_missing_returns_invalid);
     RUN_TEST(test_duplicate_name_fails);
     RUN_TEST(test_deregister_on_actor_stop);
+    RUN_TEST(test_grows_past_initial_size);
+    RUN_TEST(test_removal_keeps_probe_chains);
+    RUN_TEST(test_reverse_lookup_all_names);
+    RUN_TEST(test_name_handle_follows_rebinding);
     TEST_REPORT();
 }
@@ -0,0 +1,215 @@
+#define _DEFAULT_SOURCE
+#include "test_framework.h"
+#include "microkernel/runtime.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include "microkernel/namespace.h"
+#include <sys/socket.h>
+
+#define NODE_A 1
+#define NODE_B 2
+#define NODE_C 3
+#define MSG_INIT 202
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    if (msg->type == MSG_INIT) {
+        actor_set_timer(rt, *(int *)state, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_runtime(runtime_t *rt, int ms) {
+    actor_id_t id = actor_spawn(rt, stopper_behavior, &ms, NULL, 4);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    runtime_run(rt);
+}
+
+static void pump_all(runtime_t **rts, size_t n, int rounds) {
+    for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < n; i++) pump_runtime(rts[i], 5);
+}
+
+/* In-process link between rts[a] (node a + 1) and rts[b] over a socketpair */
+static bool link_nodes(runtime_t **rts, size_t a, size_t b) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return false;
+    transport_t *ta = transport_tcp_from_fd(sv[0], (node_id_t)(b + 1));
+    transport_t *tb = transport_tcp_from_fd(sv[1], (node_id_t)(a + 1));
+    return ta && tb && runtime_add_transport(rts[a], ta) &&
+           runtime_add_transport(rts[b], tb);
+}
+
+static bool noop_behavior(runtime_t *rt, actor_t *self,
+                          message_t *msg, void *state) {
+    (void)rt; (void)self; (void)msg; (void)state;
+    return true;
+}
+
+/* ── Node event watcher ────────────────────────────────────────────── */
+
+typedef struct {
+    int       ups;
+    int       downs;
+    node_id_t last_down;
+} watcher_t;
+
+static bool watcher_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    watcher_t *w = state;
+    if (msg->type == MSG_INIT) {
+        actor_watch_nodes(rt);
+    } else if (msg->type == MSG_NODE_UP) {
+        w->ups++;
+    } else if (msg->type == MSG_NODE_DOWN) {
+        const node_event_payload_t *ev = msg->payload;
+        w->last_down = ev->node_id;
+        w->downs++;
+    }
+    return true;
+}
+
+static void start_watcher(runtime_t *rt, watcher_t *w) {
+    actor_id_t id = actor_spawn(rt, watcher_behavior, w, NULL, 16);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    pump_runtime(rt, 1);
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────── */
+
+static int test_silent_peer_declared_down(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    ns_actor_init(rts[0]);
+    ns_actor_init(rts[1]);
+    watcher_t w = {0};
+    start_watcher(rts[0], &w);
+    runtime_set_heartbeat(rts[0], 20, 150);
+    runtime_set_heartbeat(rts[1], 20, 150);
+
+    ASSERT(link_nodes(rts, 0, 1));
+    actor_id_t svc = actor_spawn(rts[1], noop_behavior, NULL, NULL, 4);
+    ASSERT(actor_register_name(rts[1], "b_svc", svc));
+    ASSERT(actor_register_name(rts[1], "/test/b_svc", svc));
+    pump_all(rts, 2, 4);
+    ASSERT_EQ(w.ups, 1);
+    ASSERT_EQ(actor_lookup(rts[0], "b_svc"), svc);
+    ASSERT_EQ(actor_lookup(rts[0], "/test/b_svc"), svc);
+
+    /* B stops answering: only A runs, so its heartbeats go unanswered */
+    pump_runtime(rts[0], 400);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(w.last_down, (node_id_t)NODE_B);
+    ASSERT_EQ(runtime_get_transport_count(rts[0]), 0u);
+    ASSERT_EQ(actor_lookup(rts[0], "b_svc"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(rts[0], "/test/b_svc"), ACTOR_ID_INVALID);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_heartbeats_keep_peer_alive(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    runtime_set_heartbeat(rts[0], 20, 150);
+    runtime_set_heartbeat(rts[1], 20, 150);
+    ASSERT(link_nodes(rts, 0, 1));
+
+    /* Both sides run but exchange no traffic of their own */
+    for (int i = 0; i < 20; i++) {
+        pump_runtime(rts[0], 10);
+        pump_runtime(rts[1], 10);
+    }
+    ASSERT_EQ(runtime_get_transport_count(rts[0]), 1u);
+    ASSERT_EQ(runtime_get_transport_count(rts[1]), 1u);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_quiet_peer_without_heartbeats_kept(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    runtime_set_heartbeat(rts[0], 20, 150);
+    runtime_set_heartbeat(rts[1], 0, 0);   /* like a build without them */
+    ASSERT(link_nodes(rts, 0, 1));
+    pump_all(rts, 2, 2);
+
+    /* B never beats, so its silence is not taken as death */
+    pump_runtime(rts[0], 400);
+    ASSERT_EQ(runtime_get_transport_count(rts[0]), 1u);
+
+    runtime_destroy(rts[0]);
+    runtime_destroy(rts[1]);
+    return 0;
+}
+
+static int test_closed_link_detected(void) {
+    runtime_t *rts[2] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256) };
+    watcher_t w = {0};
+    start_watcher(rts[0], &w);
+    runtime_set_heartbeat(rts[0], 0, 0);
+
+    ASSERT(link_nodes(rts, 0, 1));
+    pump_all(rts, 2, 2);
+    runtime_destroy(rts[1]);   /* closes B's end of the link */
+
+    pump_runtime(rts[0], 50);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(runtime_get_transport_count(rts[0]), 0u);
+
+    runtime_destroy(rts[0]);
+    return 0;
+}
+
+static int test_lost_gateway_reports_nodes_behind(void) {
+    runtime_t *rts[3] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256),
+                          runtime_init(NODE_C, 256) };
+    watcher_t w = {0};
+    start_watcher(rts[0], &w);
+    ASSERT(link_nodes(rts, 0, 1));
+    ASSERT(link_nodes(rts, 1, 2));
+    pump_all(rts, 3, 6);
+    ASSERT_EQ(w.ups, 2);   /* B directly, C through B */
+
+    /* B publishes a name for an actor on C, as a proxy would */
+    actor_id_t svc = actor_spawn(rts[2], noop_behavior, NULL, NULL, 4);
+    ASSERT(actor_register_name(rts[1], "c_svc", svc));
+    pump_all(rts, 3, 2);
+    ASSERT_EQ(actor_lookup(rts[0], "c_svc"), svc);
+
+    /* B loses C: A still reaches B but reports C down and drops its names */
+    ASSERT(runtime_remove_transport(rts[1], NODE_C));
+    pump_all(rts, 3, 4);
+    ASSERT_EQ(w.downs, 1);
+    ASSERT_EQ(w.last_down, (node_id_t)NODE_C);
+    ASSERT_EQ(actor_lookup(rts[0], "c_svc"), ACTOR_ID_INVALID);
+
+    for (int i = 0; i < 3; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+int main(void) {
+    printf("test_node_liveness:\n");
+    RUN_TEST(test_silent_peer_declared_down);
+    RUN_TEST(test_heartbeats_keep_peer_alive);
+    RUN_TEST(test_quiet_peer_without_heartbeats_kept);
+    RUN_TEST(test_closed_link_detected);
+    RUN_TEST(test_lost_gateway_reports_nodes_behind);
+    TEST_REPORT();
+}
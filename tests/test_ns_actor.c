@@ -4,6 +4,8 @@
 #include "microkernel/message.h"
 #include "microkernel/services.h"
 #include "microkernel/namespace.h"
+#include "microkernel/transport_tcp.h"
+#include <sys/socket.h>
 
 /* ── Helpers ────────────────────────────────────────────────────────── */
 
@@ -440,6 +442,349 @@ static int test_ns_list_paths_direct(void) {
     return 0;
 }
 
+/* ── Test 16: no fixed cap on the path table ───────────────────────── */
+
+static int test_many_paths(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    ns_actor_init(rt);
+
+    actor_id_t a = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    char path[NS_PATH_MAX];
+    for (int i = 0; i < 300; i++) {
+        snprintf(path, sizeof(path), "/bulk/g%d/svc%d", i % 7, i);
+        ASSERT(actor_register_name(rt, path, a));
+    }
+    for (int i = 0; i < 300; i++) {
+        snprintf(path, sizeof(path), "/bulk/g%d/svc%d", i % 7, i);
+        ASSERT_EQ(actor_lookup(rt, path), a);
+    }
+    /* Interior branches are not paths themselves */
+    ASSERT_EQ(actor_lookup(rt, "/bulk/g3"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(rt, "/bulk/g3/svc"), ACTOR_ID_INVALID);
+
+    /* Removing one keeps its siblings and cousins reachable */
+    ns_remove_path(rt, "/bulk/g3/svc3");
+    ASSERT_EQ(actor_lookup(rt, "/bulk/g3/svc3"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(rt, "/bulk/g3/svc10"), a);
+    ASSERT_EQ(actor_lookup(rt, "/bulk/g4/svc4"), a);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ── Test 17: longest mount wins, only on component boundaries ─────── */
+
+static int test_nested_mounts(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    ns_actor_init(rt);
+
+    actor_id_t outer = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    actor_id_t inner = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    actor_id_t local = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+
+    ns_mount_t mnt;
+    ns_reply_t reply;
+    memset(&mnt, 0, sizeof(mnt));
+    strncpy(mnt.mount_point, "/mnt", NS_PATH_MAX - 1);
+    mnt.target = outer;
+    ns_call(rt, MSG_NS_MOUNT, &mnt, sizeof(mnt), &reply);
+    ASSERT_EQ(reply.status, NS_OK);
+    strncpy(mnt.mount_point, "/mnt/deep/er", NS_PATH_MAX - 1);
+    mnt.target = inner;
+    ns_call(rt, MSG_NS_MOUNT, &mnt, sizeof(mnt), &reply);
+    ASSERT_EQ(reply.status, NS_OK);
+    ASSERT(actor_register_name(rt, "/mntx/svc", local));
+
+    ASSERT_EQ(actor_lookup(rt, "/mnt"), outer);
+    ASSERT_EQ(actor_lookup(rt, "/mnt/deep"), outer);
+    ASSERT_EQ(actor_lookup(rt, "/mnt/deep/erx"), outer);
+    ASSERT_EQ(actor_lookup(rt, "/mnt/deep/er"), inner);
+    ASSERT_EQ(actor_lookup(rt, "/mnt/deep/er/x/y"), inner);
+    ASSERT_EQ(actor_lookup(rt, "/mntx/svc"), local);
+
+    /* Unmounting the inner one falls back to the outer */
+    ns_umount_t um;
+    memset(&um, 0, sizeof(um));
+    strncpy(um.mount_point, "/mnt/deep/er", NS_PATH_MAX - 1);
+    ns_call(rt, MSG_NS_UMOUNT, &um, sizeof(um), &reply);
+    ASSERT_EQ(reply.status, NS_OK);
+    ASSERT_EQ(actor_lookup(rt, "/mnt/deep/er/x"), outer);
+    ns_call(rt, MSG_NS_UMOUNT, &um, sizeof(um), &reply);
+    ASSERT_EQ(reply.status, NS_ENOENT);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ── Test 18: listing is ordered and honours partial components ────── */
+
+static int test_list_ordered(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    ns_actor_init(rt);
+
+    actor_id_t a = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    actor_register_name(rt, "/svc/zeta", a);
+    actor_register_name(rt, "/svc/alpha/two", a);
+    actor_register_name(rt, "/svc/alpha", a);
+    actor_register_name(rt, "/svc/beta", a);
+    actor_register_name(rt, "/svcs/other", a);
+
+    char buf[512];
+    size_t n = ns_list_paths(rt, "/svc/", buf, sizeof(buf));
+    buf[n] = '\0';
+    char *p_alpha = strstr(buf, "/svc/alpha=");
+    char *p_two = strstr(buf, "/svc/alpha/two=");
+    char *p_beta = strstr(buf, "/svc/beta=");
+    char *p_zeta = strstr(buf, "/svc/zeta=");
+    ASSERT(p_alpha && p_two && p_beta && p_zeta);
+    ASSERT(p_alpha < p_two && p_two < p_beta && p_beta < p_zeta);
+    ASSERT(strstr(buf, "/svcs/") == NULL);
+
+    /* A prefix that ends inside a component still matches */
+    n = ns_list_paths(rt, "/svc/al", buf, sizeof(buf));
+    buf[n] = '\0';
+    ASSERT(strstr(buf, "/svc/alpha=") != NULL);
+    ASSERT(strstr(buf, "/svc/alpha/two=") != NULL);
+    ASSERT(strstr(buf, "/svc/beta=") == NULL);
+
+    n = ns_list_paths(rt, "/svc", buf, sizeof(buf));
+    buf[n] = '\0';
+    ASSERT(strstr(buf, "/svcs/other=") != NULL);
+
+    /* Removing a branch point keeps what hangs below it */
+    ns_remove_path(rt, "/svc/alpha");
+    ASSERT_EQ(actor_lookup(rt, "/svc/alpha"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(rt, "/svc/alpha/two"), a);
+    ASSERT(actor_register_name(rt, "/svc/alpha", a));
+    ASSERT(!actor_register_name(rt, "/svc/alpha", a));
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ── Test 19: name handles follow path and mount changes ──────────── */
+
+static int test_path_handle(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    ns_actor_init(rt);
+
+    actor_id_t kv = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    actor_id_t proxy = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    ASSERT(actor_register_name(rt, "/node/storage/kv", kv));
+
+    actor_name_handle_t h = actor_name_resolve(rt, "/node/storage/kv");
+    ASSERT_EQ(h.id, kv);
+
+    /* A mount over the path takes over the binding */
+    ns_mount_t mnt;
+    ns_reply_t reply;
+    memset(&mnt, 0, sizeof(mnt));
+    strncpy(mnt.mount_point, "/node/storage", NS_PATH_MAX - 1);
+    mnt.target = proxy;
+    ns_call(rt, MSG_NS_MOUNT, &mnt, sizeof(mnt), &reply);
+    ASSERT_EQ(reply.status, NS_OK);
+    ASSERT_EQ(actor_name_handle_id(rt, &h), proxy);
+
+    ns_umount_t um;
+    memset(&um, 0, sizeof(um));
+    strncpy(um.mount_point, "/node/storage", NS_PATH_MAX - 1);
+    ns_call(rt, MSG_NS_UMOUNT, &um, sizeof(um), &reply);
+    ASSERT_EQ(actor_name_handle_id(rt, &h), kv);
+
+    ns_remove_path(rt, "/node/storage/kv");
+    ASSERT_EQ(actor_name_handle_id(rt, &h), ACTOR_ID_INVALID);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ── Subscription helpers ──────────────────────────────────────────── */
+
+#define MSG_SUB_START 300
+#define MSG_SUB_STOP  301
+
+typedef struct {
+    actor_id_t  ns;            /* ACTOR_ID_INVALID = local */
+    const char *prefix;
+    uint32_t    flags;
+    int32_t     status;
+    int         replies;
+    int         batches;
+    int         events;
+    ns_notify_t last[8];       /* first 8 events received */
+} sub_state_t;
+
+static bool sub_behavior(runtime_t *rt, actor_t *self,
+                         message_t *msg, void *state) {
+    (void)self;
+    sub_state_t *ss = state;
+    if (msg->type == MSG_SUB_START) {
+        ns_subscribe(rt, ss->ns, ss->prefix, ss->flags);
+    } else if (msg->type == MSG_SUB_STOP) {
+        ns_unsubscribe(rt, ss->ns, ss->prefix);
+    } else if (msg->type == MSG_NS_REPLY) {
+        const ns_reply_t *r = msg->payload;
+        ss->status = r->status;
+        ss->replies++;
+    } else if (msg->type == MSG_NS_NOTIFY) {
+        const ns_notify_t *ev = msg->payload;
+        size_t n = msg->payload_size / sizeof(ns_notify_t);
+        for (size_t i = 0; i < n; i++, ss->events++)
+            if (ss->events < 8) ss->last[ss->events] = ev[i];
+        ss->batches++;
+    }
+    return true;
+}
+
+static void drain(runtime_t *rt) {
+    for (int i = 0; i < 50; i++) runtime_step(rt);
+}
+
+/* ── Test 20: register/unregister events arrive batched ────────────── */
+
+static int test_subscribe_batches(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    ns_actor_init(rt);
+
+    sub_state_t ss = { .ns = ACTOR_ID_INVALID, .prefix = "/svc/" };
+    actor_id_t sub = actor_spawn(rt, sub_behavior, &ss, NULL, 16);
+    actor_send(rt, sub, MSG_SUB_START, NULL, 0);
+    drain(rt);
+    ASSERT_EQ(ss.replies, 1);
+    ASSERT_EQ(ss.status, NS_OK);
+    ASSERT_EQ(ss.batches, 0);
+
+    actor_id_t a = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    ASSERT(actor_register_name(rt, "/svc/a", a));
+    ASSERT(actor_register_name(rt, "/other/x", a));
+    ASSERT(actor_register_name(rt, "/svc/b", a));
+    drain(rt);
+    ASSERT_EQ(ss.batches, 1);
+    ASSERT_EQ(ss.events, 2);
+    ASSERT_EQ(strcmp(ss.last[0].path, "/svc/a"), 0);
+    ASSERT_EQ(ss.last[0].event, NS_EVENT_REGISTER);
+    ASSERT_EQ(ss.last[0].actor_id, a);
+    ASSERT_EQ(strcmp(ss.last[1].path, "/svc/b"), 0);
+
+    /* The owner dies: both paths go in one batch */
+    actor_stop(rt, a);
+    drain(rt);
+    ASSERT_EQ(ss.batches, 2);
+    ASSERT_EQ(ss.events, 4);
+    ASSERT_EQ(ss.last[2].event, NS_EVENT_UNREGISTER);
+    ASSERT_EQ(ss.last[3].event, NS_EVENT_UNREGISTER);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ── Test 21: snapshot, mounts and unsubscribe ─────────────────────── */
+
+static int test_subscribe_snapshot(void) {
+    runtime_t *rt = runtime_init(0, 64);
+    ns_actor_init(rt);
+
+    actor_id_t a = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    actor_id_t proxy = actor_spawn(rt, noop_behavior, NULL, NULL, 16);
+    ASSERT(actor_register_name(rt, "/app/one", a));
+
+    ns_mount_t mnt;
+    ns_reply_t reply;
+    memset(&mnt, 0, sizeof(mnt));
+    strncpy(mnt.mount_point, "/app/remote", NS_PATH_MAX - 1);
+    mnt.target = proxy;
+    ns_call(rt, MSG_NS_MOUNT, &mnt, sizeof(mnt), &reply);
+    ASSERT_EQ(reply.status, NS_OK);
+
+    sub_state_t ss = { .ns = ACTOR_ID_INVALID, .prefix = "/app",
+                       .flags = NS_SUB_SNAPSHOT };
+    actor_id_t sub = actor_spawn(rt, sub_behavior, &ss, NULL, 16);
+    actor_send(rt, sub, MSG_SUB_START, NULL, 0);
+    drain(rt);
+    ASSERT_EQ(ss.events, 2);
+    ASSERT_EQ(ss.last[0].event, NS_EVENT_MOUNT);
+    ASSERT_EQ(ss.last[0].actor_id, proxy);
+    ASSERT_EQ(strcmp(ss.last[1].path, "/app/one"), 0);
+
+    /* Subscribing twice to the same prefix is refused */
+    actor_send(rt, sub, MSG_SUB_START, NULL, 0);
+    drain(rt);
+    ASSERT_EQ(ss.status, NS_EEXIST);
+
+    ns_umount_t um;
+    memset(&um, 0, sizeof(um));
+    strncpy(um.mount_point, "/app/remote", NS_PATH_MAX - 1);
+    ns_call(rt, MSG_NS_UMOUNT, &um, sizeof(um), &reply);
+    drain(rt);
+    ASSERT_EQ(ss.events, 3);
+    ASSERT_EQ(ss.last[2].event, NS_EVENT_UMOUNT);
+    ASSERT_EQ(ss.last[2].actor_id, proxy);
+
+    actor_send(rt, sub, MSG_SUB_STOP, NULL, 0);
+    drain(rt);
+    ASSERT_EQ(ss.status, NS_OK);
+    ns_remove_path(rt, "/app/one");
+    drain(rt);
+    ASSERT_EQ(ss.events, 3);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ── Test 22: a subscriber on another node ─────────────────────────── */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self; (void)state;
+    if (msg->type == 1) {
+        actor_set_timer(rt, 5, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_pair(runtime_t *a, runtime_t *b, int rounds) {
+    for (int r = 0; r < rounds; r++) {
+        runtime_t *rts[2] = { a, b };
+        for (int i = 0; i < 2; i++) {
+            actor_id_t id = actor_spawn(rts[i], stopper_behavior,
+                                        NULL, NULL, 4);
+            actor_send(rts[i], id, 1, NULL, 0);
+            runtime_run(rts[i]);
+        }
+    }
+}
+
+static int test_subscribe_remote(void) {
+    runtime_t *a = runtime_init(1, 64);
+    runtime_t *b = runtime_init(2, 64);
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+    ASSERT(runtime_add_transport(a, transport_tcp_from_fd(sv[0], 2)));
+    ASSERT(runtime_add_transport(b, transport_tcp_from_fd(sv[1], 1)));
+    actor_id_t ns_b = ns_actor_init(b);
+
+    sub_state_t ss = { .ns = ns_b, .prefix = "/dev/" };
+    actor_id_t sub = actor_spawn(a, sub_behavior, &ss, NULL, 16);
+    actor_send(a, sub, MSG_SUB_START, NULL, 0);
+    pump_pair(a, b, 3);
+    ASSERT_EQ(ss.status, NS_OK);
+
+    actor_id_t led = actor_spawn(b, noop_behavior, NULL, NULL, 16);
+    ASSERT(ns_register_path(b, "/dev/led", led) == NS_OK);
+    pump_pair(a, b, 3);
+    ASSERT_EQ(ss.events, 1);
+    ASSERT_EQ(ss.last[0].actor_id, led);
+
+    runtime_destroy(a);
+    runtime_destroy(b);
+    return 0;
+}
+
 /* ── main ──────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -459,5 +804,12 @@ int main(void) {
     RUN_TEST(test_path_cleanup_on_death);
     RUN_TEST(test_node_identity_registered);
     RUN_TEST(test_ns_list_paths_direct);
+    RUN_TEST(test_many_paths);
+    RUN_TEST(test_nested_mounts);
+    RUN_TEST(test_list_ordered);
+    RUN_TEST(test_path_handle);
+    RUN_TEST(test_subscribe_batches);
+    RUN_TEST(test_subscribe_snapshot);
+    RUN_TEST(test_subscribe_remote);
     TEST_REPORT();
 }
@@ -6,8 +6,14 @@
 #include "microkernel/message.h"
 #include "microkernel/services.h"
 #include "microkernel/namespace.h"
+#include "microkernel/wire.h"
+#include "router.h"
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 #include <string.h>
 
 #define TEST_PORT 19897
@@ -416,12 +422,17 @@ static bool bidir_b_behavior(runtime_t *rt, actor_t *self,
     bidir_b_state_t *s = state;
 
     if (msg->type == MSG_INIT || msg->type == MSG_TIMER) {
+        if (s->found_a) {
+            runtime_stop(rt);
+            return false;
+        }
         actor_id_t id = actor_lookup(rt, "/test/a_svc");
         s->polls++;
         if (id != ACTOR_ID_INVALID) {
+            /* Stay connected a while: A purges our paths when we go */
             s->found_a = true;
-            runtime_stop(rt);
-            return false;
+            actor_set_timer(rt, 300, false);
+            return true;
         }
         if (s->polls < 200) {
             actor_set_timer(rt, 10, false);
@@ -534,6 +545,291 @@ static int test_bidirectional_path_sync(void) {
     return 0;
 }
 
+/* ══════════════════════════════════════════════════════════════════════
+ *  Test 4: Wire version negotiation with a raw-socket peer
+ *
+ *  A hand-rolled peer speaks the mount hello directly.  A v1 peer (zeroed
+ *  wire_version) must get 28-byte framing; a v2 peer gets compact framing.
+ * ══════════════════════════════════════════════════════════════════════ */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                              message_t *msg, void *state) {
+    (void)self;
+    if (msg->type == MSG_INIT) {
+        actor_set_timer(rt, *(int *)state, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_runtime(runtime_t *rt, int ms) {
+    actor_id_t id = actor_spawn(rt, stopper_behavior, &ms, NULL, 4);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    runtime_run(rt);
+}
+
+static int run_hello_peer(uint16_t port, uint8_t peer_version) {
+    runtime_t *rt = runtime_init(NODE_A, 32);
+    ASSERT_NOT_NULL(rt);
+    ns_actor_init(rt);
+    ASSERT_NE(ns_mount_listen(rt, port), ACTOR_ID_INVALID);
+    pump_runtime(rt, 20);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT(fd >= 0);
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(connect(fd, (struct sockaddr *)&addr, sizeof(addr)), 0);
+
+    mount_hello_t hello;
+    memset(&hello, 0, sizeof(hello));
+    hello.magic = htonl(MOUNT_HELLO_MAGIC);
+    hello.node_id = htonl(NODE_B);
+    snprintf(hello.identity, sizeof(hello.identity), "raw-peer");
+    hello.wire_version = peer_version;
+    ASSERT_EQ(send(fd, &hello, sizeof(hello), 0), (ssize_t)sizeof(hello));
+
+    pump_runtime(rt, 50);
+
+    mount_hello_t reply;
+    ASSERT_EQ(recv(fd, &reply, sizeof(reply), MSG_WAITALL),
+              (ssize_t)sizeof(reply));
+    ASSERT_EQ(ntohl(reply.magic), (uint32_t)MOUNT_HELLO_MAGIC);
+    ASSERT_EQ(reply.wire_version, WIRE_VERSION_MAX);
+    ASSERT(reply.features & MOUNT_FEATURE_COMPRESS);
+
+    /* First synced frame is the "ns" name registration */
+    uint8_t frame[WIRE_HEADER_SIZE];
+    ASSERT_EQ(recv(fd, frame, sizeof(frame), MSG_WAITALL),
+              (ssize_t)sizeof(frame));
+    if (peer_version >= WIRE_VERSION_2) {
+        wire_v2_header_t hdr;
+        ASSERT(wire_v2_decode_header(frame, sizeof(frame), &hdr) > 0);
+        ASSERT_EQ(hdr.type, MSG_NAME_REGISTER);
+    } else {
+        const wire_header_t *hdr = (const wire_header_t *)frame;
+        ASSERT_EQ(ntohl(hdr->type), MSG_NAME_REGISTER);
+        ASSERT_EQ(ntohl(hdr->payload_size),
+                  (uint32_t)sizeof(name_register_payload_t));
+    }
+
+    /* Register a name from the raw peer in its own framing */
+    name_register_payload_t reg;
+    memset(&reg, 0, sizeof(reg));
+    snprintf(reg.name, sizeof(reg.name), "raw_svc");
+    reg.actor_id = actor_id_make(NODE_B, 5);
+    message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                                    MSG_NAME_REGISTER, &reg, sizeof(reg));
+    ASSERT_NOT_NULL(msg);
+    size_t wire_size;
+    void *buf = (peer_version >= WIRE_VERSION_2)
+        ? wire_serialize_v2(msg, &wire_size)
+        : wire_serialize_net(msg, &wire_size);
+    message_destroy(msg);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_EQ(send(fd, buf, wire_size, 0), (ssize_t)wire_size);
+    free(buf);
+
+    pump_runtime(rt, 50);
+    ASSERT_EQ(actor_lookup(rt, "raw_svc"), actor_id_make(NODE_B, 5));
+
+    close(fd);
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_mount_hello_v1_peer(void) {
+    return run_hello_peer(TEST_PORT + 3, 0);
+}
+
+static int test_mount_hello_v2_peer(void) {
+    return run_hello_peer(TEST_PORT + 4, WIRE_VERSION_2);
+}
+
+/* ══════════════════════════════════════════════════════════════════════
+ *  Test 5: Node ID collisions
+ *
+ *  A second peer claiming a node ID already held by a connected peer with
+ *  a different identity is refused; the same identity may reconnect.
+ *  The same holds once the node is only reachable through a gateway.
+ * ══════════════════════════════════════════════════════════════════════ */
+
+/* Send a hello; returns the fd if the listener answered, else -1 */
+static int raw_hello(runtime_t *rt, uint16_t port, node_id_t node,
+                     const char *identity) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    mount_hello_t hello;
+    memset(&hello, 0, sizeof(hello));
+    hello.magic = htonl(MOUNT_HELLO_MAGIC);
+    hello.node_id = htonl(node);
+    snprintf(hello.identity, sizeof(hello.identity), "%s", identity);
+    send(fd, &hello, sizeof(hello), 0);
+
+    pump_runtime(rt, 50);
+
+    mount_hello_t reply;
+    if (recv(fd, &reply, sizeof(reply), MSG_WAITALL) != (ssize_t)sizeof(reply)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int test_mount_node_id_collision(void) {
+    uint16_t port = TEST_PORT + 5;
+    node_id_t big = 0xC0FFEE01u;   /* full 32-bit IDs route too */
+
+    runtime_t *rt = runtime_init(NODE_A, 32);
+    ASSERT_NOT_NULL(rt);
+    ns_actor_init(rt);
+    ASSERT_NE(ns_mount_listen(rt, port), ACTOR_ID_INVALID);
+    pump_runtime(rt, 20);
+
+    int first = raw_hello(rt, port, big, "peer-one");
+    ASSERT(first >= 0);
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)1);
+
+    ASSERT_EQ(raw_hello(rt, port, big, "peer-two"), -1);
+    ASSERT_EQ(raw_hello(rt, port, NODE_A, "impostor"), -1);
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)1);
+
+    /* Same identity reconnecting takes over the node ID */
+    int again = raw_hello(rt, port, big, "peer-one");
+    ASSERT(again >= 0);
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)1);
+
+    /* Drop the direct link and reach the node through a gateway */
+    ASSERT(runtime_remove_transport(rt, big));
+    node_id_t gw_node = 0xC0FFEE02u;
+    int gw_fd = raw_hello(rt, port, gw_node, "gateway");
+    ASSERT(gw_fd >= 0);
+    transport_t *gw = transport_tcp_from_fd(gw_fd, NODE_A);
+    ASSERT_NOT_NULL(gw);
+    route_advert_entry_t advert = { big, 1 };
+    message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                                    MSG_ROUTE_ADVERT, &advert, sizeof(advert));
+    ASSERT(gw->send(gw, msg));
+    message_destroy(msg);
+    pump_runtime(rt, 50);
+    node_id_t hop = 0;
+    ASSERT(runtime_get_route(rt, big, &hop, NULL));
+    ASSERT_EQ(hop, gw_node);
+
+    ASSERT_EQ(raw_hello(rt, port, big, "peer-two"), -1);
+    int direct = raw_hello(rt, port, big, "peer-one");
+    ASSERT(direct >= 0);
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)2);
+
+    close(first);
+    close(again);
+    close(direct);
+    gw->destroy(gw);
+    runtime_destroy(rt);
+    return 0;
+}
+
+/* ══════════════════════════════════════════════════════════════════════
+ *  Test 6: Reconnect after a dropped mount
+ *
+ *  Node B mounts node A.  A drops the link; B notices the close, and its
+ *  mount keeper dials A again.  A sees node B come up a second time.
+ * ══════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    int ups;
+    int downs;
+} reconnect_state_t;
+
+static bool reconnect_watcher(runtime_t *rt, actor_t *self,
+                              message_t *msg, void *state) {
+    (void)self;
+    reconnect_state_t *s = state;
+    if (msg->type == MSG_INIT) {
+        actor_watch_nodes(rt);
+    } else if (msg->type == MSG_NODE_UP) {
+        if (++s->ups == 1) {
+            actor_set_timer(rt, 100, false);
+        } else {
+            runtime_stop(rt);
+            return false;
+        }
+    } else if (msg->type == MSG_NODE_DOWN) {
+        s->downs++;
+    } else if (msg->type == MSG_TIMER) {
+        runtime_remove_transport(rt, NODE_B);   /* drop the link */
+    }
+    return true;
+}
+
+static int run_node_b_reconnect(uint16_t port) {
+    alarm(5);
+    usleep(50000);
+
+    runtime_t *rt = runtime_init(NODE_B, 64);
+    if (!rt) return 1;
+    ns_actor_init(rt);
+    if (ns_mount_connect(rt, "127.0.0.1", port, NULL) != 0) {
+        runtime_destroy(rt);
+        return 1;
+    }
+    pump_runtime(rt, 1500);
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_mount_reconnect(void) {
+    uint16_t port = TEST_PORT + 6;
+
+    runtime_t *rt = runtime_init(NODE_A, 64);
+    ASSERT_NOT_NULL(rt);
+    ns_actor_init(rt);
+    ASSERT_NE(ns_mount_listen(rt, port), ACTOR_ID_INVALID);
+
+    reconnect_state_t state = {0};
+    actor_id_t watcher = actor_spawn(rt, reconnect_watcher, &state, NULL, 16);
+    ASSERT_NE(watcher, ACTOR_ID_INVALID);
+    actor_send(rt, watcher, MSG_INIT, NULL, 0);
+
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+    if (child == 0) _exit(run_node_b_reconnect(port));
+
+    alarm(5);
+    runtime_run(rt);
+
+    int wstatus;
+    waitpid(child, &wstatus, 0);
+    alarm(0);
+
+    ASSERT_EQ(state.ups, 2);
+    ASSERT_EQ(state.downs, 1);
+    ASSERT(WIFEXITED(wstatus));
+    ASSERT_EQ(WEXITSTATUS(wstatus), 0);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
 /* ══════════════════════════════════════════════════════════════════════ */
 
 int main(void) {
@@ -541,5 +837,9 @@ int main(void) {
     RUN_TEST(test_path_sync_on_mount);
     RUN_TEST(test_remote_send_via_path);
     RUN_TEST(test_bidirectional_path_sync);
+    RUN_TEST(test_mount_hello_v1_peer);
+    RUN_TEST(test_mount_hello_v2_peer);
+    RUN_TEST(test_mount_node_id_collision);
+    RUN_TEST(test_mount_reconnect);
     TEST_REPORT();
 }
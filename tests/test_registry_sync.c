@@ -0,0 +1,413 @@
+#define _DEFAULT_SOURCE
+#include "test_framework.h"
+#include "microkernel/runtime.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include "microkernel/namespace.h"
+#include "microkernel/wire.h"
+#include "runtime_internal.h"
+#include "hash_ring.h"
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define NODE_A 1
+#define NODE_B 2
+#define NODE_C 3
+#define MSG_INIT 202
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    if (msg->type == MSG_INIT) {
+        actor_set_timer(rt, *(int *)state, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_runtime(runtime_t *rt, int ms) {
+    actor_id_t id = actor_spawn(rt, stopper_behavior, &ms, NULL, 4);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    runtime_run(rt);
+}
+
+static void pump_pair(runtime_t *a, runtime_t *b, int rounds) {
+    for (int r = 0; r < rounds; r++) {
+        pump_runtime(a, 5);
+        pump_runtime(b, 5);
+    }
+}
+
+static void pump_all(runtime_t **rts, size_t n, int rounds) {
+    for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < n; i++) pump_runtime(rts[i], 5);
+}
+
+static bool idle_behavior(runtime_t *rt, actor_t *self,
+                          message_t *msg, void *state) {
+    (void)rt; (void)self; (void)msg; (void)state;
+    return true;
+}
+
+/* In-process link between two runtimes over a socketpair */
+static bool link_pair(runtime_t *a, runtime_t *b, transport_t **ta,
+                      transport_t **tb) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return false;
+    *ta = transport_tcp_from_fd(sv[0], NODE_B);
+    *tb = transport_tcp_from_fd(sv[1], NODE_A);
+    return *ta && *tb && runtime_add_transport(a, *ta) &&
+           runtime_add_transport(b, *tb);
+}
+
+/* Next frame on a raw v1 socket, or NULL if nothing is waiting */
+static message_t *read_frame(int fd) {
+    uint8_t hdr[WIRE_HEADER_SIZE];
+    if (recv(fd, hdr, sizeof(hdr), MSG_DONTWAIT) != (ssize_t)sizeof(hdr))
+        return NULL;
+    wire_header_t h;
+    wire_header_from_net(hdr, &h);
+    uint8_t *buf = malloc(sizeof(hdr) + h.payload_size);
+    memcpy(buf, hdr, sizeof(hdr));
+    if (h.payload_size &&
+        recv(fd, buf + sizeof(hdr), h.payload_size, MSG_WAITALL) !=
+            (ssize_t)h.payload_size) {
+        free(buf);
+        return NULL;
+    }
+    message_t *msg = wire_deserialize_net(buf, sizeof(hdr) + h.payload_size);
+    free(buf);
+    return msg;
+}
+
+static bool write_frame(int fd, msg_type_t type, const void *payload,
+                        size_t size) {
+    message_t *msg = message_create(ACTOR_ID_INVALID, ACTOR_ID_INVALID,
+                                    type, payload, size);
+    size_t len;
+    void *buf = wire_serialize_net(msg, &len);
+    message_destroy(msg);
+    bool ok = buf && send(fd, buf, len, 0) == (ssize_t)len;
+    free(buf);
+    return ok;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────── */
+
+static int test_delta_codec(void) {
+    registry_batch_t b = {0};
+    ASSERT(registry_batch_add(&b, REGISTRY_NAME_ADD, "svc",
+                              actor_id_make(NODE_A, 3)));
+    ASSERT(registry_batch_add(&b, REGISTRY_PATH_DEL, "/node/x/svc",
+                              ACTOR_ID_INVALID));
+    ASSERT(!registry_batch_add(&b, REGISTRY_NAME_ADD, "", 1));
+    ASSERT_EQ(b.len, 2 * sizeof(registry_delta_entry_t) + 3 + 11);
+
+    registry_op_t op;
+    char key[NS_PATH_MAX];
+    actor_id_t id;
+    size_t pos = 0;
+    ASSERT(registry_delta_next(b.buf, b.len, &pos, &op, key, &id));
+    ASSERT_EQ(op, REGISTRY_NAME_ADD);
+    ASSERT(strcmp(key, "svc") == 0);
+    ASSERT_EQ(id, actor_id_make(NODE_A, 3));
+    ASSERT(registry_delta_next(b.buf, b.len, &pos, &op, key, &id));
+    ASSERT_EQ(op, REGISTRY_PATH_DEL);
+    ASSERT(strcmp(key, "/node/x/svc") == 0);
+    ASSERT(!registry_delta_next(b.buf, b.len, &pos, &op, key, &id));
+
+    /* A truncated entry is refused */
+    pos = 0;
+    ASSERT(!registry_delta_next(b.buf, sizeof(registry_delta_entry_t) + 2,
+                                &pos, &op, key, &id));
+
+    /* The batch reports when a message would overflow */
+    ASSERT(!registry_batch_full(&b, 10));
+    ASSERT(registry_batch_full(&b, MK_REGISTRY_DELTA_MAX));
+
+    /* Adding and removing a binding leaves the digest as it was */
+    registry_digest_t d = {0}, zero = {0};
+    registry_digest_toggle(&d, "svc", 42);
+    ASSERT(memcmp(&d, &zero, sizeof(d)) != 0);
+    registry_digest_toggle(&d, "svc", 42);
+    ASSERT(memcmp(&d, &zero, sizeof(d)) == 0);
+
+    registry_batch_free(&b);
+    return 0;
+}
+
+static int test_batched_propagation(void) {
+    runtime_t *a = runtime_init(NODE_A, 64);
+    runtime_t *b = runtime_init(NODE_B, 64);
+    ns_actor_init(a);
+    ns_actor_init(b);
+    transport_t *ta, *tb;
+    ASSERT(link_pair(a, b, &ta, &tb));
+
+    actor_id_t svc = actor_spawn(a, idle_behavior, NULL, NULL, 4);
+    char name[32];
+    for (int i = 0; i < 40; i++) {
+        snprintf(name, sizeof(name), "svc%d", i);
+        ASSERT(actor_register_name(a, name, svc));
+    }
+    ASSERT(actor_register_name(a, "/svc/batched", svc));
+    pump_pair(a, b, 3);
+
+    for (int i = 0; i < 40; i++) {
+        snprintf(name, sizeof(name), "svc%d", i);
+        ASSERT_EQ(actor_lookup(b, name), svc);
+    }
+    ASSERT_EQ(actor_lookup(b, "/svc/batched"), svc);
+
+    /* Its death unbinds every name and path on the peer too */
+    actor_stop(a, svc);
+    pump_pair(a, b, 3);
+    ASSERT_EQ(actor_lookup(b, "svc0"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(b, "svc39"), ACTOR_ID_INVALID);
+    ASSERT_EQ(actor_lookup(b, "/svc/batched"), ACTOR_ID_INVALID);
+
+    runtime_destroy(a);
+    runtime_destroy(b);
+    return 0;
+}
+
+static int test_digest_repair(void) {
+    runtime_t *a = runtime_init(NODE_A, 64);
+    runtime_t *b = runtime_init(NODE_B, 64);
+    actor_id_t x = actor_spawn(a, idle_behavior, NULL, NULL, 4);
+    actor_id_t y = actor_spawn(b, idle_behavior, NULL, NULL, 4);
+
+    /* Bindings made while apart, plus one both already agree on */
+    ASSERT(actor_register_name(a, "only_a", x));
+    ASSERT(actor_register_name(b, "only_b", y));
+    ASSERT(name_registry_insert(a, "shared", x));
+    ASSERT(name_registry_insert(b, "shared", x));
+    ASSERT(memcmp(&runtime_get_name_registry(a)->digest,
+                  &runtime_get_name_registry(b)->digest,
+                  sizeof(registry_digest_t)) != 0);
+
+    transport_t *ta, *tb;
+    ASSERT(link_pair(a, b, &ta, &tb));
+    runtime_send_registry_digest(a, ta);
+    runtime_send_registry_digest(b, tb);
+    pump_pair(a, b, 3);
+
+    ASSERT_EQ(actor_lookup(a, "only_b"), y);
+    ASSERT_EQ(actor_lookup(b, "only_a"), x);
+    ASSERT(memcmp(&runtime_get_name_registry(a)->digest,
+                  &runtime_get_name_registry(b)->digest,
+                  sizeof(registry_digest_t)) == 0);
+
+    runtime_destroy(a);
+    runtime_destroy(b);
+    return 0;
+}
+
+static int test_digest_sends_only_differences(void) {
+    runtime_t *rt = runtime_init(NODE_A, 64);
+    runtime_set_heartbeat(rt, 0, 0);
+    actor_id_t x = actor_spawn(rt, idle_behavior, NULL, NULL, 4);
+    char name[32];
+    for (int i = 0; i < 10; i++) {
+        snprintf(name, sizeof(name), "n%d", i);
+        ASSERT(actor_register_name(rt, name, x));
+    }
+
+    int sv[2];
+    ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    ASSERT(runtime_add_transport(rt, transport_tcp_from_fd(sv[0], NODE_B)));
+    pump_runtime(rt, 5);
+    message_t *m;
+    while ((m = read_frame(sv[1])) != NULL) message_destroy(m);
+
+    /* A peer that already agrees gets nothing back */
+    registry_digest_t d = runtime_get_name_registry(rt)->digest;
+    ASSERT(write_frame(sv[1], MSG_REGISTRY_DIGEST, &d, sizeof(d)));
+    pump_runtime(rt, 5);
+    m = read_frame(sv[1]);
+    ASSERT(m == NULL);
+
+    /* One that lacks a single name gets one small delta */
+    registry_digest_toggle(&d, "n7", x);
+    ASSERT(write_frame(sv[1], MSG_REGISTRY_DIGEST, &d, sizeof(d)));
+    pump_runtime(rt, 5);
+    m = read_frame(sv[1]);
+    ASSERT_NOT_NULL(m);
+    ASSERT_EQ(m->type, MSG_REGISTRY_DELTA);
+    size_t pos = 0, entries = 0;
+    bool saw_n7 = false;
+    registry_op_t op;
+    char key[NS_PATH_MAX];
+    actor_id_t id;
+    while (registry_delta_next(m->payload, m->payload_size, &pos,
+                               &op, key, &id)) {
+        ASSERT_EQ(registry_bucket(key), registry_bucket("n7"));
+        if (strcmp(key, "n7") == 0) saw_n7 = true;
+        entries++;
+    }
+    ASSERT(saw_n7);
+    ASSERT(entries < 10);
+    message_destroy(m);
+
+    close(sv[1]);
+    runtime_destroy(rt);
+    return 0;
+}
+
+static int test_ring_owner(void) {
+    hash_ring_t r = {0};
+    ASSERT_EQ(hash_ring_owner(&r, "x"), (node_id_t)0);
+    node_id_t three[] = { 3, 1, 2 };
+    ASSERT(hash_ring_build(&r, three, 3));
+    node_id_t same[] = { 1, 2, 3 };
+    ASSERT(!hash_ring_build(&r, same, 3));
+
+    enum { KEYS = 3000 };
+    node_id_t before[KEYS];
+    int per_node[4] = {0};
+    char key[16];
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        before[i] = hash_ring_owner(&r, key);
+        ASSERT(before[i] >= 1 && before[i] <= 3);
+        per_node[before[i]]++;
+    }
+    for (int n = 1; n <= 3; n++) ASSERT(per_node[n] > KEYS / 6);
+
+    /* Losing node 3 only moves the keys it owned */
+    node_id_t two[] = { 1, 2 };
+    ASSERT(hash_ring_build(&r, two, 2));
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        node_id_t now = hash_ring_owner(&r, key);
+        if (before[i] != 3) ASSERT_EQ(now, before[i]);
+        else ASSERT(now == 1 || now == 2);
+    }
+    hash_ring_free(&r);
+    return 0;
+}
+
+typedef struct {
+    char       name[64];
+    int        answers;
+    actor_id_t id;
+} asker_t;
+
+static bool asker_behavior(runtime_t *rt, actor_t *self,
+                           message_t *msg, void *state) {
+    (void)self;
+    asker_t *a = state;
+    if (msg->type == MSG_INIT) {
+        actor_resolve_name(rt, a->name);
+    } else if (msg->type == MSG_NAME_RESOLVED) {
+        const name_register_payload_t *p = msg->payload;
+        a->id = p->actor_id;
+        a->answers++;
+    }
+    return true;
+}
+
+/* Where the name lives according to node `from`'s ring */
+static runtime_t *owner_of(runtime_t **rts, runtime_t *from,
+                           const char *name) {
+    return rts[runtime_name_owner(from, name) - 1];
+}
+
+static int test_partitioned_registry(void) {
+    enum { NAMES = 30 };
+    runtime_t *rts[3];
+    for (int i = 0; i < 3; i++) {
+        rts[i] = runtime_init((node_id_t)(i + 1), 64);
+        runtime_set_registry_partitioned(rts[i], true);
+    }
+    transport_t *ta, *tb;
+    ASSERT(link_pair(rts[0], rts[1], &ta, &tb));
+    int sv[2];
+    for (int pair = 0; pair < 2; pair++) {
+        /* C links to A and to B */
+        ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        ASSERT(runtime_add_transport(rts[2],
+                                     transport_tcp_from_fd(sv[0], pair + 1)));
+        ASSERT(runtime_add_transport(rts[pair],
+                                     transport_tcp_from_fd(sv[1], NODE_C)));
+    }
+
+    actor_id_t ids[3];
+    char name[32];
+    for (int i = 0; i < 3; i++) {
+        ids[i] = actor_spawn(rts[i], idle_behavior, NULL, NULL, 4);
+        for (int k = 0; k < NAMES; k++) {
+            snprintf(name, sizeof(name), "n%d_%d", i, k);
+            ASSERT(actor_register_name(rts[i], name, ids[i]));
+        }
+    }
+    pump_all(rts, 3, 3);
+
+    /* Every name is held by its owner; nobody holds them all */
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < NAMES; k++) {
+            snprintf(name, sizeof(name), "n%d_%d", i, k);
+            ASSERT_EQ(actor_lookup(owner_of(rts, rts[i], name), name), ids[i]);
+        }
+        ASSERT(runtime_get_name_registry(rts[i])->live < 3 * NAMES - 10);
+    }
+
+    /* A name held elsewhere is fetched from its owner and cached */
+    int k = 0;
+    do snprintf(name, sizeof(name), "n2_%d", k++);
+    while (owner_of(rts, rts[0], name) != rts[1]);
+    ASSERT_EQ(actor_lookup(rts[0], name), ACTOR_ID_INVALID);
+    asker_t a = {0};
+    snprintf(a.name, sizeof(a.name), "%s", name);
+    actor_id_t asker = actor_spawn(rts[0], asker_behavior, &a, NULL, 8);
+    actor_send(rts[0], asker, MSG_INIT, NULL, 0);
+    pump_all(rts, 3, 3);
+    ASSERT_EQ(a.answers, 1);
+    ASSERT_EQ(a.id, ids[2]);
+    ASSERT_EQ(actor_lookup(rts[0], name), ids[2]);
+
+    /* Unbound names answer ACTOR_ID_INVALID */
+    asker_t none = { .name = "nobody" };
+    asker = actor_spawn(rts[0], asker_behavior, &none, NULL, 8);
+    actor_send(rts[0], asker, MSG_INIT, NULL, 0);
+    pump_all(rts, 3, 3);
+    ASSERT_EQ(none.answers, 1);
+    ASSERT_EQ(none.id, ACTOR_ID_INVALID);
+
+    /* C leaves: cached answers go, and A's and B's names move to
+       whichever of them owns them now */
+    ASSERT(runtime_remove_transport(rts[0], NODE_C));
+    ASSERT(runtime_remove_transport(rts[1], NODE_C));
+    pump_all(rts, 2, 3);
+    ASSERT_EQ(actor_lookup(rts[0], name), ACTOR_ID_INVALID);
+    for (int i = 0; i < 2; i++) {
+        for (int n = 0; n < NAMES; n++) {
+            snprintf(name, sizeof(name), "n%d_%d", i, n);
+            runtime_t *owner = owner_of(rts, rts[i], name);
+            ASSERT(owner != rts[2]);
+            ASSERT_EQ(actor_lookup(owner, name), ids[i]);
+        }
+    }
+
+    for (int i = 0; i < 3; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+int main(void) {
+    printf("test_registry_sync:\n");
+    RUN_TEST(test_delta_codec);
+    RUN_TEST(test_batched_propagation);
+    RUN_TEST(test_digest_repair);
+    RUN_TEST(test_digest_sends_only_differences);
+    RUN_TEST(test_ring_owner);
+    RUN_TEST(test_partitioned_registry);
+    TEST_REPORT();
+}
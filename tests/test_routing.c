@@ -0,0 +1,187 @@
+#define _DEFAULT_SOURCE
+#include "test_framework.h"
+#include "microkernel/runtime.h"
+#include "microkernel/transport_tcp.h"
+#include "microkernel/actor.h"
+#include "microkernel/message.h"
+#include "microkernel/services.h"
+#include <sys/socket.h>
+
+#define NODE_A 1
+#define NODE_B 2
+#define NODE_C 3
+#define NODE_D 4
+#define MSG_PING 200
+#define MSG_PONG 201
+#define MSG_INIT 202
+
+/* ── Helpers ───────────────────────────────────────────────────────── */
+
+static bool stopper_behavior(runtime_t *rt, actor_t *self,
+                             message_t *msg, void *state) {
+    (void)self;
+    if (msg->type == MSG_INIT) {
+        actor_set_timer(rt, *(int *)state, false);
+        return true;
+    }
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
+static void pump_runtime(runtime_t *rt, int ms) {
+    actor_id_t id = actor_spawn(rt, stopper_behavior, &ms, NULL, 4);
+    actor_send(rt, id, MSG_INIT, NULL, 0);
+    runtime_run(rt);
+}
+
+/* Round-robin the runtimes so adverts and messages cross every link */
+static void pump_all(runtime_t **rts, size_t n, int rounds) {
+    for (int r = 0; r < rounds; r++)
+        for (size_t i = 0; i < n; i++) pump_runtime(rts[i], 5);
+}
+
+/* In-process link between rts[a] (node a + 1) and rts[b] over a socketpair */
+static bool link_nodes(runtime_t **rts, size_t a, size_t b) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return false;
+    transport_t *ta = transport_tcp_from_fd(sv[0], (node_id_t)(b + 1));
+    transport_t *tb = transport_tcp_from_fd(sv[1], (node_id_t)(a + 1));
+    return ta && tb && runtime_add_transport(rts[a], ta) &&
+           runtime_add_transport(rts[b], tb);
+}
+
+/* ── Echo / collector actors ───────────────────────────────────────── */
+
+static bool echo_behavior(runtime_t *rt, actor_t *self,
+                          message_t *msg, void *state) {
+    (void)self; (void)state;
+    if (msg->type == MSG_PING)
+        actor_send(rt, msg->source, MSG_PONG, msg->payload, msg->payload_size);
+    return true;
+}
+
+typedef struct {
+    actor_id_t target;
+    int        pongs;
+    uint32_t   last;
+} pinger_t;
+
+static bool pinger_behavior(runtime_t *rt, actor_t *self,
+                            message_t *msg, void *state) {
+    (void)self;
+    pinger_t *p = state;
+    if (msg->type == MSG_INIT) {
+        uint32_t v = 42;
+        actor_send(rt, p->target, MSG_PING, &v, sizeof(v));
+    } else if (msg->type == MSG_PONG && msg->payload_size == sizeof(uint32_t)) {
+        memcpy(&p->last, msg->payload, sizeof(p->last));
+        p->pongs++;
+    }
+    return true;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────── */
+
+static int test_two_hop_delivery(void) {
+    runtime_t *rts[3] = { runtime_init(NODE_A, 256), runtime_init(NODE_B, 256),
+                          runtime_init(NODE_C, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    ASSERT(link_nodes(rts, 1, 2));
+    pump_all(rts, 3, 6);
+
+    /* A and C learn each other through B */
+    node_id_t hop;
+    uint32_t metric;
+    ASSERT(runtime_get_route(rts[0], NODE_C, &hop, &metric));
+    ASSERT_EQ(hop, (node_id_t)NODE_B);
+    ASSERT_EQ(metric, 2u);
+    ASSERT(runtime_get_route(rts[2], NODE_A, &hop, &metric));
+    ASSERT_EQ(hop, (node_id_t)NODE_B);
+    ASSERT(runtime_get_route(rts[0], NODE_B, &hop, &metric));
+    ASSERT_EQ(hop, (node_id_t)NODE_B);
+    ASSERT_EQ(metric, 1u);
+
+    /* A ping from A reaches C's echo actor and the reply comes back */
+    actor_id_t echo = actor_spawn(rts[2], echo_behavior, NULL, NULL, 8);
+    pinger_t p = { echo, 0, 0 };
+    actor_id_t pinger = actor_spawn(rts[0], pinger_behavior, &p, NULL, 8);
+    actor_send(rts[0], pinger, MSG_INIT, NULL, 0);
+    pump_all(rts, 3, 6);
+    ASSERT_EQ(p.pongs, 1);
+    ASSERT_EQ(p.last, 42u);
+
+    for (int i = 0; i < 3; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+static int test_route_withdrawn(void) {
+    runtime_t *rts[3] = { runtime_init(NODE_A, 256), runtime_init(NODE_B, 256),
+                          runtime_init(NODE_C, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    ASSERT(link_nodes(rts, 1, 2));
+    pump_all(rts, 3, 6);
+    ASSERT(runtime_get_route(rts[0], NODE_C, NULL, NULL));
+
+    /* B loses C: A must neither keep the route nor teach it back to B */
+    ASSERT(runtime_remove_transport(rts[1], NODE_C));
+    pump_all(rts, 3, 6);
+    ASSERT(!runtime_get_route(rts[0], NODE_C, NULL, NULL));
+    ASSERT(!runtime_get_route(rts[1], NODE_C, NULL, NULL));
+    ASSERT(!actor_send(rts[0], actor_id_make(NODE_C, 1), MSG_PING, NULL, 0));
+
+    for (int i = 0; i < 3; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+static int test_ring_prefers_shortest_and_heals(void) {
+    /* A - B - C - D - A: A reaches C in two hops either way, D in one */
+    runtime_t *rts[4] = { runtime_init(NODE_A, 256),
+                          runtime_init(NODE_B, 256),
+                          runtime_init(NODE_C, 256),
+                          runtime_init(NODE_D, 256) };
+    ASSERT(link_nodes(rts, 0, 1));
+    ASSERT(link_nodes(rts, 1, 2));
+    ASSERT(link_nodes(rts, 2, 3));
+    ASSERT(link_nodes(rts, 3, 0));
+    pump_all(rts, 4, 8);
+
+    node_id_t hop;
+    uint32_t metric;
+    ASSERT(runtime_get_route(rts[0], NODE_C, &hop, &metric));
+    ASSERT_EQ(metric, 2u);
+    ASSERT(hop == NODE_B || hop == NODE_D);
+
+    /* Cut the link A uses; traffic reroutes the long way round */
+    node_id_t via = hop;
+    runtime_t *mid = rts[via - 1];
+    ASSERT(runtime_remove_transport(rts[0], via));
+    ASSERT(runtime_remove_transport(mid, NODE_A));
+    pump_all(rts, 4, 8);
+
+    ASSERT(runtime_get_route(rts[0], NODE_C, &hop, &metric));
+    ASSERT(hop != via);
+    ASSERT_EQ(metric, 2u);
+    ASSERT(runtime_get_route(rts[0], via, &hop, &metric));
+    ASSERT_EQ(metric, 3u);
+
+    actor_id_t echo = actor_spawn(mid, echo_behavior, NULL, NULL, 8);
+    pinger_t p = { echo, 0, 0 };
+    actor_id_t pinger = actor_spawn(rts[0], pinger_behavior, &p, NULL, 8);
+    actor_send(rts[0], pinger, MSG_INIT, NULL, 0);
+    pump_all(rts, 4, 8);
+    ASSERT_EQ(p.pongs, 1);
+
+    for (int i = 0; i < 4; i++) runtime_destroy(rts[i]);
+    return 0;
+}
+
+int main(void) {
+    printf("test_routing:\n");
+    RUN_TEST(test_two_hop_delivery);
+    RUN_TEST(test_route_withdrawn);
+    RUN_TEST(test_ring_prefers_shortest_and_heals);
+    TEST_REPORT();
+}
@@ -2,6 +2,7 @@
 #include "microkernel/runtime.h"
 #include "microkernel/actor.h"
 #include "microkernel/message.h"
+#include "microkernel/transport.h"
 
 /* ── Behaviors ──────────────────────────────────────────────────────── */
 
@@ -46,6 +47,37 @@ static void my_free(void *p) {
     freed_flag = 1;
 }
 
+/* For test_many_peers: in-memory transport that counts sends */
+static int fake_destroyed = 0;
+
+typedef struct {
+    transport_t base;
+    int         sends;
+    actor_id_t  last_dest;
+} fake_transport_t;
+
+static bool fake_send(transport_t *self, const message_t *msg) {
+    fake_transport_t *ft = (fake_transport_t *)self;
+    ft->sends++;
+    ft->last_dest = msg->dest;
+    return true;
+}
+
+static message_t *fake_recv(transport_t *self) { (void)self; return NULL; }
+static bool fake_connected(transport_t *self) { (void)self; return true; }
+static void fake_destroy(transport_t *self) { free(self); fake_destroyed++; }
+
+static fake_transport_t *fake_create(node_id_t peer) {
+    fake_transport_t *ft = calloc(1, sizeof(*ft));
+    ft->base.peer_node = peer;
+    ft->base.fd = -1;
+    ft->base.send = fake_send;
+    ft->base.recv = fake_recv;
+    ft->base.is_connected = fake_connected;
+    ft->base.destroy = fake_destroy;
+    return ft;
+}
+
 /* ── Tests ──────────────────────────────────────────────────────────── */
 
 static int test_init_destroy(void) {
@@ -152,6 +184,66 @@ static int test_free_state_called(void) {
     return 0;
 }
 
+static int test_many_peers(void) {
+    enum { PEERS = 300 };
+    fake_destroyed = 0;
+    runtime_t *rt = runtime_init(7, 64);
+    fake_transport_t *fakes[PEERS];
+
+    /* Scattered full-width IDs, well past the old 16-slot table */
+    for (uint32_t i = 0; i < PEERS; i++) {
+        node_id_t node = (i + 1) * 2654435761u;
+        fakes[i] = fake_create(node);
+        ASSERT(runtime_add_transport(rt, &fakes[i]->base));
+    }
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)PEERS);
+
+    for (uint32_t i = 0; i < PEERS; i++) {
+        actor_id_t dest = actor_id_make(fakes[i]->base.peer_node, 5);
+        ASSERT(actor_send(rt, dest, 1, NULL, 0));
+        ASSERT_EQ(fakes[i]->sends, 1);
+        ASSERT_EQ(fakes[i]->last_dest, dest);
+    }
+    ASSERT(!actor_send(rt, actor_id_make(12345, 1), 1, NULL, 0));
+
+    /* Detach every other peer; the rest still route */
+    for (uint32_t i = 0; i < PEERS; i += 2)
+        ASSERT(runtime_remove_transport(rt, fakes[i]->base.peer_node));
+    ASSERT_EQ(fake_destroyed, PEERS / 2);
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)PEERS / 2);
+    for (uint32_t i = 1; i < PEERS; i += 2) {
+        ASSERT(actor_send(rt, actor_id_make(fakes[i]->base.peer_node, 5),
+                          1, NULL, 0));
+        ASSERT_EQ(fakes[i]->sends, 2);
+    }
+
+    /* Registry changes are batched, and go out (to attached peers only)
+       ahead of the next remote send */
+    actor_id_t id = actor_spawn(rt, echo_behavior, NULL, NULL, 16);
+    ASSERT(actor_register_name(rt, "svc", id));
+    ASSERT(actor_register_name(rt, "svc2", id));
+    ASSERT_EQ(fakes[1]->sends, 2);
+    ASSERT(actor_send(rt, actor_id_make(fakes[1]->base.peer_node, 5),
+                      1, NULL, 0));
+    ASSERT_EQ(fakes[1]->sends, 4);
+    for (uint32_t i = 3; i < PEERS; i += 2) ASSERT_EQ(fakes[i]->sends, 3);
+
+    /* Re-attaching a node replaces and destroys the old transport */
+    fake_transport_t *again = fake_create(fakes[1]->base.peer_node);
+    ASSERT(runtime_add_transport(rt, &again->base));
+    ASSERT_EQ(fake_destroyed, PEERS / 2 + 1);
+    ASSERT_EQ(runtime_get_transport_count(rt), (size_t)PEERS / 2);
+
+    /* Own node and node 0 are never peers */
+    fake_transport_t *self_tp = fake_create(7);
+    ASSERT(!runtime_add_transport(rt, &self_tp->base));
+    free(self_tp);
+
+    runtime_destroy(rt);
+    ASSERT_EQ(fake_destroyed, PEERS + 1);
+    return 0;
+}
+
 int main(void) {
     printf("test_runtime:\n");
     RUN_TEST(test_init_destroy);
@@ -163,5 +255,6 @@ int main(void) {
     RUN_TEST(test_clean_shutdown_with_live_actors);
     RUN_TEST(test_runtime_run);
     RUN_TEST(test_free_state_called);
+    RUN_TEST(test_many_peers);
     TEST_REPORT();
 }
@@ -15,6 +15,9 @@
 #include <errno.h>
 
 #define TEST_PORT 19885
+#define SLOW_CLIENT_PORT 19914
+#define MANY_PORT 19915
+#define MANY_CLIENTS 200
 
 /* ── Client helper ─────────────────────────────────────────────────── */
 
@@ -51,7 +54,8 @@ typedef struct {
 enum {
     SSE_PUSH,
     SSE_NAMED_EVENTS,
-    SSE_CLIENT_DISCONNECT
+    SSE_CLIENT_DISCONNECT,
+    SSE_SLOW_CLIENT
 };
 
 static bool sse_server_behavior(runtime_t *rt,
@@ -102,6 +106,18 @@ static bool sse_server_behavior(runtime_t *rt,
             /* Second timer = timeout, stop */
             runtime_stop(rt);
             return false;
+
+        case SSE_SLOW_CLIENT: {
+            /* Client never reads: pushes succeed until the backlog is
+               full, then the client is dropped */
+            static char chunk[16384];
+            memset(chunk, 'e', sizeof(chunk));
+            while (s->events_pushed < 4096 &&
+                   actor_sse_push(rt, s->sse_conn, NULL,
+                                  chunk, sizeof(chunk)))
+                s->events_pushed++;
+            return true;
+        }
         }
 
         if (s->events_pushed > 0) {
@@ -121,6 +137,48 @@ static bool sse_server_behavior(runtime_t *rt,
     return true;
 }
 
+/* ── Many concurrent streams ───────────────────────────────────────── */
+
+typedef struct {
+    http_conn_id_t conns[MANY_CLIENTS];
+    int count;
+    int pushed;
+    bool stale_rejected;
+} many_state_t;
+
+static bool many_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
+                          message_t *msg, void *state) {
+    many_state_t *s = state;
+
+    if (msg->type == 0) {
+        actor_http_listen(rt, MANY_PORT);
+        return true;
+    }
+
+    if (msg->type == MSG_HTTP_REQUEST) {
+        const http_request_payload_t *p = msg->payload;
+        if (!actor_sse_start(rt, p->conn_id)) return true;
+        s->conns[s->count++] = p->conn_id;
+        if (s->count < MANY_CLIENTS) return true;
+
+        for (int i = 0; i < s->count; i++)
+            if (actor_sse_push(rt, s->conns[i], NULL, "all", 3))
+                s->pushed++;
+
+        /* A closed conn's id stays dead */
+        actor_http_close(rt, s->conns[0]);
+        s->stale_rejected = !actor_sse_push(rt, s->conns[0], NULL, "x", 1);
+        actor_set_timer(rt, 100, false);
+        return true;
+    }
+
+    if (msg->type == MSG_TIMER) {
+        runtime_stop(rt);
+        return false;
+    }
+    return true;
+}
+
 /* ── Tests ─────────────────────────────────────────────────────────── */
 
 static int test_sse_push(void) {
@@ -276,11 +334,106 @@ static int test_sse_client_disconnect(void) {
     return 0;
 }
 
+static int test_sse_slow_client(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = connect_retry(SLOW_CLIENT_PORT, 50);
+        if (fd < 0) _exit(1);
+
+        const char *req = "GET /events HTTP/1.1\r\n"
+                          "Host: localhost\r\n"
+                          "\r\n";
+        send(fd, req, strlen(req), 0);
+        usleep(1000000);
+        close(fd);
+        _exit(0);
+    }
+
+    runtime_t *rt = runtime_init(1, 16);
+    sse_server_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.port = SLOW_CLIENT_PORT;
+    state.scenario = SSE_SLOW_CLIENT;
+
+    actor_id_t aid = actor_spawn(rt, sse_server_behavior, &state, NULL, 32);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+
+    /* Dropped with MSG_HTTP_CONN_CLOSED, not buffered without bound */
+    ASSERT(state.conn_closed);
+    ASSERT(state.events_pushed > 0);
+    ASSERT(state.events_pushed < 4096);
+
+    runtime_destroy(rt);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
+static int test_sse_many_clients(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        static int fds[MANY_CLIENTS];
+        const char *req = "GET /events HTTP/1.1\r\n"
+                          "Host: localhost\r\n"
+                          "\r\n";
+        for (int i = 0; i < MANY_CLIENTS; i++) {
+            fds[i] = connect_retry(MANY_PORT, 50);
+            if (fds[i] < 0) _exit(1);
+            send(fds[i], req, strlen(req), 0);
+        }
+
+        /* Every client gets the event */
+        int got = 0;
+        for (int i = 0; i < MANY_CLIENTS; i++) {
+            char buf[1024];
+            size_t pos = 0;
+            while (pos < sizeof(buf) - 1) {
+                ssize_t n = recv(fds[i], buf + pos, sizeof(buf) - 1 - pos, 0);
+                if (n <= 0) break;
+                pos += (size_t)n;
+                buf[pos] = '\0';
+                if (strstr(buf, "data: all\n\n")) {
+                    got++;
+                    break;
+                }
+            }
+            close(fds[i]);
+        }
+        _exit(got == MANY_CLIENTS ? 0 : 2);
+    }
+
+    runtime_t *rt = runtime_init(1, 16);
+    many_state_t state;
+    memset(&state, 0, sizeof(state));
+
+    actor_id_t aid = actor_spawn(rt, many_behavior, &state, NULL, 256);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+
+    ASSERT_EQ(state.count, MANY_CLIENTS);
+    ASSERT_EQ(state.pushed, MANY_CLIENTS);
+    ASSERT(state.stale_rejected);
+
+    runtime_destroy(rt);
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    return 0;
+}
+
 int main(void) {
     signal(SIGPIPE, SIG_IGN);
     printf("test_sse_server:\n");
     RUN_TEST(test_sse_push);
     RUN_TEST(test_sse_named_events);
     RUN_TEST(test_sse_client_disconnect);
+    RUN_TEST(test_sse_slow_client);
+    RUN_TEST(test_sse_many_clients);
     TEST_REPORT();
 }
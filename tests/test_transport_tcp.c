@@ -1,8 +1,12 @@
 #define _DEFAULT_SOURCE
 #include "test_framework.h"
 #include "microkernel/transport_tcp.h"
+#include "microkernel/wire.h"
 #include "microkernel/message.h"
 #include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #define TEST_PORT 19876
 
@@ -138,6 +142,85 @@ static int test_destroy_cleanup(void) {
     return 0;
 }
 
+static int test_v2_fifo_mixed_sizes(void) {
+    transport_t *server = transport_tcp_listen("127.0.0.1", TEST_PORT, 2);
+    ASSERT_NOT_NULL(server);
+
+    transport_t *client = transport_tcp_connect("127.0.0.1", TEST_PORT, 1);
+    ASSERT_NOT_NULL(client);
+
+    transport_tcp_set_wire_version(server, WIRE_VERSION_2);
+    transport_tcp_set_wire_version(client, WIRE_VERSION_2);
+    transport_tcp_set_compression(client, WIRE_COMPRESS_THRESHOLD);
+
+    /* Small, empty and multi-chunk (compressed) payloads back to back */
+    size_t sizes[] = {3, 0, 100000, 1};
+    for (size_t i = 0; i < 4; i++) {
+        uint8_t *data = malloc(sizes[i] + 1);
+        ASSERT_NOT_NULL(data);
+        memset(data, (int)(0x40 + i), sizes[i] + 1);
+        message_t *msg = message_create(0x200000001ULL, 0x100000001ULL,
+                                        (msg_type_t)(0xFF000010 + i),
+                                        sizes[i] ? data : NULL, sizes[i]);
+        free(data);
+        ASSERT_NOT_NULL(msg);
+        ASSERT(client->send(client, msg));
+        message_destroy(msg);
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        message_t *recv_msg = NULL;
+        for (int tries = 0; tries < 1000 && !recv_msg; tries++) {
+            recv_msg = server->recv(server);
+            if (!recv_msg) usleep(1000);
+        }
+        ASSERT_NOT_NULL(recv_msg);
+        ASSERT_EQ(recv_msg->type, (msg_type_t)(0xFF000010 + i));
+        ASSERT_EQ(recv_msg->source, 0x200000001ULL);
+        ASSERT_EQ(recv_msg->dest, 0x100000001ULL);
+        ASSERT_EQ(recv_msg->payload_size, sizes[i]);
+        if (sizes[i] > 0) {
+            const uint8_t *p = recv_msg->payload;
+            ASSERT_EQ(p[0], (uint8_t)(0x40 + i));
+            ASSERT_EQ(p[sizes[i] - 1], (uint8_t)(0x40 + i));
+        }
+        message_destroy(recv_msg);
+    }
+
+    client->destroy(client);
+    server->destroy(server);
+    return 0;
+}
+
+/* A frame header that can't be parsed drops the link: the bytes after
+   it would otherwise be read as a new frame from mid-stream */
+static int test_v2_corrupt_drops_conn(void) {
+    transport_t *server = transport_tcp_listen("127.0.0.1", TEST_PORT, 2);
+    ASSERT_NOT_NULL(server);
+    transport_tcp_set_wire_version(server, WIRE_VERSION_2);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = inet_addr("127.0.0.1")
+    };
+    ASSERT_EQ(connect(fd, (struct sockaddr *)&addr, sizeof(addr)), 0);
+    const uint8_t junk[] = { 0xFF, 0x01, 0x02, 0x03 };   /* unknown flags */
+    ASSERT_EQ(send(fd, junk, sizeof(junk), 0), (ssize_t)sizeof(junk));
+    usleep(1000);
+
+    ASSERT_NULL(server->recv(server));   /* accepts, reads, drops */
+    ASSERT(!server->is_connected(server));
+
+    /* The peer sees the close */
+    char buf[8];
+    ASSERT_EQ(recv(fd, buf, sizeof(buf), 0), 0);
+    close(fd);
+    server->destroy(server);
+    return 0;
+}
+
 int main(void) {
     printf("test_transport_tcp:\n");
     RUN_TEST(test_send_recv_simple);
@@ -145,5 +228,7 @@ int main(void) {
     RUN_TEST(test_fifo_order);
     RUN_TEST(test_nonblocking_recv_empty);
     RUN_TEST(test_destroy_cleanup);
+    RUN_TEST(test_v2_fifo_mixed_sizes);
+    RUN_TEST(test_v2_corrupt_drops_conn);
     TEST_REPORT();
 }
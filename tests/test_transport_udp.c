@@ -4,6 +4,10 @@
 #include "microkernel/wire.h"
 #include "microkernel/message.h"
 #include <unistd.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #define TEST_PORT 19878
 
@@ -80,37 +84,132 @@ static int test_nonblocking_recv_empty(void) {
     return 0;
 }
 
-static int test_oversized_rejected(void) {
+static message_t *recv_retry(transport_t *tp) {
+    message_t *msg = NULL;
+    for (int tries = 0; tries < 200 && !msg; tries++) {
+        msg = tp->recv(tp);
+        if (!msg) usleep(1000);
+    }
+    return msg;
+}
+
+static int test_fragmented_large_message(void) {
     transport_t *server = transport_udp_bind("127.0.0.1", TEST_PORT, 2);
     ASSERT_NOT_NULL(server);
 
     transport_t *client = transport_udp_connect("127.0.0.1", TEST_PORT, 1);
     ASSERT_NOT_NULL(client);
 
-    /* Create a message with payload that exceeds UDP_MAX_DGRAM when serialized */
-    size_t big_size = 65507;  /* max dgram */
-    uint8_t *big_data = calloc(1, big_size);
+    /* Larger than a single UDP datagram can carry */
+    size_t big_size = 100000;
+    uint8_t *big_data = malloc(big_size);
     ASSERT_NOT_NULL(big_data);
+    for (size_t i = 0; i < big_size; i++) big_data[i] = (uint8_t)(i * 7);
 
     message_t *msg = message_create(1, 2, 3, big_data, big_size);
     ASSERT_NOT_NULL(msg);
+    ASSERT(client->send(client, msg));
+    message_destroy(msg);
 
-    /* total wire size = 28 (header) + 65507 = 65535 > UDP_MAX_DGRAM → rejected */
-    bool sent = client->send(client, msg);
-    ASSERT(!sent);
+    message_t *recv_msg = recv_retry(server);
+    ASSERT_NOT_NULL(recv_msg);
+    ASSERT_EQ(recv_msg->type, (msg_type_t)3);
+    ASSERT_EQ(recv_msg->payload_size, big_size);
+    ASSERT(memcmp(recv_msg->payload, big_data, big_size) == 0);
+    message_destroy(recv_msg);
+
+    /* Beyond UDP_MAX_MESSAGE is still rejected */
+    message_t huge = { .source = 1, .dest = 2, .type = 3,
+                       .payload = big_data,
+                       .payload_size = (size_t)UDP_MAX_MESSAGE + 1 };
+    ASSERT(!client->send(client, &huge));
 
-    message_destroy(msg);
     free(big_data);
     client->destroy(client);
     server->destroy(server);
     return 0;
 }
 
+/* A whole message in one datagram well past UDP_FRAG_MTU, as senders
+   without fragmentation produce it */
+static int test_recv_large_datagram(void) {
+    transport_t *server = transport_udp_bind("127.0.0.1", TEST_PORT, 2);
+    ASSERT_NOT_NULL(server);
+
+    size_t size = 30000;
+    uint8_t *data = malloc(size);
+    ASSERT_NOT_NULL(data);
+    for (size_t i = 0; i < size; i++) data[i] = (uint8_t)(i % 253);
+    message_t *msg = message_create(0x200000001ULL, 0x100000001ULL, 77,
+                                    data, size);
+    size_t wire_size;
+    void *frame = wire_serialize_net(msg, &wire_size);
+    ASSERT_NOT_NULL(frame);
+    message_destroy(msg);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = inet_addr("127.0.0.1")
+    };
+    ASSERT_EQ(sendto(fd, frame, wire_size, 0, (struct sockaddr *)&addr,
+                     sizeof(addr)), (ssize_t)wire_size);
+    free(frame);
+    usleep(1000);
+
+    message_t *recv_msg = server->recv(server);
+    ASSERT_NOT_NULL(recv_msg);
+    ASSERT_EQ(recv_msg->type, (msg_type_t)77);
+    ASSERT_EQ(recv_msg->payload_size, size);
+    ASSERT(memcmp(recv_msg->payload, data, size) == 0);
+    message_destroy(recv_msg);
+
+    free(data);
+    close(fd);
+    server->destroy(server);
+    return 0;
+}
+
+static int test_batched_send_flush(void) {
+    transport_t *server = transport_udp_bind("127.0.0.1", TEST_PORT, 2);
+    ASSERT_NOT_NULL(server);
+
+    transport_t *client = transport_udp_connect("127.0.0.1", TEST_PORT, 1);
+    ASSERT_NOT_NULL(client);
+    transport_udp_set_batch(client, 16);
+
+    for (uint32_t i = 0; i < 10; i++) {
+        message_t *msg = message_create(1, 2, 100 + i, &i, sizeof(i));
+        ASSERT_NOT_NULL(msg);
+        ASSERT(client->send(client, msg));
+        message_destroy(msg);
+    }
+
+    /* Nothing leaves until the batch is flushed */
+    usleep(1000);
+    ASSERT_NULL(server->recv(server));
+    ASSERT(client->flush(client));
+
+    for (uint32_t i = 0; i < 10; i++) {
+        message_t *recv_msg = recv_retry(server);
+        ASSERT_NOT_NULL(recv_msg);
+        ASSERT_EQ(recv_msg->type, (msg_type_t)(100 + i));
+        message_destroy(recv_msg);
+    }
+
+    client->destroy(client);
+    server->destroy(server);
+    return 0;
+}
+
 int main(void) {
     printf("test_transport_udp:\n");
     RUN_TEST(test_send_recv_simple);
     RUN_TEST(test_send_recv_with_payload);
     RUN_TEST(test_nonblocking_recv_empty);
-    RUN_TEST(test_oversized_rejected);
+    RUN_TEST(test_fragmented_large_message);
+    RUN_TEST(test_recv_large_datagram);
+    RUN_TEST(test_batched_send_flush);
     TEST_REPORT();
 }
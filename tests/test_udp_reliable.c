@@ -0,0 +1,176 @@
+#define _DEFAULT_SOURCE
+#include "test_framework.h"
+#include "udp_shim.h"
+#include "microkernel/transport_udp.h"
+#include "microkernel/message.h"
+#include <time.h>
+
+#define SERVER_PORT 19893
+#define SHIM_PORT   19894
+
+typedef struct {
+    udp_shim_t   shim;
+    transport_t *server;
+    transport_t *client;
+} rig_t;
+
+static bool rig_open(rig_t *rig, udp_reliable_mode_t mode, double loss,
+                     double reorder) {
+    if (!udp_shim_open(&rig->shim, SHIM_PORT, SERVER_PORT, loss, reorder, 42))
+        return false;
+    rig->server = transport_udp_bind("127.0.0.1", SERVER_PORT, 2);
+    rig->client = transport_udp_connect("127.0.0.1", SHIM_PORT, 1);
+    return rig->server && rig->client &&
+           transport_udp_set_reliable(rig->server, mode) &&
+           transport_udp_set_reliable(rig->client, mode);
+}
+
+static void rig_close(rig_t *rig) {
+    if (rig->client) rig->client->destroy(rig->client);
+    if (rig->server) rig->server->destroy(rig->server);
+    udp_shim_close(&rig->shim);
+}
+
+/* Drive both ends and the relay once; returns one delivered message */
+static message_t *rig_step(rig_t *rig) {
+    udp_shim_pump(&rig->shim);
+    message_t *msg = rig->server->recv(rig->server);
+    message_t *stray = rig->client->recv(rig->client);   /* takes ACKs */
+    if (stray) message_destroy(stray);
+    rig->client->flush(rig->client);
+    rig->server->flush(rig->server);
+    if (!msg) usleep(200);
+    return msg;
+}
+
+static size_t msg_size(uint32_t i) {
+    return (i % 10 == 9) ? 6000 + i : 16 + i % 64;   /* every tenth fragments */
+}
+
+static message_t *make_msg(uint32_t i) {
+    size_t size = msg_size(i);
+    uint8_t *data = malloc(size);
+    for (size_t k = 0; k < size; k++) data[k] = (uint8_t)(i + k);
+    memcpy(data, &i, sizeof(i));
+    message_t *msg = message_create(1, 2, 100, data, size);
+    free(data);
+    return msg;
+}
+
+static int check_msg(const message_t *msg, uint32_t *idx) {
+    ASSERT(msg->payload_size >= sizeof(uint32_t));
+    memcpy(idx, msg->payload, sizeof(*idx));
+    ASSERT_EQ(msg->payload_size, msg_size(*idx));
+    const uint8_t *p = msg->payload;
+    for (size_t k = sizeof(uint32_t); k < msg->payload_size; k++)
+        ASSERT_EQ(p[k], (uint8_t)(*idx + k));
+    return 0;
+}
+
+/* Send count messages through the relay, collecting them at the server */
+static int exchange(rig_t *rig, uint32_t count, bool ordered) {
+    uint8_t *seen = calloc(count, 1);
+    uint32_t sent = 0, received = 0, expect = 0;
+    time_t deadline = time(NULL) + 20;
+
+    while (received < count && time(NULL) < deadline) {
+        while (sent < count) {
+            message_t *msg = make_msg(sent);
+            bool ok = rig->client->send(rig->client, msg);
+            message_destroy(msg);
+            if (!ok) break;   /* window full: wait for ACKs */
+            sent++;
+        }
+
+        message_t *in = rig_step(rig);
+        if (!in) continue;
+        uint32_t idx;
+        ASSERT_EQ(check_msg(in, &idx), 0);
+        message_destroy(in);
+        ASSERT(idx < count);
+        ASSERT(!seen[idx]);
+        seen[idx] = 1;
+        if (ordered) ASSERT_EQ(idx, expect++);
+        received++;
+    }
+    free(seen);
+    ASSERT_EQ(received, count);
+    return 0;
+}
+
+static int test_ordered_under_loss(void) {
+    rig_t rig;
+    ASSERT(rig_open(&rig, UDP_RELIABLE_ORDERED, 0.10, 0.10));
+    ASSERT_EQ(exchange(&rig, 2000, true), 0);
+
+    udp_rel_stats_t stats;
+    ASSERT(transport_udp_get_stats(rig.client, &stats));
+    ASSERT(stats.retransmits > 0);
+    ASSERT(rig.shim.dropped > 0);
+    ASSERT(rig.shim.reordered > 0);
+    rig_close(&rig);
+    return 0;
+}
+
+static int test_unordered_exactly_once(void) {
+    rig_t rig;
+    ASSERT(rig_open(&rig, UDP_RELIABLE_UNORDERED, 0.05, 0.20));
+    ASSERT_EQ(exchange(&rig, 2000, false), 0);
+
+    /* Nothing else shows up once everything has been delivered */
+    for (int i = 0; i < 50; i++) {
+        message_t *extra = rig_step(&rig);
+        ASSERT_NULL(extra);
+    }
+    rig_close(&rig);
+    return 0;
+}
+
+static int test_window_backpressure(void) {
+    rig_t rig;
+    ASSERT(rig_open(&rig, UDP_RELIABLE_ORDERED, 0.0, 0.0));
+
+    /* Without ACKs the sender refuses once the window is full */
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < UDP_REL_WINDOW + 10; i++) {
+        message_t *msg = message_create(1, 2, 7, &i, sizeof(i));
+        bool ok = rig.client->send(rig.client, msg);
+        message_destroy(msg);
+        if (!ok) break;
+        accepted++;
+    }
+    ASSERT_EQ(accepted, (uint32_t)UDP_REL_WINDOW);
+
+    udp_rel_stats_t stats;
+    ASSERT(transport_udp_get_stats(rig.client, &stats));
+    ASSERT(stats.in_flight <= UDP_REL_WINDOW);
+
+    /* Draining the receiver frees the window again */
+    uint32_t got = 0;
+    time_t deadline = time(NULL) + 10;
+    while (got < accepted && time(NULL) < deadline) {
+        message_t *in = rig_step(&rig);
+        if (!in) continue;
+        uint32_t v;
+        memcpy(&v, in->payload, sizeof(v));
+        ASSERT_EQ(v, got);
+        message_destroy(in);
+        got++;
+    }
+    ASSERT_EQ(got, accepted);
+    for (int i = 0; i < 20; i++) rig_step(&rig);
+
+    message_t *msg = message_create(1, 2, 7, NULL, 0);
+    ASSERT(rig.client->send(rig.client, msg));
+    message_destroy(msg);
+    rig_close(&rig);
+    return 0;
+}
+
+int main(void) {
+    printf("test_udp_reliable:\n");
+    RUN_TEST(test_ordered_under_loss);
+    RUN_TEST(test_unordered_exactly_once);
+    RUN_TEST(test_window_backpressure);
+    TEST_REPORT();
+}
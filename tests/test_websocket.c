@@ -215,6 +215,8 @@ typedef struct {
     bool opened;
     bool closed;
     bool error;
+    bool http_error;
+    char error_msg[128];
     uint16_t close_code;
     int msg_count;
     char messages[MAX_WS_MSGS][256];
@@ -279,6 +281,14 @@ static bool ws_test_behavior(runtime_t *rt, actor_t *self __attribute__((unused)
         return false;
     }
 
+    if (msg->type == MSG_HTTP_ERROR) {
+        const http_error_payload_t *p = msg->payload;
+        s->http_error = true;
+        snprintf(s->error_msg, sizeof(s->error_msg), "%s", p->message);
+        runtime_stop(rt);
+        return false;
+    }
+
     return true;
 }
 
@@ -357,11 +367,32 @@ static int test_ws_server_close(void) {
     return 0;
 }
 
+static int test_ws_connect_error(void) {
+    runtime_t *rt = runtime_init(1, 16);
+    ws_test_state_t state;
+    memset(&state, 0, sizeof(state));
+    snprintf(state.url, sizeof(state.url), "ws://no-such-host.invalid/");
+
+    actor_id_t aid = actor_spawn(rt, ws_test_behavior, &state, NULL, 32);
+    actor_send(rt, aid, 0, NULL, 0);
+    runtime_run(rt);
+
+    /* Never opened, so the reason arrives as MSG_HTTP_ERROR */
+    ASSERT(!state.opened);
+    ASSERT(!state.error);
+    ASSERT(state.http_error);
+    ASSERT(strcmp(state.error_msg, "host not found") == 0);
+
+    runtime_destroy(rt);
+    return 0;
+}
+
 int main(void) {
     signal(SIGPIPE, SIG_IGN);
     printf("test_websocket:\n");
     RUN_TEST(test_ws_echo);
     RUN_TEST(test_ws_ping_pong);
     RUN_TEST(test_ws_server_close);
+    RUN_TEST(test_ws_connect_error);
     TEST_REPORT();
 }
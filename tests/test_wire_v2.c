@@ -0,0 +1,194 @@
+#include "test_framework.h"
+#include "microkernel/wire.h"
+#include "microkernel/message.h"
+
+static int test_v2_roundtrip_with_payload(void) {
+    uint8_t data[] = {0x90, 0x3C, 0x7F};
+    message_t *orig = message_create(0x100000001ULL, 0x200000002ULL,
+                                     42, data, sizeof(data));
+    ASSERT_NOT_NULL(orig);
+
+    size_t wire_size;
+    void *buf = wire_serialize_v2(orig, &wire_size);
+    ASSERT_NOT_NULL(buf);
+    /* flags + size + type + 4 one-byte id varints */
+    ASSERT_EQ(wire_size, (size_t)WIRE_V2_MIN_HEADER + sizeof(data));
+
+    message_t *decoded = wire_deserialize_v2(buf, wire_size);
+    ASSERT_NOT_NULL(decoded);
+    ASSERT_EQ(decoded->source, orig->source);
+    ASSERT_EQ(decoded->dest, orig->dest);
+    ASSERT_EQ(decoded->type, orig->type);
+    ASSERT_EQ(decoded->payload_size, orig->payload_size);
+    ASSERT(memcmp(decoded->payload, data, sizeof(data)) == 0);
+
+    message_destroy(decoded);
+    free(buf);
+    message_destroy(orig);
+    return 0;
+}
+
+static int test_v2_roundtrip_empty(void) {
+    message_t *orig = message_create(ACTOR_ID_INVALID, 0x300000007ULL,
+                                     7, NULL, 0);
+    ASSERT_NOT_NULL(orig);
+
+    size_t wire_size;
+    void *buf = wire_serialize_v2(orig, &wire_size);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_EQ(wire_size, (size_t)WIRE_V2_MIN_HEADER);
+
+    message_t *decoded = wire_deserialize_v2(buf, wire_size);
+    ASSERT_NOT_NULL(decoded);
+    ASSERT_EQ(decoded->source, ACTOR_ID_INVALID);
+    ASSERT_EQ(decoded->dest, orig->dest);
+    ASSERT_EQ(decoded->payload_size, (size_t)0);
+    ASSERT_NULL(decoded->payload);
+
+    message_destroy(decoded);
+    free(buf);
+    message_destroy(orig);
+    return 0;
+}
+
+static int test_v2_system_type_compact(void) {
+    message_t *msg = message_create(0x100000001ULL, 0x200000002ULL,
+                                    0xFF000012, NULL, 0);
+    ASSERT_NOT_NULL(msg);
+
+    size_t wire_size;
+    uint8_t *buf = wire_serialize_v2(msg, &wire_size);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_EQ(wire_size, (size_t)WIRE_V2_MIN_HEADER);
+    ASSERT(buf[0] & WIRE_FLAG_SYS_TYPE);
+
+    message_t *decoded = wire_deserialize_v2(buf, wire_size);
+    ASSERT_NOT_NULL(decoded);
+    ASSERT_EQ(decoded->type, (msg_type_t)0xFF000012);
+
+    message_destroy(decoded);
+    free(buf);
+    message_destroy(msg);
+    return 0;
+}
+
+static int test_v2_max_fields(void) {
+    wire_v2_header_t hdr = {
+        .flags = WIRE_FLAG_TRACE | WIRE_FLAG_COMPRESSED,
+        .source = 0xFFFFFFFFFFFFFFFFULL,
+        .dest = 0xFFFFFFFEFFFFFFFDULL,
+        .type = 0x7FFFFFFF,
+        .payload_size = 0xFFFFFFFF,
+        .trace_id = 0xFFFFFFFFFFFFFFFFULL,
+        .raw_size = 0xFFFFFFFF
+    };
+    uint8_t buf[WIRE_V2_MAX_HEADER];
+    size_t n = wire_v2_encode_header(&hdr, buf);
+    ASSERT_EQ(n, (size_t)WIRE_V2_MAX_HEADER);
+
+    wire_v2_header_t out;
+    ASSERT_EQ(wire_v2_decode_header(buf, n, &out), (int)n);
+    ASSERT_EQ(out.source, hdr.source);
+    ASSERT_EQ(out.dest, hdr.dest);
+    ASSERT_EQ(out.type, hdr.type);
+    ASSERT_EQ(out.payload_size, hdr.payload_size);
+    ASSERT_EQ(out.trace_id, hdr.trace_id);
+    ASSERT_EQ(out.raw_size, hdr.raw_size);
+    ASSERT(out.flags & WIRE_FLAG_TRACE);
+    return 0;
+}
+
+static int test_v2_truncated_header(void) {
+    wire_v2_header_t hdr = {
+        .source = 0x500001234ULL, .dest = 0x600005678ULL,
+        .type = 300, .payload_size = 70000
+    };
+    uint8_t buf[WIRE_V2_MAX_HEADER];
+    size_t n = wire_v2_encode_header(&hdr, buf);
+
+    /* Every strict prefix asks for more bytes */
+    wire_v2_header_t out;
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(wire_v2_decode_header(buf, i, &out), 0);
+    }
+    ASSERT_EQ(wire_v2_decode_header(buf, n, &out), (int)n);
+
+    /* Header complete but payload missing */
+    ASSERT_NULL(wire_deserialize_v2(buf, n));
+    return 0;
+}
+
+static int test_v2_malformed_rejected(void) {
+    wire_v2_header_t out;
+
+    /* Unknown flag bit */
+    uint8_t bad_flags[] = {0x80, 0, 0, 0, 0, 0, 0};
+    ASSERT_EQ(wire_v2_decode_header(bad_flags, sizeof(bad_flags), &out), -1);
+
+    /* 32-bit field with six continuation bytes */
+    uint8_t long_varint[] = {0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    ASSERT_EQ(wire_v2_decode_header(long_varint, sizeof(long_varint), &out), -1);
+
+    /* Corrupt compressed block */
+    uint8_t corrupt[] = {WIRE_FLAG_COMPRESSED, 1, 1, 0, 0, 0, 0, 5, 0xF0};
+    ASSERT_NULL(wire_deserialize_v2(corrupt, sizeof(corrupt)));
+
+    /* raw_size far beyond what the block could expand to */
+    uint8_t bomb[] = {WIRE_FLAG_COMPRESSED, 1, 1, 0, 0, 0, 0,
+                      0x80, 0x80, 0x80, 0x01, 0x00};
+    ASSERT_NULL(wire_deserialize_v2(bomb, sizeof(bomb)));
+    return 0;
+}
+
+static int test_v2_compressed_roundtrip(void) {
+    char json[3000];
+    size_t n = 0;
+    while (n + 32 < sizeof(json))
+        n += (size_t)snprintf(json + n, sizeof(json) - n,
+                              "{\"path\":\"/node/%zu\"},", n % 5);
+    message_t *msg = message_create(actor_id_make(2, 9), actor_id_make(1, 3),
+                                    77, json, n);
+    ASSERT_NOT_NULL(msg);
+
+    size_t plain_size, z_size;
+    void *plain = wire_serialize_v2(msg, &plain_size);
+    uint8_t *z = wire_serialize_v2_compressed(msg, WIRE_COMPRESS_THRESHOLD,
+                                              &z_size);
+    ASSERT_NOT_NULL(plain);
+    ASSERT_NOT_NULL(z);
+    ASSERT(z[0] & WIRE_FLAG_COMPRESSED);
+    ASSERT(z_size < plain_size / 2);
+
+    message_t *decoded = wire_deserialize_v2(z, z_size);
+    ASSERT_NOT_NULL(decoded);
+    ASSERT_EQ(decoded->type, (msg_type_t)77);
+    ASSERT_EQ(decoded->source, msg->source);
+    ASSERT_EQ(decoded->payload_size, n);
+    ASSERT(memcmp(decoded->payload, json, n) == 0);
+    message_destroy(decoded);
+    free(z);
+    free(plain);
+
+    /* Below the threshold the frame is left alone */
+    message_t *small = message_create(1, 2, 5, json, 100);
+    z = wire_serialize_v2_compressed(small, WIRE_COMPRESS_THRESHOLD, &z_size);
+    ASSERT_NOT_NULL(z);
+    ASSERT(!(z[0] & WIRE_FLAG_COMPRESSED));
+    ASSERT_EQ(z_size, (size_t)WIRE_V2_MIN_HEADER + 100);
+    free(z);
+    message_destroy(small);
+    message_destroy(msg);
+    return 0;
+}
+
+int main(void) {
+    printf("test_wire_v2:\n");
+    RUN_TEST(test_v2_roundtrip_with_payload);
+    RUN_TEST(test_v2_roundtrip_empty);
+    RUN_TEST(test_v2_system_type_compact);
+    RUN_TEST(test_v2_max_fields);
+    RUN_TEST(test_v2_truncated_header);
+    RUN_TEST(test_v2_malformed_rejected);
+    RUN_TEST(test_v2_compressed_roundtrip);
+    TEST_REPORT();
+}
@@ -72,7 +72,7 @@ static bool ws_rw_behavior(runtime_t *rt, actor_t *self __attribute__((unused)),
         return false;
     }
 
-    if (msg->type == MSG_WS_ERROR) {
+    if (msg->type == MSG_WS_ERROR || msg->type == MSG_HTTP_ERROR) {
         s->error = true;
         runtime_stop(rt);
         return false;
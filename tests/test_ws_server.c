@@ -55,16 +55,18 @@ static bool ws_client_handshake(int fd) {
                      "\r\n", key);
     send(fd, req, (size_t)n, 0);
 
+    /* Byte at a time: frames the server sends right after the 101 must
+       be left for ws_client_recv */
     char resp[1024];
     size_t pos = 0;
-    for (int i = 0; i < 100 && pos < sizeof(resp) - 1; i++) {
-        ssize_t r = recv(fd, resp + pos, sizeof(resp) - 1 - pos, 0);
+    while (pos < sizeof(resp) - 1) {
+        ssize_t r = recv(fd, resp + pos, 1, 0);
         if (r <= 0) break;
-        pos += (size_t)r;
+        pos++;
         resp[pos] = '\0';
-        if (strstr(resp, "\r\n\r\n")) break;
-        usleep(5000);
+        if (pos >= 4 && memcmp(resp + pos - 4, "\r\n\r\n", 4) == 0) break;
     }
+    resp[pos] = '\0';
 
     return strstr(resp, "101 Switching Protocols") != NULL;
 }
@@ -0,0 +1,150 @@
+#ifndef UDP_SHIM_H
+#define UDP_SHIM_H
+
+/* Lossy UDP relay for tests and benchmarks.  The client connects to
+   front_port; the shim forwards to 127.0.0.1:back_port and back again,
+   dropping and swapping datagrams with the given probabilities.
+   Single-threaded: call udp_shim_pump() from the test loop. */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define UDP_SHIM_MAX_DGRAM 2048
+
+typedef struct {
+    int      fd;                 /* socket datagrams are forwarded out of */
+    uint8_t  held[UDP_SHIM_MAX_DGRAM];
+    size_t   held_len;           /* 0 = nothing held back */
+} udp_shim_dir_t;
+
+typedef struct {
+    int                front, back;
+    struct sockaddr_in client;
+    bool               have_client;
+    double             loss, reorder;
+    uint32_t           rng;
+    udp_shim_dir_t     up, down;     /* client->server, server->client */
+    uint64_t           forwarded, dropped, reordered;
+} udp_shim_t;
+
+static double udp_shim_rand(udp_shim_t *s) {
+    s->rng ^= s->rng << 13;
+    s->rng ^= s->rng >> 17;
+    s->rng ^= s->rng << 5;
+    return (double)s->rng / 4294967296.0;
+}
+
+static int udp_shim_socket(uint16_t bind_port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    int buf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf, sizeof(buf));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buf, sizeof(buf));
+    struct sockaddr_in addr = { .sin_family = AF_INET,
+                                .sin_port = htons(bind_port),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool udp_shim_open(udp_shim_t *s, uint16_t front_port,
+                          uint16_t back_port, double loss, double reorder,
+                          uint32_t seed) {
+    memset(s, 0, sizeof(*s));
+    s->loss = loss;
+    s->reorder = reorder;
+    s->rng = seed ? seed : 1;
+    s->front = udp_shim_socket(front_port);
+    s->back = udp_shim_socket(0);
+    if (s->front < 0 || s->back < 0) return false;
+
+    struct sockaddr_in server = { .sin_family = AF_INET,
+                                  .sin_port = htons(back_port),
+                                  .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (connect(s->back, (struct sockaddr *)&server, sizeof(server)) < 0)
+        return false;
+    s->up.fd = s->back;
+    s->down.fd = s->front;
+    return true;
+}
+
+static void udp_shim_out(udp_shim_t *s, udp_shim_dir_t *d,
+                         const uint8_t *buf, size_t len) {
+    if (d == &s->down) {
+        sendto(d->fd, buf, len, 0, (struct sockaddr *)&s->client,
+               sizeof(s->client));
+    } else {
+        send(d->fd, buf, len, 0);
+    }
+    s->forwarded++;
+}
+
+static void udp_shim_forward(udp_shim_t *s, udp_shim_dir_t *d,
+                             const uint8_t *buf, size_t len) {
+    if (udp_shim_rand(s) < s->loss) {
+        s->dropped++;
+        return;
+    }
+    /* Hold one datagram back so that the next overtakes it */
+    if (d->held_len == 0 && udp_shim_rand(s) < s->reorder) {
+        memcpy(d->held, buf, len);
+        d->held_len = len;
+        s->reordered++;
+        return;
+    }
+    udp_shim_out(s, d, buf, len);
+    if (d->held_len) {
+        udp_shim_out(s, d, d->held, d->held_len);
+        d->held_len = 0;
+    }
+}
+
+/* Relay everything currently queued in both directions */
+static void udp_shim_pump(udp_shim_t *s) {
+    uint8_t buf[UDP_SHIM_MAX_DGRAM];
+    for (;;) {
+        bool any = false;
+        struct sockaddr_in from;
+        socklen_t flen = sizeof(from);
+        ssize_t n = recvfrom(s->front, buf, sizeof(buf), 0,
+                             (struct sockaddr *)&from, &flen);
+        if (n > 0) {
+            s->client = from;
+            s->have_client = true;
+            udp_shim_forward(s, &s->up, buf, (size_t)n);
+            any = true;
+        }
+        n = recv(s->back, buf, sizeof(buf), 0);
+        if (n > 0 && s->have_client) {
+            udp_shim_forward(s, &s->down, buf, (size_t)n);
+            any = true;
+        }
+        if (!any) break;
+    }
+    /* A held datagram is released by the next pump at the latest */
+    if (s->up.held_len) {
+        udp_shim_out(s, &s->up, s->up.held, s->up.held_len);
+        s->up.held_len = 0;
+    }
+    if (s->down.held_len) {
+        udp_shim_out(s, &s->down, s->down.held, s->down.held_len);
+        s->down.held_len = 0;
+    }
+}
+
+static void udp_shim_close(udp_shim_t *s) {
+    if (s->front >= 0) close(s->front);
+    if (s->back >= 0) close(s->back);
+}
+
+#endif /* UDP_SHIM_H */